@@ -44,6 +44,7 @@ namespace QuickFAST{
         PCAPFILE_RECEIVER = DecoderConfigurationEnums::PCAPFILE_RECEIVER,
         ASYNCHRONOUS_FILE_RECEIVER = DecoderConfigurationEnums::ASYNCHRONOUS_FILE_RECEIVER,
         BUFFER_RECEIVER = DecoderConfigurationEnums::BUFFER_RECEIVER,
+        MAPPED_FILE_RECEIVER = DecoderConfigurationEnums::MAPPED_FILE_RECEIVER,
         UNSPECIFIED_RECEIVER = DecoderConfigurationEnums::UNSPECIFIED_RECEIVER
       };
 
@@ -96,11 +97,13 @@ namespace QuickFAST{
         : head_(0)
         , reset_(false)
         , strict_(true)
+        , exceptionFree_(false)
         , asynchReads_(false)
         , echoType_(Application::DecoderConfigurationEnums::HEX)
         , echoMessage_(true)
         , echoField_(false)
         , pcapWordSize_(0)
+        , pcapFilterPort_(0)
         , packetHeaderType_(NO_HEADER)
         , packetHeaderMessageSizeBytes_(0)
         , packetHeaderBigEndian_(true)
@@ -113,11 +116,32 @@ namespace QuickFAST{
         , messageHeaderSuffixCount_(0)
         , assemblerType_(UNSPECIFIED_ASSEMBLER)
         , waitForCompleteMessage_(false)
+        , resumableDecoding_(false)
         , receiverType_(UNSPECIFIED_RECEIVER)
         , bufferSize_(1500)
         , bufferCount_(2)
+        , ringBuffer_(false)
+        , bufferSlabs_(false)
+        , hugePages_(false)
+        , lockBuffers_(false)
+        , bufferLimit_(0)
+        , genericReceiveOffload_(false)
+        , packetRingInterface_()
+        , inlineService_(false)
         , nonstandard_(0)
         , privateIOService_(false)
+        , ioServiceName_()
+        , threadCpus_()
+        , threadName_()
+        , threadPriority_(0)
+        , numaBuffers_(false)
+        , idleStrategy_()
+        , busyPoll_(0)
+        , metricsFile_()
+        , metricsSharedMemory_()
+        , metricsInterval_(1000)
+        , latencyFile_()
+        , latencyInterval_(0)
         , testSkip_(0)
       {
       }
@@ -127,16 +151,20 @@ namespace QuickFAST{
         : head_(rhs.head_)
         , reset_(rhs.reset_)
         , strict_(rhs.strict_)
+        , exceptionFree_(rhs.exceptionFree_)
         , asynchReads_(false)
         , templateFileName_(rhs.templateFileName_)
         , fastFileName_(rhs.fastFileName_)
         , verboseFileName_(rhs.verboseFileName_)
+        , profileFileName_(rhs.profileFileName_)
         , pcapFileName_(rhs.pcapFileName_)
         , echoFileName_(rhs.echoFileName_)
         , echoType_(rhs.echoType_)
         , echoMessage_(rhs.echoMessage_)
         , echoField_(rhs.echoField_)
         , pcapWordSize_(rhs.pcapWordSize_)
+        , pcapFilterGroup_(rhs.pcapFilterGroup_)
+        , pcapFilterPort_(rhs.pcapFilterPort_)
         , packetHeaderType_(rhs.packetHeaderType_)
         , packetHeaderMessageSizeBytes_(rhs.packetHeaderMessageSizeBytes_)
         , packetHeaderBigEndian_(rhs.packetHeaderBigEndian_)
@@ -149,13 +177,34 @@ namespace QuickFAST{
         , messageHeaderSuffixCount_(rhs.messageHeaderSuffixCount_)
         , assemblerType_(rhs.assemblerType_)
         , waitForCompleteMessage_(rhs.waitForCompleteMessage_)
+        , resumableDecoding_(rhs.resumableDecoding_)
         , receiverType_(rhs.receiverType_)
         , hostName_(rhs.hostName_)
         , portName_(rhs.portName_)
         , bufferSize_(rhs.bufferSize_)
         , bufferCount_(rhs.bufferCount_)
+        , ringBuffer_(rhs.ringBuffer_)
+        , bufferSlabs_(rhs.bufferSlabs_)
+        , hugePages_(rhs.hugePages_)
+        , lockBuffers_(rhs.lockBuffers_)
+        , bufferLimit_(rhs.bufferLimit_)
+        , genericReceiveOffload_(rhs.genericReceiveOffload_)
+        , packetRingInterface_(rhs.packetRingInterface_)
+        , inlineService_(rhs.inlineService_)
         , nonstandard_(rhs.nonstandard_)
         , privateIOService_(rhs.privateIOService_)
+        , ioServiceName_(rhs.ioServiceName_)
+        , threadCpus_(rhs.threadCpus_)
+        , threadName_(rhs.threadName_)
+        , threadPriority_(rhs.threadPriority_)
+        , numaBuffers_(rhs.numaBuffers_)
+        , idleStrategy_(rhs.idleStrategy_)
+        , busyPoll_(rhs.busyPoll_)
+        , metricsFile_(rhs.metricsFile_)
+        , metricsSharedMemory_(rhs.metricsSharedMemory_)
+        , metricsInterval_(rhs.metricsInterval_)
+        , latencyFile_(rhs.latencyFile_)
+        , latencyInterval_(rhs.latencyInterval_)
         , testSkip_(rhs.testSkip_)
         , extras_(rhs.extras_)
       {
@@ -179,6 +228,12 @@ namespace QuickFAST{
         return strict_;
       }
 
+      /// @brief Report decoding errors via error codes rather than exceptions
+      bool exceptionFree()const
+      {
+        return exceptionFree_;
+      }
+
       /// @brief Read input file asynchronously
       bool asynchReads()const
       {
@@ -203,6 +258,12 @@ namespace QuickFAST{
         return verboseFileName_;
       }
 
+      /// @brief The name of a file to which a decoding profile will be written.
+      const std::string & profileFileName()const
+      {
+        return profileFileName_;
+      }
+
       /// @brief The name of a file containing PCap captured, FAST encoded records
       const std::string & pcapFileName()const
       {
@@ -240,6 +301,18 @@ namespace QuickFAST{
         return pcapWordSize_;
       }
 
+      /// @brief Only packets sent to this address are read from the PCAP file (empty means any).
+      const std::string & pcapFilterGroup()const
+      {
+        return pcapFilterGroup_;
+      }
+
+      /// @brief Only packets sent to this port are read from the PCAP file (zero means any).
+      unsigned short pcapFilterPort()const
+      {
+        return pcapFilterPort_;
+      }
+
       /// @brief What type of header is expected for each packet
       HeaderType packetHeaderType()const
       {
@@ -307,6 +380,13 @@ namespace QuickFAST{
         return waitForCompleteMessage_;
       }
 
+      /// @brief Should StreamingAssembler restart an incomplete message
+      /// rather than block waiting for the rest of it.
+      bool resumableDecoding()const
+      {
+        return resumableDecoding_;
+      }
+
       /// @brief What type of receiver should be used?
       ReceiverType receiverType()
       {
@@ -408,6 +488,56 @@ namespace QuickFAST{
         return bufferCount_;
       }
 
+      /// @brief Should stream receivers use a double-mapped ring buffer
+      /// so that consecutive buffers are contiguous in memory.
+      bool ringBuffer()const
+      {
+        return ringBuffer_;
+      }
+
+      /// @brief Should buffers be carved from cache line aligned slabs.
+      bool bufferSlabs()const
+      {
+        return bufferSlabs_;
+      }
+
+      /// @brief Should buffer slabs be backed by huge pages.
+      bool hugePages()const
+      {
+        return hugePages_;
+      }
+
+      /// @brief Should buffer slabs be locked into memory.
+      bool lockBuffers()const
+      {
+        return lockBuffers_;
+      }
+
+      /// @brief How many buffers the pool may grow to when buffers run out.
+      /// Zero means the pool does not grow.
+      size_t bufferLimit()const
+      {
+        return bufferLimit_;
+      }
+
+      /// @brief Should multicast receivers accept several datagrams per read (Linux UDP_GRO).
+      bool genericReceiveOffload()const
+      {
+        return genericReceiveOffload_;
+      }
+
+      /// @brief If not empty, receive all multicast feeds from a packet ring on this interface.
+      const std::string & packetRingInterface()const
+      {
+        return packetRingInterface_;
+      }
+
+      /// @brief Should packets be decoded on the receiving thread when nothing else is waiting.
+      bool inlineService()const
+      {
+        return inlineService_;
+      }
+
       /// @brief Support (nonstandard) presence attribute on length instruction
       unsigned long nonstandard() const
       {
@@ -420,6 +550,84 @@ namespace QuickFAST{
         return privateIOService_;
       }
 
+      /// @brief If not empty, the connection uses the IO Service with this name.
+      const std::string & ioServiceName() const
+      {
+        return ioServiceName_;
+      }
+
+      /// @brief CPUs to which the receiver threads are pinned.  See Communication::ThreadPlacement::addThreads().
+      const std::string & threadCpus() const
+      {
+        return threadCpus_;
+      }
+
+      /// @brief If not empty, the receiver threads are named from this prefix.
+      const std::string & threadName() const
+      {
+        return threadName_;
+      }
+
+      /// @brief Real time (SCHED_FIFO) priority for the receiver threads.  Zero for normal scheduling.
+      int threadPriority() const
+      {
+        return threadPriority_;
+      }
+
+      /// @brief Should the buffers be allocated on the NUMA node of the first receiver thread's CPUs?
+      bool numaBuffers() const
+      {
+        return numaBuffers_;
+      }
+
+      /// @brief How idle receiver threads wait.  See Communication::IdleStrategy::parse().  Empty to block.
+      const std::string & idleStrategy() const
+      {
+        return idleStrategy_;
+      }
+
+      /// @brief Microseconds for the kernel to busy poll multicast sockets.  Zero for the system default.
+      unsigned int busyPoll() const
+      {
+        return busyPoll_;
+      }
+
+      /// @brief The file to which metrics are exported in Prometheus format.  Empty for none.
+      const std::string & metricsFile() const
+      {
+        return metricsFile_;
+      }
+
+      /// @brief The file mapped as a shared memory page for metrics.  Empty for none.
+      const std::string & metricsSharedMemory() const
+      {
+        return metricsSharedMemory_;
+      }
+
+      /// @brief Milliseconds between metrics exports.
+      unsigned int metricsInterval() const
+      {
+        return metricsInterval_;
+      }
+
+      /// @brief Are metrics to be exported?
+      bool metricsEnabled() const
+      {
+        return !metricsFile_.empty() || !metricsSharedMemory_.empty();
+      }
+
+      /// @brief The file to which latency histograms are written.  Empty to not measure latency.
+      const std::string & latencyFile() const
+      {
+        return latencyFile_;
+      }
+
+      /// @brief Milliseconds between writing latency histograms.  Zero for only on signal and at exit.
+      unsigned int latencyInterval() const
+      {
+        return latencyInterval_;
+      }
+
       /// @brief debug/testing only.   Skip every n'th message?
       size_t testSkip()const
       {
@@ -444,6 +652,12 @@ namespace QuickFAST{
         strict_ = strict;
       }
 
+      /// @brief Report decoding errors via error codes rather than exceptions
+      void setExceptionFree(bool exceptionFree)
+      {
+        exceptionFree_ = exceptionFree;
+      }
+
       /// @brief Read input file asynchronously (Windows only)
       void setAsynchReads(bool asynchReads)
       {
@@ -468,6 +682,12 @@ namespace QuickFAST{
         verboseFileName_ = verboseFileName;
       }
 
+      /// @brief The name of a file to which a decoding profile will be written.
+      void setProfileFileName(const std::string & profileFileName)
+      {
+        profileFileName_ = profileFileName;
+      }
+
       /// @brief The name of a file containing PCap captured, FAST encoded records
       void setPcapFileName(const std::string & pcapFileName)
       {
@@ -510,6 +730,15 @@ namespace QuickFAST{
         pcapWordSize_ = pcapWordSize;
       }
 
+      /// @brief Only read packets sent to one channel from the PCAP file.
+      /// @param group is the destination address (empty means any).
+      /// @param port is the destination port (zero means any).
+      void setPcapFilter(const std::string & group, unsigned short port)
+      {
+        pcapFilterGroup_ = group;
+        pcapFilterPort_ = port;
+      }
+
       ////////////////////////////////////////////
       // HEADER BACKWARD COMPATIBILITY (DEPRECATED)
 
@@ -621,6 +850,13 @@ namespace QuickFAST{
         waitForCompleteMessage_ = waitForCompleteMessage;
       }
 
+      /// @brief Should StreamingAssembler restart an incomplete message
+      /// rather than block waiting for the rest of it.
+      void setResumableDecoding(bool resumableDecoding)
+      {
+        resumableDecoding_ = resumableDecoding;
+      }
+
       /// @brief Set the type of receiver to use
       void setReceiverType(ReceiverType receiverType)
       {
@@ -689,6 +925,61 @@ namespace QuickFAST{
         bufferCount_ = bufferCount;
       }
 
+      /// @brief Should stream receivers use a double-mapped ring buffer
+      /// so that consecutive buffers are contiguous in memory.
+      void setRingBuffer(bool ringBuffer)
+      {
+        ringBuffer_ = ringBuffer;
+      }
+
+      /// @brief Should buffers be carved from cache line aligned slabs.
+      void setBufferSlabs(bool bufferSlabs)
+      {
+        bufferSlabs_ = bufferSlabs;
+      }
+
+      /// @brief Should buffer slabs be backed by huge pages.
+      /// Implies setBufferSlabs(true).
+      void setHugePages(bool hugePages)
+      {
+        hugePages_ = hugePages;
+        bufferSlabs_ = bufferSlabs_ || hugePages;
+      }
+
+      /// @brief Should buffer slabs be locked into memory.
+      /// Implies setBufferSlabs(true).
+      void setLockBuffers(bool lockBuffers)
+      {
+        lockBuffers_ = lockBuffers;
+        bufferSlabs_ = bufferSlabs_ || lockBuffers;
+      }
+
+      /// @brief How many buffers the pool may grow to when buffers run out.
+      /// Zero means the pool does not grow.
+      void setBufferLimit(size_t bufferLimit)
+      {
+        bufferLimit_ = bufferLimit;
+      }
+
+      /// @brief Should multicast receivers accept several datagrams per read (Linux UDP_GRO).
+      void setGenericReceiveOffload(bool genericReceiveOffload)
+      {
+        genericReceiveOffload_ = genericReceiveOffload;
+      }
+
+      /// @brief Receive all multicast feeds from a packet ring on this interface (Linux).
+      /// @param packetRingInterface names the network interface.  Empty for one socket per feed.
+      void setPacketRingInterface(const std::string & packetRingInterface)
+      {
+        packetRingInterface_ = packetRingInterface;
+      }
+
+      /// @brief Should packets be decoded on the receiving thread when nothing else is waiting.
+      void setInlineService(bool inlineService)
+      {
+        inlineService_ = inlineService;
+      }
+
       /// @brief Support nonstandard FAST featurs
       /// @param nonstandard is an 'or' of the nonstandard features that will be allowed
       ///      1:  if the presence attribute is allowed on length instructoin
@@ -708,6 +999,97 @@ namespace QuickFAST{
         privateIOService_ = privateIOService;
       }
 
+      /// @brief Use a named IO Service.
+      ///
+      /// Connections configured with the same name share one IO Service (and
+      /// hence the threads that run it); connections with different names are
+      /// independent.  This takes precedence over setPrivateIOService().
+      /// @param ioServiceName names the IO Service.  Empty for the default.
+      void setIOServiceName(const std::string & ioServiceName)
+      {
+        ioServiceName_ = ioServiceName;
+      }
+
+      /// @brief Pin the receiver threads to CPUs.
+      /// @param threadCpus lists the CPUs for each thread: "2:3:4-7" pins the first
+      ///        thread to CPU 2, the second to CPU 3 and the third to CPUs 4 through 7.
+      void setThreadCpus(const std::string & threadCpus)
+      {
+        threadCpus_ = threadCpus;
+      }
+
+      /// @brief Name the receiver threads "<name>-<n>".
+      void setThreadName(const std::string & threadName)
+      {
+        threadName_ = threadName;
+      }
+
+      /// @brief Run the receiver threads with a real time (SCHED_FIFO) priority.
+      /// @param threadPriority from 1 to 99; zero for normal scheduling.
+      void setThreadPriority(int threadPriority)
+      {
+        threadPriority_ = threadPriority;
+      }
+
+      /// @brief Allocate the buffers on the NUMA node of the first receiver thread's CPUs.
+      ///
+      /// Requires setThreadCpus().  Implies buffer slabs.
+      void setNumaBuffers(bool numaBuffers)
+      {
+        numaBuffers_ = numaBuffers;
+        bufferSlabs_ = bufferSlabs_ || numaBuffers;
+      }
+
+      /// @brief Let idle receiver threads poll for work rather than block.
+      /// @param idleStrategy one strategy per thread: "spin:park" has the first thread
+      ///        spin and the second spin, yield, then sleep.  Empty to block.
+      void setIdleStrategy(const std::string & idleStrategy)
+      {
+        idleStrategy_ = idleStrategy;
+      }
+
+      /// @brief Let the kernel busy poll the network device when a multicast read would block.
+      /// @param busyPoll microseconds to poll.  Zero for the system default.
+      void setBusyPoll(unsigned int busyPoll)
+      {
+        busyPoll_ = busyPoll;
+      }
+
+      /// @brief Export metrics to a file in the Prometheus text format.
+      /// @param metricsFile names the file.
+      void setMetricsFile(const std::string & metricsFile)
+      {
+        metricsFile_ = metricsFile;
+      }
+
+      /// @brief Export metrics to a shared memory page.  See MetricsExporter.
+      /// @param metricsSharedMemory names the file to be mapped, e.g. /dev/shm/quickfast
+      void setMetricsSharedMemory(const std::string & metricsSharedMemory)
+      {
+        metricsSharedMemory_ = metricsSharedMemory;
+      }
+
+      /// @brief How often metrics are exported.
+      /// @param metricsInterval milliseconds between exports.
+      void setMetricsInterval(unsigned int metricsInterval)
+      {
+        metricsInterval_ = metricsInterval;
+      }
+
+      /// @brief Measure latency and write histograms to a file.  See LatencyTracker.
+      /// @param latencyFile names the file; cout or cerr for the standard streams.
+      void setLatencyFile(const std::string & latencyFile)
+      {
+        latencyFile_ = latencyFile;
+      }
+
+      /// @brief How often latency histograms are written.
+      /// @param latencyInterval milliseconds between writes; zero for only on signal and at exit.
+      void setLatencyInterval(unsigned int latencyInterval)
+      {
+        latencyInterval_ = latencyInterval;
+      }
+
       /// @brief For debugging, skip every 'n'th message.
       void setTestSkip(size_t testSkip)
       {
@@ -747,15 +1129,24 @@ namespace QuickFAST{
         out << "                         every message' (default false)." << std::endl;
         out << "  -strict              : Toggle 'strict decoding rules'" << std::endl;
         out << "                         (default true)." << std::endl;
+        out << "  -nothrow             : Decoder reports errors via error codes rather" << std::endl;
+        out << "                         than exceptions. (default false)." << std::endl;
         out << "  -vo filename         : Write verbose output to file" << std::endl;
         out << "                         (cout for standard out;" << std::endl;
         out << "                         cerr for standard error)." << std::endl;
+        out << "  -profile filename    : Write bytes and time spent decoding each field" << std::endl;
+        out << "                         to file when the connection closes" << std::endl;
+        out << "                         (cout for standard out;" << std::endl;
+        out << "                         cerr for standard error)." << std::endl;
         out << std::endl;
         out << "  -file file           : Input from FAST message file." << std::endl;
         out << "  -afile file          : Use asynchronous reads from FAST message file." << std::endl;
         out << "  -bfile file          : Buffer entire FAST message file in memory." << std::endl;
+        out << "  -mfile file          : Decode FAST message file in place from memory mapped pages." << std::endl;
         out << "  -pcap file           : Input from PCap FAST message file." << std::endl;
         out << "  -pcapsource [64|32]    : Word size of the machine where the PCap data was captured." << std::endl;
+        out << "  -pcapchannel group:port : Only decode PCap packets sent to this group and port." << std::endl;
+        out << "                         Either may be omitted to match any, e.g. :30001" << std::endl;
         out << "                           Defaults to the current platform." << std::endl;
         out << "  -mname name          : Declare a new multicast feed with the given name." << std::endl;
         out << "                         May appear multiple times. The first occurrence names the default feed." << std::endl;
@@ -779,8 +1170,30 @@ namespace QuickFAST{
         out << "                         This doesn't do much for this program, but it helps with testing." << std::endl;
         out << "                         The option would be used when you need multiple independent connections in the" << std::endl;
         out << "                         same process." << std::endl;
+        out << "  -ioservice name      : Use the I/O service with this name.  Connections that" << std::endl;
+        out << "                         name the same service share it and its threads." << std::endl;
+        out << "  -cpus list           : Pin receiver threads to CPUs.  Threads are separated" << std::endl;
+        out << "                         by ':', e.g. \"2:3:4-7,12\" pins thread 0 to CPU 2," << std::endl;
+        out << "                         thread 1 to CPU 3 and thread 2 to CPUs 4-7 and 12." << std::endl;
+        out << "  -threadname name     : Name receiver threads name-0, name-1, ..." << std::endl;
+        out << "  -fifo priority       : Run receiver threads at SCHED_FIFO priority (1-99)." << std::endl;
+        out << "  -numa                : Allocate buffers on the NUMA node of the CPUs of the" << std::endl;
+        out << "                         first receiver thread (requires -cpus, implies -slabs)." << std::endl;
+        out << "  -idle list           : How idle receiver threads wait, one entry per thread" << std::endl;
+        out << "                         separated by ':'.  Each is block (default), spin," << std::endl;
+        out << "                         yield[,spins] or park[,spins[,yields[,maxusec]]]." << std::endl;
+        out << "  -busypoll usec       : Busy poll the network device on multicast reads" << std::endl;
+        out << "                         (Linux SO_BUSY_POLL)." << std::endl;
+        out << "  -metrics file        : Export counters to file in the Prometheus text format." << std::endl;
+        out << "  -metricsshm file     : Export counters to a shared memory page mapped from file" << std::endl;
+        out << "                         (e.g. /dev/shm/quickfast)." << std::endl;
+        out << "  -metricsinterval ms  : Milliseconds between metrics exports (default " << metricsInterval_ << ")" << std::endl;
+        out << "  -latency file        : Write histograms of queue wait, decode time per template" << std::endl;
+        out << "                         and end-to-end latency to file (or cout or cerr) on" << std::endl;
+        out << "                         SIGUSR1 and at exit." << std::endl;
+        out << "  -latencyinterval ms  : Also write the latency histograms this often." << std::endl;
         out << std::endl;
-        out << "  -streaming [no]block : Message boundaries do not match packet" << std::endl;
+        out << "  -streaming [no]block|resume : Message boundaries do not match packet" << std::endl;
         out << "                         boundaries (default if TCP/IP or raw file)." << std::endl;
         out << "                         noblock means decoding doesn't start until" << std::endl;
         out << "                           a complete message has arrived." << std::endl;
@@ -788,6 +1201,9 @@ namespace QuickFAST{
         out << "                           input if this option is used." << std::endl;
         out << "                         block means the decoding starts immediately" << std::endl;
         out << "                           The decoding thread may block for more data." << std::endl;
+        out << "                         resume means decoding starts immediately" << std::endl;
+        out << "                           but an incomplete message is decoded again" << std::endl;
+        out << "                           when more data arrives.  No thread blocks." << std::endl;
         out << "  -datagram            : Message boundaries match packet boundaries" << std::endl;
         out << "                         (default if Multicast or PCap file)." << std::endl;
         out << std::endl;
@@ -819,6 +1235,21 @@ namespace QuickFAST{
         out << "  -buffers count       : Number of buffers. (default " << bufferCount() << ")." << std::endl;
         out << "                         For \"-streaming block\" buffersize * buffers must" << std::endl;
         out << "                         exceed largest expected message." << std::endl;
+        out << "  -ring                : Receive TCP/IP or file data into a ring buffer" << std::endl;
+        out << "                         so messages are contiguous in memory." << std::endl;
+        out << "  -slabs               : Carve buffers from cache line aligned slabs" << std::endl;
+        out << "                         that are paged in before data arrives." << std::endl;
+        out << "  -hugepages           : Back buffer slabs with 2MB huge pages (implies -slabs)." << std::endl;
+        out << "  -lockbuffers         : Lock buffer slabs into memory (implies -slabs)." << std::endl;
+        out << "  -maxbuffers count    : Double the number of buffers, up to count, whenever" << std::endl;
+        out << "                         none is available to receive data. (default " << bufferLimit() << ")." << std::endl;
+        out << "  -gro                 : Receive several multicast datagrams per read (Linux)." << std::endl;
+        out << "                         Raises -buffersize to at least 65536." << std::endl;
+        out << "  -packetring interface : Receive all multicast feeds from one memory mapped" << std::endl;
+        out << "                         packet ring on the named interface (Linux, needs" << std::endl;
+        out << "                         CAP_NET_RAW).  -buffers limits the blocks in use." << std::endl;
+        out << "  -inline              : Decode each packet on the thread that received it" << std::endl;
+        out << "                         unless other packets are waiting (-datagram only)." << std::endl;
         out << std::endl;
         out << "  -e file              : Echo input to file:" << std::endl;
         out << "    -ehex                : Echo as hexadecimal (default)." << std::endl;
@@ -863,11 +1294,21 @@ namespace QuickFAST{
           setStrict(false);
           consumed = 1;
         }
+        else if(opt == "-nothrow")
+        {
+          setExceptionFree(true);
+          consumed = 1;
+        }
         else if(opt == "-vo" && argc > 1)
         {
           setVerboseFileName(argv[1]);
           consumed = 2;
         }
+        else if(opt == "-profile" && argc > 1)
+        {
+          setProfileFileName(argv[1]);
+          consumed = 2;
+        }
         else if(opt == "-e" && argc > 1)
         {
           setEchoFileName(argv[1]);
@@ -927,6 +1368,12 @@ namespace QuickFAST{
           setFastFileName(argv[1]);
           consumed = 2;
         }
+        else if(opt == "-mfile" && argc > 1)
+        {
+          setReceiverType(MAPPED_FILE_RECEIVER);
+          setFastFileName(argv[1]);
+          consumed = 2;
+        }
         else if(opt == "-pcap" && argc > 1)
         {
           setReceiverType(PCAPFILE_RECEIVER);
@@ -947,6 +1394,18 @@ namespace QuickFAST{
             consumed = 2;
           }
         }
+        else if(opt == "-pcapchannel" && argc > 1)
+        {
+          std::string channel(argv[1]);
+          std::string::size_type colon = channel.find(':');
+          unsigned short port = 0;
+          if(colon != std::string::npos && colon + 1 < channel.size())
+          {
+            port = boost::lexical_cast<unsigned short>(channel.substr(colon + 1));
+          }
+          setPcapFilter(channel.substr(0, colon), port);
+          consumed = 2;
+        }
         else if(opt == "-mname" && argc > 1)
         {
           setMulticastName(argv[1]);
@@ -1003,6 +1462,11 @@ namespace QuickFAST{
             {
               consumed = 2;
             }
+            else if(std::string(argv[1]) == "resume")
+            {
+              consumed = 2;
+              setResumableDecoding(true);
+            }
           }
         }
         else if(opt == "-datagram") //           : Message boundaries match packet boundaries (default if Multicast or PCap file).
@@ -1103,6 +1567,66 @@ namespace QuickFAST{
           setPrivateIOService(true);
           consumed = 1;
         }
+        else if(opt == "-ioservice" && argc > 1)
+        {
+          setIOServiceName(argv[1]);
+          consumed = 2;
+        }
+        else if(opt == "-cpus" && argc > 1)
+        {
+          setThreadCpus(argv[1]);
+          consumed = 2;
+        }
+        else if(opt == "-threadname" && argc > 1)
+        {
+          setThreadName(argv[1]);
+          consumed = 2;
+        }
+        else if(opt == "-fifo" && argc > 1)
+        {
+          setThreadPriority(boost::lexical_cast<int>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-numa")
+        {
+          setNumaBuffers(true);
+          consumed = 1;
+        }
+        else if(opt == "-idle" && argc > 1)
+        {
+          setIdleStrategy(argv[1]);
+          consumed = 2;
+        }
+        else if(opt == "-busypoll" && argc > 1)
+        {
+          setBusyPoll(boost::lexical_cast<unsigned int>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-metrics" && argc > 1)
+        {
+          setMetricsFile(argv[1]);
+          consumed = 2;
+        }
+        else if(opt == "-metricsshm" && argc > 1)
+        {
+          setMetricsSharedMemory(argv[1]);
+          consumed = 2;
+        }
+        else if(opt == "-metricsinterval" && argc > 1)
+        {
+          setMetricsInterval(boost::lexical_cast<unsigned int>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-latency" && argc > 1)
+        {
+          setLatencyFile(argv[1]);
+          consumed = 2;
+        }
+        else if(opt == "-latencyinterval" && argc > 1)
+        {
+          setLatencyInterval(boost::lexical_cast<unsigned int>(argv[1]));
+          consumed = 2;
+        }
         else if(opt == "-testskip" && argc > 1)
         {
           setTestSkip(boost::lexical_cast<size_t>(argv[1]));
@@ -1118,6 +1642,46 @@ namespace QuickFAST{
           setBufferCount(boost::lexical_cast<size_t>(argv[1]));
           consumed = 2;
         }
+        else if(opt == "-ring")
+        {
+          setRingBuffer(true);
+          consumed = 1;
+        }
+        else if(opt == "-slabs")
+        {
+          setBufferSlabs(true);
+          consumed = 1;
+        }
+        else if(opt == "-hugepages")
+        {
+          setHugePages(true);
+          consumed = 1;
+        }
+        else if(opt == "-lockbuffers")
+        {
+          setLockBuffers(true);
+          consumed = 1;
+        }
+        else if(opt == "-maxbuffers" && argc > 1)
+        {
+          setBufferLimit(boost::lexical_cast<size_t>(argv[1]));
+          consumed = 2;
+        }
+        else if(opt == "-gro")
+        {
+          setGenericReceiveOffload(true);
+          consumed = 1;
+        }
+        else if(opt == "-inline")
+        {
+          setInlineService(true);
+          consumed = 1;
+        }
+        else if(opt == "-packetring" && argc > 1)
+        {
+          setPacketRingInterface(argv[1]);
+          consumed = 2;
+        }
         else if(opt == "-nonstandard" && argc > 1)
         {
           setNonstandard(boost::lexical_cast<unsigned long>(argv[1]));
@@ -1148,6 +1712,8 @@ namespace QuickFAST{
       bool reset_;
       /// @brief Use strict decoding rules
       bool strict_;
+      /// @brief Report decoding errors via error codes rather than exceptions
+      bool exceptionFree_;
 
       /// @brief Should file reads be asynchronous
       bool asynchReads_;
@@ -1158,6 +1724,8 @@ namespace QuickFAST{
       std::string fastFileName_;
       /// @brief The name of a file to which verbose output will be written.
       std::string verboseFileName_;
+      /// @brief The name of a file to which a decoding profile will be written.
+      std::string profileFileName_;
       /// @brief The name of a file containing PCap captured, FAST encoded records
       std::string pcapFileName_;
       /// @brief The name of a file to which echo output will be written
@@ -1171,6 +1739,10 @@ namespace QuickFAST{
 
       /// @brief What word size is used in the PCAP file.
       size_t pcapWordSize_;
+      /// @brief Destination address of the PCAP packets to be read.
+      std::string pcapFilterGroup_;
+      /// @brief Destination port of the PCAP packets to be read.
+      unsigned short pcapFilterPort_;
 
       /// @brief What type of header is expected for each packet
       HeaderType packetHeaderType_;
@@ -1201,6 +1773,10 @@ namespace QuickFAST{
       /// before decoding starts.
       bool waitForCompleteMessage_;
 
+      /// @brief Should StreamingAssembler restart an incomplete message
+      /// rather than block waiting for the rest of it.
+      bool resumableDecoding_;
+
       /// @brief What type of receiver supplies incoming buffers.
       ReceiverType receiverType_;
 
@@ -1218,6 +1794,23 @@ namespace QuickFAST{
       /// bufferCount_ * bufferSize_ must equal or exceed maximum message size.
       size_t bufferCount_;
 
+      /// @brief Use a double-mapped ring buffer for stream receivers.
+      bool ringBuffer_;
+      /// @brief Carve buffers from cache line aligned slabs.
+      bool bufferSlabs_;
+      /// @brief Back buffer slabs with huge pages.
+      bool hugePages_;
+      /// @brief Lock buffer slabs into memory.
+      bool lockBuffers_;
+      /// @brief Grow the buffer pool up to this many buffers. Zero for no growth.
+      size_t bufferLimit_;
+      /// @brief Receive several multicast datagrams per read.
+      bool genericReceiveOffload_;
+      /// @brief Network interface for a packet ring receiver.  Empty for none.
+      std::string packetRingInterface_;
+      /// @brief Decode packets on the receiving thread when nothing else is waiting.
+      bool inlineService_;
+
       /// @brief Allow nonstandard presence attribute on length instruction
       /// If true, allow presence= attribute on sequence length instruction
       unsigned long nonstandard_;
@@ -1227,6 +1820,30 @@ namespace QuickFAST{
       /// This makes connections independent of each other, but may require more threads to be
       /// allocated because connections can no longer share threads.
       bool privateIOService_;
+      /// @brief Name of a shared IO Service.  Empty for the default.
+      std::string ioServiceName_;
+      /// @brief CPUs for the receiver threads.  Empty for no pinning.
+      std::string threadCpus_;
+      /// @brief Prefix for the names of the receiver threads.
+      std::string threadName_;
+      /// @brief SCHED_FIFO priority for the receiver threads.
+      int threadPriority_;
+      /// @brief Allocate buffers on the NUMA node of the first receiver thread.
+      bool numaBuffers_;
+      /// @brief How idle receiver threads wait.
+      std::string idleStrategy_;
+      /// @brief SO_BUSY_POLL microseconds for multicast sockets.
+      unsigned int busyPoll_;
+      /// @brief Prometheus text file for metrics.
+      std::string metricsFile_;
+      /// @brief Shared memory file for metrics.
+      std::string metricsSharedMemory_;
+      /// @brief Milliseconds between metrics exports.
+      unsigned int metricsInterval_;
+      /// @brief File for latency histograms.
+      std::string latencyFile_;
+      /// @brief Milliseconds between writing latency histograms.
+      unsigned int latencyInterval_;
 
       size_t testSkip_;
 
@@ -41,6 +41,7 @@ namespace QuickFAST{
         PCAPFILE_RECEIVER,            /// File captured from network in PCAP format
         ASYNCHRONOUS_FILE_RECEIVER,   /// File read using asynchronous I/O (not in core QuickFAST)
         BUFFER_RECEIVER,              /// Decode from in-memory buffer.
+        MAPPED_FILE_RECEIVER,         /// File containing FAST encoded records mapped into memory.
         UNSPECIFIED_RECEIVER          /// Receiver has not yet been specified.
       };
 
@@ -13,15 +13,24 @@
 #include <Codecs/FastEncodedHeaderAnalyzer.h>
 #include <Codecs/TemplateRegistry.h>
 #include <Codecs/DataSource.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/DecodeProfiler.h>
 
 #include <Communication/MulticastReceiver.h>
+#include <Communication/PacketRingReceiver.h>
 #include <Communication/TCPReceiver.h>
 #include <Communication/RawFileReceiver.h>
 #include <Communication/BufferedRawFileReceiver.h>
+#include <Communication/MappedFileReceiver.h>
 #include <Communication/PCapFileReceiver.h>
 #include <Communication/AsynchFileReceiver.h>
 #include <Communication/BufferReceiver.h>
 #include <Communication/AsioService.h>
+#include <Common/Metrics.h>
+#include <Common/MetricsExporter.h>
+#include <Common/AtomicCounter.h>
+#include <Common/LatencyTracker.h>
+#include <csignal>
 
 using namespace QuickFAST;
 using namespace Application;
@@ -33,6 +42,8 @@ namespace
 #else
   const std::ios::openmode binaryMode = static_cast<std::ios::openmode>(0);
 #endif
+  // numbers the connections to label their metrics.
+  AtomicCounter connectionsWithMetrics;
 }
 
 
@@ -47,6 +58,23 @@ DecoderConnection::DecoderConnection()
 
 DecoderConnection::~DecoderConnection()
 {
+  metricsExporter_.reset();
+  if(profiler_)
+  {
+    if(profileFileName_ == "cout")
+    {
+      profiler_->report(std::cout);
+    }
+    else if(profileFileName_ == "cerr")
+    {
+      profiler_->report(std::cerr);
+    }
+    else
+    {
+      std::ofstream profileFile(profileFileName_.c_str());
+      profiler_->report(profileFile);
+    }
+  }
   delete fastFile_;
   if(ownEchoFile_)
   {
@@ -69,7 +97,9 @@ DecoderConnection::configure(
   Messages::ValueMessageBuilder & builder,
   Application::DecoderConfiguration &configuration)
 {
-  if(!configuration.asynchReads() && !configuration.fastFileName().empty())
+  if(!configuration.asynchReads()
+    && configuration.receiverType() != Application::DecoderConfiguration::MAPPED_FILE_RECEIVER
+    && !configuration.fastFileName().empty())
   {
 #ifndef _WIN32
     // on Windows cin is opened in ascii mode which garbles FAST data
@@ -262,6 +292,7 @@ DecoderConnection::configure(
         configuration.echoMessage(),
         configuration.echoField());
       pAssembler->setMessageLimit(configuration.head());
+      pAssembler->setResumable(configuration.resumableDecoding());
       break;
     }
   default:
@@ -290,6 +321,7 @@ DecoderConnection::configure(
       case Application::DecoderConfiguration::TCP_RECEIVER:
       case Application::DecoderConfiguration::RAWFILE_RECEIVER:
       case Application::DecoderConfiguration::BUFFERED_RAWFILE_RECEIVER:
+      case Application::DecoderConfiguration::MAPPED_FILE_RECEIVER:
       case Application::DecoderConfiguration::ASYNCHRONOUS_FILE_RECEIVER:
         {
           Codecs::StreamingAssembler * pAssembler = new Codecs::StreamingAssembler(
@@ -304,6 +336,7 @@ DecoderConnection::configure(
             configuration.echoMessage(),
             configuration.echoField());
           pAssembler->setMessageLimit(configuration.head());
+          pAssembler->setResumable(configuration.resumableDecoding());
           break;
         }
       default:
@@ -318,22 +351,64 @@ DecoderConnection::configure(
 
   assembler_->setReset(configuration.reset());
   assembler_->setStrict(configuration.strict());
+  assembler_->setExceptionFree(configuration.exceptionFree());
+
+  if(!configuration.profileFileName().empty())
+  {
+    profileFileName_ = configuration.profileFileName();
+    profiler_.reset(new Codecs::DecodeProfiler);
+    assembler_->decoder().setProfiler(profiler_.get());
+  }
+
+  if(!configuration.latencyFile().empty())
+  {
+    latency_.reset(new LatencyTracker);
+    assembler_->decoder().setLatencyTracker(latency_.get());
+  }
 
   switch(configuration.receiverType())
   {
   case Application::DecoderConfiguration::MULTICAST_RECEIVER:
+    if(!configuration.packetRingInterface().empty())
+    {
+#if defined(__linux__)
+      Communication::PacketRingReceiver * receiver;
+      boost::asio::io_service * ioService = receiverIoService(configuration);
+      if(ioService != 0)
+      {
+        receiver = new Communication::PacketRingReceiver(*ioService, configuration.packetRingInterface());
+      }
+      else
+      {
+        receiver = new Communication::PacketRingReceiver(configuration.packetRingInterface());
+      }
+      receiver_.reset(receiver);
+      for(size_t nFeed = 0; nFeed < configuration.multicastCount(); ++nFeed)
+      {
+        receiver->addFeed(
+          configuration.multicastGroupIP(nFeed),
+          configuration.portNumber(nFeed));
+      }
+      break;
+#else // __linux__
+      throw std::invalid_argument("DecoderConnection: Packet ring receiver is available only on Linux.");
+#endif // __linux__
+    }
+    else
     {
       Communication::MulticastReceiver * receiver;
-      if(configuration.privateIOService())
+      boost::asio::io_service * ioService = receiverIoService(configuration);
+      if(ioService != 0)
       {
-        ioService_.reset(new boost::asio::io_service);
-        receiver = new Communication::MulticastReceiver(*ioService_);
+        receiver = new Communication::MulticastReceiver(*ioService);
       }
       else
       {
         receiver = new Communication::MulticastReceiver();
       }
       receiver_.reset(receiver);
+      receiver->setGenericReceiveOffload(configuration.genericReceiveOffload());
+      receiver->setBusyPoll(configuration.busyPoll());
       receiver->addFeed(
         configuration.multicastName(),
         configuration.multicastGroupIP(),
@@ -356,11 +431,11 @@ DecoderConnection::configure(
     }
   case Application::DecoderConfiguration::TCP_RECEIVER:
     {
-      if(configuration.privateIOService())
+      boost::asio::io_service * ioService = receiverIoService(configuration);
+      if(ioService != 0)
       {
-        ioService_.reset(new boost::asio::io_service);
           receiver_.reset(new Communication::TCPReceiver(
-            *ioService_,
+            *ioService,
             configuration.hostName(),
             configuration.portName()));
       }
@@ -384,11 +459,19 @@ DecoderConnection::configure(
         *fastFile_));
       break;
     }
+  case Application::DecoderConfiguration::MAPPED_FILE_RECEIVER:
+    {
+      receiver_.reset(new Communication::MappedFileReceiver(
+        configuration.fastFileName()));
+      break;
+    }
   case Application::DecoderConfiguration::PCAPFILE_RECEIVER:
     {
-      receiver_.reset(new Communication::PCapFileReceiver(
+      Communication::PCapFileReceiver * pcapReceiver = new Communication::PCapFileReceiver(
         configuration.pcapFileName(),
-        configuration.pcapWordSize()));
+        configuration.pcapWordSize());
+      receiver_.reset(pcapReceiver);
+      pcapReceiver->setFilter(configuration.pcapFilterGroup(), configuration.pcapFilterPort());
       break;
     }
   case Application::DecoderConfiguration::ASYNCHRONOUS_FILE_RECEIVER:
@@ -426,8 +509,92 @@ DecoderConnection::configure(
     }
   }
 
-  receiver_->start(*assembler_, configuration.bufferSize(), configuration.bufferCount());
+  Communication::ThreadPlacement placement;
+  if(!configuration.threadCpus().empty())
+  {
+    placement.addThreads(configuration.threadCpus());
+  }
+  placement.setName(configuration.threadName());
+  placement.setPriority(configuration.threadPriority());
+  receiver_->setThreadPlacement(placement);
+
+  std::vector<Communication::IdleStrategy> idleStrategies;
+  if(!configuration.idleStrategy().empty())
+  {
+    Communication::IdleStrategy::parse(configuration.idleStrategy(), idleStrategies);
+  }
+  receiver_->setIdleStrategies(idleStrategies);
+
+  receiver_->setRingBuffer(configuration.ringBuffer());
+  if(configuration.bufferSlabs())
+  {
+    receiver_->setBufferSlabs(configuration.hugePages(), configuration.lockBuffers());
+    if(configuration.numaBuffers())
+    {
+      receiver_->setBufferNumaNode(placement.numaNode(0));
+    }
+  }
+  receiver_->setBufferLimit(configuration.bufferLimit());
+  receiver_->setInlineService(configuration.inlineService());
+
+  if(latency_)
+  {
+    receiver_->setLatencyTracker(latency_.get());
+#if defined(SIGUSR1)
+    LatencyTracker::dumpOnSignal(SIGUSR1);
+#endif
+    latency_->startDumping(configuration.latencyFile(), configuration.latencyInterval());
+  }
+
+  if(configuration.metricsEnabled())
+  {
+    std::string labels = "connection=\"";
+    labels += boost::lexical_cast<std::string>(long(++connectionsWithMetrics));
+    labels += '"';
+    MetricsRegistry & registry = MetricsRegistry::instance();
+    receiver_->registerMetrics(registry, labels);
+    assembler_->registerMetrics(registry, labels);
+    metricsExporter_.reset(new MetricsExporter(registry));
+    if(!configuration.metricsFile().empty())
+    {
+      metricsExporter_->setPrometheusFile(configuration.metricsFile());
+    }
+    if(!configuration.metricsSharedMemory().empty()
+      && !metricsExporter_->setSharedMemory(configuration.metricsSharedMemory()))
+    {
+      std::stringstream msg;
+      msg << "DecoderConnection: Cannot map metrics shared memory " << configuration.metricsSharedMemory();
+      throw std::invalid_argument(msg.str());
+    }
+    metricsExporter_->start(configuration.metricsInterval());
+  }
+  size_t bufferSize = configuration.bufferSize();
+  if(configuration.receiverType() == Application::DecoderConfiguration::MULTICAST_RECEIVER
+    && configuration.packetRingInterface().empty()
+    && configuration.genericReceiveOffload()
+    && bufferSize < Communication::MulticastReceiver::groBufferSize)
+  {
+    // A smaller buffer would truncate coalesced reads.
+    bufferSize = Communication::MulticastReceiver::groBufferSize;
+  }
+  receiver_->start(*assembler_, bufferSize, configuration.bufferCount());
+
+}
 
+boost::asio::io_service *
+DecoderConnection::receiverIoService(const Application::DecoderConfiguration &configuration)
+{
+  if(!configuration.ioServiceName().empty())
+  {
+    return &Communication::AsioService::namedIoService(configuration.ioServiceName());
+  }
+  if(configuration.privateIOService())
+  {
+    ioService_.reset(new boost::asio::io_service);
+    return ioService_.get();
+  }
+  // use the shared io service
+  return 0;
 }
 
 Codecs::Decoder &
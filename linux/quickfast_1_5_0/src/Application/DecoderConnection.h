@@ -14,9 +14,12 @@
 #include <Codecs/TemplateRegistry_fwd.h>
 #include <Codecs/HeaderAnalyzer_fwd.h>
 #include <Codecs/Decoder_fwd.h>
+#include <Codecs/DecodeProfiler_fwd.h>
 #include <Communication/Assembler_fwd.h>
 #include <Communication/Receiver.h>
 #include <Communication/AsioService_fwd.h>
+#include <Common/MetricsExporter_fwd.h>
+#include <Common/LatencyTracker_fwd.h>
 #include <Application/DecoderConfiguration.h>
 
 namespace QuickFAST{
@@ -163,6 +166,19 @@ namespace QuickFAST{
       /// @brief Access the decoder.
       Codecs::Decoder & decoder() const;
 
+      /// @brief Access the decoding profile.
+      ///
+      /// The profile is collected only if a profile file was configured.  It is written
+      /// to that file when the connection is destroyed.
+      /// @returns the profiler or zero if profiling is not enabled.
+      Codecs::DecodeProfiler * profiler() const
+      {
+        return profiler_.get();
+      }
+
+    private:
+      boost::asio::io_service * receiverIoService(const Application::DecoderConfiguration &configuration);
+
     private:
       std::istream * fastFile_;
       std::ostream * echoFile_;
@@ -170,13 +186,20 @@ namespace QuickFAST{
       bool ownEchoFile_;
       bool ownVerboseFile_;
 
+      std::string profileFileName_;
+
       Codecs::TemplateRegistryPtr registry_;
+      // declared before the assembler so it outlives the decoder that uses it.
+      boost::scoped_ptr<Codecs::DecodeProfiler> profiler_;
+      // likewise outlives the receiver and decoder.  Writes its last report when destroyed.
+      boost::scoped_ptr<LatencyTracker> latency_;
       boost::scoped_ptr<boost::asio::io_service> ioService_;
       boost::scoped_ptr<Codecs::HeaderAnalyzer> packetHeaderAnalyzer_;
       boost::scoped_ptr<Codecs::HeaderAnalyzer> messageHeaderAnalyzer_;
       boost::scoped_ptr<Communication::Assembler> assembler_;
       boost::scoped_ptr<Communication::Receiver> receiver_;
-
+      // declared last so exports stop before anything they report on is destroyed.
+      boost::scoped_ptr<MetricsExporter> metricsExporter_;
     };
   }
 }
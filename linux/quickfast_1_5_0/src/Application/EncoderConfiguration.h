@@ -0,0 +1,388 @@
+// Copyright (c) 2009, 2010, 2011, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef ENCODERCONFIGURATION_H
+#define ENCODERCONFIGURATION_H
+#include "EncoderConfiguration_fwd.h"
+
+namespace QuickFAST{
+  namespace Application{
+    /// @brief structure to capture all the information needed to configure an EncoderConnection
+    ///
+    /// The header parameters have the same meaning as the corresponding
+    /// DecoderConfiguration FIXED_HEADER parameters so a DecoderConnection
+    /// configured the same way can read what the EncoderConnection sends.
+    struct EncoderConfiguration
+    {
+      /// @brief Initialize to defaults
+      EncoderConfiguration()
+        : primaryPort_(0)
+        , secondaryPort_(0)
+        , retransmitPort_(0)
+        , sendInterfaceIP_("0.0.0.0")
+        , ttl_(0)
+        , reset_(false)
+        , maxDatagramSize_(1472)
+        , maxMessagesPerDatagram_(0)
+        , flushMicroseconds_(0)
+        , batchSize_(16)
+        , queueSize_(65536)
+        , retransmitPackets_(4096)
+        , firstSequenceNumber_(1)
+        , packetHeaderMessageSizeBytes_(0)
+        , packetHeaderBigEndian_(true)
+        , packetHeaderPrefixCount_(4)
+        , packetHeaderSuffixCount_(0)
+        , sequenceOffset_(0)
+        , sequenceLength_(4)
+        , messageHeaderMessageSizeBytes_(0)
+        , messageHeaderBigEndian_(true)
+        , messageHeaderPrefixCount_(0)
+        , messageHeaderSuffixCount_(0)
+      {
+      }
+
+      /// @brief The name of the template file
+      const std::string & templateFileName()const
+      {
+        return templateFileName_;
+      }
+
+      /// @brief The dotted IP of the primary (A) multicast group
+      const std::string & primaryGroupIP()const
+      {
+        return primaryGroupIP_;
+      }
+
+      /// @brief The port number of the primary (A) multicast group
+      unsigned short primaryPort()const
+      {
+        return primaryPort_;
+      }
+
+      /// @brief The dotted IP of the secondary (B) multicast group
+      const std::string & secondaryGroupIP()const
+      {
+        return secondaryGroupIP_;
+      }
+
+      /// @brief The port number of the secondary (B) multicast group; zero for none
+      unsigned short secondaryPort()const
+      {
+        return secondaryPort_;
+      }
+
+      /// @brief The dotted IP of the group to which retransmitted packets are sent
+      const std::string & retransmitGroupIP()const
+      {
+        return retransmitGroupIP_;
+      }
+
+      /// @brief The port to which retransmitted packets are sent; zero means the primary group.
+      unsigned short retransmitPort()const
+      {
+        return retransmitPort_;
+      }
+
+      /// @brief The dotted IP of the NIC from which to send.
+      const std::string & sendInterfaceIP()const
+      {
+        return sendInterfaceIP_;
+      }
+
+      /// @brief Multicast time-to-live; zero leaves the system default.
+      unsigned int ttl()const
+      {
+        return ttl_;
+      }
+
+      /// @brief Reset the encoder at the start of every packet
+      bool reset()const
+      {
+        return reset_;
+      }
+
+      /// @brief The size limit for a datagram, headers included.
+      size_t maxDatagramSize()const
+      {
+        return maxDatagramSize_;
+      }
+
+      /// @brief The most messages in one datagram; zero means no limit.
+      size_t maxMessagesPerDatagram()const
+      {
+        return maxMessagesPerDatagram_;
+      }
+
+      /// @brief The longest a message may wait to be sent; zero means send when the encode queue is empty.
+      unsigned int flushMicroseconds()const
+      {
+        return flushMicroseconds_;
+      }
+
+      /// @brief The number of datagrams handed to the kernel in one system call.
+      size_t batchSize()const
+      {
+        return batchSize_;
+      }
+
+      /// @brief The number of messages that may wait to be encoded.
+      size_t queueSize()const
+      {
+        return queueSize_;
+      }
+
+      /// @brief The number of recent packets kept for retransmission.
+      size_t retransmitPackets()const
+      {
+        return retransmitPackets_;
+      }
+
+      /// @brief The sequence number of the first packet.
+      unsigned int firstSequenceNumber()const
+      {
+        return firstSequenceNumber_;
+      }
+
+      /// @brief How many bytes in the packet header size field; zero for none.
+      size_t packetHeaderMessageSizeBytes()const
+      {
+        return packetHeaderMessageSizeBytes_;
+      }
+
+      /// @brief Is the packet header size field big-endian?
+      bool packetHeaderBigEndian()const
+      {
+        return packetHeaderBigEndian_;
+      }
+
+      /// @brief Byte count before the packet header size field
+      size_t packetHeaderPrefixCount()const
+      {
+        return packetHeaderPrefixCount_;
+      }
+
+      /// @brief Byte count after the packet header size field
+      size_t packetHeaderSuffixCount()const
+      {
+        return packetHeaderSuffixCount_;
+      }
+
+      /// @brief Position of the sequence number in the packet header.
+      size_t sequenceOffset()const
+      {
+        return sequenceOffset_;
+      }
+
+      /// @brief Byte count of the sequence number in the packet header; zero for none.
+      size_t sequenceLength()const
+      {
+        return sequenceLength_;
+      }
+
+      /// @brief How many bytes in the message header size field; zero for none.
+      size_t messageHeaderMessageSizeBytes()const
+      {
+        return messageHeaderMessageSizeBytes_;
+      }
+
+      /// @brief Is the message header size field big-endian?
+      bool messageHeaderBigEndian()const
+      {
+        return messageHeaderBigEndian_;
+      }
+
+      /// @brief Byte count before the message header size field
+      size_t messageHeaderPrefixCount()const
+      {
+        return messageHeaderPrefixCount_;
+      }
+
+      /// @brief Byte count after the message header size field
+      size_t messageHeaderSuffixCount()const
+      {
+        return messageHeaderSuffixCount_;
+      }
+
+      /// @brief The name of the template file
+      void setTemplateFileName(const std::string & templateFileName)
+      {
+        templateFileName_ = templateFileName;
+      }
+
+      /// @brief Send to the primary (A) multicast group
+      void setPrimaryGroup(const std::string & groupIP, unsigned short port)
+      {
+        primaryGroupIP_ = groupIP;
+        primaryPort_ = port;
+      }
+
+      /// @brief Send a copy of every packet to the secondary (B) multicast group
+      void setSecondaryGroup(const std::string & groupIP, unsigned short port)
+      {
+        secondaryGroupIP_ = groupIP;
+        secondaryPort_ = port;
+      }
+
+      /// @brief Send retransmitted packets to this group rather than the primary group
+      void setRetransmitGroup(const std::string & groupIP, unsigned short port)
+      {
+        retransmitGroupIP_ = groupIP;
+        retransmitPort_ = port;
+      }
+
+      /// @brief The dotted IP of the NIC from which to send.
+      void setSendInterfaceIP(const std::string & sendInterfaceIP)
+      {
+        sendInterfaceIP_ = sendInterfaceIP;
+      }
+
+      /// @brief Multicast time-to-live; zero leaves the system default.
+      void setTtl(unsigned int ttl)
+      {
+        ttl_ = ttl;
+      }
+
+      /// @brief Reset the encoder at the start of every packet
+      ///
+      /// Each packet can then be decoded without the ones before it.
+      void setReset(bool reset)
+      {
+        reset_ = reset;
+      }
+
+      /// @brief The size limit for a datagram, headers included.
+      void setMaxDatagramSize(size_t maxDatagramSize)
+      {
+        maxDatagramSize_ = maxDatagramSize;
+      }
+
+      /// @brief The most messages in one datagram; zero means no limit.
+      void setMaxMessagesPerDatagram(size_t maxMessagesPerDatagram)
+      {
+        maxMessagesPerDatagram_ = maxMessagesPerDatagram;
+      }
+
+      /// @brief The longest a message may wait to be sent; zero means send when the encode queue is empty.
+      void setFlushMicroseconds(unsigned int flushMicroseconds)
+      {
+        flushMicroseconds_ = flushMicroseconds;
+      }
+
+      /// @brief The number of datagrams handed to the kernel in one system call.
+      void setBatchSize(size_t batchSize)
+      {
+        batchSize_ = batchSize;
+      }
+
+      /// @brief The number of messages that may wait to be encoded.
+      void setQueueSize(size_t queueSize)
+      {
+        queueSize_ = queueSize;
+      }
+
+      /// @brief The number of recent packets kept for retransmission.
+      void setRetransmitPackets(size_t retransmitPackets)
+      {
+        retransmitPackets_ = retransmitPackets;
+      }
+
+      /// @brief The sequence number of the first packet.
+      void setFirstSequenceNumber(unsigned int firstSequenceNumber)
+      {
+        firstSequenceNumber_ = firstSequenceNumber;
+      }
+
+      /// @brief How many bytes in the packet header size field; zero for none.
+      void setPacketHeaderMessageSizeBytes(size_t headerMessageSizeBytes)
+      {
+        packetHeaderMessageSizeBytes_ = headerMessageSizeBytes;
+      }
+
+      /// @brief Is the packet header size field big-endian?
+      void setPacketHeaderBigEndian(bool headerBigEndian)
+      {
+        packetHeaderBigEndian_ = headerBigEndian;
+      }
+
+      /// @brief Byte count before the packet header size field
+      void setPacketHeaderPrefixCount(size_t headerPrefixCount)
+      {
+        packetHeaderPrefixCount_ = headerPrefixCount;
+      }
+
+      /// @brief Byte count after the packet header size field
+      void setPacketHeaderSuffixCount(size_t headerSuffixCount)
+      {
+        packetHeaderSuffixCount_ = headerSuffixCount;
+      }
+
+      /// @brief Where the sequence number goes in the packet header.
+      /// @param offset is its position
+      /// @param length is its byte count; zero for none.
+      void setSequenceNumberPosition(size_t offset, size_t length)
+      {
+        sequenceOffset_ = offset;
+        sequenceLength_ = length;
+      }
+
+      /// @brief How many bytes in the message header size field; zero for none.
+      void setMessageHeaderMessageSizeBytes(size_t headerMessageSizeBytes)
+      {
+        messageHeaderMessageSizeBytes_ = headerMessageSizeBytes;
+      }
+
+      /// @brief Is the message header size field big-endian?
+      void setMessageHeaderBigEndian(bool headerBigEndian)
+      {
+        messageHeaderBigEndian_ = headerBigEndian;
+      }
+
+      /// @brief Byte count before the message header size field
+      void setMessageHeaderPrefixCount(size_t headerPrefixCount)
+      {
+        messageHeaderPrefixCount_ = headerPrefixCount;
+      }
+
+      /// @brief Byte count after the message header size field
+      void setMessageHeaderSuffixCount(size_t headerSuffixCount)
+      {
+        messageHeaderSuffixCount_ = headerSuffixCount;
+      }
+
+    private:
+      std::string templateFileName_;
+      std::string primaryGroupIP_;
+      unsigned short primaryPort_;
+      std::string secondaryGroupIP_;
+      unsigned short secondaryPort_;
+      std::string retransmitGroupIP_;
+      unsigned short retransmitPort_;
+      std::string sendInterfaceIP_;
+      unsigned int ttl_;
+      bool reset_;
+      size_t maxDatagramSize_;
+      size_t maxMessagesPerDatagram_;
+      unsigned int flushMicroseconds_;
+      size_t batchSize_;
+      size_t queueSize_;
+      size_t retransmitPackets_;
+      unsigned int firstSequenceNumber_;
+      size_t packetHeaderMessageSizeBytes_;
+      bool packetHeaderBigEndian_;
+      size_t packetHeaderPrefixCount_;
+      size_t packetHeaderSuffixCount_;
+      size_t sequenceOffset_;
+      size_t sequenceLength_;
+      size_t messageHeaderMessageSizeBytes_;
+      bool messageHeaderBigEndian_;
+      size_t messageHeaderPrefixCount_;
+      size_t messageHeaderSuffixCount_;
+    };
+  }
+}
+#endif // ENCODERCONFIGURATION_H
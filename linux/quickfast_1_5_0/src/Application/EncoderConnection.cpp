@@ -0,0 +1,427 @@
+// Copyright (c) 2009, 2010, 2011, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Common/QuickFASTPch.h>
+#include "EncoderConnection.h"
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Encoder.h>
+#include <Messages/Message.h>
+#include <Communication/DatagramBatch.h>
+#include <Communication/ReplayPacer.h>
+
+using namespace QuickFAST;
+using namespace Application;
+
+namespace
+{
+#ifdef _WIN32
+  const std::ios::openmode binaryMode = std::ios::binary;
+#else
+  const std::ios::openmode binaryMode = static_cast<std::ios::openmode>(0);
+#endif
+
+  // An SCP reset message: presence map, then template ID 120.
+  const unsigned char scpReset[] = {0xC0, 0xF8};
+
+  // How long the encoding thread spins, then yields, before it starts to sleep.
+  const size_t idleSpins = 1000;
+  const size_t idleYields = 100;
+  const long idleSleepMicroseconds = 50;
+}
+
+EncoderConnection::EncoderConnection()
+: stopping_(false)
+, resetPending_(false)
+, messageCount_(0)
+, packetCount_(0)
+, encodingErrorCount_(0)
+, sendErrorCount_(0)
+{
+}
+
+EncoderConnection::~EncoderConnection()
+{
+  stop();
+}
+
+void
+EncoderConnection::setTemplateRegistry(Codecs::TemplateRegistryPtr registry)
+{
+  registry_ = registry;
+}
+
+void
+EncoderConnection::configure(const Application::EncoderConfiguration & configuration)
+{
+  // the sender keeps a reference to the address, so it must live as long as the connection.
+  configuration_ = configuration;
+
+  if(!registry_)
+  {
+    std::ifstream templates(configuration_.templateFileName().c_str(),
+      std::ios::in | binaryMode
+      );
+    if(!templates.good())
+    {
+        std::stringstream msg;
+        msg << "Can't open template file: "
+          << configuration_.templateFileName();
+        throw std::invalid_argument(msg.str());
+    }
+    Codecs::XMLTemplateParser parser;
+    registry_ = parser.parse(templates);
+  }
+  encoder_.reset(new Codecs::Encoder(registry_));
+
+  queue_.reset(new AtomicRing<Publication>(configuration_.queueSize()));
+  {
+    boost::mutex::scoped_lock lock(retainMutex_);
+    retained_.clear();
+    retained_.resize(configuration_.retransmitPackets());
+  }
+
+  sender_.reset(new Communication::MulticastSender(
+    recycler_,
+    configuration_.primaryGroupIP(),
+    configuration_.primaryPort()));
+  sender_->initializeSender();
+  boost::asio::ip::udp::socket & socket = sender_->socket();
+  socket.set_option(boost::asio::ip::multicast::enable_loopback(true));
+  if(configuration_.sendInterfaceIP() != "0.0.0.0")
+  {
+    socket.set_option(boost::asio::ip::multicast::outbound_interface(
+      boost::asio::ip::address_v4::from_string(configuration_.sendInterfaceIP())));
+  }
+  if(configuration_.ttl() != 0)
+  {
+    socket.set_option(boost::asio::ip::multicast::hops(int(configuration_.ttl())));
+  }
+
+  // The encoding thread flushes; the sender's own timer would need an io_service thread.
+  sender_->setPacking(
+    configuration_.maxDatagramSize(),
+    configuration_.maxMessagesPerDatagram(),
+    0,
+    configuration_.batchSize());
+  sender_->setPacketHeader(
+    configuration_.packetHeaderMessageSizeBytes(),
+    configuration_.packetHeaderBigEndian(),
+    configuration_.packetHeaderPrefixCount(),
+    configuration_.packetHeaderSuffixCount(),
+    configuration_.sequenceOffset(),
+    configuration_.sequenceLength());
+  sender_->setMessageHeader(
+    configuration_.messageHeaderMessageSizeBytes(),
+    configuration_.messageHeaderBigEndian(),
+    configuration_.messageHeaderPrefixCount(),
+    configuration_.messageHeaderSuffixCount());
+  sender_->setSequenceNumber(configuration_.firstSequenceNumber());
+  if(configuration_.secondaryPort() != 0)
+  {
+    sender_->setSecondary(configuration_.secondaryGroupIP(), configuration_.secondaryPort());
+  }
+  sender_->setDatagramObserver(this);
+}
+
+void
+EncoderConnection::start()
+{
+  if(!sender_)
+  {
+    throw UsageError("Coding Error","Starting EncoderConnection before it is configured.");
+  }
+  if(!thread_)
+  {
+    {
+      boost::mutex::scoped_lock lock(stopMutex_);
+      stopping_ = false;
+    }
+    thread_.reset(new boost::thread(boost::bind(&EncoderConnection::encodeLoop, this)));
+  }
+}
+
+void
+EncoderConnection::stop()
+{
+  if(thread_)
+  {
+    {
+      boost::mutex::scoped_lock lock(stopMutex_);
+      stopping_ = true;
+    }
+    thread_->join();
+    thread_.reset();
+  }
+  if(sender_)
+  {
+    flushSender();
+  }
+}
+
+bool
+EncoderConnection::stopping()
+{
+  boost::mutex::scoped_lock lock(stopMutex_);
+  return stopping_;
+}
+
+bool
+EncoderConnection::tryPublish(template_id_t templateId, const Messages::MessageCPtr & message)
+{
+  Publication publication;
+  publication.templateId_ = templateId;
+  publication.message_ = message;
+  if(!queue_->push(publication))
+  {
+    ++queueFullCount_;
+    return false;
+  }
+  return true;
+}
+
+void
+EncoderConnection::publish(template_id_t templateId, const Messages::MessageCPtr & message)
+{
+  Publication publication;
+  publication.templateId_ = templateId;
+  publication.message_ = message;
+  while(!queue_->push(publication))
+  {
+    boost::thread::yield();
+  }
+}
+
+void
+EncoderConnection::encodeLoop()
+{
+  const uint64 flushNanoseconds = uint64(configuration_.flushMicroseconds()) * 1000;
+  uint64 firstPending = 0;
+  bool pending = false;
+  size_t idle = 0;
+  Publication publication;
+  for(;;)
+  {
+    if(queue_->pop(publication))
+    {
+      idle = 0;
+      encode(publication);
+      publication = Publication();
+      if(flushNanoseconds != 0)
+      {
+        uint64 now = Communication::ReplayPacer::now();
+        if(!pending)
+        {
+          firstPending = now;
+        }
+        else if(now - firstPending >= flushNanoseconds)
+        {
+          flushSender();
+          firstPending = now;
+        }
+      }
+      pending = true;
+    }
+    else
+    {
+      // the queue is empty: send what we have rather than wait for more.
+      if(pending)
+      {
+        flushSender();
+        pending = false;
+      }
+      if(queue_->empty() && stopping())
+      {
+        break;
+      }
+      ++idle;
+      if(idle > idleSpins + idleYields)
+      {
+        boost::this_thread::sleep(boost::posix_time::microseconds(idleSleepMicroseconds));
+      }
+      else if(idle > idleSpins)
+      {
+        boost::thread::yield();
+      }
+    }
+  }
+}
+
+void
+EncoderConnection::encode(const Publication & publication)
+{
+  try
+  {
+    try
+    {
+      packPublication(publication);
+    }
+    catch (const CommunicationError &)
+    {
+      // Earlier datagrams were lost, and with them the dictionary updates they
+      // carried.  This message was encoded fine but not packed: start over with it.
+      ++sendErrorCount_;
+      encoder_->reset();
+      resetPending_ = true;
+      packPublication(publication);
+    }
+    ++messageCount_;
+  }
+  catch (const CommunicationError &)
+  {
+    // The send failed again.  This message is lost too.
+    ++sendErrorCount_;
+    encoder_->reset();
+    resetPending_ = true;
+  }
+  catch (const std::exception &)
+  {
+    // The dictionaries may have been partially updated. Start over, and tell the
+    // decoders with the next message.  Sending the reset now could fail the same way.
+    ++encodingErrorCount_;
+    encoder_->reset();
+    resetPending_ = true;
+  }
+}
+
+void
+EncoderConnection::packPublication(const Publication & publication)
+{
+  if(resetPending_)
+  {
+    sender_->pack(scpReset, sizeof(scpReset));
+    resetPending_ = false;
+  }
+  bool reset = configuration_.reset();
+  if(reset && sender_->datagramEmpty())
+  {
+    encoder_->reset();
+  }
+  encodeToBuffer(publication);
+  if(reset && !sender_->fits(buffer_.size()))
+  {
+    // it was encoded against this packet's dictionary; start a new packet and encode it again.
+    sender_->endDatagram();
+    encoder_->reset();
+    encodeToBuffer(publication);
+  }
+  sender_->pack(buffer_.begin(), buffer_.size());
+}
+
+void
+EncoderConnection::flushSender()
+{
+  try
+  {
+    sender_->flush();
+  }
+  catch (const std::exception &)
+  {
+    // The decoders missed the dictionary updates in the lost datagram.
+    ++sendErrorCount_;
+    encoder_->reset();
+    resetPending_ = true;
+  }
+}
+
+void
+EncoderConnection::encodeToBuffer(const Publication & publication)
+{
+  destination_.clear();
+  encoder_->encodeMessage(destination_, publication.templateId_, *publication.message_);
+  destination_.toWorkingBuffer(buffer_);
+}
+
+void
+EncoderConnection::datagramPacked(uint32 sequenceNumber, const unsigned char * datagram, size_t size)
+{
+  ++packetCount_;
+  boost::mutex::scoped_lock lock(retainMutex_);
+  if(!retained_.empty())
+  {
+    Retained & retained = retained_[sequenceNumber % retained_.size()];
+    retained.valid_ = true;
+    retained.sequenceNumber_ = sequenceNumber;
+    retained.datagram_.assign(reinterpret_cast<const char *>(datagram), size);
+  }
+}
+
+bool
+EncoderConnection::fetchPacket(uint32 sequenceNumber, std::string & datagram)
+{
+  boost::mutex::scoped_lock lock(retainMutex_);
+  if(retained_.empty())
+  {
+    return false;
+  }
+  const Retained & retained = retained_[sequenceNumber % retained_.size()];
+  if(!retained.valid_ || retained.sequenceNumber_ != sequenceNumber)
+  {
+    return false;
+  }
+  datagram = retained.datagram_;
+  return true;
+}
+
+size_t
+EncoderConnection::retransmit(uint32 first, uint32 last)
+{
+  if(!sender_)
+  {
+    throw UsageError("Coding Error","Retransmitting on EncoderConnection before it is configured.");
+  }
+  uint32 address = 0;
+  uint16 port = 0;
+  if(configuration_.retransmitPort() != 0)
+  {
+    address = uint32(boost::asio::ip::address_v4::from_string(
+      configuration_.retransmitGroupIP()).to_ulong());
+    port = configuration_.retransmitPort();
+  }
+  else
+  {
+    address = uint32(boost::asio::ip::address_v4::from_string(
+      configuration_.primaryGroupIP()).to_ulong());
+    port = configuration_.primaryPort();
+  }
+
+  size_t count = 0;
+  Communication::DatagramBatch batch(configuration_.batchSize());
+  boost::mutex::scoped_lock lock(retainMutex_);
+  if(retained_.empty())
+  {
+    return 0;
+  }
+  // only the most recent datagrams can still be in the ring.
+  if(last - first >= retained_.size())
+  {
+    first = last - uint32(retained_.size() - 1);
+  }
+  for(uint32 sequenceNumber = first; ; ++sequenceNumber)
+  {
+    const Retained & retained = retained_[sequenceNumber % retained_.size()];
+    if(retained.valid_ && retained.sequenceNumber_ == sequenceNumber)
+    {
+      ++count;
+      if(batch.add(
+        reinterpret_cast<const unsigned char *>(retained.datagram_.data()),
+        retained.datagram_.size(),
+        address,
+        port))
+      {
+        batch.send(sender_->socket());
+        batch.clear();
+      }
+    }
+    if(sequenceNumber == last)
+    {
+      break;
+    }
+  }
+  if(!batch.empty())
+  {
+    batch.send(sender_->socket());
+  }
+  return count;
+}
@@ -0,0 +1,214 @@
+// Copyright (c) 2009, 2010, 2011, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef ENCODERCONNECTION_H
+#define ENCODERCONNECTION_H
+#include "EncoderConnection_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Exceptions.h>
+#include <Common/AtomicRing.h>
+#include <Common/AtomicCounter.h>
+#include <Common/WorkingBuffer.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+#include <Codecs/Encoder_fwd.h>
+#include <Codecs/DataDestination.h>
+#include <Messages/Message_fwd.h>
+#include <Communication/MulticastSender.h>
+#include <Communication/BufferRecycler.h>
+#include <Application/EncoderConfiguration.h>
+
+namespace QuickFAST{
+  namespace Application{
+    /// @brief Publish FAST encoded messages to a multicast feed.
+    ///
+    /// Any number of threads may publish messages.  Each message is placed in
+    /// a bounded lock-free queue and encoded by a dedicated thread, so the
+    /// encoder's dictionaries see the messages in a single order without the
+    /// publishers ever waiting on a lock.
+    ///
+    /// The encoded messages are packed into sequence-numbered datagrams (see
+    /// MulticastSender::setPacking) and sent to a primary (A) group and,
+    /// optionally, a secondary (B) group.  The most recent datagrams are kept
+    /// so gaps reported by subscribers can be filled with retransmit().
+    class QuickFAST_Export EncoderConnection
+      : private Communication::MulticastSender::DatagramObserver
+    {
+    public:
+      EncoderConnection();
+      ~EncoderConnection();
+
+      /// @brief call this before calling configure if you want to share a prebuilt template registry
+      /// @param registry the registry to use
+      void setTemplateRegistry(Codecs::TemplateRegistryPtr registry);
+
+      /// @brief Configure the connection for use
+      /// @param configuration contains configuration parameters
+      /// @throws std::invalid_argument if the templates cannot be read.
+      void configure(const Application::EncoderConfiguration & configuration);
+
+      /// @brief Start the encoding thread.
+      void start();
+
+      /// @brief Encode and send everything published so far, then stop the encoding thread.
+      ///
+      /// Messages published after stop() is called may not be sent.
+      void stop();
+
+      /// @brief Publish a message unless the queue is full.
+      ///
+      /// May be called from any thread.
+      /// @param templateId identifies the template with which to encode the message.
+      /// @param message is the message. It must not be changed after it is published.
+      /// @returns false if the queue was full and the message was not published.
+      bool tryPublish(template_id_t templateId, const Messages::MessageCPtr & message);
+
+      /// @brief Publish a message, waiting for room in the queue if necessary.
+      ///
+      /// May be called from any thread.
+      /// @param templateId identifies the template with which to encode the message.
+      /// @param message is the message. It must not be changed after it is published.
+      void publish(template_id_t templateId, const Messages::MessageCPtr & message);
+
+      /// @brief Get a copy of a recently sent datagram.
+      /// @param sequenceNumber identifies the datagram.
+      /// @param[out] datagram receives the datagram, headers included.
+      /// @returns false if the datagram is no longer (or not yet) available.
+      bool fetchPacket(uint32 sequenceNumber, std::string & datagram);
+
+      /// @brief Send recently sent datagrams again.
+      ///
+      /// They go to the retransmit group if one was configured; otherwise to the primary group.
+      /// May be called from any thread.
+      /// @param first is the sequence number of the first datagram to resend.
+      /// @param last is the sequence number of the last datagram to resend.
+      /// @returns the number of datagrams resent.
+      size_t retransmit(uint32 first, uint32 last);
+
+      /// @brief provide access to the template registry
+      Codecs::TemplateRegistryPtr & registry()
+      {
+        if(!registry_)
+        {
+          throw UsageError("Coding Error","Using EncoderConnection registry before it is configured.");
+        }
+        return registry_;
+      }
+
+      /// @brief Access the multicast sender.
+      Communication::MulticastSender & sender()const
+      {
+        if(!sender_)
+        {
+          throw UsageError("Coding Error","Using EncoderConnection sender before it is configured.");
+        }
+        return *sender_;
+      }
+
+      /// @brief The number of messages encoded.
+      size_t messageCount()const
+      {
+        return messageCount_;
+      }
+
+      /// @brief The number of datagrams packed (each counted once, even if sent to A and B).
+      size_t packetCount()const
+      {
+        return packetCount_;
+      }
+
+      /// @brief The number of messages that could not be encoded.
+      ///
+      /// A message that fails to encode is dropped and the next message is
+      /// preceded by an SCP reset message so decoders stay in step with the encoder.
+      size_t encodingErrorCount()const
+      {
+        return encodingErrorCount_;
+      }
+
+      /// @brief The number of times the packed datagrams could not be sent.
+      ///
+      /// The messages in them are lost.  The next message is preceded by an SCP
+      /// reset message.  A message being packed when the send failed is kept
+      /// and encoded again after the reset.
+      size_t sendErrorCount()const
+      {
+        return sendErrorCount_;
+      }
+
+      /// @brief The number of times tryPublish found the queue full.
+      size_t queueFullCount()const
+      {
+        return size_t(long(queueFullCount_));
+      }
+
+    private:
+      struct Publication
+      {
+        Publication()
+          : templateId_(0)
+        {
+        }
+        template_id_t templateId_;
+        Messages::MessageCPtr message_;
+      };
+
+      struct Retained
+      {
+        Retained()
+          : valid_(false)
+          , sequenceNumber_(0)
+        {
+        }
+        bool valid_;
+        uint32 sequenceNumber_;
+        std::string datagram_;
+      };
+
+      class NullRecycler : public Communication::BufferRecycler
+      {
+      public:
+        virtual void recycle(Communication::LinkedBuffer * /*emptyBuffer*/)
+        {
+        }
+      };
+
+      void encodeLoop();
+      void encode(const Publication & publication);
+      void packPublication(const Publication & publication);
+      void encodeToBuffer(const Publication & publication);
+      void flushSender();
+      bool stopping();
+      virtual void datagramPacked(uint32 sequenceNumber, const unsigned char * datagram, size_t size);
+
+    private:
+      EncoderConfiguration configuration_;
+      Codecs::TemplateRegistryPtr registry_;
+      boost::scoped_ptr<Codecs::Encoder> encoder_;
+      NullRecycler recycler_;
+      boost::scoped_ptr<Communication::MulticastSender> sender_;
+      boost::scoped_ptr<AtomicRing<Publication> > queue_;
+      boost::scoped_ptr<boost::thread> thread_;
+      boost::mutex stopMutex_;
+      bool stopping_;
+
+      // used only by the encoding thread
+      Codecs::DataDestination destination_;
+      WorkingBuffer buffer_;
+      bool resetPending_;
+
+      boost::mutex retainMutex_;
+      std::vector<Retained> retained_;
+
+      size_t messageCount_;
+      size_t packetCount_;
+      size_t encodingErrorCount_;
+      size_t sendErrorCount_;
+      AtomicCounter queueFullCount_;
+    };
+  }
+}
+#endif // ENCODERCONNECTION_H
@@ -101,9 +101,13 @@ BasePacketAssembler::decodeBuffer(const unsigned char * buffer, size_t size)
             currentSize_ = 0;
             currentBuffer_ = 0;
           }
-          else
+          else if(!decoder_.decodeMessage(*this, builder_))
           {
-            decoder_.decodeMessage(*this, builder_);
+            // exception-free decoding failed: the rest of the packet is suspect.
+            result = reportDecoderError();
+            DataSource::reset();
+            currentSize_ = 0;
+            currentBuffer_ = 0;
           }
         }
       }
@@ -127,6 +131,7 @@ void
 BasePacketAssembler::receiverStarted(Communication::Receiver & /*receiver*/)
 {
   decoder_.setStrict(strict_);
+  decoder_.setExceptionFree(exceptionFree_);
   if(builder_.wantLog(Common::Logger::QF_LOG_INFO))
   {
     builder_.logMessage(Common::Logger::QF_LOG_INFO, "Receiver started");
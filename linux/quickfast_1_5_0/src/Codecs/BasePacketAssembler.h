@@ -85,10 +85,13 @@ namespace QuickFAST
       // Implement DataSource
       virtual bool getBuffer(const uchar *& buffer, size_t & size);
 
-    protected:
       /// @brief Decode the contents of a memory buffer
+      ///
+      /// The buffer holds one complete packet.  Used by serviceQueue, or
+      /// directly when the packets do not come from a Receiver.
       /// @param buffer points to the data.
       /// @param size is how many valid bytes of data are at *buffer.
+      /// @returns false if decoding should stop.
       bool decodeBuffer(const unsigned char * buffer, size_t size);
 
     private:
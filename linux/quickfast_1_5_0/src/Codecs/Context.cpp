@@ -17,9 +17,17 @@ Context::Context(Codecs::TemplateRegistryCPtr registry)
 , templateRegistry_(registry)
 , templateId_(~0U)
 , strict_(true)
+, exceptionFree_(false)
+, errorCode_(0)
+, errorMessage_(0)
 , indexedDictionarySize_(registry->dictionarySize())
 //, indexedDictionary_(new Messages::FieldCPtr[indexedDictionarySize_])
 , indexedDictionary_(new Value[indexedDictionarySize_])
+, dictionaryReads_(0)
+, dictionaryMisses_(0)
+, checkpointActive_(false)
+, checkpointTemplateId_(~0U)
+, checkpointNumber_(0)
 {
 }
 
@@ -32,6 +40,10 @@ Context::reset(bool resetTemplateId /*= true*/)
 {
   for(size_t nDict = 0; nDict < indexedDictionarySize_; ++nDict)
   {
+    if(checkpointActive_ && indexedDictionary_[nDict].isDefined())
+    {
+      saveDictionaryEntry(nDict);
+    }
     indexedDictionary_[nDict].erase();
   }
   if(resetTemplateId)
@@ -41,6 +53,43 @@ Context::reset(bool resetTemplateId /*= true*/)
 }
 
 
+void
+Context::beginCheckpoint()
+{
+  if(!checkpointMarks_)
+  {
+    checkpointMarks_.reset(new size_t[indexedDictionarySize_]);
+    for(size_t nDict = 0; nDict < indexedDictionarySize_; ++nDict)
+    {
+      checkpointMarks_[nDict] = 0;
+    }
+    savedDictionary_.reset(new Value[indexedDictionarySize_]);
+  }
+  ++checkpointNumber_;
+  journal_.clear();
+  checkpointTemplateId_ = templateId_;
+  checkpointActive_ = true;
+}
+
+void
+Context::rollbackCheckpoint()
+{
+  for(Journal::const_iterator it = journal_.begin(); it != journal_.end(); ++it)
+  {
+    indexedDictionary_[*it] = savedDictionary_[*it];
+  }
+  journal_.clear();
+  templateId_ = checkpointTemplateId_;
+  checkpointActive_ = false;
+}
+
+void
+Context::endCheckpoint()
+{
+  journal_.clear();
+  checkpointActive_ = false;
+}
+
 bool
 Context::findTemplate(const std::string & name, const std::string & nameSpace, TemplateCPtr & result) const
 {
@@ -59,6 +108,40 @@ Context::logMessage(const std::string & message)
   }
 }
 
+void
+Context::recordError(const char * errorCode, const char * message, const char * name)
+{
+  if(logOut_)
+  {
+    (*logOut_) << errorCode << ' ' << message;
+    if(name != 0)
+    {
+      (*logOut_) << " Field: " << name;
+    }
+    (*logOut_) << std::endl;
+  }
+  if(errorCode_ == 0)
+  {
+    errorCode_ = errorCode;
+    errorMessage_ = message;
+  }
+}
+
+void
+Context::recordError(const std::string & errorCode, const std::string & message, const char * name)
+{
+  bool first = (errorCode_ == 0);
+  recordError(errorCode.c_str(), message.c_str(), name);
+  if(first)
+  {
+    // the caller's strings are temporary; keep our own copies
+    errorCodeText_ = errorCode;
+    errorMessageText_ = message;
+    errorCode_ = errorCodeText_.c_str();
+    errorMessage_ = errorMessageText_.c_str();
+  }
+}
+
 void
 Context::reportWarning(const std::string & errorCode, const std::string & message)
 {
@@ -102,6 +185,11 @@ Context::reportError(const std::string & errorCode, const std::string & message)
       return;
     }
   }
+  if(exceptionFree_)
+  {
+    recordError(errorCode, message, 0);
+    return;
+  }
   throw EncodingError(errorCode + ' ' + message);
 }
 
@@ -111,6 +199,11 @@ Context::reportError(
   const std::string & message,
   const Messages::FieldIdentity & identity)
 {
+  if(exceptionFree_)
+  {
+    recordError(errorCode, message, identity.name().c_str());
+    return;
+  }
   throw EncodingError(errorCode + ' ' + message + " Field: " + identity.name());
 }
 
@@ -120,12 +213,22 @@ Context::reportError(
   const std::string & message,
   const std::string & name)
 {
+  if(exceptionFree_)
+  {
+    recordError(errorCode, message, name.c_str());
+    return;
+  }
   throw EncodingError(errorCode + ' ' + message + " Field: " + name);
 }
 
 void
 Context::reportFatal(const std::string & errorCode, const std::string & message)
 {
+  if(exceptionFree_)
+  {
+    recordError(errorCode, message, 0);
+    return;
+  }
   throw EncodingError(errorCode + ' ' +  message);
 }
 
@@ -135,6 +238,11 @@ Context::reportFatal(
   const std::string & message,
   const Messages::FieldIdentity & identity)
 {
+  if(exceptionFree_)
+  {
+    recordError(errorCode, message, identity.name().c_str());
+    return;
+  }
   throw EncodingError(errorCode + ' ' + message + " Field: " + identity.name());
 }
 
@@ -144,6 +252,91 @@ Context::reportFatal(
   const std::string & message,
   const std::string & name)
 {
+  if(exceptionFree_)
+  {
+    recordError(errorCode, message, name.c_str());
+    return;
+  }
   throw EncodingError(errorCode + ' ' + message + " Field: " + name);
 }
 
+void
+Context::reportError(const char * errorCode, const char * message)
+{
+  if(exceptionFree_)
+  {
+    if(strict_ || strcmp(errorCode, "[ERR D2]") != 0)
+    {
+      recordError(errorCode, message, 0);
+    }
+    return;
+  }
+  reportError(std::string(errorCode), std::string(message));
+}
+
+void
+Context::reportError(
+  const char * errorCode,
+  const char * message,
+  const Messages::FieldIdentity & identity)
+{
+  if(exceptionFree_)
+  {
+    recordError(errorCode, message, identity.name().c_str());
+    return;
+  }
+  reportError(std::string(errorCode), std::string(message), identity);
+}
+
+void
+Context::reportError(
+  const char * errorCode,
+  const char * message,
+  const std::string & name)
+{
+  if(exceptionFree_)
+  {
+    recordError(errorCode, message, name.c_str());
+    return;
+  }
+  reportError(std::string(errorCode), std::string(message), name);
+}
+
+void
+Context::reportFatal(const char * errorCode, const char * message)
+{
+  if(exceptionFree_)
+  {
+    recordError(errorCode, message, 0);
+    return;
+  }
+  reportFatal(std::string(errorCode), std::string(message));
+}
+
+void
+Context::reportFatal(
+  const char * errorCode,
+  const char * message,
+  const Messages::FieldIdentity & identity)
+{
+  if(exceptionFree_)
+  {
+    recordError(errorCode, message, identity.name().c_str());
+    return;
+  }
+  reportFatal(std::string(errorCode), std::string(message), identity);
+}
+
+void
+Context::reportFatal(
+  const char * errorCode,
+  const char * message,
+  const std::string & name)
+{
+  if(exceptionFree_)
+  {
+    recordError(errorCode, message, name.c_str());
+    return;
+  }
+  reportFatal(std::string(errorCode), std::string(message), name);
+}
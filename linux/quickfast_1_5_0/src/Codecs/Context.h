@@ -57,11 +57,75 @@ namespace QuickFAST
         return strict_;
       }
 
+      /// @brief Enable/disable exception-free operation
+      ///
+      /// When exception-free operation is enabled reportError() and reportFatal()
+      /// record the error code rather than throwing an EncodingError.
+      /// The first error is remembered until clearError() is called.  The
+      /// Xcoder unwinds by checking hasError() so no message text is built unless
+      /// a log stream has been supplied.  The default is false -- errors throw.
+      /// @param exceptionFree true to record errors; false to throw them.
+      void setExceptionFree(bool exceptionFree)
+      {
+        exceptionFree_ = exceptionFree;
+      }
+
+      /// @brief get the current status of the exceptionFree property.
+      /// @returns true if errors are recorded rather than thrown.
+      bool getExceptionFree()const
+      {
+        return exceptionFree_;
+      }
+
+      /// @brief Has an error been recorded since the last clearError()?
+      /// @returns true if an error is pending.  Always false unless exceptionFree is set.
+      bool hasError()const
+      {
+        return errorCode_ != 0;
+      }
+
+      /// @brief Access the code of the first recorded error.
+      /// @returns the error code, i.e. "[ERR D9]", or zero if no error is pending.
+      const char * getErrorCode()const
+      {
+        return errorCode_;
+      }
+
+      /// @brief Access the text describing the first recorded error.
+      /// @returns the message or zero if no error is pending.
+      const char * getErrorMessage()const
+      {
+        return errorMessage_;
+      }
+
+      /// @brief Forget any recorded error.
+      void clearError()
+      {
+        errorCode_ = 0;
+        errorMessage_ = 0;
+      }
+
       /// @brief Reset decoding state to initial conditions
       /// @param resetTemplateId Normally you want to reset the template ID
       ///        however there are cases when you don't.
       void reset(bool resetTemplateId = true);
 
+      /// @brief Begin recording dictionary changes so they can be undone.
+      ///
+      /// Used to restart decoding of a message that was cut short by lack of data.
+      /// Each entry is saved the first time it changes after this call, so the
+      /// cost is one copy per entry the message touches.
+      /// Any previous checkpoint is discarded.
+      void beginCheckpoint();
+
+      /// @brief Undo all dictionary and template ID changes since beginCheckpoint().
+      ///
+      /// The checkpoint is ended.
+      void rollbackCheckpoint();
+
+      /// @brief Accept all changes since beginCheckpoint() and stop recording.
+      void endCheckpoint();
+
       /// @brief Remember the id of the template driving the Xcoding.
       void setTemplateId(const template_id_t & templateId)
       {
@@ -104,6 +168,10 @@ namespace QuickFAST
         {
           throw TemplateDefinitionError("Illegal dictionary index.");
         }
+        if(checkpointActive_)
+        {
+          saveDictionaryEntry(index);
+        }
         indexedDictionary_[index].setNull();
       }
 
@@ -115,6 +183,10 @@ namespace QuickFAST
         {
           throw TemplateDefinitionError("Illegal dictionary index.");
         }
+        if(checkpointActive_)
+        {
+          saveDictionaryEntry(index);
+        }
         indexedDictionary_[index].setUndefined();
       }
 
@@ -128,6 +200,10 @@ namespace QuickFAST
         {
           throw TemplateDefinitionError("Illegal dictionary index.");
         }
+        if(checkpointActive_)
+        {
+          saveDictionaryEntry(index);
+        }
         indexedDictionary_[index].setValue(value);
       }
 
@@ -141,6 +217,10 @@ namespace QuickFAST
         {
           throw TemplateDefinitionError("Illegal dictionary index.");
         }
+        if(checkpointActive_)
+        {
+          saveDictionaryEntry(index);
+        }
         indexedDictionary_[index].setValue(value, length);
       }
 
@@ -155,8 +235,10 @@ namespace QuickFAST
           throw TemplateDefinitionError("Illegal dictionary index.");
         }
         Value & entry = indexedDictionary_[index];
+        ++dictionaryReads_;
         if(!entry.isDefined())
         {
+          ++dictionaryMisses_;
           return UNDEFINED_VALUE;
         }
         if(entry.isNull())
@@ -178,8 +260,10 @@ namespace QuickFAST
           throw TemplateDefinitionError("Illegal dictionary index.");
         }
         Value & entry = indexedDictionary_[index];
+        ++dictionaryReads_;
         if(!entry.isDefined())
         {
+          ++dictionaryMisses_;
           return UNDEFINED_VALUE;
         }
         if(entry.isNull())
@@ -190,6 +274,47 @@ namespace QuickFAST
         return OK_VALUE;
       }
 
+      /// @brief Find a dictionary entry that will be updated in place.
+      ///
+      /// The entry is journaled first if a checkpoint is active, so a rollback
+      /// restores the value it held before the update.
+      /// @param index identifies the dictionary entry corresponding to this field
+      /// @returns the entry to be updated
+      Value & getDictionaryEntryForUpdate(size_t index)
+      {
+        if(index > indexedDictionarySize_)
+        {
+          throw TemplateDefinitionError("Illegal dictionary index.");
+        }
+        Value & entry = indexedDictionary_[index];
+        ++dictionaryReads_;
+        if(!entry.isDefined())
+        {
+          ++dictionaryMisses_;
+        }
+        if(checkpointActive_)
+        {
+          saveDictionaryEntry(index);
+        }
+        return entry;
+      }
+
+      /// @brief How many times has getDictionaryValue() been called?
+      ///
+      /// A running count intended for analysis tools such as DecodeProfiler.
+      size_t dictionaryReads()const
+      {
+        return dictionaryReads_;
+      }
+
+      /// @brief How many calls to getDictionaryValue() found an undefined entry?
+      ///
+      /// A running count intended for analysis tools such as DecodeProfiler.
+      size_t dictionaryMisses()const
+      {
+        return dictionaryMisses_;
+      }
+
       /// @brief Report a warning
       /// @param errorCode as defined in the FIX standard (or invented for QuickFAST)
       ///                  i.e [R123]
@@ -278,6 +403,56 @@ namespace QuickFAST
         const std::string & name
         );
 
+      /// @brief Report a recoverable error without constructing strings.
+      ///
+      /// Honors exceptionFree; otherwise equivalent to the std::string version.
+      /// @param errorCode as defined in the FIX standard (or invented for QuickFAST)
+      /// @param message a text description of the problem.
+      void reportError(const char * errorCode, const char * message);
+
+      /// @brief Report a recoverable error without constructing strings.
+      /// @param errorCode as defined in the FIX standard (or invented for QuickFAST)
+      /// @param message a text description of the problem.
+      /// @param identity identifies the field being Xcoded
+      void reportError(
+        const char * errorCode,
+        const char * message,
+        const Messages::FieldIdentity & identity);
+
+      /// @brief Report a recoverable error without constructing strings.
+      /// @param errorCode as defined in the FIX standard (or invented for QuickFAST)
+      /// @param message a text description of the problem.
+      /// @param name identifies the field being Xcoded
+      void reportError(
+        const char * errorCode,
+        const char * message,
+        const std::string & name);
+
+      /// @brief Report a fatal error without constructing strings.
+      ///
+      /// Honors exceptionFree; otherwise equivalent to the std::string version.
+      /// @param errorCode as defined in the FIX standard (or invented for QuickFAST)
+      /// @param message a text description of the problem.
+      void reportFatal(const char * errorCode, const char * message);
+
+      /// @brief Report a fatal error without constructing strings.
+      /// @param errorCode as defined in the FIX standard (or invented for QuickFAST)
+      /// @param message a text description of the problem.
+      /// @param identity identifies the field being Xcoded
+      void reportFatal(
+        const char * errorCode,
+        const char * message,
+        const Messages::FieldIdentity & identity);
+
+      /// @brief Report a fatal error without constructing strings.
+      /// @param errorCode as defined in the FIX standard (or invented for QuickFAST)
+      /// @param message a text description of the problem.
+      /// @param name identifies the field being Xcoded
+      void reportFatal(
+        const char * errorCode,
+        const char * message,
+        const std::string & name);
+
       /// @brief get a working buffer for use during Xcoding.
       WorkingBuffer & getWorkingBuffer()
       {
@@ -337,6 +512,19 @@ namespace QuickFAST
       Context(const Context &);
       Context & operator = (const Context &);
 
+      /// @brief Save an entry about to change, unless this checkpoint already saved it.
+      void saveDictionaryEntry(size_t index)
+      {
+        if(checkpointMarks_[index] != checkpointNumber_)
+        {
+          checkpointMarks_[index] = checkpointNumber_;
+          savedDictionary_[index] = indexedDictionary_[index];
+          journal_.push_back(index);
+        }
+      }
+      void recordError(const char * errorCode, const char * message, const char * name);
+      void recordError(const std::string & errorCode, const std::string & message, const char * name);
+
     protected:
       /// if an ostream is supplied make the Xcoder noisy
       std::ostream * verboseOut_;
@@ -351,10 +539,28 @@ namespace QuickFAST
 
       /// false makes the Xcoder more forgiving
       bool strict_;
+      /// true records errors rather than throwing them
+      bool exceptionFree_;
     private:
+      const char * errorCode_;
+      const char * errorMessage_;
+      std::string errorCodeText_;
+      std::string errorMessageText_;
       size_t indexedDictionarySize_;
       typedef boost::scoped_array<Value> IndexedDictionary;
       IndexedDictionary indexedDictionary_;
+      size_t dictionaryReads_;
+      size_t dictionaryMisses_;
+      bool checkpointActive_;
+      template_id_t checkpointTemplateId_;
+      /// Counts checkpoints; never zero once a checkpoint has begun.
+      size_t checkpointNumber_;
+      /// The checkpoint in which each entry was saved
+      boost::scoped_array<size_t> checkpointMarks_;
+      /// Values of the entries listed in journal_ when the checkpoint began
+      IndexedDictionary savedDictionary_;
+      typedef std::vector<size_t> Journal;
+      Journal journal_;
       WorkingBuffer workingBuffer_;
     };
   }
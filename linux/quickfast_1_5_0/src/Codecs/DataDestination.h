@@ -98,6 +98,26 @@ namespace QuickFAST{
         }
       }
 
+      /// @brief Append a run of bytes to the end of the currently selected buffer.
+      /// @param data points to the bytes to be appended.
+      /// @param length is the number of bytes to be appended.
+      void putBytes(const uchar * data, size_t length)
+      {
+        if(verboseOut_)
+        {
+          for(size_t pos = 0; pos < length; ++pos)
+          {
+            putByte(data[pos]);
+          }
+          return;
+        }
+        if(active_ == NotABuffer)
+        {
+          (void)startBuffer();
+        }
+        buffers_[active_].append(data, length);
+      }
+
       /// @brief Get the currently selected buffer
       /// @returns a handle to the buffer that can be used with selectBuffer()
       BufferHandle getBuffer()const
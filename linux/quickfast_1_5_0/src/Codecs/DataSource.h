@@ -116,6 +116,7 @@ namespace QuickFAST{
         }
         else if(getBuffer(buffer_, size_))
         {
+          consumed_ += position_;
           position_ = 0;
           byte = buffer_[position_++];
         }
@@ -174,15 +175,59 @@ namespace QuickFAST{
         return echo_;
       }
 
+      /// @brief How many bytes have been delivered to the decoder?
+      ///
+      /// Intended for analysis tools such as DecodeProfiler.  Only differences
+      /// between two calls are meaningful.
+      /// @returns a running count of bytes delivered.
+      size_t bytesConsumed()const
+      {
+        return consumed_ + position_;
+      }
+
       /// @brief Discard any remaining contents and prepare for new data.
       void reset()
       {
+        consumed_ += position_;
         size_ = 0;
         position_ = 0;
         buffer_ = 0;
       }
 
     protected:
+      /// @brief Where is the decoder within the current buffer?
+      /// @returns the offset of the next byte to be delivered.
+      size_t currentPosition()const
+      {
+        return position_;
+      }
+
+      /// @brief Resume delivering data from a buffer that was delivered earlier.
+      ///
+      /// Used by data sources that restart an interrupted message.
+      /// @param buffer the data to be delivered
+      /// @param size the number of bytes in buffer
+      /// @param position the offset of the next byte to be delivered
+      void restartBuffer(const uchar * buffer, size_t size, size_t position)
+      {
+        // bytes delivered again are counted again.
+        consumed_ += position_;
+        consumed_ -= position;
+        buffer_ = buffer;
+        size_ = size;
+        position_ = position;
+      }
+
+      /// @brief Make more bytes available from the current buffer.
+      ///
+      /// Used by data sources that can tell the next bytes immediately follow
+      /// the current buffer in memory.
+      /// @param additional the number of bytes to add to the current buffer.
+      void extendBuffer(size_t additional)
+      {
+        size_ += additional;
+      }
+
       /// @brief Honor the echo parameters
       /// @param ok the result about to be returned from getByte
       /// @param byte the byte found by getByte
@@ -203,6 +248,8 @@ namespace QuickFAST{
       size_t size_;
       /// position within current buffer
       size_t position_;
+      /// bytes delivered from previous buffers
+      size_t consumed_;
     protected:
       /// Where echo output gets written
       std::ostream * echo_;
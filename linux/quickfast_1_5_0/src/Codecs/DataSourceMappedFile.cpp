@@ -0,0 +1,43 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "DataSourceMappedFile.h"
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Codecs;
+
+DataSourceMappedFile::DataSourceMappedFile(const std::string & fileName, size_t windowSize)
+: position_(0)
+{
+  file_.open(fileName, windowSize);
+}
+
+DataSourceMappedFile::~DataSourceMappedFile()
+{
+}
+
+bool
+DataSourceMappedFile::good()const
+{
+  return file_.isOpen();
+}
+
+bool
+DataSourceMappedFile::getBuffer(const uchar *& buffer, size_t & size)
+{
+  size = 0;
+  if(position_ >= file_.size())
+  {
+    return false;
+  }
+  // deliver the rest of the file, one window at a time.
+  size = size_t(std::min(uint64(file_.windowSize()), file_.size() - position_));
+  buffer = file_.map(position_, size);
+  if(buffer == 0)
+  {
+    size = 0;
+    return false;
+  }
+  position_ += size;
+  return true;
+}
@@ -0,0 +1,43 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef DATASOURCEMAPPEDFILE_H
+#define DATASOURCEMAPPEDFILE_H
+#include <Common/QuickFAST_Export.h>
+#include <Codecs/DataSource.h>
+#include <Common/MappedFile.h>
+namespace QuickFAST{
+  namespace Codecs{
+    /// A data source that delivers a file in place from memory mapped pages.
+    ///
+    /// Nothing is read when the source is opened.  The operating system reads
+    /// ahead as the decoder moves through the file, and files larger than the
+    /// address space are handled by moving the mapped window.
+    class QuickFAST_Export DataSourceMappedFile : public DataSource
+    {
+    public:
+      /// @brief Map a file into a DataSource
+      /// @param fileName names the file containing FAST encoded data.
+      /// @param windowSize the number of bytes to map at once (see MappedFile).
+      explicit DataSourceMappedFile(const std::string & fileName, size_t windowSize = 0);
+
+      /// @brief a typical virtual destructor.
+      virtual ~DataSourceMappedFile();
+
+      /// @brief Was the file opened successfully?
+      bool good()const;
+
+      ///////////////////////
+      // Implement DataSource
+      virtual bool getBuffer(const uchar *& buffer, size_t & size);
+
+    private:
+      MappedFile file_;
+      uint64 position_;
+    };
+  }
+}
+#endif // DATASOURCEMAPPEDFILE_H
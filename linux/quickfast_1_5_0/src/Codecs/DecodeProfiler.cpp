@@ -0,0 +1,348 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "DecodeProfiler.h"
+#include <Codecs/DataSource.h>
+#include <Codecs/PresenceMap.h>
+#include <Codecs/FieldInstruction.h>
+#include <Codecs/Context.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Template.h>
+
+using namespace QuickFAST;
+using namespace Codecs;
+
+namespace
+{
+  typedef const DecodeProfiler::FieldStatistics * FieldStatisticsCPtr;
+
+  struct MoreBytes
+  {
+    bool operator()(FieldStatisticsCPtr lhs, FieldStatisticsCPtr rhs)const
+    {
+      return lhs->bytes_ > rhs->bytes_;
+    }
+  };
+
+  struct MoreTime
+  {
+    bool operator()(FieldStatisticsCPtr lhs, FieldStatisticsCPtr rhs)const
+    {
+      return lhs->nanoseconds_ > rhs->nanoseconds_;
+    }
+  };
+
+  struct MoreCount
+  {
+    bool operator()(FieldStatisticsCPtr lhs, FieldStatisticsCPtr rhs)const
+    {
+      return lhs->count_ > rhs->count_;
+    }
+  };
+
+  double ratio(double numerator, double denominator)
+  {
+    return denominator == 0.0 ? 0.0 : numerator / denominator;
+  }
+}
+
+DecodeProfiler::FieldStatistics::FieldStatistics()
+  : templateId_(0)
+  , count_(0)
+  , bytes_(0)
+  , nanoseconds_(0)
+  , pmapChecks_(0)
+  , pmapSet_(0)
+  , dictionaryReads_(0)
+  , dictionaryMisses_(0)
+{
+}
+
+DecodeProfiler::TemplateStatistics::TemplateStatistics()
+  : messages_(0)
+  , bytes_(0)
+  , nanoseconds_(0)
+{
+}
+
+DecodeProfiler::DecodeProfiler()
+  : messageCount_(0)
+  , messageBytes_(0)
+  , messageTime_(0)
+{
+}
+
+DecodeProfiler::~DecodeProfiler()
+{
+}
+
+void
+DecodeProfiler::beginMessage(const DataSource & source, const Context & /*context*/)
+{
+  // a message abandoned part way through leaves frames behind.
+  frames_.clear();
+  messageBytes_ = source.bytesConsumed();
+  messageTime_ = now();
+}
+
+void
+DecodeProfiler::endMessage(const DataSource & source, const Context & context)
+{
+  uint64 time = now();
+  TemplateStatistics & statistics = templates_[context.getTemplateId()];
+  statistics.messages_ += 1;
+  statistics.bytes_ += source.bytesConsumed() - messageBytes_;
+  statistics.nanoseconds_ += time - messageTime_;
+  ++messageCount_;
+  frames_.clear();
+}
+
+void
+DecodeProfiler::beginField(
+  const FieldInstruction & instruction,
+  const DataSource & source,
+  PresenceMap & pmap,
+  const Context & context)
+{
+  size_t bytes = source.bytesConsumed();
+  uint64 time = now();
+  if(!frames_.empty())
+  {
+    // the enclosing field is paused while this one is decoded.
+    Frame & outer = frames_.back();
+    charge(outer, bytes, time, context);
+    settlePresence(outer);
+  }
+
+  template_id_t templateId = context.getTemplateId();
+  FieldStatistics & statistics = fields_[FieldKey(templateId, &instruction)];
+  if(statistics.count_ == 0)
+  {
+    statistics.templateId_ = templateId;
+    statistics.fieldName_ = instruction.getIdentity().name();
+    statistics.operatorName_ = instruction.getFieldOp()->opName();
+    TemplateCPtr templatePtr;
+    if(context.getTemplateRegistry()->getTemplate(templateId, templatePtr))
+    {
+      statistics.templateName_ = templatePtr->getTemplateName();
+    }
+  }
+  statistics.count_ += 1;
+
+  Frame frame;
+  frame.statistics_ = &statistics;
+  frame.pmap_ = &pmap;
+  frame.pmapPosition_ = pmap.bitPosition();
+  frame.pmapSettled_ = instruction.getPresenceMapBitsUsed() == 0;
+  frame.dictionaryReads_ = context.dictionaryReads();
+  frame.dictionaryMisses_ = context.dictionaryMisses();
+  frames_.push_back(frame);
+  // start the clock last so the bookkeeping above is not charged to the field.
+  frames_.back().bytes_ = bytes;
+  frames_.back().time_ = now();
+}
+
+void
+DecodeProfiler::endField(const DataSource & source, const Context & context)
+{
+  uint64 time = now();
+  size_t bytes = source.bytesConsumed();
+  if(frames_.empty())
+  {
+    return;
+  }
+  charge(frames_.back(), bytes, time, context);
+  settlePresence(frames_.back());
+  frames_.pop_back();
+  if(!frames_.empty())
+  {
+    // resume the enclosing field.
+    Frame & outer = frames_.back();
+    outer.bytes_ = bytes;
+    outer.dictionaryReads_ = context.dictionaryReads();
+    outer.dictionaryMisses_ = context.dictionaryMisses();
+    outer.time_ = now();
+  }
+}
+
+void
+DecodeProfiler::charge(Frame & frame, size_t bytes, uint64 time, const Context & context)
+{
+  FieldStatistics & statistics = *frame.statistics_;
+  statistics.bytes_ += bytes - frame.bytes_;
+  statistics.nanoseconds_ += time - frame.time_;
+  statistics.dictionaryReads_ += context.dictionaryReads() - frame.dictionaryReads_;
+  statistics.dictionaryMisses_ += context.dictionaryMisses() - frame.dictionaryMisses_;
+  frame.bytes_ = bytes;
+  frame.time_ = time;
+  frame.dictionaryReads_ = context.dictionaryReads();
+  frame.dictionaryMisses_ = context.dictionaryMisses();
+}
+
+void
+DecodeProfiler::settlePresence(Frame & frame)
+{
+  // A field's own presence bit is the first one it checks, and it is
+  // checked before any nested field begins.
+  if(!frame.pmapSettled_)
+  {
+    frame.pmapSettled_ = true;
+    if(frame.pmap_->bitPosition() > frame.pmapPosition_)
+    {
+      frame.statistics_->pmapChecks_ += 1;
+      if(frame.pmap_->checkSpecificField(frame.pmapPosition_))
+      {
+        frame.statistics_->pmapSet_ += 1;
+      }
+    }
+  }
+}
+
+const DecodeProfiler::FieldStatistics *
+DecodeProfiler::findField(template_id_t templateId, const std::string & fieldName)const
+{
+  for(FieldMap::const_iterator it = fields_.begin(); it != fields_.end(); ++it)
+  {
+    if(it->first.first == templateId && it->second.fieldName_ == fieldName)
+    {
+      return &it->second;
+    }
+  }
+  return 0;
+}
+
+const DecodeProfiler::TemplateStatistics *
+DecodeProfiler::findTemplate(template_id_t templateId)const
+{
+  TemplateMap::const_iterator it = templates_.find(templateId);
+  if(it == templates_.end())
+  {
+    return 0;
+  }
+  return &it->second;
+}
+
+void
+DecodeProfiler::clear()
+{
+  fields_.clear();
+  templates_.clear();
+  frames_.clear();
+  messageCount_ = 0;
+}
+
+void
+DecodeProfiler::report(std::ostream & out, SortKey key)const
+{
+  size_t totalBytes = 0;
+  uint64 totalTime = 0;
+  for(TemplateMap::const_iterator it = templates_.begin(); it != templates_.end(); ++it)
+  {
+    totalBytes += it->second.bytes_;
+    totalTime += it->second.nanoseconds_;
+  }
+  out << "Messages: " << messageCount_
+    << " Bytes: " << totalBytes
+    << " Nanoseconds: " << totalTime << std::endl;
+
+  out << std::endl
+    << std::setw(10) << "Template"
+    << std::setw(12) << "Messages"
+    << std::setw(10) << "% bytes"
+    << std::setw(10) << "% time"
+    << std::setw(12) << "bytes/msg"
+    << std::setw(12) << "ns/msg"
+    << std::endl;
+  for(TemplateMap::const_iterator it = templates_.begin(); it != templates_.end(); ++it)
+  {
+    const TemplateStatistics & statistics = it->second;
+    out << std::setw(10) << it->first
+      << std::setw(12) << statistics.messages_
+      << std::fixed << std::setprecision(1)
+      << std::setw(10) << 100.0 * ratio(double(statistics.bytes_), double(totalBytes))
+      << std::setw(10) << 100.0 * ratio(double(statistics.nanoseconds_), double(totalTime))
+      << std::setw(12) << ratio(double(statistics.bytes_), double(statistics.messages_))
+      << std::setw(12) << ratio(double(statistics.nanoseconds_), double(statistics.messages_))
+      << std::endl;
+  }
+
+  std::vector<FieldStatisticsCPtr> sorted;
+  for(FieldMap::const_iterator it = fields_.begin(); it != fields_.end(); ++it)
+  {
+    sorted.push_back(&it->second);
+  }
+  switch(key)
+  {
+  case BY_TIME:
+    std::stable_sort(sorted.begin(), sorted.end(), MoreTime());
+    break;
+  case BY_COUNT:
+    std::stable_sort(sorted.begin(), sorted.end(), MoreCount());
+    break;
+  default:
+    std::stable_sort(sorted.begin(), sorted.end(), MoreBytes());
+    break;
+  }
+
+  out << std::endl
+    << std::setw(10) << "Template"
+    << std::setw(12) << "Count"
+    << std::setw(10) << "% bytes"
+    << std::setw(10) << "% time"
+    << std::setw(12) << "bytes/fld"
+    << std::setw(12) << "ns/fld"
+    << std::setw(10) << "% pmap"
+    << std::setw(10) << "% dict"
+    << "  Field (operator)"
+    << std::endl;
+  for(std::vector<FieldStatisticsCPtr>::const_iterator it = sorted.begin(); it != sorted.end(); ++it)
+  {
+    const FieldStatistics & statistics = **it;
+    out << std::setw(10) << statistics.templateId_
+      << std::setw(12) << statistics.count_
+      << std::fixed << std::setprecision(1)
+      << std::setw(10) << 100.0 * ratio(double(statistics.bytes_), double(totalBytes))
+      << std::setw(10) << 100.0 * ratio(double(statistics.nanoseconds_), double(totalTime))
+      << std::setw(12) << ratio(double(statistics.bytes_), double(statistics.count_))
+      << std::setw(12) << ratio(double(statistics.nanoseconds_), double(statistics.count_));
+    if(statistics.pmapChecks_ == 0)
+    {
+      out << std::setw(10) << '-';
+    }
+    else
+    {
+      out << std::setw(10) << 100.0 * ratio(double(statistics.pmapSet_), double(statistics.pmapChecks_));
+    }
+    if(statistics.dictionaryReads_ == 0)
+    {
+      out << std::setw(10) << '-';
+    }
+    else
+    {
+      out << std::setw(10) << 100.0 * ratio(
+        double(statistics.dictionaryReads_ - statistics.dictionaryMisses_),
+        double(statistics.dictionaryReads_));
+    }
+    out << "  ";
+    if(!statistics.templateName_.empty())
+    {
+      out << statistics.templateName_ << '/';
+    }
+    out << statistics.fieldName_ << " (" << statistics.operatorName_ << ')' << std::endl;
+  }
+  out.unsetf(std::ios::floatfield);
+}
+
+uint64
+DecodeProfiler::now()
+{
+#if defined(_WIN32)
+  static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+  return uint64((boost::posix_time::microsec_clock::universal_time() - epoch).total_microseconds()) * 1000;
+#else // _WIN32
+  struct timespec current;
+  clock_gettime(CLOCK_MONOTONIC, &current);
+  return uint64(current.tv_sec) * 1000000000 + uint64(current.tv_nsec);
+#endif // _WIN32
+}
@@ -0,0 +1,178 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef DECODEPROFILER_H
+#define DECODEPROFILER_H
+#include "DecodeProfiler_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+#include <Codecs/DataSource_fwd.h>
+#include <Codecs/PresenceMap_fwd.h>
+#include <Codecs/FieldInstruction_fwd.h>
+#include <Codecs/Context_fwd.h>
+
+namespace QuickFAST{
+  namespace Codecs{
+    /// @brief Attribute the bytes and time spent decoding to templates and fields.
+    ///
+    /// When a DecodeProfiler is attached to a Decoder via Decoder::setProfiler(),
+    /// the decoder reports each message and each field it decodes.  For every
+    /// field of every template the profiler accumulates:
+    ///  - the number of bytes read from the DataSource,
+    ///  - the time spent decoding, in nanoseconds,
+    ///  - how often the field's presence map bit was checked and how often it was set,
+    ///  - how many dictionary reads were made and how many found no value.
+    ///
+    /// Costs are exclusive: the bytes and time of the fields inside a group,
+    /// sequence or templateRef are charged to those fields, not to the
+    /// enclosing one.  What is left for the enclosing field is its own
+    /// presence bit, presence map and sequence length.
+    ///
+    /// Unlike the echo stream this is cheap enough to leave on for real traffic;
+    /// the largest cost is reading the clock twice per field.
+    class QuickFAST_Export DecodeProfiler
+    {
+    public:
+      /// @brief How to order the fields in the report.
+      enum SortKey
+      {
+        BY_BYTES,
+        BY_TIME,
+        BY_COUNT
+      };
+
+      DecodeProfiler();
+      ~DecodeProfiler();
+
+      /// @brief The decoder is about to decode a message.
+      /// @param source supplies the message.
+      /// @param context is the decoder.
+      void beginMessage(const DataSource & source, const Context & context);
+
+      /// @brief The decoder has finished a message.
+      /// @param source supplied the message.
+      /// @param context is the decoder; its current template is charged with the message.
+      void endMessage(const DataSource & source, const Context & context);
+
+      /// @brief The decoder is about to decode a field.
+      /// @param instruction describes the field.
+      /// @param source supplies the field.
+      /// @param pmap is the presence map for the segment containing the field.
+      /// @param context is the decoder; its current template is charged with the field.
+      void beginField(
+        const FieldInstruction & instruction,
+        const DataSource & source,
+        PresenceMap & pmap,
+        const Context & context);
+
+      /// @brief The decoder has finished the field most recently begun.
+      /// @param source supplied the field.
+      /// @param context is the decoder.
+      void endField(const DataSource & source, const Context & context);
+
+      /// @brief How many messages have been profiled?
+      size_t messageCount()const
+      {
+        return messageCount_;
+      }
+
+      /// @brief Write the accumulated statistics.
+      ///
+      /// A summary line for each template is followed by a line for each
+      /// field, most expensive first.
+      /// @param out receives the report.
+      /// @param key selects the order in which the fields appear.
+      void report(std::ostream & out, SortKey key = BY_BYTES)const;
+
+      /// @brief Discard the accumulated statistics.
+      void clear();
+
+      /// @brief Statistics for one field of one template.
+      struct FieldStatistics
+      {
+        FieldStatistics();
+        /// @brief The template in which the field appears
+        template_id_t templateId_;
+        /// @brief The name of that template
+        std::string templateName_;
+        /// @brief The name of the field
+        std::string fieldName_;
+        /// @brief The name of the field's operator
+        std::string operatorName_;
+        /// @brief How many times the field was decoded
+        size_t count_;
+        /// @brief Bytes read while decoding the field
+        size_t bytes_;
+        /// @brief Nanoseconds spent decoding the field
+        uint64 nanoseconds_;
+        /// @brief How often the field's presence map bit was checked
+        size_t pmapChecks_;
+        /// @brief How often the field's presence map bit was set
+        size_t pmapSet_;
+        /// @brief Dictionary reads made while decoding the field
+        size_t dictionaryReads_;
+        /// @brief Dictionary reads that found no previous value
+        size_t dictionaryMisses_;
+      };
+
+      /// @brief Statistics for one template.
+      struct TemplateStatistics
+      {
+        TemplateStatistics();
+        /// @brief How many messages used the template.
+        size_t messages_;
+        /// @brief Bytes in those messages, including their presence map and template ID.
+        size_t bytes_;
+        /// @brief Nanoseconds spent decoding those messages.
+        uint64 nanoseconds_;
+      };
+
+      /// @brief Find the statistics for a field.
+      /// @param templateId identifies the template
+      /// @param fieldName identifies the field
+      /// @returns the statistics or zero if the field has not been decoded.
+      const FieldStatistics * findField(template_id_t templateId, const std::string & fieldName)const;
+
+      /// @brief Find the statistics for a template.
+      /// @param templateId identifies the template
+      /// @returns the statistics or zero if no message has used the template.
+      const TemplateStatistics * findTemplate(template_id_t templateId)const;
+
+    private:
+      DecodeProfiler(const DecodeProfiler &);
+      DecodeProfiler & operator=(const DecodeProfiler &);
+
+      /// A field whose decoding has begun but not ended.
+      struct Frame
+      {
+        FieldStatistics * statistics_;
+        PresenceMap * pmap_;
+        size_t pmapPosition_;
+        bool pmapSettled_;
+        size_t bytes_;
+        uint64 time_;
+        size_t dictionaryReads_;
+        size_t dictionaryMisses_;
+      };
+
+      void charge(Frame & frame, size_t bytes, uint64 time, const Context & context);
+      void settlePresence(Frame & frame);
+      static uint64 now();
+
+    private:
+      typedef std::pair<template_id_t, const FieldInstruction *> FieldKey;
+      typedef std::map<FieldKey, FieldStatistics> FieldMap;
+      FieldMap fields_;
+      typedef std::map<template_id_t, TemplateStatistics> TemplateMap;
+      TemplateMap templates_;
+      std::vector<Frame> frames_;
+      size_t messageCount_;
+      size_t messageBytes_;
+      uint64 messageTime_;
+    };
+  }
+}
+#endif // DECODEPROFILER_H
@@ -8,29 +8,172 @@
 #include <Codecs/PresenceMap.h>
 #include <Codecs/TemplateRegistry.h>
 #include <Codecs/FieldInstruction.h>
+#include <Codecs/DecodeProfiler.h>
 #include <Messages/ValueMessageBuilder.h>
 #include <Common/Profiler.h>
+#include <Common/Metrics.h>
+#include <Common/LatencyTracker.h>
+#include <Common/Probes.h>
 
 using namespace ::QuickFAST;
 using namespace ::QuickFAST::Codecs;
 
 Decoder::Decoder(Codecs::TemplateRegistryPtr registry)
 : Context(registry)
+, profiler_(0)
+, metrics_(0)
+, errorsCounted_(0)
+, messagesBuilt_(0)
+, messagesIgnored_(0)
+, lastTemplateId_(0)
+, lastTemplateMetrics_(0)
+, fieldsDecoded_(0)
+, latency_(0)
 {
 }
 
+Decoder::~Decoder()
+{
+  setMetrics(0, "");
+}
+
+void
+Decoder::setMetrics(MetricsRegistry * registry, const std::string & labels)
+{
+  if(metrics_ != 0)
+  {
+    metrics_->remove(this);
+  }
+  templateMetrics_.clear();
+  lastTemplateMetrics_ = 0;
+  metrics_ = registry;
+  metricsLabels_ = labels;
+  if(metrics_ == 0)
+  {
+    errorsCounted_ = 0;
+    messagesBuilt_ = 0;
+    messagesIgnored_ = 0;
+    return;
+  }
+  errorsCounted_ = &metrics_->counter("quickfast_decoder_errors_total",
+    "Messages that could not be decoded.", labels, this);
+  messagesBuilt_ = &metrics_->counter("quickfast_builder_messages_total",
+    "Messages passed to the builder.", labels, this);
+  messagesIgnored_ = &metrics_->counter("quickfast_builder_ignored_total",
+    "Messages the builder was told to ignore.", labels, this);
+}
+
+void
+Decoder::countMessage()
+{
+  if(lastTemplateMetrics_ == 0 || lastTemplateId_ != templateId_)
+  {
+    TemplateMetricsMap::iterator it = templateMetrics_.find(templateId_);
+    if(it == templateMetrics_.end())
+    {
+      std::string labels = metricsLabels_;
+      if(!labels.empty())
+      {
+        labels += ',';
+      }
+      labels += "template=\"";
+      labels += boost::lexical_cast<std::string>(templateId_);
+      labels += '"';
+      TemplateMetrics metrics;
+      metrics.messages_ = &metrics_->counter("quickfast_decoder_messages_total",
+        "Messages decoded.", labels, this);
+      metrics.fields_ = &metrics_->counter("quickfast_decoder_fields_total",
+        "Field instructions executed.", labels, this);
+      it = templateMetrics_.insert(TemplateMetricsMap::value_type(templateId_, metrics)).first;
+    }
+    lastTemplateId_ = templateId_;
+    lastTemplateMetrics_ = &it->second;
+  }
+  lastTemplateMetrics_->messages_->increment();
+  lastTemplateMetrics_->fields_->increment(fieldsDecoded_);
+}
+
 //Decoder::Decoder()
 //{
 //}
 
 
-void
+bool
 Decoder::decodeMessage(
    DataSource & source,
    Messages::ValueMessageBuilder & messageBuilder)
+{
+  // while the decode_error probe is attached, every message is measured so errors can be traced.
+  if(!QUICKFAST_PROBE_ENABLED(decode_error) && metrics_ == 0 && latency_ == 0)
+  {
+    return decodeOneMessage(source, messageBuilder);
+  }
+  return decodeMeasuredMessage(source, messageBuilder);
+}
+
+bool
+Decoder::decodeMeasuredMessage(
+   DataSource & source,
+   Messages::ValueMessageBuilder & messageBuilder)
+{
+  uint64 decodeStart = latency_ == 0 ? 0 : LatencyTracker::now();
+  fieldsDecoded_ = 0;
+  bool result = false;
+  try
+  {
+    result = decodeOneMessage(source, messageBuilder);
+  }
+  catch(const std::exception & ex)
+  {
+    QUICKFAST_PROBE2(decode_error, templateId_, ex.what());
+    if(errorsCounted_ != 0)
+    {
+      errorsCounted_->increment();
+    }
+    throw;
+  }
+  catch(...)
+  {
+    if(errorsCounted_ != 0)
+    {
+      errorsCounted_->increment();
+    }
+    throw;
+  }
+  if(!result)
+  {
+    QUICKFAST_PROBE2(decode_error, templateId_, getErrorCode());
+    if(errorsCounted_ != 0)
+    {
+      errorsCounted_->increment();
+    }
+  }
+  else
+  {
+    if(metrics_ != 0)
+    {
+      countMessage();
+    }
+    if(latency_ != 0)
+    {
+      latency_->messageDecoded(templateId_, decodeStart);
+    }
+  }
+  return result;
+}
+
+bool
+Decoder::decodeOneMessage(
+   DataSource & source,
+   Messages::ValueMessageBuilder & messageBuilder)
 {
   PROFILE_POINT("decode");
+  clearError();
   source.beginMessage();
+  if(profiler_)
+  {
+    profiler_->beginMessage(source, *this);
+  }
 
   Codecs::PresenceMap pmap(getTemplateRegistry()->presenceMapBits());
   if(this->verboseOut_)
@@ -40,7 +183,11 @@ Decoder::decodeMessage(
 
   static const std::string pmp("PMAP");
   source.beginField(pmp);
-  pmap.decode(source);
+  if(!pmap.decode(source))
+  {
+    reportFatal("[ERR U03]", "EOF while decoding presence map.");
+    return false;
+  }
 
   static const std::string tid("templateID");
   source.beginField(tid);
@@ -48,8 +195,13 @@ Decoder::decodeMessage(
   {
     template_id_t id;
     FieldInstruction::decodeUnsignedInteger(source, *this, id, tid);
+    if(hasError())
+    {
+      return false;
+    }
     setTemplateId(id);
   }
+  QUICKFAST_PROBE1(decode_begin, templateId_);
   if(verboseOut_)
   {
     (*verboseOut_) << "Template ID: " << getTemplateId() << std::endl;
@@ -68,13 +220,21 @@ Decoder::decodeMessage(
         templatePtr->fieldCount()));
 
     decodeSegmentBody(source, pmap, templatePtr, bodyBuilder);
-    if(templatePtr->getIgnore())
+    if(templatePtr->getIgnore() || hasError())
     {
       messageBuilder.ignoreMessage(bodyBuilder);
+      if(messagesIgnored_ != 0)
+      {
+        messagesIgnored_->increment();
+      }
     }
     else
     {
       messageBuilder.endMessage(bodyBuilder);
+      if(messagesBuilt_ != 0)
+      {
+        messagesBuilt_->increment();
+      }
     }
   }
   else if(templateId_ == SCPResetTemplateId)
@@ -83,11 +243,28 @@ Decoder::decodeMessage(
   }
   else
   {
-    std::string error =  "Unknown template ID:";
-    error += boost::lexical_cast<std::string>(getTemplateId());
-    reportError("[ERR D9]", error);
+    reportUnknownTemplate();
   }
-  return;
+  if(profiler_)
+  {
+    profiler_->endMessage(source, *this);
+  }
+  QUICKFAST_PROBE2(decode_end, templateId_, int(!hasError()));
+  return !hasError();
+}
+
+void
+Decoder::reportUnknownTemplate()
+{
+  if(exceptionFree_ && logOut_ == 0)
+  {
+    // nobody will see the text, so don't pay to format it.
+    reportError("[ERR D9]", "Unknown template ID.");
+    return;
+  }
+  std::string error =  "Unknown template ID:";
+  error += boost::lexical_cast<std::string>(getTemplateId());
+  reportError("[ERR D9]", error);
 }
 
 void
@@ -104,7 +281,11 @@ Decoder::decodeNestedTemplate(
 
   static const std::string pmp("PMAP");
   source.beginField(pmp);
-  pmap.decode(source);
+  if(!pmap.decode(source))
+  {
+    reportFatal("[ERR U03]", "EOF while decoding presence map.");
+    return;
+  }
 
   static const std::string tid("templateID");
   source.beginField(tid);
@@ -112,6 +293,10 @@ Decoder::decodeNestedTemplate(
   {
     template_id_t id;
     FieldInstruction::decodeUnsignedInteger(source, *this, id, tid);
+    if(hasError())
+    {
+      return;
+    }
     setTemplateId(id);
   }
   if(verboseOut_)
@@ -137,9 +322,7 @@ Decoder::decodeNestedTemplate(
   }
   else
   {
-    std::string error =  "Unknown template ID:";
-    error += boost::lexical_cast<std::string>(getTemplateId());
-    reportError("[ERR D9]", error);
+    reportUnknownTemplate();
   }
   return;
 }
@@ -161,7 +344,11 @@ Decoder::decodeGroup(
   {
     static const std::string pm("PMAP");
     source.beginField(pm);
-    pmap.decode(source);
+    if(!pmap.decode(source))
+    {
+      reportFatal("[ERR U03]", "EOF while decoding presence map.");
+      return;
+    }
   }
 // for debugging:  pmap.setVerbose(source.getEcho());
   decodeSegmentBody(source, pmap, group, messageBuilder);
@@ -175,6 +362,7 @@ Decoder::decodeSegmentBody(
   Messages::ValueMessageBuilder & messageBuilder)
 {
   size_t instructionCount = segment->size();
+  fieldsDecoded_ += instructionCount;
   for( size_t nField = 0; nField < instructionCount; ++nField)
   {
     PROFILE_POINT("decode field");
@@ -184,6 +372,19 @@ Decoder::decodeSegmentBody(
       (*verboseOut_) <<std::endl << "Decode instruction[" <<nField << "]: " << instruction->getIdentity().name() << std::endl;
     }
     source.beginField(instruction->getIdentity().name());
-    (void)instruction->decode(source, pmap, *this, messageBuilder);
+    if(profiler_)
+    {
+      profiler_->beginField(*instruction, source, pmap, *this);
+      (void)instruction->decode(source, pmap, *this, messageBuilder);
+      profiler_->endField(source, *this);
+    }
+    else
+    {
+      (void)instruction->decode(source, pmap, *this, messageBuilder);
+    }
+    if(hasError())
+    {
+      return;
+    }
   }
 }
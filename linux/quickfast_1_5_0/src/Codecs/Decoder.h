@@ -13,6 +13,9 @@
 #include <Codecs/PresenceMap_fwd.h>
 #include <Codecs/Template.h>
 #include <Codecs/SegmentBody_fwd.h>
+#include <Codecs/DecodeProfiler_fwd.h>
+#include <Common/Metrics_fwd.h>
+#include <Common/LatencyTracker_fwd.h>
 #include <Messages/ValueMessageBuilder_fwd.h>
 
 #include <Common/Exceptions.h>
@@ -30,11 +33,15 @@ namespace QuickFAST{
       /// @brief Construct with a TemplateRegistry containing all templates to be used.
       /// @param registry A registry containing all templates to be used to decode messages.
       explicit Decoder(TemplateRegistryPtr registry);
+      ~Decoder();
 
       /// @brief Decode the next message.
       /// @param[in] source where to read the incoming message(s).
       /// @param[out] message an empty message into which the decoded fields will be stored.
-      void decodeMessage(
+      /// @returns false if an error was recorded (only possible when exceptionFree is set).
+      ///          The message is passed to ignoreMessage() rather than endMessage() and the
+      ///          error is available via getErrorCode() until the next decodeMessage().
+      bool decodeMessage(
         DataSource & source,
         Messages::ValueMessageBuilder & message);
 
@@ -77,6 +84,67 @@ namespace QuickFAST{
         PresenceMap & pmap,
         const SegmentBodyCPtr & segment,
         Messages::ValueMessageBuilder & messageBuilder);
+
+      /// @brief Attribute the bytes and time spent decoding to templates and fields.
+      ///
+      /// The profiler is not owned by the decoder and must outlive its use.
+      /// @param profiler receives the measurements; zero disables profiling.
+      void setProfiler(DecodeProfiler * profiler)
+      {
+        profiler_ = profiler;
+      }
+
+      /// @brief Count messages, fields and errors in a MetricsRegistry.
+      ///
+      /// Adds quickfast_decoder_messages_total and quickfast_decoder_fields_total
+      /// for each template (a field is counted each time an instruction is executed,
+      /// so fields in sequences are counted once per entry),
+      /// quickfast_decoder_errors_total, and the messages passed to the builder:
+      /// quickfast_builder_messages_total and quickfast_builder_ignored_total.
+      /// The metrics are removed when the decoder is destroyed.
+      /// @param registry receives the metrics; zero stops counting.
+      /// @param labels distinguish this decoder's metrics from others', e.g. connection="1"
+      void setMetrics(MetricsRegistry * registry, const std::string & labels);
+
+      /// @brief Measure the time from starting to decode each message until
+      /// the builder's endMessage() returns.
+      ///
+      /// The tracker is not owned by the decoder and must outlive its use.
+      /// @param latency receives the measurements; zero stops measuring.
+      void setLatencyTracker(LatencyTracker * latency)
+      {
+        latency_ = latency;
+      }
+
+    private:
+      void reportUnknownTemplate();
+      bool decodeOneMessage(
+        DataSource & source,
+        Messages::ValueMessageBuilder & message);
+      bool decodeMeasuredMessage(
+        DataSource & source,
+        Messages::ValueMessageBuilder & message);
+      void countMessage();
+    private:
+      DecodeProfiler * profiler_;
+
+      struct TemplateMetrics
+      {
+        MetricCounter * messages_;
+        MetricCounter * fields_;
+      };
+      typedef std::map<template_id_t, TemplateMetrics> TemplateMetricsMap;
+
+      MetricsRegistry * metrics_;
+      std::string metricsLabels_;
+      MetricCounter * errorsCounted_;
+      MetricCounter * messagesBuilt_;
+      MetricCounter * messagesIgnored_;
+      TemplateMetricsMap templateMetrics_;
+      template_id_t lastTemplateId_;
+      TemplateMetrics * lastTemplateMetrics_;
+      size_t fieldsDecoded_;
+      LatencyTracker * latency_;
     };
   }
 }
@@ -9,6 +9,14 @@
 #include <Codecs/Decoder.h>
 #include <Codecs/Encoder.h>
 
+#if defined(__GNUC__) && defined(__BMI2__) && defined(__x86_64__)
+// With BMI2 available the 7 bit groups of an integer are scattered in one instruction.
+# include <immintrin.h>
+# define QUICKFAST_USE_PDEP
+#elif defined(_MSC_VER) && defined(_M_X64)
+# include <intrin.h>
+#endif
+
 using namespace ::QuickFAST;
 using namespace ::QuickFAST::Codecs;
 
@@ -242,6 +250,22 @@ FieldInstruction::decodeAscii(
   WorkingBuffer & workingBuffer)
 {
   workingBuffer.clear(false);
+  // Usually the whole string is in the current buffer: find the stop bit and copy it in one piece.
+  const uchar * data = 0;
+  size_t available = source.currentBytesAvailable();
+  if(available > 0 && source.hasContiguous(available, data))
+  {
+    for(size_t length = 0; length < available; ++length)
+    {
+      if((data[length] & stopBit) != 0)
+      {
+        workingBuffer.append(data, length);
+        workingBuffer.push(data[length] & dataBits);
+        source.skipContiguous(length + 1);
+        return true;
+      }
+    }
+  }
   uchar byte = 0;
   if(!source.getByte(byte))
   {
@@ -306,11 +330,33 @@ FieldInstruction::decodeByteVector(
     if(!source.getByte(byte))
     {
       decoder.reportFatal("[ERR U03]", "End of file: Too few bytes in ByteVector.", name);
+      return;
     }
     buffer.push(byte);
   }
 }
 
+void
+FieldInstruction::decodeByteVector(
+  Codecs::Context & decoder,
+  Codecs::DataSource & source,
+  const std::string & name,
+  WorkingBuffer & buffer,
+  size_t length,
+  const uchar *& value,
+  size_t & valueSize)
+{
+  if(source.hasContiguous(length, value))
+  {
+    source.skipContiguous(length);
+    valueSize = length;
+    return;
+  }
+  decodeByteVector(decoder, source, name, buffer, length);
+  value = buffer.begin();
+  valueSize = buffer.size();
+}
+
 void
 FieldInstruction::indexDictionaries(
   DictionaryIndexer & indexer,
@@ -362,347 +408,74 @@ FieldInstruction::setDefaultValueTail()
 {
 }
 
-#if 0 // Unrolled version is about 15% faster
 namespace
 {
-  void
-  encodeToWorkingBuffer(WorkingBuffer & buffer, int64 value)
+  /// @brief How many bits are needed to represent value (at least one).
+  inline unsigned int significantBits(uint64 value)
   {
-    buffer.clear(true);
-    int64 until = 0LL;
-    uchar sign = 0;
-    if(value < 0)
-    {
-      until = -1LL;
-      sign = signBit;
-    }
-
-    // force at least one byte to be stored
-    uchar prevByte = ~sign;
-    uchar byte = stopBit;
-    while(value != until || (prevByte & signBit) != sign)
-    {
-      byte |= static_cast<uchar>(value & dataBits);
-      value >>= dataShift;
-      buffer.push(byte);
-      prevByte = byte;
-      byte = 0;
-    }
-  }
-}
-
-void
-FieldInstruction::encodeSignedInteger(DataDestination & destination, WorkingBuffer & buffer, int64 value)
-{
-  encodeToWorkingBuffer(buffer, value);
-  for(const uchar * it = buffer.begin();
-    it != buffer.end();
-    ++it)
-  {
-    destination.putByte(*it);
-  }
-}
-
+    value |= 1;
+#if defined(__GNUC__)
+    return 64u - static_cast<unsigned int>(__builtin_clzll(value));
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long high = 0;
+    _BitScanReverse64(&high, value);
+    return static_cast<unsigned int>(high) + 1u;
 #else
-void
-FieldInstruction::encodeSignedInteger(DataDestination & destination, WorkingBuffer & buffer, int64 value)
-{
-  if (value >= 0)
-  {
-    if (value < 0x0000000000000040LL)
-    {
-      destination.putByte(((value & 0x7F) | 0x80)); // .... .... .... ..7f
-    }
-    else if (value < 0x0000000000002000LL)
-    {
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte(((value & 0x7F) | 0x80)); // .... .... .... ..7f
-    }
-    else if (value < 0x0000000000100000LL)
-    {
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ..1F C...
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte(((value & 0x7F) | 0x80)); // .... .... .... ..7f
-    }
-    else if (value < 0x0000000008000000LL)
-    {
-      destination.putByte(((value >> 21)  & 0x7F)); // .... .... .FE. ....
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ..1F C...
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte(((value & 0x7F) | 0x80)); // .... .... .... ..7f
-    }
-    else if (value < 0x0000000400000000LL)
-    {
-      destination.putByte(((value >> 28)  & 0x7F)); // .... ...7 F... ....
-      destination.putByte(((value >> 21)  & 0x7F)); // .... .... .FE. ....
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ..1F C...
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte(((value & 0x7F) | 0x80)); // .... .... .... ..7f
-    }
-    else if (value < 0x0000020000000000LL)
-    {
-      destination.putByte(((value >> 35)  & 0x7F)); // .... .3F8 .... ....
-      destination.putByte(((value >> 28)  & 0x7F)); // .... ...7 F... ....
-      destination.putByte(((value >> 21)  & 0x7F)); // .... .... .FE. ....
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ..1F C...
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte(((value & 0x7F) | 0x80)); // .... .... .... ..7f
-    }
-    else if (value < 0x0001000000000000LL)
-    {
-      destination.putByte(((value >> 42)  & 0x7F)); // ...1 FC.. .... ....
-      destination.putByte(((value >> 35)  & 0x7F)); // .... .3F8 .... ....
-      destination.putByte(((value >> 28)  & 0x7F)); // .... ...7 F... ....
-      destination.putByte(((value >> 21)  & 0x7F)); // .... .... .FE. ....
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ..1F C...
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte(((value & 0x7F) | 0x80)); // .... .... .... ..7f
-    }
-    else if (value < 0x0080000000000000LL)
-    {
-      destination.putByte(((value >> 49)  & 0x7F)); // ..FE .... .... ....
-      destination.putByte(((value >> 42)  & 0x7F)); // ...1 FC.. .... ....
-      destination.putByte(((value >> 35)  & 0x7F)); // .... .3F8 .... ....
-      destination.putByte(((value >> 28)  & 0x7F)); // .... ...7 F... ....
-      destination.putByte(((value >> 21)  & 0x7F)); // .... .... .FE. ....
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ..1F C...
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte(((value & 0x7F) | 0x80)); // .... .... .... ..7f
-    }
-    else if (value < 0x4000000000000000LL)
-    {
-      destination.putByte(((value >> 56)  & 0x7F)); // 7F.. .... .... ....
-      destination.putByte(((value >> 49)  & 0x7F)); // ..FE .... .... ....
-      destination.putByte(((value >> 42)  & 0x7F)); // ...1 FC.. .... ....
-      destination.putByte(((value >> 35)  & 0x7F)); // .... .3F8 .... ....
-      destination.putByte(((value >> 28)  & 0x7F)); // .... ...7 F... ....
-      destination.putByte(((value >> 21)  & 0x7F)); // .... .... .FE. ....
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ..1F C...
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte(((value & 0x7F) | 0x80)); // .... .... .... ..7f
-    }
-    else
+    unsigned int bits = 1;
+    while((value >>= 1) != 0)
     {
-      destination.putByte(((value >> 63)  & 0x7F)); // 8... .... .... ....  (this will always be zero)
-      destination.putByte(((value >> 56)  & 0x7F)); // 7F.. .... .... ....
-      destination.putByte(((value >> 49)  & 0x7F)); // ..FE .... .... ....
-      destination.putByte(((value >> 42)  & 0x7F)); // ...1 FC.. .... ....
-      destination.putByte(((value >> 35)  & 0x7F)); // .... .3F8 .... ....
-      destination.putByte(((value >> 28)  & 0x7F)); // .... ...7 F... ....
-      destination.putByte(((value >> 21)  & 0x7F)); // .... .... .FE. ....
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ..1F C...
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte(((value & 0x7F) | 0x80)); // .... .... .... ..7f
+      ++bits;
     }
+    return bits;
+#endif
   }
-  else
+
+  /// @brief Write the low order length * 7 bits of value as a stop bit encoded field.
+  ///
+  /// The length has already been calculated so the bytes are built in a single
+  /// pass and appended to the destination in one piece.
+  /// VALUE_TYPE is int64 or uint64; a right shift of an int64 propagates the sign.
+  template<typename VALUE_TYPE>
+  inline void putStopBitEncoded(DataDestination & destination, VALUE_TYPE value, size_t length)
   {
-    // using absolute value avoids tricky word length issues
-    int64 absv = -value;
-//    if(absv == value) // Apparently this is not a valid check on all compilers
-    if((value << 1) == 0)
-    {
-      // encode the most negative possible number
-      destination.putByte(0x7F);    // 8... .... .... ....
-      destination.putByte(0x00);    // 7F.. .... .... ....
-      destination.putByte(0x00);    // . FE .... .... ....
-      destination.putByte(0x00);    // ...1 FC.. .... ....
-      destination.putByte(0x00);    // .... .3F8 .... ....
-      destination.putByte(0x00);    // .... ...7 F... ....
-      destination.putByte(0x00);    // .... .... .FE. ....
-      destination.putByte(0x00);    // .... .... ...1 FC..
-      destination.putByte(0x00);    // .... .... .... 3F8.
-      destination.putByte(0x80);    // .... .... .... ..7f
-    }
-    else if (absv <= 0x0000000000000040LL)
-    {
-      destination.putByte(value & 0xFF); // .... .... .... ..7f
-    }
-    else if (absv <= 0x0000000000002000LL)
-    {
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte((value & 0x7F)  | 0x80);  // .... .... .... ..7f
-    }
-    else if (absv <= 0x0000000000100000LL)
-    {
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ...1 FC..
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte((value & 0x7F)  | 0x80);  // .... .... .... ..7f
-    }
-    else if (absv <= 0x0000000008000000LL)
-    {
-      destination.putByte(((value >> 21)  & 0x7F)); // .... .... .FE. ....
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ...1 FC..
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte((value & 0x7F)  | 0x80);  // .... .... .... ..7f
-    }
-    else if (absv <= 0x0000000400000000LL)
-    {
-      destination.putByte(((value >> 28)  & 0x7F)); // .... ...7 F... ....
-      destination.putByte(((value >> 21)  & 0x7F)); // .... .... .FE. ....
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ...1 FC..
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte((value & 0x7F)  | 0x80);  // .... .... .... ..7f
-    }
-    else if (absv <= 0x0000020000000000LL)
-    {
-      destination.putByte(((value >> 35)  & 0x7F)); // .... .3F8 .... ....
-      destination.putByte(((value >> 28)  & 0x7F)); // .... ...7 F... ....
-      destination.putByte(((value >> 21)  & 0x7F)); // .... .... .FE. ....
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ...1 FC..
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte((value & 0x7F)  | 0x80);  // .... .... .... ..7f
-    }
-    else if (absv <= 0x0001000000000000LL)
+    uchar bytes[10];
+#if defined(QUICKFAST_USE_PDEP)
+    if(length <= 8)
     {
-      destination.putByte(((value >> 42)  & 0x7F));// ...1 FC.. .... ....
-      destination.putByte(((value >> 35)  & 0x7F)); // .... .3F8 .... ....
-      destination.putByte(((value >> 28)  & 0x7F)); // .... ...7 F... ....
-      destination.putByte(((value >> 21)  & 0x7F)); // .... .... .FE. ....
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ...1 FC..
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte((value & 0x7F)  | 0x80);  // .... .... .... ..7f
+      // scatter the 7 bit groups into the low order 7 bits of each byte,
+      // then reverse the bytes so the most significant group comes first.
+      uint64 groups = _pdep_u64(static_cast<uint64>(value), 0x7F7F7F7F7F7F7F7FULL) | stopBit;
+      groups = __builtin_bswap64(groups);
+      std::memcpy(bytes, &groups, sizeof(groups));
+      destination.putBytes(bytes + sizeof(groups) - length, length);
+      return;
     }
-    else if (absv <= 0x0080000000000000LL)
-    {
-      destination.putByte(((value >> 49)  & 0x7F)); // ..FE .... .... ....
-      destination.putByte(((value >> 42)  & 0x7F)); // ...1 FC.. .... ....
-      destination.putByte(((value >> 35)  & 0x7F)); // .... .3F8 .... ....
-      destination.putByte(((value >> 28)  & 0x7F)); // .... ...7 F... ....
-      destination.putByte(((value >> 21)  & 0x7F)); // .... .... .FE. ....
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ...1 FC..
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte((value & 0x7F)  | 0x80);  // .... .... .... ..7f
-    }
-    else
+#endif
+    size_t pos = length - 1;
+    bytes[pos] = static_cast<uchar>((value & dataBits) | stopBit);
+    while(pos > 0)
     {
-      destination.putByte(((value >> 56)  & 0x7F)); // 7F.. .... .... ....
-      destination.putByte(((value >> 49)  & 0x7F)); // ..FE .... .... ....
-      destination.putByte(((value >> 42)  & 0x7F)); // ...1 FC.. .... ....
-      destination.putByte(((value >> 35)  & 0x7F)); // .... .3F8 .... ....
-      destination.putByte(((value >> 28)  & 0x7F)); // .... ...7 F... ....
-      destination.putByte(((value >> 21)  & 0x7F)); // .... .... .FE. ....
-      destination.putByte(((value >> 14)  & 0x7F)); // .... .... ...1 FC..
-      destination.putByte(((value >> 7)   & 0x7F)); // .... .... .... 3F8.
-      destination.putByte((value & 0x7F)  | 0x80);  // .... .... .... ..7f
+      value >>= dataShift;
+      bytes[--pos] = static_cast<uchar>(value & dataBits);
     }
+    destination.putBytes(bytes, length);
   }
 }
-#endif
-#if 0
+
 void
-FieldInstruction::encodeUnsignedInteger(DataDestination & destination, WorkingBuffer & buffer, uint64 value)
+FieldInstruction::encodeSignedInteger(DataDestination & destination, WorkingBuffer & /*buffer*/, int64 value)
 {
-  buffer.clear(true);
-  uint64 until = 0ULL;
-  uchar byte = stopBit;
-  while(value != until || byte != 0)
-  {
-    byte |= static_cast<uchar>(value & dataBits);
-    value >>= dataShift;
-    buffer.push(byte);
-    byte = 0;
-  }
-  for(const uchar * it = buffer.begin();
-    it != buffer.end();
-    ++it)
-  {
-    destination.putByte(*it);
-  }
+  // the bits that differ from the sign, plus the sign bit itself.
+  unsigned int bits = significantBits(static_cast<uint64>(value ^ (value >> 63))) + 1;
+  putStopBitEncoded(destination, value, (bits + dataShift - 1) / dataShift);
 }
 
-
-#else
 void
-FieldInstruction::encodeUnsignedInteger(DataDestination & destination, WorkingBuffer & buffer, uint64 value)
+FieldInstruction::encodeUnsignedInteger(DataDestination & destination, WorkingBuffer & /*buffer*/, uint64 value)
 {
-  if (value <      0x0000000000000080ULL)
-  {
-    destination.putByte(((value & 0x7f) | 0x80));
-  }
-  else if (value < 0x0000000000004000ULL)
-  {
-    destination.putByte(((value >> 7) & 0x7F));
-    destination.putByte(((value & 0x7F) | 0x80));
-  }
-  else if (value < 0x0000000000200000ULL)
-  {
-    destination.putByte(((value >> 14) & 0x7F));
-    destination.putByte(((value >> 7) & 0x7F));
-    destination.putByte(((value & 0x7F) | 0x80));
-  }
-  else if (value < 0x0000000010000000ULL)
-  {
-    destination.putByte(((value >> 21) & 0x7F));
-    destination.putByte(((value >> 14) & 0x7F));
-    destination.putByte(((value >> 7) & 0x7F));
-    destination.putByte(((value & 0x7F) | 0x80));
-  }
-  else if (value < 0x0000000800000000ULL) // 1000 0000 0000 0000 0000 0000 0000 0000 0000
-  {
-    destination.putByte(((value >> 28) & 0x7F));
-    destination.putByte(((value >> 21) & 0x7F));
-    destination.putByte(((value >> 14) & 0x7F));
-    destination.putByte(((value >> 7) & 0x7F));
-    destination.putByte(((value & 0x7F) | 0x80));
-  }
-  else if (value < 0x0000040000000000ULL) // 100 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000
-  {
-    destination.putByte(((value >> 35) & 0x7F));
-    destination.putByte(((value >> 28) & 0x7F));
-    destination.putByte(((value >> 21) & 0x7F));
-    destination.putByte(((value >> 14) & 0x7F));
-    destination.putByte(((value >> 7) & 0x7F));
-    destination.putByte(((value & 0x7F) | 0x80));
-  }
-  else if (value < 0x0002000000000000ULL) //
-  {
-    destination.putByte(((value >> 42) & 0x7F));
-    destination.putByte(((value >> 35) & 0x7F));
-    destination.putByte(((value >> 28) & 0x7F));
-    destination.putByte(((value >> 21) & 0x7F));
-    destination.putByte(((value >> 14) & 0x7F));
-    destination.putByte(((value >> 7) & 0x7F));
-    destination.putByte(((value & 0x7F) | 0x80));
-  }
-  else if (value < 0x0100000000000000ULL) // 1 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000
-  {
-    destination.putByte(((value >> 49) & 0x7F));
-    destination.putByte(((value >> 42) & 0x7F));
-    destination.putByte(((value >> 35) & 0x7F));
-    destination.putByte(((value >> 28) & 0x7F));
-    destination.putByte(((value >> 21) & 0x7F));
-    destination.putByte(((value >> 14) & 0x7F));
-    destination.putByte(((value >> 7) & 0x7F));
-    destination.putByte(((value & 0x7F) | 0x80));
-  }
-  else if (value < 0x8000000000000000ULL) //
- {
-    destination.putByte(((value >> 56) & 0x7F));
-    destination.putByte(((value >> 49) & 0x7F));
-    destination.putByte(((value >> 42) & 0x7F));
-    destination.putByte(((value >> 35) & 0x7F));
-    destination.putByte(((value >> 28) & 0x7F));
-    destination.putByte(((value >> 21) & 0x7F));
-    destination.putByte(((value >> 14) & 0x7F));
-    destination.putByte(((value >> 7) & 0x7F));
-    destination.putByte(((value & 0x7F) | 0x80));
-  }
-  else
-  {
-    destination.putByte(((value >> 63) & 0x7F));
-    destination.putByte(((value >> 56) & 0x7F));
-    destination.putByte(((value >> 49) & 0x7F));
-    destination.putByte(((value >> 42) & 0x7F));
-    destination.putByte(((value >> 35) & 0x7F));
-    destination.putByte(((value >> 28) & 0x7F));
-    destination.putByte(((value >> 21) & 0x7F));
-    destination.putByte(((value >> 14) & 0x7F));
-    destination.putByte(((value >> 7) & 0x7F));
-    destination.putByte(((value & 0x7F) | 0x80));
-  }
+  unsigned int bits = significantBits(value);
+  putStopBitEncoded(destination, value, (bits + dataShift - 1) / dataShift);
 }
-#endif
 
 void
 FieldInstruction::encodeNullableAscii(DataDestination & destination, const StringBuffer & value)
@@ -727,11 +500,9 @@ FieldInstruction::encodeAscii(DataDestination & destination, const StringBuffer
     {
       destination.putByte(leadingZeroBytePreamble);
     }
-    for(size_t pos = 0; pos + 1 < value.size(); ++pos)
-    {
-      destination.putByte(static_cast<uchar>(value[pos]));
-    }
-    destination.putByte(value[value.size() - 1] | stopBit);
+    size_t last = value.size() - 1;
+    destination.putBytes(value.data(), last);
+    destination.putByte(value[last] | stopBit);
   }
 }
 
@@ -739,10 +510,7 @@ FieldInstruction::encodeAscii(DataDestination & destination, const StringBuffer
 void
 FieldInstruction::encodeBlobData(DataDestination & destination, const StringBuffer & value)
 {
-  for(size_t pos = 0; pos < value.size(); ++pos)
-  {
-    destination.putByte(static_cast<uchar>(value[pos]));
-  }
+  destination.putBytes(value.data(), value.size());
 }
 
 size_t
@@ -480,15 +480,20 @@ namespace QuickFAST{
       /// @brief Encode signed integer
       ///
       /// Works with all signed integer types.  Variable byte length encoding
-      /// assures the most compact result.
+      /// assures the most compact result.  The length is calculated first, then
+      /// the bytes are appended to the destination in one piece.
+      /// @param destination receives encoded results
+      /// @param buffer is not used.
+      /// @param value is the data to be encoded
       static void encodeSignedInteger(DataDestination & destination, WorkingBuffer & buffer, int64 value);
 
-      /// @brief Encode signed integer
+      /// @brief Encode unsigned integer
       ///
-      /// Works with all signed integer types.  Variable byte length encoding
-      /// assures the most compact result.
+      /// Works with all unsigned integer types.  Variable byte length encoding
+      /// assures the most compact result.  The length is calculated first, then
+      /// the bytes are appended to the destination in one piece.
       /// @param destination receives encoded results
-      /// @param buffer provides working space
+      /// @param buffer is not used.
       /// @param value is the data to be encoded
       static void encodeUnsignedInteger(DataDestination & destination, WorkingBuffer & buffer, uint64 value);
 
@@ -597,6 +602,29 @@ namespace QuickFAST{
         WorkingBuffer & buffer,
         size_t length);
 
+      /// @brief Decode a ByteVector or Utf8 string without copying it if possible.
+      ///
+      /// If the entire value is contiguous in the source's current buffer, value
+      /// points into that buffer and no copy is made.  Such a value is valid only until
+      /// more data is read from the source, so it must be copied to be retained.
+      /// Otherwise the value is copied into buffer as decodeByteVector() does.
+      /// @param[in] decoder for which this decoding is being done
+      /// @param[in] source supplies the data
+      /// @param[in] name of this field to be used in error messages
+      /// @param[out] buffer receives the result if it must be copied
+      /// @param[in] length expected
+      /// @param[out] value points to the result
+      /// @param[out] valueSize is the length of the result (less than length only after an error)
+      /// @throws EncodingError if not enough data is available
+      static void decodeByteVector(
+        Codecs::Context & decoder,
+        Codecs::DataSource & source,
+        const std::string & name,
+        WorkingBuffer & buffer,
+        size_t length,
+        const uchar *& value,
+        size_t & valueSize);
+
       /// @brief do final processing of this field instruction after parsing entire template set.
       virtual void finalize(Codecs::TemplateRegistry & registry);
 
@@ -672,6 +700,8 @@ namespace QuickFAST{
       if(!source.getByte(byte))
       {
         context.reportFatal("[ERR U03]", "Unexpected end of data decoding signedinteger", name);
+        value = 0;
+        return;
       }
 
       value = 0;
@@ -703,6 +733,7 @@ namespace QuickFAST{
         if(!source.getByte(byte))
         {
           context.reportFatal("[ERR D2]", "Unexpected EOF in signed integer field.", name);
+          return;
         }
       }
       // include the last byte (the one with the stop bit)
@@ -1015,6 +1046,8 @@ namespace QuickFAST{
       if(!source.getByte(byte))
       {
         context.reportFatal("[ERR U03]", "Unexpected end of data decoding unsigned integer", name);
+        value = 0;
+        return;
       }
 
       value = 0;
@@ -1037,6 +1070,7 @@ namespace QuickFAST{
         if(!source.getByte(byte))
         {
           context.reportFatal("[ERR U03]", "End of file without stop bit decoding unsigned integer.", name);
+          return;
         }
       }
       if(!ignoreOverflow && (value & overflowMask) != overflowCheck)
@@ -36,11 +36,16 @@ FieldInstructionAscii::~FieldInstructionAscii()
 bool
 FieldInstructionAscii::decodeAsciiFromSource(
   Codecs::DataSource & source,
+  Codecs::Context & context,
   bool mandatory,
   WorkingBuffer & buffer) const
 {
   PROFILE_POINT("ascii::decodeAsciiFromSource");
-  decodeAscii(source, buffer);
+  if(!decodeAscii(source, buffer))
+  {
+    context.reportFatal("[ERR U03]", "Unexpected end of data decoding ASCII string.", identity_);
+    return false;
+  }
   if(!mandatory)
   {
     if(checkNullAscii(buffer))
@@ -66,7 +71,7 @@ FieldInstructionAscii::decodeNop(
   // note NOP never uses pmap.  It uses a null value instead for optional fields
   // so it's always safe to do the basic decode.
   WorkingBuffer & buffer = decoder.getWorkingBuffer();
-  if(decodeAsciiFromSource(source, isMandatory(), buffer))
+  if(decodeAsciiFromSource(source, decoder, isMandatory(), buffer))
   {
     builder.addValue(identity_, ValueType::ASCII, buffer.begin(), buffer.size());
   }
@@ -116,7 +121,7 @@ FieldInstructionAscii::decodeDefault(
   if(pmap.checkNextField())
   {
     WorkingBuffer & buffer = decoder.getWorkingBuffer();
-    if(decodeAsciiFromSource(source, isMandatory(), buffer))
+    if(decodeAsciiFromSource(source, decoder, isMandatory(), buffer))
     {
       builder.addValue(
         identity_,
@@ -155,7 +160,7 @@ FieldInstructionAscii::decodeCopy(
   {
     // field is in the stream, use it
     WorkingBuffer & buffer = decoder.getWorkingBuffer();
-    if(decodeAsciiFromSource(source, isMandatory(), buffer))
+    if(decodeAsciiFromSource(source, decoder, isMandatory(), buffer))
     {
       builder.addValue(
         identity_,
@@ -217,27 +222,20 @@ FieldInstructionAscii::decodeDelta(
       return;
     }
   }
-  std::string deltaValue;
+  const uchar * deltaValue = 0;
+  size_t deltaSize = 0;
   WorkingBuffer & buffer = decoder.getWorkingBuffer();
-  if(decodeAsciiFromSource(source, true, buffer))
+  if(decodeAsciiFromSource(source, decoder, true, buffer))
   {
-    deltaValue = std::string(
-      reinterpret_cast<const char *>(buffer.begin()),
-      buffer.size());
+    deltaValue = buffer.begin();
+    deltaSize = buffer.size();
   }
 
-
-  std::string previousValue;
-  Context::DictionaryStatus previousStatus = fieldOp_->getDictionaryValue(decoder, previousValue);
-  if(previousStatus == Context::UNDEFINED_VALUE)
-  {
-    if(fieldOp_->hasValue())
-    {
-      previousValue = fieldOp_->getValue();
-    }
-  }
-
-  size_t previousLength = previousValue.length();
+  // the delta is applied to the dictionary entry in place.
+  Value & entry = fieldOp_->getDictionaryStringForUpdate(decoder);
+  const uchar * previousValue = 0;
+  size_t previousLength = 0;
+  (void)entry.getValue(previousValue, previousLength);
   if( deltaLength < 0)
   {
     // operate on front of string
@@ -249,13 +247,7 @@ FieldInstructionAscii::decodeDelta(
       decoder.reportError("[ERR D7]", "ASCII tail delta front length exceeds length of previous string.", identity_);
       deltaLength = QuickFAST::int32(previousLength);
     }
-    std::string value = deltaValue + previousValue.substr(deltaLength);
-    builder.addValue(
-      identity_,
-      ValueType::ASCII,
-      reinterpret_cast<const uchar *>(value.c_str()),
-      value.size());
-    fieldOp_->setDictionaryValue(decoder, value);
+    entry.replaceStringFront(deltaLength, deltaValue, deltaSize);
   }
   else
   { // operate on end of string
@@ -268,14 +260,16 @@ FieldInstructionAscii::decodeDelta(
       decoder.reportError("[ERR D7]", "ASCII tail delta back length exceeds length of previous string.", identity_);
       deltaLength = QuickFAST::uint32(previousLength);
     }
-    std::string value = previousValue.substr(0, previousLength - deltaLength) + deltaValue;
-    builder.addValue(
-      identity_,
-      ValueType::ASCII,
-      reinterpret_cast<const uchar *>(value.c_str()),
-      value.size());
-    fieldOp_->setDictionaryValue(decoder, value);
+    entry.replaceStringBack(deltaLength, deltaValue, deltaSize);
   }
+  const uchar * value = 0;
+  size_t valueSize = 0;
+  (void)entry.getValue(value, valueSize);
+  builder.addValue(
+    identity_,
+    ValueType::ASCII,
+    value,
+    valueSize);
 }
 
 void
@@ -290,32 +284,28 @@ FieldInstructionAscii::decodeTail(
   {
     // field is in the stream, use it
     WorkingBuffer & buffer = decoder.getWorkingBuffer();
-    if(decodeAsciiFromSource(source, isMandatory(), buffer))
-    {
-      const std::string tailValue(reinterpret_cast<const char *>(buffer.begin()), buffer.size());
-      size_t tailLength = tailValue.length();
-      std::string previousValue;
-      Context::DictionaryStatus previousStatus = fieldOp_->getDictionaryValue(decoder, previousValue);
-      if(previousStatus == Context::UNDEFINED_VALUE)
-      {
-        if(fieldOp_->hasValue())
-        {
-          previousValue = fieldOp_->getValue();
-          fieldOp_->setDictionaryValue(decoder, previousValue);
-        }
-      }
-      size_t previousLength = previousValue.length();
-      if(tailLength > previousLength)
+    if(decodeAsciiFromSource(source, decoder, isMandatory(), buffer))
+    {
+      // the tail is applied to the dictionary entry in place.
+      Value & entry = fieldOp_->getDictionaryStringForUpdate(decoder);
+      const uchar * previousValue = 0;
+      size_t previousLength = 0;
+      (void)entry.getValue(previousValue, previousLength);
+      size_t tailLength = buffer.size();
+      size_t replacedLength = tailLength;
+      if(replacedLength > previousLength)
       {
-        tailLength = previousLength;
+        replacedLength = previousLength;
       }
-      std::string value(previousValue.substr(0, previousLength - tailLength) + tailValue);
+      entry.replaceStringBack(replacedLength, buffer.begin(), tailLength);
+      const uchar * value = 0;
+      size_t valueSize = 0;
+      (void)entry.getValue(value, valueSize);
       builder.addValue(
         identity_,
         ValueType::ASCII,
-        reinterpret_cast<const uchar *>(value.c_str()),
-        value.size());
-      fieldOp_->setDictionaryValue(decoder, value);
+        value,
+        valueSize);
     }
     else // null
     {
@@ -324,15 +314,15 @@ FieldInstructionAscii::decodeTail(
   }
   else // pmap says not in stream
   {
-    std::string previousValue;
-    Context::DictionaryStatus previousStatus = fieldOp_->getDictionaryValue(decoder, previousValue);
+    const uchar * previousValue = 0;
+    size_t previousLength = 0;
+    Context::DictionaryStatus previousStatus = fieldOp_->getDictionaryValue(decoder, previousValue, previousLength);
     if(previousStatus == Context::OK_VALUE)
     {
-      Messages::FieldCPtr field = Messages::FieldAscii::create(previousValue);
       builder.addValue(identity_,
         ValueType::ASCII,
-        reinterpret_cast<const uchar *>(previousValue.c_str()),
-        previousValue.size());
+        previousValue,
+        previousLength);
     }
     else if(fieldOp_->hasValue())
     {
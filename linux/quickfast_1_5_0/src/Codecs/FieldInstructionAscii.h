@@ -104,6 +104,7 @@ namespace QuickFAST{
     private:
       /// @brief helper decoder.
       /// @param source where the data comes from
+      /// @param context receives error reports
       /// @param mandatory true if field is presence="mandatory"
       /// @param buffer a playground
       /// @param[out] pointer to the decoded field.  Null if the field
@@ -112,6 +113,7 @@ namespace QuickFAST{
 
      virtual bool decodeAsciiFromSource(
         Codecs::DataSource & source,
+        Codecs::Context & context,
         bool mandatory,
         WorkingBuffer & buffer) const;
 
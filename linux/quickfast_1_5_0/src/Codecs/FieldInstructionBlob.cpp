@@ -35,7 +35,9 @@ FieldInstructionBlob::decodeBlobFromSource(
   Codecs::DataSource & source,
   Codecs::Context & context,
   bool mandatory,
-  WorkingBuffer & buffer) const
+  WorkingBuffer & buffer,
+  const uchar *& value,
+  size_t & valueSize) const
 {
   PROFILE_POINT("blob::decodeBlobFromSource");
   uint32 length;
@@ -48,7 +50,7 @@ FieldInstructionBlob::decodeBlobFromSource(
       return false;
     }
   }
-  decodeByteVector(context, source, identity_.name(), buffer, length);
+  decodeByteVector(context, source, identity_.name(), buffer, length, value, valueSize);
   return true;
 }
 
@@ -63,10 +65,10 @@ FieldInstructionBlob::decodeNop(
   // note NOP never uses pmap.  It uses a null value instead for optional fields
   // so it's always safe to do the basic decode.
   WorkingBuffer& buffer = decoder.getWorkingBuffer();
-  if(decodeBlobFromSource(source, decoder, isMandatory(), buffer))
+  const uchar * value = 0;
+  size_t valueSize = 0;
+  if(decodeBlobFromSource(source, decoder, isMandatory(), buffer, value, valueSize))
   {
-    const uchar * value = buffer.begin();
-    size_t valueSize = buffer.size();
     builder.addValue(identity_, type_, value, valueSize);
   }
 }
@@ -115,10 +117,10 @@ FieldInstructionBlob::decodeDefault(
   if(pmap.checkNextField())
   {
     WorkingBuffer& buffer = decoder.getWorkingBuffer();
-    if(decodeBlobFromSource(source, decoder, isMandatory(), buffer))
+    const uchar * value = 0;
+    size_t valueSize = 0;
+    if(decodeBlobFromSource(source, decoder, isMandatory(), buffer, value, valueSize))
     {
-      const uchar * value = buffer.begin();
-      size_t valueSize = buffer.size();
       builder.addValue(
         identity_,
         type_,
@@ -155,11 +157,11 @@ FieldInstructionBlob::decodeCopy(
   if(pmap.checkNextField())
   {
     // field is in the stream, use it
-  WorkingBuffer& buffer = decoder.getWorkingBuffer();
-  if(decodeBlobFromSource(source, decoder, isMandatory(), buffer))
-  {
-    const uchar * value = buffer.begin();
-    size_t valueSize = buffer.size();
+    WorkingBuffer& buffer = decoder.getWorkingBuffer();
+    const uchar * value = 0;
+    size_t valueSize = 0;
+    if(decodeBlobFromSource(source, decoder, isMandatory(), buffer, value, valueSize))
+    {
       builder.addValue(
         identity_,
         type_,
@@ -219,27 +221,20 @@ FieldInstructionBlob::decodeDelta(
       return;
     }
   }
-
-  std::string deltaValue;
+  const uchar * deltaValue = 0;
+  size_t deltaSize = 0;
   WorkingBuffer& buffer = decoder.getWorkingBuffer();
-  if(decodeBlobFromSource(source, decoder, true /*isMandatory()*/, buffer))
+  if(!decodeBlobFromSource(source, decoder, true /*isMandatory()*/, buffer, deltaValue, deltaSize))
   {
-    const uchar * value = buffer.begin();
-    size_t valueSize = buffer.size();
-    deltaValue = std::string(reinterpret_cast<const char *>(value), valueSize);
+    deltaValue = 0;
+    deltaSize = 0;
   }
 
-  std::string previousValue;
-  Context::DictionaryStatus previousStatus = fieldOp_->getDictionaryValue(decoder, previousValue);
-  if(previousStatus == Context::UNDEFINED_VALUE)
-  {
-    if(fieldOp_->hasValue())
-    {
-      previousValue = fieldOp_->getValue();
-    }
-  }
-  size_t previousLength = previousValue.size();
-
+  // the delta is applied to the dictionary entry in place.
+  Value & entry = fieldOp_->getDictionaryStringForUpdate(decoder);
+  const uchar * previousValue = 0;
+  size_t previousLength = 0;
+  (void)entry.getValue(previousValue, previousLength);
   if( deltaLength < 0)
   {
     // operate on front of string
@@ -251,13 +246,7 @@ FieldInstructionBlob::decodeDelta(
       decoder.reportError("[ERR D7]", "String tail delta front length exceeds length of previous string.", identity_);
       deltaLength = QuickFAST::int32(previousLength);
     }
-    std::string value = deltaValue + previousValue.substr(deltaLength);
-    builder.addValue(
-      identity_,
-      type_,
-      reinterpret_cast<const uchar *>(value.c_str()),
-      value.size());
-    fieldOp_->setDictionaryValue(decoder, value);
+    entry.replaceStringFront(deltaLength, deltaValue, deltaSize);
   }
   else
   { // operate on end of string
@@ -270,15 +259,16 @@ FieldInstructionBlob::decodeDelta(
       decoder.reportError("[ERR D7]", "String tail delta back length exceeds length of previous string.", identity_);
       deltaLength = QuickFAST::uint32(previousLength);
     }
-
-    std::string value = previousValue.substr(0, previousLength - deltaLength) + deltaValue;
-    builder.addValue(
-      identity_,
-      type_,
-      reinterpret_cast<const uchar *>(value.c_str()),
-      value.size());
-    fieldOp_->setDictionaryValue(decoder, value);
+    entry.replaceStringBack(deltaLength, deltaValue, deltaSize);
   }
+  const uchar * value = 0;
+  size_t valueSize = 0;
+  (void)entry.getValue(value, valueSize);
+  builder.addValue(
+    identity_,
+    type_,
+    value,
+    valueSize);
 }
 
 void
@@ -293,33 +283,29 @@ FieldInstructionBlob::decodeTail(
   {
     // field is in the stream, use it
     WorkingBuffer& buffer = decoder.getWorkingBuffer();
-    if(decodeBlobFromSource(source, decoder, isMandatory(), buffer))
-    {
-      size_t tailLength = buffer.size();
-      std::string tailValue(reinterpret_cast<const char *>(buffer.begin()), tailLength);
-
-      std::string previousValue;
-      Context::DictionaryStatus previousStatus = fieldOp_->getDictionaryValue(decoder, previousValue);
-      if(previousStatus == Context::UNDEFINED_VALUE)
-      {
-        if(fieldOp_->hasValue())
-        {
-          previousValue = fieldOp_->getValue();
-          fieldOp_->setDictionaryValue(decoder, previousValue);
-        }
-      }
-      size_t previousLength = previousValue.length();
-      if(tailLength > previousLength)
+    const uchar * tail = 0;
+    size_t tailLength = 0;
+    if(decodeBlobFromSource(source, decoder, isMandatory(), buffer, tail, tailLength))
+    {
+      // the tail is applied to the dictionary entry in place.
+      Value & entry = fieldOp_->getDictionaryStringForUpdate(decoder);
+      const uchar * previousValue = 0;
+      size_t previousLength = 0;
+      (void)entry.getValue(previousValue, previousLength);
+      size_t replacedLength = tailLength;
+      if(replacedLength > previousLength)
       {
-        tailLength = previousLength;
+        replacedLength = previousLength;
       }
-      std::string value(previousValue.substr(0, previousLength - tailLength) + tailValue);
+      entry.replaceStringBack(replacedLength, tail, tailLength);
+      const uchar * value = 0;
+      size_t valueSize = 0;
+      (void)entry.getValue(value, valueSize);
       builder.addValue(
         identity_,
         type_,
-        reinterpret_cast<const uchar *>(value.c_str()),
-        value.size());
-      fieldOp_->setDictionaryValue(decoder, value);
+        value,
+        valueSize);
     }
     else // null
     {
@@ -328,16 +314,15 @@ FieldInstructionBlob::decodeTail(
   }
   else // pmap says not in stream
   {
-    std::string previousValue;
-    Context::DictionaryStatus previousStatus = fieldOp_->getDictionaryValue(decoder, previousValue);
+    const uchar * previousValue = 0;
+    size_t previousLength = 0;
+    Context::DictionaryStatus previousStatus = fieldOp_->getDictionaryValue(decoder, previousValue, previousLength);
     if(previousStatus == Context::OK_VALUE)
     {
-
-      builder.addValue(
-        identity_,
+      builder.addValue(identity_,
         type_,
-        reinterpret_cast<const uchar *>(previousValue.c_str()),
-        previousValue.size());
+        previousValue,
+        previousLength);
     }
     else if(fieldOp_->hasValue())
     {
@@ -127,12 +127,25 @@ namespace QuickFAST{
       void interpretValue(const std::string & value);
 
       /// @brief helper routine to decode the blob data
+      ///
+      /// When the data is contiguous in the source, value points directly into the
+      /// source's buffer and is valid only until more data is read from the source.
+      /// Otherwise the data is copied into buffer and value points there.
+      /// @param source supplies the data
+      /// @param context in which decoding is done
+      /// @param mandatory is false if the field is nullable
+      /// @param buffer receives the data if it must be copied.
+      /// @param[out] value points to the data
+      /// @param[out] valueSize is the length of the data
+      /// @returns false if the field is null
       bool
       decodeBlobFromSource(
         Codecs::DataSource & source,
         Codecs::Context & context,
         bool mandatory,
-        WorkingBuffer & buffer) const;
+        WorkingBuffer & buffer,
+        const uchar *& value,
+        size_t & valueSize) const;
 
       /// @brief helper routine to encode a nullable, but not null value
       void encodeNullableBlob(
@@ -232,6 +232,10 @@ namespace QuickFAST{
       {
         decodeUnsignedInteger(source, decoder, value, identity_.name(), ignoreOverflow_);
       }
+      if(decoder.hasError())
+      {
+        return;
+      }
       if(isMandatory())
       {
         builder.addValue(
@@ -309,6 +313,10 @@ namespace QuickFAST{
         {
           decodeUnsignedInteger(source, decoder, value, identity_.name(), ignoreOverflow_);
         }
+        if(decoder.hasError())
+        {
+          return;
+        }
 
         if(isMandatory())
         {
@@ -417,6 +425,10 @@ namespace QuickFAST{
         {
           decodeUnsignedInteger(source, decoder, value, identity_.name(), ignoreOverflow_);
         }
+        if(decoder.hasError())
+        {
+          return;
+        }
         if(isMandatory())
         {
           builder.addValue(
@@ -466,6 +478,10 @@ namespace QuickFAST{
       PROFILE_POINT("int::decodeDelta");
       int64 delta;
       decodeSignedInteger(source, decoder, delta, identity_.name(), true);
+      if(decoder.hasError())
+      {
+        return;
+      }
       if(!isMandatory())
       {
         if(checkNullInteger(delta))
@@ -527,6 +543,10 @@ namespace QuickFAST{
         {
           decodeUnsignedInteger(source, decoder, value, identity_.name(), ignoreOverflow_);
         }
+        if(decoder.hasError())
+        {
+          return;
+        }
         if(isMandatory())
         {
           builder.addValue(
@@ -12,6 +12,7 @@
 #include <Messages/FieldUInt32.h>
 #include <Messages/SingleValueBuilder.h>
 #include <Messages/SpecialAccessors.h>
+#include <Common/Probes.h>
 
 using namespace QuickFAST;
 using namespace QuickFAST::Codecs;
@@ -62,6 +63,7 @@ FieldInstructionSequence::decodeNop(
   if(!segment_)
   {
     decoder.reportFatal("[ERR U07]", "SegmentBody not defined for Sequence instruction.");
+    return;
   }
   size_t length = 0;
   Codecs::FieldInstructionCPtr lengthInstruction;
@@ -77,6 +79,10 @@ FieldInstructionSequence::decodeNop(
     defaultLengthInstruction.setPresence(isMandatory());
     defaultLengthInstruction.decode(source, pmap, decoder, lengthSet);
   }
+  if(decoder.hasError())
+  {
+    return;
+  }
   if(lengthSet.isSet())
   {
     length = lengthSet.value();
@@ -91,6 +97,7 @@ FieldInstructionSequence::decodeNop(
 
     for(size_t nEntry = 0; nEntry < length; ++nEntry)
     {
+      QUICKFAST_PROBE2(sequence_entry, nEntry, length);
       if(decoder.getLogOut())
       {
         std::stringstream msg;
@@ -105,6 +112,11 @@ FieldInstructionSequence::decodeNop(
           segment_->fieldCount()));
       decoder.decodeGroup(source, segment_, entrySet);
       sequenceBuilder.endSequenceEntry(entrySet);
+      if(decoder.hasError())
+      {
+        // keep the builder balanced; the message will be ignored.
+        break;
+      }
     }
     builder.endSequence(identity_, sequenceBuilder);
   }
@@ -68,6 +68,7 @@ FieldInstructionStaticTemplateRef::decodeNop(
   if(!decoder.findTemplate(templateName_, templateNamespace_, target))
   {
     decoder.reportFatal("[ERR D9]", "Unknown template name for static templateref.", identity_);
+    return;
   }
 
   if(messageBuilder.getApplicationType() != target->getApplicationType())
@@ -291,6 +291,30 @@ namespace QuickFAST{
         return context.getDictionaryValue(dictionaryIndex_, value, length);
       }
 
+      /// @brief find the dictionary string to which a delta or tail will be applied in place
+      ///
+      /// An entry that does not hold a string is first set to this operator's
+      /// value if the entry is undefined and a value was provided, otherwise
+      /// to an empty string.
+      /// @param context holds the dictionary
+      /// @returns the dictionary entry, which isString()
+      Value & getDictionaryStringForUpdate(Context & context)
+      {
+        Value & entry = context.getDictionaryEntryForUpdate(dictionaryIndex_);
+        if(!entry.isString())
+        {
+          if(!entry.isDefined() && valueIsDefined_)
+          {
+            entry.setValue(value_);
+          }
+          else
+          {
+            entry.setValue(reinterpret_cast<const unsigned char *>(""), 0);
+          }
+        }
+        return entry;
+      }
+
       /// @brief Return the FieldOp type of this field
       virtual OpType opType()const = 0;
 
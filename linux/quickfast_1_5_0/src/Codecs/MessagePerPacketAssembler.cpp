@@ -34,22 +34,8 @@ MessagePerPacketAssembler::serviceQueue(Communication::Receiver & receiver)
   Communication::LinkedBuffer * buffer = receiver.getBuffer(false);
   while(result && buffer != 0)
   {
-    try
-    {
-      result = decodeBuffer(buffer->get(), buffer->used());
-    }
-    catch(const std::exception &ex)
-    {
-      receiver.releaseBuffer(buffer);
-      buffer = 0;
-      result = reportDecodingError(ex.what());
-      reset();
-    }
-    if(buffer != 0)
-    {
-      receiver.releaseBuffer(buffer);
-      buffer = 0;
-    }
+    result = serviceBuffer(receiver, buffer);
+    buffer = 0;
     if(result)
     {
       buffer = receiver.getBuffer(false);
@@ -58,3 +44,31 @@ MessagePerPacketAssembler::serviceQueue(Communication::Receiver & receiver)
   return result;
 }
 
+bool
+MessagePerPacketAssembler::supportsInlineService() const
+{
+  return true;
+}
+
+bool
+MessagePerPacketAssembler::serviceBuffer(Communication::Receiver & receiver, Communication::LinkedBuffer * buffer)
+{
+  bool result = true;
+  try
+  {
+    result = decodeBuffer(buffer->get(), buffer->used());
+  }
+  catch(const std::exception &ex)
+  {
+    receiver.releaseBuffer(buffer);
+    buffer = 0;
+    result = reportDecodingError(ex.what());
+    reset();
+  }
+  if(buffer != 0)
+  {
+    receiver.releaseBuffer(buffer);
+  }
+  return result;
+}
+
@@ -38,6 +38,8 @@ namespace QuickFAST
       ///////////////////////////////////////
       // Implement Remaining Assembler method
       virtual bool serviceQueue(Communication::Receiver & receiver);
+      virtual bool supportsInlineService() const;
+      virtual bool serviceBuffer(Communication::Receiver & receiver, Communication::LinkedBuffer * buffer);
 
     private:
       MessagePerPacketAssembler & operator = (const MessagePerPacketAssembler &);
@@ -0,0 +1,968 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "OperatorOptimizer.h"
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Template.h>
+#include <Codecs/PresenceMap.h>
+#include <Codecs/FieldInstructionInt8.h>
+#include <Codecs/FieldInstructionUInt8.h>
+#include <Codecs/FieldInstructionInt16.h>
+#include <Codecs/FieldInstructionUInt16.h>
+#include <Codecs/FieldInstructionInt32.h>
+#include <Codecs/FieldInstructionUInt32.h>
+#include <Codecs/FieldInstructionInt64.h>
+#include <Codecs/FieldInstructionUInt64.h>
+#include <Codecs/FieldInstructionDecimal.h>
+#include <Codecs/FieldInstructionAscii.h>
+#include <Codecs/FieldInstructionUtf8.h>
+#include <Codecs/FieldInstructionByteVector.h>
+#include <Codecs/FieldInstructionTemplateRef.h>
+#include <Codecs/FieldOpNop.h>
+#include <Codecs/FieldOpCopy.h>
+#include <Codecs/FieldOpDelta.h>
+#include <Codecs/FieldOpIncrement.h>
+#include <Codecs/FieldOpTail.h>
+#include <Messages/SpecialAccessors.h>
+#include <Messages/FieldUInt32.h>
+#include <Common/Exceptions.h>
+
+#include <xercesc/framework/MemBufInputSource.hpp>
+#include <xercesc/framework/MemBufFormatTarget.hpp>
+#include <xercesc/util/PlatformUtils.hpp>
+#include <xercesc/parsers/XercesDOMParser.hpp>
+#include <xercesc/dom/DOM.hpp>
+
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Codecs;
+XERCES_CPP_NAMESPACE_USE
+
+namespace
+{
+  // More distinct values than this and a field is not a candidate for constant.
+  const size_t maxTallies = 1024;
+
+  FieldInstructionPtr createInstruction(ValueType::Type type, const std::string & name, const std::string & fieldNamespace)
+  {
+    FieldInstructionPtr result;
+    switch(type)
+    {
+    case ValueType::INT8:
+      result.reset(new FieldInstructionInt8(name, fieldNamespace));
+      break;
+    case ValueType::UINT8:
+      result.reset(new FieldInstructionUInt8(name, fieldNamespace));
+      break;
+    case ValueType::INT16:
+      result.reset(new FieldInstructionInt16(name, fieldNamespace));
+      break;
+    case ValueType::UINT16:
+      result.reset(new FieldInstructionUInt16(name, fieldNamespace));
+      break;
+    case ValueType::INT32:
+      result.reset(new FieldInstructionInt32(name, fieldNamespace));
+      break;
+    case ValueType::UINT32:
+      result.reset(new FieldInstructionUInt32(name, fieldNamespace));
+      break;
+    case ValueType::INT64:
+      result.reset(new FieldInstructionInt64(name, fieldNamespace));
+      break;
+    case ValueType::UINT64:
+      result.reset(new FieldInstructionUInt64(name, fieldNamespace));
+      break;
+    case ValueType::DECIMAL:
+      result.reset(new FieldInstructionDecimal(name, fieldNamespace));
+      break;
+    case ValueType::ASCII:
+      result.reset(new FieldInstructionAscii(name, fieldNamespace));
+      break;
+    case ValueType::UTF8:
+      result.reset(new FieldInstructionUtf8(name, fieldNamespace));
+      break;
+    case ValueType::BYTEVECTOR:
+      result.reset(new FieldInstructionByteVector(name, fieldNamespace));
+      break;
+    default:
+      break;
+    }
+    return result;
+  }
+
+  FieldOpPtr createOp(FieldOp::OpType op)
+  {
+    FieldOpPtr result;
+    switch(op)
+    {
+    case FieldOp::COPY:
+      result.reset(new FieldOpCopy);
+      break;
+    case FieldOp::DELTA:
+      result.reset(new FieldOpDelta);
+      break;
+    case FieldOp::INCREMENT:
+      result.reset(new FieldOpIncrement);
+      break;
+    case FieldOp::TAIL:
+      result.reset(new FieldOpTail);
+      break;
+    default:
+      result.reset(new FieldOpNop);
+      break;
+    }
+    return result;
+  }
+
+  // DataDestination::size() counts buffers, not bytes.
+  size_t byteCount(const DataDestination & destination)
+  {
+    size_t bytes = 0;
+    for(size_t nBuffer = 0; nBuffer < destination.size(); ++nBuffer)
+    {
+      bytes += destination[nBuffer].size();
+    }
+    return bytes;
+  }
+
+  // A decimal written the way Decimal::parse reads it.
+  std::string decimalString(const Decimal & value)
+  {
+    std::string digits = boost::lexical_cast<std::string>(value.getMantissa());
+    bool negative = !digits.empty() && digits[0] == '-';
+    if(negative)
+    {
+      digits = digits.substr(1);
+    }
+    int exponent = value.getExponent();
+    if(exponent >= 0)
+    {
+      digits.append(size_t(exponent), '0');
+    }
+    else
+    {
+      size_t places = size_t(-exponent);
+      if(digits.size() <= places)
+      {
+        digits.insert(0, places + 1 - digits.size(), '0');
+      }
+      digits.insert(digits.size() - places, 1, '.');
+    }
+    return negative ? '-' + digits : digits;
+  }
+
+  /// Xerces must be initialized while it is in use.
+  class XMLPlatform
+  {
+  public:
+    XMLPlatform()
+    {
+      XMLPlatformUtils::Initialize();
+    }
+    ~XMLPlatform()
+    {
+      XMLPlatformUtils::Terminate();
+    }
+  };
+
+  /// A narrow string converted for Xerces.
+  class XMLText
+  {
+  public:
+    explicit XMLText(const std::string & text)
+      : text_(XMLString::transcode(text.c_str()))
+    {
+    }
+    ~XMLText()
+    {
+      XMLString::release(&text_);
+    }
+    operator const XMLCh *()const
+    {
+      return text_;
+    }
+  private:
+    XMLCh * text_;
+  };
+
+  std::string narrow(const XMLCh * text)
+  {
+    std::string result;
+    if(text != 0)
+    {
+      char * raw = XMLString::transcode(text);
+      result = raw;
+      XMLString::release(&raw);
+    }
+    return result;
+  }
+
+  std::string elementName(const DOMElement * element)
+  {
+    const XMLCh * name = element->getLocalName();
+    if(name == 0)
+    {
+      name = element->getTagName();
+    }
+    return narrow(name);
+  }
+
+  bool isFieldElement(const std::string & tag)
+  {
+    return tag == "int8" || tag == "uInt8" || tag == "int16" || tag == "uInt16"
+      || tag == "int32" || tag == "uInt32" || tag == "int64" || tag == "uInt64"
+      || tag == "decimal" || tag == "string" || tag == "byteVector" || tag == "length";
+  }
+
+  bool isOperatorElement(const std::string & tag)
+  {
+    return tag == "nop" || tag == "constant" || tag == "default" || tag == "copy"
+      || tag == "delta" || tag == "increment" || tag == "tail";
+  }
+
+  struct Decision
+  {
+    FieldOp::OpType op_;
+    std::string value_;
+    bool hasValue_;
+  };
+  typedef std::map<std::string, Decision> Decisions;
+
+  void replaceOperator(DOMElement * field, const Decision & decision)
+  {
+    DOMElement * old = 0;
+    for(DOMNode * node = field->getFirstChild(); node != 0 && old == 0; node = node->getNextSibling())
+    {
+      if(node->getNodeType() == DOMNode::ELEMENT_NODE
+        && isOperatorElement(elementName(static_cast<DOMElement *>(node))))
+      {
+        old = static_cast<DOMElement *>(node);
+      }
+    }
+
+    DOMElement * replacement = 0;
+    if(decision.op_ != FieldOp::NOP)
+    {
+      std::string qualifiedName = FieldOp::opName(decision.op_);
+      std::string prefix = narrow(field->getPrefix());
+      if(!prefix.empty())
+      {
+        qualifiedName = prefix + ':' + qualifiedName;
+      }
+      replacement = field->getOwnerDocument()->createElementNS(
+        field->getNamespaceURI(), XMLText(qualifiedName));
+      if(old != 0)
+      {
+        // keep the dictionary, key and nsKey attributes
+        DOMNamedNodeMap * attributes = old->getAttributes();
+        for(XMLSize_t nAttribute = 0; nAttribute < attributes->getLength(); ++nAttribute)
+        {
+          DOMAttr * attribute = static_cast<DOMAttr *>(attributes->item(nAttribute));
+          if(narrow(attribute->getName()) != "value")
+          {
+            replacement->setAttributeNS(
+              attribute->getNamespaceURI(), attribute->getName(), attribute->getValue());
+          }
+        }
+      }
+      if(decision.hasValue_)
+      {
+        replacement->setAttribute(XMLText("value"), XMLText(decision.value_));
+      }
+    }
+
+    if(old != 0)
+    {
+      if(replacement != 0)
+      {
+        field->replaceChild(replacement, old)->release();
+      }
+      else
+      {
+        field->removeChild(old)->release();
+      }
+    }
+    else if(replacement != 0)
+    {
+      field->appendChild(replacement);
+    }
+  }
+
+  void rewriteChildren(
+    DOMElement * parent,
+    const std::string & templateName,
+    const std::string & prefix,
+    const Decisions & decisions)
+  {
+    for(DOMNode * node = parent->getFirstChild(); node != 0; node = node->getNextSibling())
+    {
+      if(node->getNodeType() != DOMNode::ELEMENT_NODE)
+      {
+        continue;
+      }
+      DOMElement * element = static_cast<DOMElement *>(node);
+      std::string tag = elementName(element);
+      std::string name = narrow(element->getAttribute(XMLText("name")));
+      if(tag == "templates")
+      {
+        rewriteChildren(element, templateName, prefix, decisions);
+      }
+      else if(tag == "template")
+      {
+        rewriteChildren(element, name, "", decisions);
+      }
+      else if(tag == "group" || tag == "sequence")
+      {
+        rewriteChildren(element, templateName, prefix + name + '/', decisions);
+      }
+      else if(isFieldElement(tag))
+      {
+        Decisions::const_iterator decision = decisions.find(templateName + '\t' + prefix + name);
+        if(decision != decisions.end())
+        {
+          replaceOperator(element, decision->second);
+        }
+      }
+    }
+  }
+}
+
+OperatorOptimizer::Candidate::Candidate()
+  : op_(FieldOp::NOP)
+  , valid_(true)
+  , bytes_(0)
+  , pmapBits_(0)
+  , hasValue_(false)
+{
+}
+
+OperatorOptimizer::Tally::Tally()
+  : count_(0)
+  , nopBytes_(0)
+{
+}
+
+OperatorOptimizer::FieldModel::FieldModel()
+  : tallyValues_(false)
+  , talliesFull_(false)
+  , occurrences_(0)
+  , absent_(0)
+  , absentNopBytes_(0)
+  , presentNopBytes_(0)
+{
+}
+
+OperatorOptimizer::OperatorOptimizer(TemplateRegistryPtr registry)
+  : registry_(registry)
+  , messageEncoder_(registry)
+  , currentEncoder_(registry)
+  , messageCount_(0)
+  , currentBytes_(0)
+{
+  for(TemplateRegistry::const_iterator it = registry_->begin(); it != registry_->end(); ++it)
+  {
+    modelSegment(it->second, it->second->getTemplateName(), "");
+  }
+
+  // Now that every candidate has its dictionary entry, the candidates can be finalized.
+  candidateRegistry_.reset(new TemplateRegistry(0, 0, indexer_.size()));
+  for(std::vector<FieldModelPtr>::iterator model = order_.begin(); model != order_.end(); ++model)
+  {
+    for(size_t nCandidate = 0; nCandidate < (*model)->candidates_.size(); ++nCandidate)
+    {
+      (*model)->candidates_[nCandidate].instruction_->finalize(*candidateRegistry_);
+    }
+  }
+  candidateEncoder_.reset(new Encoder(candidateRegistry_));
+}
+
+OperatorOptimizer::~OperatorOptimizer()
+{
+}
+
+void
+OperatorOptimizer::modelSegment(
+  const SegmentBodyCPtr & segment,
+  const std::string & templateName,
+  const std::string & prefix)
+{
+  size_t instructionCount = segment->size();
+  for(size_t nField = 0; nField < instructionCount; ++nField)
+  {
+    const FieldInstructionCPtr & instruction = segment->getInstruction(nField);
+    const std::string & name = instruction->getName();
+    switch(instruction->fieldInstructionType())
+    {
+    case ValueType::GROUP:
+      {
+        SegmentBodyPtr body;
+        if(instruction->getSegmentBody(body))
+        {
+          modelSegment(body, templateName, prefix + name + '/');
+        }
+        break;
+      }
+    case ValueType::SEQUENCE:
+      {
+        SegmentBodyPtr body;
+        if(instruction->getSegmentBody(body))
+        {
+          FieldInstructionCPtr lengthInstruction;
+          if(body->getLengthInstruction(lengthInstruction))
+          {
+            modelField(lengthInstruction, templateName, prefix + name + '/' + lengthInstruction->getName());
+          }
+          modelSegment(body, templateName, prefix + name + '/');
+        }
+        break;
+      }
+    case ValueType::TEMPLATEREF:
+      // modeled as part of the referenced template
+      break;
+    default:
+      modelField(instruction, templateName, prefix + name);
+      break;
+    }
+  }
+}
+
+void
+OperatorOptimizer::modelField(
+  const FieldInstructionCPtr & instruction,
+  const std::string & templateName,
+  const std::string & path)
+{
+  if(models_.find(instruction.get()) != models_.end())
+  {
+    return;
+  }
+  ValueType::Type type = instruction->fieldInstructionType();
+  bool integer = false;
+  bool text = false;
+  bool tallyValues = true;
+  switch(type)
+  {
+  case ValueType::INT8:
+  case ValueType::UINT8:
+  case ValueType::INT16:
+  case ValueType::UINT16:
+  case ValueType::INT32:
+  case ValueType::UINT32:
+  case ValueType::INT64:
+  case ValueType::UINT64:
+    integer = true;
+    break;
+  case ValueType::DECIMAL:
+    {
+      const FieldInstructionDecimal * decimal = dynamic_cast<const FieldInstructionDecimal *>(instruction.get());
+      FieldInstructionCPtr exponent;
+      if(decimal == 0 || decimal->getExponentInstruction(exponent))
+      {
+        return;
+      }
+      break;
+    }
+  case ValueType::ASCII:
+    text = true;
+    break;
+  case ValueType::UTF8:
+  case ValueType::BYTEVECTOR:
+    text = true;
+    tallyValues = false;
+    break;
+  default:
+    return;
+  }
+
+  FieldModelPtr model(new FieldModel);
+  model->instruction_ = instruction;
+  model->templateName_ = templateName;
+  model->path_ = path;
+  model->current_.op_ = instruction->getFieldOp()->opType();
+  model->tallyValues_ = tallyValues;
+
+  std::vector<FieldOp::OpType> ops;
+  ops.push_back(FieldOp::NOP); // must be first: its cost is the base for default and constant
+  ops.push_back(FieldOp::COPY);
+  ops.push_back(FieldOp::DELTA);
+  if(integer)
+  {
+    ops.push_back(FieldOp::INCREMENT);
+  }
+  if(text)
+  {
+    ops.push_back(FieldOp::TAIL);
+  }
+  // every candidate gets a dictionary entry of its own.
+  std::string key = "OperatorOptimizer" + boost::lexical_cast<std::string>(order_.size()) + '.';
+  for(size_t nOp = 0; nOp < ops.size(); ++nOp)
+  {
+    Candidate candidate;
+    candidate.op_ = ops[nOp];
+    FieldInstructionPtr candidateInstruction = createInstruction(
+      type,
+      instruction->getIdentity().getLocalName(),
+      instruction->getIdentity().getNamespace());
+    candidateInstruction->setPresence(instruction->isMandatory());
+    FieldOpPtr op = createOp(ops[nOp]);
+    op->setKey(key + FieldOp::opName(ops[nOp]));
+    candidateInstruction->setFieldOp(op);
+    candidateInstruction->indexDictionaries(indexer_, "global", "", "");
+    candidate.instruction_ = candidateInstruction;
+    model->candidates_.push_back(candidate);
+  }
+  models_[instruction.get()] = model;
+  order_.push_back(model);
+}
+
+void
+OperatorOptimizer::observe(template_id_t templateId, const Messages::MessageAccessor & message)
+{
+  TemplateCPtr templatePtr;
+  if(!registry_->getTemplate(templateId, templatePtr))
+  {
+    throw EncodingError("[ERR D9] Unknown template ID.");
+  }
+  destination_.clear();
+  messageEncoder_.encodeMessage(destination_, templateId, message);
+  currentBytes_ += byteCount(destination_);
+  ++messageCount_;
+  observeSegment(templatePtr, message);
+}
+
+void
+OperatorOptimizer::observeSegment(const SegmentBodyCPtr & segment, const Messages::MessageAccessor & accessor)
+{
+  size_t instructionCount = segment->size();
+  for(size_t nField = 0; nField < instructionCount; ++nField)
+  {
+    const FieldInstructionCPtr & instruction = segment->getInstruction(nField);
+    const Messages::FieldIdentity & identity = instruction->getIdentity();
+    switch(instruction->fieldInstructionType())
+    {
+    case ValueType::GROUP:
+      {
+        SegmentBodyPtr body;
+        const Messages::MessageAccessor * group = 0;
+        if(instruction->getSegmentBody(body) && accessor.getGroup(identity, group))
+        {
+          observeSegment(body, *group);
+          accessor.endGroup(identity, group);
+        }
+        break;
+      }
+    case ValueType::SEQUENCE:
+      {
+        SegmentBodyPtr body;
+        if(!instruction->getSegmentBody(body))
+        {
+          break;
+        }
+        FieldInstructionCPtr lengthInstruction;
+        bool hasLength = body->getLengthInstruction(lengthInstruction);
+        size_t length = 0;
+        if(accessor.getSequenceLength(identity, length))
+        {
+          if(hasLength)
+          {
+            Messages::FieldCPtr lengthField(Messages::FieldUInt32::create(uint32(length)));
+            Messages::SingleFieldAccessor lengthAccessor(lengthInstruction->getIdentity(), lengthField);
+            observeField(lengthInstruction, lengthAccessor);
+          }
+          for(size_t pos = 0; pos < length; ++pos)
+          {
+            const Messages::MessageAccessor * entry = 0;
+            if(accessor.getSequenceEntry(identity, pos, entry))
+            {
+              observeSegment(body, *entry);
+            }
+            accessor.endSequenceEntry(identity, pos, entry);
+          }
+          accessor.endSequence(identity);
+        }
+        else if(hasLength)
+        {
+          Messages::EmptyAccessor empty;
+          observeField(lengthInstruction, empty);
+        }
+        break;
+      }
+    case ValueType::TEMPLATEREF:
+      {
+        const FieldInstructionStaticTemplateRef * reference =
+          dynamic_cast<const FieldInstructionStaticTemplateRef *>(instruction.get());
+        TemplateCPtr target;
+        if(reference != 0
+          && messageEncoder_.findTemplate(reference->templateName(), reference->templateNamespace(), target))
+        {
+          const Messages::MessageAccessor * group = 0;
+          if(accessor.getGroup(identity, group))
+          {
+            observeSegment(target, *group);
+            accessor.endGroup(identity, group);
+          }
+          else
+          {
+            observeSegment(target, accessor);
+          }
+        }
+        break;
+      }
+    default:
+      observeField(instruction, accessor);
+      break;
+    }
+  }
+}
+
+void
+OperatorOptimizer::observeField(const FieldInstructionCPtr & instruction, const Messages::MessageAccessor & accessor)
+{
+  FieldModels::iterator it = models_.find(instruction.get());
+  if(it == models_.end())
+  {
+    return;
+  }
+  FieldModel & model = *it->second;
+  ++model.occurrences_;
+  measure(model.current_, *model.instruction_, currentEncoder_, accessor);
+
+  Candidate & nop = model.candidates_[0];
+  size_t nopBefore = nop.bytes_;
+  for(size_t nCandidate = 0; nCandidate < model.candidates_.size(); ++nCandidate)
+  {
+    Candidate & candidate = model.candidates_[nCandidate];
+    measure(candidate, *candidate.instruction_, *candidateEncoder_, accessor);
+  }
+  size_t nopBytes = nop.bytes_ - nopBefore;
+
+  std::string key;
+  if(valueKey(*model.instruction_, accessor, key))
+  {
+    model.presentNopBytes_ += nopBytes;
+    if(model.tallyValues_)
+    {
+      Tallies::iterator tally = model.tallies_.find(key);
+      if(tally == model.tallies_.end())
+      {
+        if(model.tallies_.size() < maxTallies)
+        {
+          tally = model.tallies_.insert(Tallies::value_type(key, Tally())).first;
+        }
+        else
+        {
+          model.talliesFull_ = true;
+        }
+      }
+      if(tally != model.tallies_.end())
+      {
+        ++tally->second.count_;
+        tally->second.nopBytes_ += nopBytes;
+      }
+    }
+  }
+  else
+  {
+    ++model.absent_;
+    model.absentNopBytes_ += nopBytes;
+  }
+}
+
+void
+OperatorOptimizer::measure(
+  Candidate & candidate,
+  const FieldInstruction & instruction,
+  Encoder & encoder,
+  const Messages::MessageAccessor & accessor)
+{
+  if(!candidate.valid_)
+  {
+    return;
+  }
+  destination_.clear();
+  PresenceMap pmap(1);
+  try
+  {
+    instruction.encode(destination_, pmap, encoder, accessor);
+    candidate.bytes_ += byteCount(destination_);
+    candidate.pmapBits_ += instruction.getPresenceMapBitsUsed();
+  }
+  catch (const EncodingError &)
+  {
+    // this operator cannot represent the traffic (a constant that changed, for example)
+    candidate.valid_ = false;
+  }
+}
+
+bool
+OperatorOptimizer::valueKey(
+  const FieldInstruction & instruction,
+  const Messages::MessageAccessor & accessor,
+  std::string & key)const
+{
+  const Messages::FieldIdentity & identity = instruction.getIdentity();
+  ValueType::Type type = instruction.fieldInstructionType();
+  switch(type)
+  {
+  case ValueType::INT8:
+  case ValueType::INT16:
+  case ValueType::INT32:
+  case ValueType::INT64:
+    {
+      int64 value = 0;
+      if(!accessor.getSignedInteger(identity, type, value))
+      {
+        return false;
+      }
+      key = boost::lexical_cast<std::string>(value);
+      return true;
+    }
+  case ValueType::UINT8:
+  case ValueType::UINT16:
+  case ValueType::UINT32:
+  case ValueType::UINT64:
+    {
+      uint64 value = 0;
+      if(!accessor.getUnsignedInteger(identity, type, value))
+      {
+        return false;
+      }
+      key = boost::lexical_cast<std::string>(value);
+      return true;
+    }
+  case ValueType::DECIMAL:
+    {
+      Decimal value;
+      if(!accessor.getDecimal(identity, type, value))
+      {
+        return false;
+      }
+      key = decimalString(value);
+      return true;
+    }
+  default:
+    {
+      const StringBuffer * value = 0;
+      if(!accessor.getString(identity, type, value))
+      {
+        return false;
+      }
+      key = *value;
+      return true;
+    }
+  }
+}
+
+void
+OperatorOptimizer::evaluateDefaults(const FieldModel & model, std::vector<Candidate> & candidates)const
+{
+  if(!model.tallyValues_ || model.occurrences_ == 0)
+  {
+    return;
+  }
+  bool mandatory = model.instruction_->isMandatory();
+
+  Tallies::const_iterator mostFrequent = model.tallies_.end();
+  for(Tallies::const_iterator tally = model.tallies_.begin(); tally != model.tallies_.end(); ++tally)
+  {
+    if(mostFrequent == model.tallies_.end() || tally->second.count_ > mostFrequent->second.count_)
+    {
+      mostFrequent = tally;
+    }
+  }
+
+  if(mostFrequent != model.tallies_.end())
+  {
+    // the default value costs nothing; anything else costs what it would without an operator.
+    // An absent optional field must be sent as a null.
+    Candidate defaultValue;
+    defaultValue.op_ = FieldOp::DEFAULT;
+    defaultValue.value_ = mostFrequent->first;
+    defaultValue.hasValue_ = true;
+    defaultValue.bytes_ = model.presentNopBytes_ - mostFrequent->second.nopBytes_ + model.absent_;
+    defaultValue.pmapBits_ = model.occurrences_;
+    candidates.push_back(defaultValue);
+
+    if(model.tallies_.size() == 1 && !model.talliesFull_ && (!mandatory || model.absent_ == 0))
+    {
+      Candidate constant;
+      constant.op_ = FieldOp::CONSTANT;
+      constant.value_ = mostFrequent->first;
+      constant.hasValue_ = true;
+      constant.pmapBits_ = mandatory ? 0 : model.occurrences_;
+      candidates.push_back(constant);
+    }
+  }
+
+  if(!mandatory)
+  {
+    // a default with no value makes an absent field cost only its presence map bit.
+    Candidate defaultAbsent;
+    defaultAbsent.op_ = FieldOp::DEFAULT;
+    defaultAbsent.bytes_ = model.presentNopBytes_;
+    defaultAbsent.pmapBits_ = model.occurrences_;
+    candidates.push_back(defaultAbsent);
+  }
+}
+
+const OperatorOptimizer::Candidate &
+OperatorOptimizer::choose(const FieldModel & model, std::vector<Candidate> & scratch)const
+{
+  scratch = model.candidates_;
+  evaluateDefaults(model, scratch);
+  const Candidate * best = model.current_.valid_ ? &model.current_ : 0;
+  for(size_t nCandidate = 0; nCandidate < scratch.size(); ++nCandidate)
+  {
+    const Candidate & candidate = scratch[nCandidate];
+    // ties go to the operator already in use
+    if(candidate.valid_ && (best == 0 || cost(candidate) < cost(*best)))
+    {
+      best = &candidate;
+    }
+  }
+  if(best == 0)
+  {
+    return model.current_;
+  }
+  return *best;
+}
+
+double
+OperatorOptimizer::cost(const Candidate & candidate)
+{
+  // each presence map byte carries seven bits.
+  return double(candidate.bytes_) * 8.0 + double(candidate.pmapBits_) * 8.0 / 7.0;
+}
+
+size_t
+OperatorOptimizer::optimizedBytes()const
+{
+  double saved = 0.0;
+  std::vector<Candidate> scratch;
+  for(std::vector<FieldModelPtr>::const_iterator model = order_.begin(); model != order_.end(); ++model)
+  {
+    if((*model)->current_.valid_)
+    {
+      saved += cost((*model)->current_) - cost(choose(**model, scratch));
+    }
+  }
+  saved /= 8.0;
+  if(saved >= double(currentBytes_))
+  {
+    return 0;
+  }
+  return size_t(double(currentBytes_) - saved + 0.5);
+}
+
+void
+OperatorOptimizer::report(std::ostream & out)const
+{
+  size_t optimized = optimizedBytes();
+  out << "Messages observed: " << messageCount_ << std::endl;
+  out << "Current size:      " << currentBytes_ << " bytes" << std::endl;
+  out << "Optimized size:    " << optimized << " bytes (estimated)" << std::endl;
+  if(currentBytes_ > 0)
+  {
+    out << "Saving:            " << std::fixed << std::setprecision(1)
+      << 100.0 * double(currentBytes_ - optimized) / double(currentBytes_) << '%'
+      << std::endl;
+  }
+  out << std::endl;
+
+  std::vector<Candidate> scratch;
+  for(std::vector<FieldModelPtr>::const_iterator it = order_.begin(); it != order_.end(); ++it)
+  {
+    const FieldModel & model = **it;
+    if(model.occurrences_ == 0)
+    {
+      continue;
+    }
+    const Candidate & best = choose(model, scratch);
+    out << model.templateName_ << '/' << model.path_ << ": "
+      << FieldOp::opName(model.current_.op_);
+    if(!model.current_.valid_)
+    {
+      out << " (not measured)";
+    }
+    else if(&best == &model.current_)
+    {
+      out << " (kept)";
+    }
+    else
+    {
+      out << " -> " << FieldOp::opName(best.op_);
+      if(best.hasValue_)
+      {
+        out << " value=\"" << best.value_ << '"';
+      }
+      out << " saves " << std::fixed << std::setprecision(1)
+        << (cost(model.current_) - cost(best)) / 8.0 << " bytes";
+    }
+    out << std::endl;
+  }
+}
+
+void
+OperatorOptimizer::rewriteTemplates(std::istream & templates, std::ostream & out)const
+{
+  if(!templates.good())
+  {
+    throw TemplateDefinitionError("[ERR S1] Can't read XML templates.");
+  }
+
+  Decisions decisions;
+  std::vector<Candidate> scratch;
+  for(std::vector<FieldModelPtr>::const_iterator it = order_.begin(); it != order_.end(); ++it)
+  {
+    const FieldModel & model = **it;
+    const Candidate & best = choose(model, scratch);
+    if(&best != &model.current_)
+    {
+      Decision decision;
+      decision.op_ = best.op_;
+      decision.value_ = best.value_;
+      decision.hasValue_ = best.hasValue_;
+      decisions[model.templateName_ + '\t' + model.path_] = decision;
+    }
+  }
+
+  std::string data((std::istreambuf_iterator<char>(templates)), std::istreambuf_iterator<char>());
+
+  XMLPlatform platform;
+  {
+    XercesDOMParser parser;
+    parser.setDoNamespaces(true);
+    parser.setLoadExternalDTD(false);
+    MemBufInputSource source(
+      reinterpret_cast<const XMLByte *>(data.data()),
+      data.size(),
+      "FAST");
+    parser.parse(source);
+    DOMDocument * document = parser.getDocument();
+    if(parser.getErrorCount() != 0 || document == 0 || document->getDocumentElement() == 0)
+    {
+      throw TemplateDefinitionError("[ERR S1] Can't parse XML templates.");
+    }
+
+    DOMElement * root = document->getDocumentElement();
+    if(elementName(root) == "template")
+    {
+      rewriteChildren(root, narrow(root->getAttribute(XMLText("name"))), "", decisions);
+    }
+    else
+    {
+      rewriteChildren(root, "", "", decisions);
+    }
+
+    DOMImplementationLS * implementation = static_cast<DOMImplementationLS *>(
+      DOMImplementationRegistry::getDOMImplementation(XMLText("LS")));
+    DOMLSSerializer * serializer = implementation->createLSSerializer();
+    DOMLSOutput * output = implementation->createLSOutput();
+    MemBufFormatTarget target;
+    output->setByteStream(&target);
+    serializer->write(document, output);
+    out.write(reinterpret_cast<const char *>(target.getRawBuffer()), std::streamsize(target.getLen()));
+    output->release();
+    serializer->release();
+  }
+}
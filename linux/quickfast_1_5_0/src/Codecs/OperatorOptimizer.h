@@ -0,0 +1,170 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef OPERATOROPTIMIZER_H
+#define OPERATOROPTIMIZER_H
+#include "OperatorOptimizer_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+#include <Codecs/SegmentBody_fwd.h>
+#include <Codecs/FieldInstruction_fwd.h>
+#include <Codecs/FieldOp.h>
+#include <Codecs/DictionaryIndexer.h>
+#include <Codecs/DataDestination.h>
+#include <Codecs/Encoder.h>
+#include <Messages/MessageAccessor.h>
+
+namespace QuickFAST{
+  namespace Codecs{
+    /// @brief Choose the field operators that minimize the encoded size of observed traffic.
+    ///
+    /// Each message passed to observe() is encoded, field by field, once for
+    /// every operator that could be applied to the field: nop, copy, delta,
+    /// increment (integers only) and tail (strings and byte vectors only).  The
+    /// encoding is done by the same FieldInstruction and FieldOp code the Encoder
+    /// uses, with a dictionary entry of its own for each candidate, so the cost
+    /// of each alternative is measured rather than estimated.  The cost of the
+    /// default and constant operators is calculated from the values seen, using
+    /// the most frequent value as the operator's value.
+    ///
+    /// Presence map bits are charged at 8/7 of a bit each because each presence
+    /// map byte carries seven of them.
+    ///
+    /// The fields of a static templateRef are charged to the referenced template.
+    /// Decimal fields with separate exponent and mantissa operators, fields of
+    /// dynamic templateRefs and the presence of groups are not modeled; they are
+    /// left as they are.
+    ///
+    /// Once the traffic has been observed, report() lists the choice made for
+    /// each field and the expected saving, and rewriteTemplates() applies the
+    /// choices to the original XML template file.
+    class QuickFAST_Export OperatorOptimizer
+    {
+    public:
+      /// @brief Construct
+      /// @param registry defines the templates used by the traffic to be observed.
+      explicit OperatorOptimizer(TemplateRegistryPtr registry);
+      ~OperatorOptimizer();
+
+      /// @brief Model the cost of encoding one message.
+      /// @param templateId identifies the template with which the message was encoded.
+      /// @param message supplies the fields of the message.
+      /// @throws EncodingError if the template is unknown or the message does not fit it.
+      void observe(template_id_t templateId, const Messages::MessageAccessor & message);
+
+      /// @brief How many messages have been observed?
+      size_t messageCount()const
+      {
+        return messageCount_;
+      }
+
+      /// @brief How many bytes did the observed messages take with the current templates?
+      size_t currentBytes()const
+      {
+        return currentBytes_;
+      }
+
+      /// @brief How many bytes are the observed messages expected to take after optimization?
+      size_t optimizedBytes()const;
+
+      /// @brief Describe the choice made for each field and the expected savings.
+      /// @param out receives the report.
+      void report(std::ostream & out)const;
+
+      /// @brief Apply the chosen operators to an XML template file.
+      ///
+      /// Only the operator elements of fields whose operator changes are touched.
+      /// The dictionary, key and nsKey attributes of a replaced operator are kept.
+      /// @param templates is the XML template file from which the registry was parsed.
+      /// @param out receives the rewritten template file.
+      void rewriteTemplates(std::istream & templates, std::ostream & out)const;
+
+    private:
+      OperatorOptimizer(const OperatorOptimizer &);
+      OperatorOptimizer & operator=(const OperatorOptimizer &);
+
+      /// One alternative encoding for a field.
+      struct Candidate
+      {
+        Candidate();
+        FieldOp::OpType op_;
+        FieldInstructionPtr instruction_;
+        bool valid_;
+        size_t bytes_;
+        size_t pmapBits_;
+        std::string value_;
+        bool hasValue_;
+      };
+
+      /// How often a value was seen, and what it cost to send without an operator.
+      struct Tally
+      {
+        Tally();
+        size_t count_;
+        size_t nopBytes_;
+      };
+      typedef std::map<std::string, Tally> Tallies;
+
+      /// Everything known about one field of one template.
+      struct FieldModel
+      {
+        FieldModel();
+        FieldInstructionCPtr instruction_;
+        std::string templateName_;
+        std::string path_;
+        Candidate current_;
+        std::vector<Candidate> candidates_;
+        bool tallyValues_;
+        Tallies tallies_;
+        bool talliesFull_;
+        size_t occurrences_;
+        size_t absent_;
+        size_t absentNopBytes_;
+        size_t presentNopBytes_;
+      };
+      typedef boost::shared_ptr<FieldModel> FieldModelPtr;
+      typedef std::map<const FieldInstruction *, FieldModelPtr> FieldModels;
+
+      void modelSegment(
+        const SegmentBodyCPtr & segment,
+        const std::string & templateName,
+        const std::string & prefix);
+      void modelField(
+        const FieldInstructionCPtr & instruction,
+        const std::string & templateName,
+        const std::string & path);
+      void observeSegment(const SegmentBodyCPtr & segment, const Messages::MessageAccessor & accessor);
+      void observeField(const FieldInstructionCPtr & instruction, const Messages::MessageAccessor & accessor);
+      void measure(
+        Candidate & candidate,
+        const FieldInstruction & instruction,
+        Encoder & encoder,
+        const Messages::MessageAccessor & accessor);
+      bool valueKey(
+        const FieldInstruction & instruction,
+        const Messages::MessageAccessor & accessor,
+        std::string & key)const;
+      void evaluateDefaults(const FieldModel & model, std::vector<Candidate> & candidates)const;
+      const Candidate & choose(const FieldModel & model, std::vector<Candidate> & scratch)const;
+      static double cost(const Candidate & candidate);
+
+    private:
+      TemplateRegistryPtr registry_;
+      DictionaryIndexer indexer_;
+      TemplateRegistryPtr candidateRegistry_;
+      Encoder messageEncoder_;
+      Encoder currentEncoder_;
+      boost::scoped_ptr<Encoder> candidateEncoder_;
+      DataDestination destination_;
+      FieldModels models_;
+      std::vector<FieldModelPtr> order_;
+      size_t messageCount_;
+      size_t currentBytes_;
+    };
+  }
+}
+#endif // OPERATOROPTIMIZER_H
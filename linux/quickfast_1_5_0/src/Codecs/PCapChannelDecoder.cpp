@@ -0,0 +1,341 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "PCapChannelDecoder.h"
+#include <Codecs/MessagePerPacketAssembler.h>
+#include <Codecs/NoHeaderAnalyzer.h>
+#include <Codecs/Decoder.h>
+#include <Communication/PCapReader.h>
+#include <Common/Exceptions.h>
+#include <boost/asio/ip/address_v4.hpp>
+
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Codecs;
+
+namespace
+{
+  // Batches waiting to be decoded, per decoding thread.
+  const size_t batchesPerThread = 8;
+
+  uint64 channelKey(uint32 address, uint16 port)
+  {
+    return (uint64(address) << 16) | port;
+  }
+}
+
+/// Packets for one channel, copied out of the file so the
+/// reader can move on while they wait to be decoded.
+struct PCapChannelDecoder::Batch
+{
+  std::vector<uchar> data_;
+  std::vector<size_t> sizes_;
+};
+
+/// The decoding state for one channel.
+struct PCapChannelDecoder::Channel
+{
+  Channel(
+      TemplateRegistryPtr registry,
+      Messages::ValueMessageBuilder & builder,
+      HeaderAnalyzer * packetHeaderAnalyzer,
+      HeaderAnalyzer * messageHeaderAnalyzer)
+    : assembler_(
+        registry,
+        packetHeaderAnalyzer == 0 ? noPacketHeader_ : *packetHeaderAnalyzer,
+        messageHeaderAnalyzer == 0 ? noMessageHeader_ : *messageHeaderAnalyzer,
+        builder)
+    , scheduled_(false)
+    , stopped_(false)
+  {
+  }
+
+  NoHeaderAnalyzer noPacketHeader_;
+  NoHeaderAnalyzer noMessageHeader_;
+  MessagePerPacketAssembler assembler_;
+  BatchPtr filling_;
+  std::deque<BatchPtr> queue_;
+  bool scheduled_;
+  bool stopped_;
+};
+
+PCapChannelDecoder::PCapChannelDecoder()
+  : threadCount_(0)
+  , wordSize_(0)
+  , strict_(true)
+  , batchSize_(64 * 1024)
+  , queuedBatches_(0)
+  , maxQueuedBatches_(0)
+  , finished_(false)
+{
+}
+
+PCapChannelDecoder::~PCapChannelDecoder()
+{
+}
+
+void
+PCapChannelDecoder::setThreadCount(size_t threadCount)
+{
+  threadCount_ = threadCount;
+}
+
+void
+PCapChannelDecoder::setWordSize(size_t wordSize)
+{
+  wordSize_ = wordSize;
+}
+
+void
+PCapChannelDecoder::setStrict(bool strict)
+{
+  strict_ = strict;
+  for(ChannelMap::iterator it = channels_.begin(); it != channels_.end(); ++it)
+  {
+    it->second->assembler_.decoder().setStrict(strict);
+  }
+}
+
+void
+PCapChannelDecoder::setBatchSize(size_t batchSize)
+{
+  batchSize_ = batchSize;
+}
+
+size_t
+PCapChannelDecoder::channelCount()const
+{
+  return channels_.size();
+}
+
+void
+PCapChannelDecoder::addChannel(
+  const std::string & group,
+  unsigned short port,
+  TemplateRegistryPtr registry,
+  Messages::ValueMessageBuilder & builder,
+  HeaderAnalyzer & packetHeaderAnalyzer,
+  HeaderAnalyzer & messageHeaderAnalyzer)
+{
+  addChannel(group, port, registry, builder, &packetHeaderAnalyzer, &messageHeaderAnalyzer);
+}
+
+void
+PCapChannelDecoder::addChannel(
+  const std::string & group,
+  unsigned short port,
+  TemplateRegistryPtr registry,
+  Messages::ValueMessageBuilder & builder)
+{
+  addChannel(group, port, registry, builder, 0, 0);
+}
+
+void
+PCapChannelDecoder::addChannel(
+  const std::string & group,
+  unsigned short port,
+  TemplateRegistryPtr registry,
+  Messages::ValueMessageBuilder & builder,
+  HeaderAnalyzer * packetHeaderAnalyzer,
+  HeaderAnalyzer * messageHeaderAnalyzer)
+{
+  uint32 address = Communication::PCapReader::parseAddress(group);
+  ChannelPtr channel(new Channel(registry, builder, packetHeaderAnalyzer, messageHeaderAnalyzer));
+  channel->assembler_.decoder().setStrict(strict_);
+  ChannelPtr & entry = channels_[channelKey(address, port)];
+  if(entry)
+  {
+    throw UsageError("Coding Error", "PCapChannelDecoder: channel added twice.");
+  }
+  entry = channel;
+  routes_.clear();
+}
+
+void
+PCapChannelDecoder::unknownChannel(const std::string & /*group*/, unsigned short /*port*/)
+{
+}
+
+PCapChannelDecoder::Channel *
+PCapChannelDecoder::findChannel(uint32 address, uint16 port)
+{
+  uint64 key = channelKey(address, port);
+  RouteMap::const_iterator route = routes_.find(key);
+  if(route != routes_.end())
+  {
+    return route->second;
+  }
+
+  // An exact match, then channels that match any port or any address.
+  ChannelMap::const_iterator it = channels_.find(key);
+  if(it == channels_.end())
+  {
+    it = channels_.find(channelKey(address, 0));
+  }
+  if(it == channels_.end())
+  {
+    it = channels_.find(channelKey(0, port));
+  }
+  if(it == channels_.end())
+  {
+    it = channels_.find(channelKey(0, 0));
+  }
+  if(it == channels_.end())
+  {
+    std::string group = boost::asio::ip::address_v4(address).to_string();
+    unknownChannel(group, port);
+    it = channels_.find(key);
+  }
+  Channel * channel = 0;
+  if(it != channels_.end())
+  {
+    channel = it->second.get();
+  }
+  // Remember the answer, even if the channel is not wanted.
+  routes_[key] = channel;
+  return channel;
+}
+
+size_t
+PCapChannelDecoder::decode(const std::string & filename)
+{
+  Communication::PCapReader reader;
+  if(wordSize_ == 32)
+  {
+    reader.set32bit(true);
+  }
+  else if(wordSize_ == 64)
+  {
+    reader.set64bit(true);
+  }
+  if(!reader.open(filename.c_str()))
+  {
+    throw CommunicationError("Can't read PCap file: " + filename);
+  }
+
+  size_t threadCount = threadCount_;
+  if(threadCount == 0)
+  {
+    threadCount = boost::thread::hardware_concurrency();
+  }
+  if(threadCount == 0)
+  {
+    threadCount = 1;
+  }
+  maxQueuedBatches_ = threadCount * batchesPerThread;
+  finished_ = false;
+  queuedBatches_ = 0;
+
+  boost::thread_group threads;
+  for(size_t nThread = 0; nThread < threadCount; ++nThread)
+  {
+    threads.create_thread(boost::bind(&PCapChannelDecoder::worker, this));
+  }
+
+  size_t packetCount = 0;
+  const unsigned char * buffer = 0;
+  size_t size = 0;
+  while(reader.read(buffer, size))
+  {
+    Channel * channel = findChannel(reader.destinationAddress(), reader.destinationPort());
+    if(channel == 0)
+    {
+      continue;
+    }
+    ++packetCount;
+    if(!channel->filling_)
+    {
+      channel->filling_.reset(new Batch);
+      channel->filling_->data_.reserve(batchSize_);
+    }
+    Batch & batch = *channel->filling_;
+    batch.data_.insert(batch.data_.end(), buffer, buffer + size);
+    batch.sizes_.push_back(size);
+    if(batch.data_.size() >= batchSize_)
+    {
+      enqueue(*channel);
+    }
+  }
+  for(ChannelMap::iterator it = channels_.begin(); it != channels_.end(); ++it)
+  {
+    if(it->second->filling_)
+    {
+      enqueue(*it->second);
+    }
+  }
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    finished_ = true;
+  }
+  condition_.notify_all();
+  threads.join_all();
+  return packetCount;
+}
+
+void
+PCapChannelDecoder::enqueue(Channel & channel)
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    while(queuedBatches_ >= maxQueuedBatches_)
+    {
+      condition_.wait(lock);
+    }
+    channel.queue_.push_back(channel.filling_);
+    ++queuedBatches_;
+    if(!channel.scheduled_)
+    {
+      channel.scheduled_ = true;
+      ready_.push_back(&channel);
+    }
+  }
+  channel.filling_.reset();
+  condition_.notify_all();
+}
+
+void
+PCapChannelDecoder::worker()
+{
+  for(;;)
+  {
+    Channel * channel = 0;
+    BatchPtr batch;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while(ready_.empty() && !finished_)
+      {
+        condition_.wait(lock);
+      }
+      if(ready_.empty())
+      {
+        return;
+      }
+      channel = ready_.front();
+      ready_.pop_front();
+      batch = channel->queue_.front();
+      channel->queue_.pop_front();
+      --queuedBatches_;
+    }
+    condition_.notify_all();
+
+    const unsigned char * packet = batch->data_.empty() ? 0 : &batch->data_[0];
+    for(size_t nPacket = 0; nPacket < batch->sizes_.size() && !channel->stopped_; ++nPacket)
+    {
+      size_t size = batch->sizes_[nPacket];
+      // decodeBuffer reports decoding errors to the builder.
+      channel->stopped_ = !channel->assembler_.decodeBuffer(packet, size);
+      packet += size;
+    }
+
+    boost::mutex::scoped_lock lock(mutex_);
+    if(channel->queue_.empty())
+    {
+      channel->scheduled_ = false;
+    }
+    else
+    {
+      ready_.push_back(channel);
+      condition_.notify_one();
+    }
+  }
+}
@@ -0,0 +1,148 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef PCAPCHANNELDECODER_H
+#define PCAPCHANNELDECODER_H
+#include "PCapChannelDecoder_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+#include <Codecs/HeaderAnalyzer_fwd.h>
+#include <Messages/ValueMessageBuilder_fwd.h>
+#include <deque>
+
+namespace QuickFAST{
+  namespace Codecs{
+    /// @brief Decode every multicast channel in a PCap file in one pass.
+    ///
+    /// The packets in the file are sorted by destination address and port.
+    /// Each channel has its own template registry, header analyzers and
+    /// builder, and is decoded by its own MessagePerPacketAssembler.  Channels
+    /// are decoded in parallel on a pool of threads while the file is being read;
+    /// the packets of any one channel are always decoded in order by one thread
+    /// at a time.
+    ///
+    /// Channels are defined in advance with addChannel().  Packets for other
+    /// channels are offered to unknownChannel(), which a derived class can
+    /// override to add the channel on the fly.  Otherwise they are ignored.
+    class QuickFAST_Export PCapChannelDecoder
+    {
+    public:
+      PCapChannelDecoder();
+
+      /// @brief Typical virtual destructor
+      virtual ~PCapChannelDecoder();
+
+      /// @brief How many threads decode channels.
+      /// @param threadCount is the number of threads.  Zero means one per processor.
+      void setThreadCount(size_t threadCount);
+
+      /// @brief The word size of the machine that captured the file.
+      /// @param wordSize is 32 or 64; zero means the same as this machine.
+      void setWordSize(size_t wordSize);
+
+      /// @brief Apply strict decoding rules to all channels.
+      ///
+      /// Affects channels already added and channels added later.
+      /// Call before decode().
+      /// @param strict true to apply the rules.
+      void setStrict(bool strict);
+
+      /// @brief How much data to collect for a channel before it is decoded.
+      /// @param batchSize is the number of bytes of packet data.
+      void setBatchSize(size_t batchSize);
+
+      /// @brief Decode the packets sent to a multicast group and port.
+      ///
+      /// The builder is used on a decoding thread, so it must not be shared
+      /// with any other channel.
+      /// @param group is the destination address. Empty matches any address.
+      /// @param port is the destination port. Zero matches any port.
+      /// @param registry contains the templates used by this channel.
+      /// @param builder receives the decoded messages.
+      /// @param packetHeaderAnalyzer analyzes the header of each packet.
+      /// @param messageHeaderAnalyzer analyzes the header of each message.
+      void addChannel(
+        const std::string & group,
+        unsigned short port,
+        TemplateRegistryPtr registry,
+        Messages::ValueMessageBuilder & builder,
+        HeaderAnalyzer & packetHeaderAnalyzer,
+        HeaderAnalyzer & messageHeaderAnalyzer);
+
+      /// @brief Decode the packets sent to a multicast group and port.
+      ///
+      /// For channels with no packet or message headers.
+      /// @param group is the destination address. Empty matches any address.
+      /// @param port is the destination port. Zero matches any port.
+      /// @param registry contains the templates used by this channel.
+      /// @param builder receives the decoded messages.
+      void addChannel(
+        const std::string & group,
+        unsigned short port,
+        TemplateRegistryPtr registry,
+        Messages::ValueMessageBuilder & builder);
+
+      /// @brief How many channels have been added.
+      size_t channelCount()const;
+
+      /// @brief Read the PCap file and decode the channels.
+      ///
+      /// Returns after every channel has been decoded.
+      /// @param filename names the PCap file.
+      /// @returns the number of packets decoded.
+      /// @throws CommunicationError if the file cannot be read.
+      size_t decode(const std::string & filename);
+
+    protected:
+      /// @brief Packets were found for a channel that has not been added.
+      ///
+      /// Called on the thread that called decode().  A derived class may call
+      /// addChannel() here.  Called once per channel.
+      /// @param group is the destination address.
+      /// @param port is the destination port.
+      virtual void unknownChannel(const std::string & group, unsigned short port);
+
+    private:
+      PCapChannelDecoder(const PCapChannelDecoder &);
+      PCapChannelDecoder & operator=(const PCapChannelDecoder &);
+
+      struct Batch;
+      typedef boost::shared_ptr<Batch> BatchPtr;
+      struct Channel;
+      typedef boost::shared_ptr<Channel> ChannelPtr;
+      typedef std::map<uint64, ChannelPtr> ChannelMap;
+      typedef std::map<uint64, Channel *> RouteMap;
+
+      void addChannel(
+        const std::string & group,
+        unsigned short port,
+        TemplateRegistryPtr registry,
+        Messages::ValueMessageBuilder & builder,
+        HeaderAnalyzer * packetHeaderAnalyzer,
+        HeaderAnalyzer * messageHeaderAnalyzer);
+      Channel * findChannel(uint32 address, uint16 port);
+      void enqueue(Channel & channel);
+      void worker();
+
+    private:
+      size_t threadCount_;
+      size_t wordSize_;
+      bool strict_;
+      size_t batchSize_;
+      ChannelMap channels_;
+      RouteMap routes_;
+
+      boost::mutex mutex_;
+      boost::condition_variable condition_;
+      std::deque<Channel *> ready_;
+      size_t queuedBatches_;
+      size_t maxQueuedBatches_;
+      bool finished_;
+    };
+  }
+}
+#endif // PCAPCHANNELDECODER_H
@@ -9,6 +9,8 @@
 #include <Messages/ValueMessageBuilder.h>
 #include <Codecs/Decoder.h>
 #include <Common/Exceptions.h>
+#include <Common/Metrics.h>
+#include <Common/Probes.h>
 
 using namespace QuickFAST;
 using namespace Codecs;
@@ -39,6 +41,12 @@ PacketSequencingAssembler::PacketSequencingAssembler(
   , gapEnd_(0)
   , recoveryFeed_(recoveryFeed)
   , receiver_(0)
+  , deferredCount_(0)
+  , metrics_(0)
+  , gapsCounted_(0)
+  , gapPacketsCounted_(0)
+  , duplicatesCounted_(0)
+  , recoveredCounted_(0)
 {
   if(!packetHeaderAnalyzer.supportsSequenceNumber())
   {
@@ -52,6 +60,38 @@ PacketSequencingAssembler::PacketSequencingAssembler(
 
 PacketSequencingAssembler::~PacketSequencingAssembler()
 {
+  if(metrics_ != 0)
+  {
+    metrics_->remove(this);
+  }
+}
+
+void
+PacketSequencingAssembler::registerMetrics(MetricsRegistry & registry, const std::string & labels)
+{
+  BasePacketAssembler::registerMetrics(registry, labels);
+  if(metrics_ != 0)
+  {
+    metrics_->remove(this);
+  }
+  metrics_ = &registry;
+  gapsCounted_ = &registry.counter("quickfast_sequencer_gaps_total",
+    "Gaps in the packet sequence numbers.", labels, this);
+  gapPacketsCounted_ = &registry.counter("quickfast_sequencer_gap_packets_total",
+    "Packets skipped because a gap could not be filled.", labels, this);
+  duplicatesCounted_ = &registry.counter("quickfast_sequencer_duplicates_total",
+    "Packets discarded because they had already been seen.", labels, this);
+  recoveredCounted_ = &registry.counter("quickfast_sequencer_recovered_packets_total",
+    "Packets decoded from the recovery feed.", labels, this);
+  registry.addSampler("quickfast_sequencer_deferred_packets",
+    "Packets held beyond the look-ahead window.", labels, MetricsRegistry::GAUGE,
+    boost::bind(&PacketSequencingAssembler::deferredDepth, this), this);
+}
+
+double
+PacketSequencingAssembler::deferredDepth() const
+{
+  return double(deferredCount_);
 }
 
 bool
@@ -152,13 +192,13 @@ PacketSequencingAssembler::capturePacket(Communication::LinkedBuffer * buffer)
   }
   else if(sequenceNumber < nextSequenceNumber_)
   {
-    releasePacket(buffer);
+    discardDuplicate(buffer);
   }
   else if(sequenceNumber <  nextSequenceNumber_ + lookAheadCount_)
   {
     if(lookAhead_[sequenceNumber % lookAheadCount_] != 0)
     {
-      releasePacket(buffer);
+      discardDuplicate(buffer);
     }
     else
     {
@@ -175,11 +215,29 @@ PacketSequencingAssembler::capturePacket(Communication::LinkedBuffer * buffer)
 void
 PacketSequencingAssembler::processPacket(Communication::LinkedBuffer * buffer)
 {
+  if(buffer->checkAnyFlag(FROM_RECOVERY_QUEUE))
+  {
+    if(recoveredCounted_ != 0)
+    {
+      recoveredCounted_->increment();
+    }
+    QUICKFAST_PROBE2(gap_filled, nextSequenceNumber_, gapEnd_);
+  }
   decodeBuffer(buffer->get(), buffer->used());
   releasePacket(buffer);
   ++nextSequenceNumber_;
 }
 
+void
+PacketSequencingAssembler::discardDuplicate(Communication::LinkedBuffer * buffer)
+{
+  if(duplicatesCounted_ != 0)
+  {
+    duplicatesCounted_->increment();
+  }
+  releasePacket(buffer);
+}
+
 void
 PacketSequencingAssembler::releasePacket(Communication::LinkedBuffer * buffer)
 {
@@ -201,6 +259,7 @@ PacketSequencingAssembler::addToDeferred(Communication::LinkedBuffer * buffer, s
   if(positionInDeferred == 0)
   {
     deferredQueue_.push_front(buffer);
+    ++deferredCount_;
     return;
   }
 
@@ -208,9 +267,10 @@ PacketSequencingAssembler::addToDeferred(Communication::LinkedBuffer * buffer, s
   sequence_t deferredSequenceNumber = packetHeaderAnalyzer_.getSequenceNumber(deferredQueue_.peek_tail()->get());
   if(sequenceNumber == deferredSequenceNumber)
   {
-    releasePacket(buffer);
+    discardDuplicate(buffer);
     return;
   }
+  ++deferredCount_;
   if(sequenceNumber > deferredSequenceNumber)
   {
     deferredQueue_.push(buffer);
@@ -226,7 +286,8 @@ PacketSequencingAssembler::addToDeferred(Communication::LinkedBuffer * buffer, s
   }
   if(sequenceNumber == deferredSequenceNumber)
   {
-    releasePacket(buffer);
+    --deferredCount_;
+    discardDuplicate(buffer);
     return;
   }
 
@@ -240,7 +301,8 @@ PacketSequencingAssembler::addToDeferred(Communication::LinkedBuffer * buffer, s
     deferredSequenceNumber = packetHeaderAnalyzer_.getSequenceNumber(positionInDeferred->link()->get());
     if(sequenceNumber == deferredSequenceNumber)
     {
-      releasePacket(buffer);
+      --deferredCount_;
+      discardDuplicate(buffer);
       return;
     }
     if(sequenceNumber < deferredSequenceNumber)
@@ -263,13 +325,15 @@ PacketSequencingAssembler::promoteDeferred()
   Communication::LinkedBuffer * buffer = deferredQueue_.peek();
   while(buffer != 0 && packetHeaderAnalyzer_.getSequenceNumber(buffer->get()) < nextSequenceNumber_)
   {
-    releasePacket(deferredQueue_.pop());
+    --deferredCount_;
+    discardDuplicate(deferredQueue_.pop());
     buffer = deferredQueue_.peek();
   }
 
   while(buffer != 0 && packetHeaderAnalyzer_.getSequenceNumber(buffer->get()) < nextSequenceNumber_ + lookAheadCount_)
   {
     buffer = deferredQueue_.pop();
+    --deferredCount_;
     sequence_t sequenceNumber = packetHeaderAnalyzer_.getSequenceNumber(buffer->get());
     if(lookAhead_[sequenceNumber % lookAheadCount_] == 0)
     {
@@ -278,7 +342,7 @@ PacketSequencingAssembler::promoteDeferred()
     }
     else
     {
-      releasePacket(buffer);
+      discardDuplicate(buffer);
     }
     buffer = deferredQueue_.peek();
   }
@@ -292,6 +356,11 @@ PacketSequencingAssembler::handleGap()
   // If this is a new gap
   if(nextSequenceNumber_ >= gapEnd_)
   {
+    if(gapsCounted_ != 0)
+    {
+      gapsCounted_->increment();
+    }
+    QUICKFAST_PROBE2(gap_detected, nextSequenceNumber_, newGapEnd);
     gapEnd_ = newGapEnd;
     gapWait_ = false;
     if(recoveryFeed_)
@@ -320,6 +389,11 @@ PacketSequencingAssembler::handleGap()
 
   if(!gapWait_)
   {
+    if(gapPacketsCounted_ != 0)
+    {
+      gapPacketsCounted_->increment(gapEnd_ - nextSequenceNumber_);
+    }
+    QUICKFAST_PROBE2(gap_skipped, nextSequenceNumber_, gapEnd_);
     builder_.reportGap(nextSequenceNumber_, gapEnd_);
     nextSequenceNumber_ = gapEnd_;
   }
@@ -41,6 +41,11 @@ namespace QuickFAST
       // Implement Remaining Assembler method
       virtual bool serviceQueue(Communication::Receiver & receiver);
 
+      /// @brief Add quickfast_sequencer_gaps_total, gap_packets_total (packets
+      /// never recovered), duplicates_total, recovered_packets_total and the
+      /// deferred_packets gauge to the decoder's metrics.
+      virtual void registerMetrics(MetricsRegistry & registry, const std::string & labels);
+
     private:
       /// @brief Initial processing of incoming packet from any source.
       void capturePacket(Communication::LinkedBuffer * buffer);
@@ -48,6 +53,10 @@ namespace QuickFAST
       void processPacket(Communication::LinkedBuffer * buffer);
       /// @brief Packet is no longer needed.  Return it to from whence it came.
       void releasePacket(Communication::LinkedBuffer * buffer);
+      /// @brief Packet has already been seen.  Count it and release it.
+      void discardDuplicate(Communication::LinkedBuffer * buffer);
+      /// @brief How many packets are deferred; for the metrics.
+      double deferredDepth() const;
       /// @brief Packet is beyond the look-ahead array.   Hang on to it for later.
       void addToDeferred(Communication::LinkedBuffer * buffer, sequence_t sequenceNumber);
       /// @brief Promote deferred packets to the look-ahead array if possible.
@@ -80,6 +89,12 @@ namespace QuickFAST
 
       Communication::Receiver * receiver_;
 
+      size_t deferredCount_;
+      MetricsRegistry * metrics_;
+      MetricCounter * gapsCounted_;
+      MetricCounter * gapPacketsCounted_;
+      MetricCounter * duplicatesCounted_;
+      MetricCounter * recoveredCounted_;
     };
 
   }
@@ -0,0 +1,495 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "ParallelDecoder.h"
+#include <Codecs/Decoder.h>
+#include <Codecs/DataSource.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/MessageConsumer.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Messages/Message.h>
+#include <Common/MappedFile.h>
+
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Codecs;
+
+namespace
+{
+  /// Deliver one chunk of an in-memory buffer and report how much has been consumed.
+  class ChunkSource : public DataSource
+  {
+  public:
+    ChunkSource(const uchar * buffer, size_t length)
+      : buffer_(buffer)
+      , length_(length)
+      , first_(true)
+    {
+    }
+
+    size_t offset()const
+    {
+      return currentPosition();
+    }
+
+    virtual bool getBuffer(const uchar *& buffer, size_t & size)
+    {
+      if(!first_)
+      {
+        return false;
+      }
+      first_ = false;
+      buffer = buffer_;
+      size = length_;
+      return length_ > 0;
+    }
+  private:
+    const uchar * buffer_;
+    size_t length_;
+    bool first_;
+  };
+
+  // Chunks decoded ahead of the in-order delivery point, per worker thread.
+  const size_t chunksAheadPerThread = 2;
+  // How often (in messages) a worker checks whether its chunk has been abandoned.
+  const size_t abandonCheckInterval = 1024;
+}
+
+ParallelDecoder::ParallelDecoder(TemplateRegistryPtr registry)
+  : registry_(registry)
+  , threadCount_(0)
+  , chunkSize_(16 * 1024 * 1024)
+  , strict_(true)
+  , pmapBytes_(0)
+  , data_(0)
+  , size_(0)
+  , handler_(0)
+  , nextChunk_(0)
+  , chainChunk_(0)
+  , maxInFlight_(0)
+  , stopping_(false)
+{
+  // one extra bit for the template id
+  pmapBytes_ = (registry_->presenceMapBits() + 1 + 6) / 7;
+  resetIds_.push_back(template_id_t(Context::SCPResetTemplateId));
+  for(TemplateRegistry::const_iterator it = registry_->begin();
+    it != registry_->end();
+    ++it)
+  {
+    if(it->second->getReset())
+    {
+      resetIds_.push_back(it->second->getId());
+    }
+  }
+}
+
+ParallelDecoder::~ParallelDecoder()
+{
+}
+
+void
+ParallelDecoder::setThreadCount(size_t threadCount)
+{
+  threadCount_ = threadCount;
+}
+
+void
+ParallelDecoder::setChunkSize(size_t chunkSize)
+{
+  chunkSize_ = chunkSize;
+  if(chunkSize_ == 0)
+  {
+    chunkSize_ = 1;
+  }
+}
+
+void
+ParallelDecoder::setStrict(bool strict)
+{
+  strict_ = strict;
+}
+
+bool
+ParallelDecoder::isResetTemplate(template_id_t id)const
+{
+  return std::find(resetIds_.begin(), resetIds_.end(), id) != resetIds_.end();
+}
+
+size_t
+ParallelDecoder::findResetPoint(const uchar * data, size_t size, size_t from)const
+{
+  for(size_t pos = (from == 0) ? 1 : from; pos < size; ++pos)
+  {
+    // A message starts after a byte with the stop bit set.
+    // Its presence map must have the template id bit set.
+    if((data[pos - 1] & 0x80) == 0 || (data[pos] & 0x40) == 0)
+    {
+      continue;
+    }
+    size_t end = pos;
+    while(end < size && end - pos < pmapBytes_ && (data[end] & 0x80) == 0)
+    {
+      ++end;
+    }
+    if(end >= size || (data[end] & 0x80) == 0)
+    {
+      continue;
+    }
+    ++end;
+    // The template id is a stop bit encoded unsigned integer.
+    template_id_t id = 0;
+    size_t idEnd = end;
+    bool stopped = false;
+    while(!stopped && idEnd < size && idEnd - end < 5)
+    {
+      id = (id << 7) | (data[idEnd] & 0x7F);
+      stopped = (data[idEnd] & 0x80) != 0;
+      ++idEnd;
+    }
+    if(stopped && isResetTemplate(id))
+    {
+      return pos;
+    }
+  }
+  return size;
+}
+
+size_t
+ParallelDecoder::decode(const uchar * data, size_t size, ChunkHandler & handler)
+{
+  data_ = data;
+  size_ = size;
+  handler_ = &handler;
+  chunks_.clear();
+  nextChunk_ = 0;
+  chainChunk_ = 0;
+  stopping_ = false;
+
+  chunks_.push_back(Chunk(0));
+  size_t target = chunkSize_;
+  while(target < size)
+  {
+    size_t point = findResetPoint(data, size, target);
+    if(point >= size)
+    {
+      break;
+    }
+    chunks_.push_back(Chunk(point));
+    target = point + chunkSize_;
+  }
+
+  size_t threadCount = threadCount_;
+  if(threadCount == 0)
+  {
+    threadCount = boost::thread::hardware_concurrency();
+  }
+  if(threadCount == 0)
+  {
+    threadCount = 1;
+  }
+  if(threadCount > chunks_.size())
+  {
+    threadCount = chunks_.size();
+  }
+  maxInFlight_ = threadCount * chunksAheadPerThread;
+
+  handler.startDecoding(chunks_.size());
+  boost::thread_group threads;
+  for(size_t nThread = 0; nThread < threadCount; ++nThread)
+  {
+    threads.create_thread(boost::bind(&ParallelDecoder::worker, this));
+  }
+
+  size_t messageCount = 0;
+  std::string error;
+  size_t chunk = 0;
+  std::vector<bool> delivered(chunks_.size(), false);
+  while(chunk < chunks_.size())
+  {
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while(!chunks_[chunk].done_)
+      {
+        condition_.wait(lock);
+      }
+    }
+    Chunk & current = chunks_[chunk];
+    delivered[chunk] = true;
+    bool more = handler.chunkDecoded(chunk);
+    messageCount += current.messageCount_;
+    if(current.failed_)
+    {
+      error = current.error_;
+      more = false;
+    }
+    size_t land = current.land_;
+    // Chunks between here and the landing point started in the middle
+    // of a message that has already been decoded.
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      for(size_t skip = chunk + 1; skip < land; ++skip)
+      {
+        chunks_[skip].abandon_ = true;
+      }
+      chainChunk_ = land;
+      stopping_ = !more;
+    }
+    condition_.notify_all();
+    if(!more)
+    {
+      break;
+    }
+    chunk = land;
+  }
+
+  threads.join_all();
+  for(size_t skip = 0; skip < chunks_.size(); ++skip)
+  {
+    if(chunks_[skip].started_ && !delivered[skip])
+    {
+      handler.chunkDiscarded(skip);
+    }
+  }
+  handler.endDecoding();
+  handler_ = 0;
+  if(!error.empty())
+  {
+    throw EncodingError(error);
+  }
+  return messageCount;
+}
+
+size_t
+ParallelDecoder::decode(MappedFile & file, ChunkHandler & handler)
+{
+  uint64 fileSize = file.size();
+  if(fileSize > uint64(size_t(-1)))
+  {
+    throw UsageError("Parallel Decoder", "File is too large to map in this address space.");
+  }
+  size_t size = size_t(fileSize);
+  if(size == 0)
+  {
+    return decode(0, 0, handler);
+  }
+  // Chunks are decoded in any order, so the data is mapped in one piece
+  // rather than through the file's moving window.
+  const uchar * data = file.map(0, size);
+  if(data == 0)
+  {
+    throw UsageError("Parallel Decoder", "Cannot map file.");
+  }
+  return decode(data, size, handler);
+}
+
+void
+ParallelDecoder::worker()
+{
+  for(;;)
+  {
+    size_t chunk = 0;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while(!stopping_
+        && nextChunk_ < chunks_.size()
+        && nextChunk_ >= chainChunk_ + maxInFlight_)
+      {
+        condition_.wait(lock);
+      }
+      if(stopping_ || nextChunk_ >= chunks_.size())
+      {
+        return;
+      }
+      chunk = nextChunk_++;
+      if(chunks_[chunk].abandon_)
+      {
+        chunks_[chunk].done_ = true;
+        continue;
+      }
+      chunks_[chunk].started_ = true;
+    }
+    decodeChunk(chunk);
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      chunks_[chunk].done_ = true;
+    }
+    condition_.notify_all();
+  }
+}
+
+void
+ParallelDecoder::decodeChunk(size_t chunk)
+{
+  Chunk & current = chunks_[chunk];
+  size_t chunkCount = chunks_.size();
+  current.land_ = chunkCount;
+  try
+  {
+    Messages::ValueMessageBuilder & builder = handler_->chunkBuilder(chunk);
+    Decoder decoder(registry_);
+    decoder.setStrict(strict_);
+    decoder.setExceptionFree(true);
+    size_t length = size_ - current.start_;
+    ChunkSource source(data_ + current.start_, length);
+    size_t next = chunk + 1;
+    bool more = true;
+    while(more && source.offset() < length)
+    {
+      if(!decoder.decodeMessage(source, builder))
+      {
+        current.failed_ = true;
+        current.error_ = std::string(decoder.getErrorCode()) + ' ' + decoder.getErrorMessage();
+        break;
+      }
+      ++current.messageCount_;
+      // Stop on reaching the start of a later chunk.
+      size_t position = current.start_ + source.offset();
+      while(next < chunkCount && chunks_[next].start_ < position)
+      {
+        ++next;
+      }
+      if(next < chunkCount && chunks_[next].start_ == position)
+      {
+        current.land_ = next;
+        more = false;
+      }
+      else if(current.messageCount_ % abandonCheckInterval == 0)
+      {
+        boost::mutex::scoped_lock lock(mutex_);
+        more = !current.abandon_ && !stopping_;
+      }
+    }
+  }
+  catch (const std::exception & ex)
+  {
+    current.failed_ = true;
+    current.error_ = ex.what();
+  }
+}
+
+///////////////////////////
+// OrderedMessageHandler
+
+/// Collect the messages from one chunk until they can be delivered.
+class OrderedMessageHandler::ChunkCollector : public MessageConsumer
+{
+public:
+  ChunkCollector()
+    : builder_(*this)
+  {
+  }
+
+  Messages::ValueMessageBuilder & builder()
+  {
+    return builder_;
+  }
+
+  bool deliver(MessageConsumer & consumer)
+  {
+    bool more = true;
+    for(size_t nError = 0; more && nError < errors_.size(); ++nError)
+    {
+      more = consumer.reportDecodingError(errors_[nError]);
+    }
+    for(size_t nMessage = 0; more && nMessage < messages_.size(); ++nMessage)
+    {
+      more = consumer.consumeMessage(*messages_[nMessage]);
+    }
+    return more;
+  }
+
+  ////////////////////////////
+  // Implement MessageConsumer
+  virtual bool consumeMessage(Messages::Message & message)
+  {
+    Messages::MessagePtr kept(new Messages::Message(0));
+    kept->swap(message);
+    messages_.push_back(kept);
+    return true;
+  }
+
+  virtual void decodingStarted()
+  {
+  }
+
+  virtual void decodingStopped()
+  {
+  }
+
+  ///////////////////
+  // Implement Logger
+  virtual bool wantLog(unsigned short /*level*/)
+  {
+    return false;
+  }
+
+  virtual bool logMessage(unsigned short /*level*/, const std::string & /*logMessage*/)
+  {
+    return true;
+  }
+
+  virtual bool reportDecodingError(const std::string & errorMessage)
+  {
+    errors_.push_back(errorMessage);
+    return true;
+  }
+
+  virtual bool reportCommunicationError(const std::string & errorMessage)
+  {
+    errors_.push_back(errorMessage);
+    return true;
+  }
+
+private:
+  GenericMessageBuilder builder_;
+  std::vector<Messages::MessagePtr> messages_;
+  std::vector<std::string> errors_;
+};
+
+OrderedMessageHandler::OrderedMessageHandler(MessageConsumer & consumer)
+  : consumer_(consumer)
+{
+}
+
+OrderedMessageHandler::~OrderedMessageHandler()
+{
+}
+
+void
+OrderedMessageHandler::startDecoding(size_t chunkCount)
+{
+  collectors_.clear();
+  collectors_.resize(chunkCount);
+  for(size_t nChunk = 0; nChunk < chunkCount; ++nChunk)
+  {
+    collectors_[nChunk].reset(new ChunkCollector);
+  }
+  consumer_.decodingStarted();
+}
+
+Messages::ValueMessageBuilder &
+OrderedMessageHandler::chunkBuilder(size_t chunk)
+{
+  return collectors_[chunk]->builder();
+}
+
+bool
+OrderedMessageHandler::chunkDecoded(size_t chunk)
+{
+  bool more = collectors_[chunk]->deliver(consumer_);
+  collectors_[chunk].reset();
+  return more;
+}
+
+void
+OrderedMessageHandler::chunkDiscarded(size_t chunk)
+{
+  collectors_[chunk].reset();
+}
+
+void
+OrderedMessageHandler::endDecoding()
+{
+  collectors_.clear();
+  consumer_.decodingStopped();
+}
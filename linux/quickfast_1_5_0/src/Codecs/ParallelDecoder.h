@@ -0,0 +1,205 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef PARALLELDECODER_H
+#define PARALLELDECODER_H
+#include "ParallelDecoder_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+#include <Codecs/TemplateRegistry_fwd.h>
+#include <Codecs/MessageConsumer_fwd.h>
+#include <Messages/ValueMessageBuilder_fwd.h>
+
+namespace QuickFAST{
+  class MappedFile;
+  namespace Codecs{
+    /// @brief Decode a complete FAST file using several threads.
+    ///
+    /// A FAST stream can only be decoded from a point at which the dictionaries
+    /// are known to be empty: the start of the stream, or a message that resets
+    /// the dictionaries (the SCP reset template, id 120, or any template
+    /// marked reset="yes").  The ParallelDecoder finds such reset points near
+    /// regular intervals in the data, splits the data into chunks at those points
+    /// and decodes each chunk with its own Decoder on a pool of worker threads.
+    ///
+    /// Reset points are found by pattern matching, so a few of them may turn out
+    /// to be coincidences in the middle of some other message.  A chunk's results
+    /// are accepted only when the decoding of the preceding chunk ends exactly
+    /// at the start of the chunk.  Chunks that are not reached this way are
+    /// discarded because they have been decoded as part of an earlier chunk.
+    ///
+    /// Results are delivered to a ChunkHandler.  Each chunk has its own
+    /// ValueMessageBuilder which is filled on a worker thread; the handler is then
+    /// told, in original order and on the thread that called decode(), that the
+    /// chunk is complete.  OrderedMessageHandler is a ChunkHandler that delivers
+    /// the decoded messages to a MessageConsumer in their original order.
+    class QuickFAST_Export ParallelDecoder
+    {
+    public:
+      /// @brief Receives the results of decoding.
+      class ChunkHandler
+      {
+      public:
+        /// @brief A typical virtual destructor.
+        virtual ~ChunkHandler(){}
+
+        /// @brief Called before any chunk is decoded.
+        /// @param chunkCount is the number of chunks.
+        virtual void startDecoding(size_t chunkCount) = 0;
+
+        /// @brief Supply the builder to receive the messages from a chunk.
+        ///
+        /// Called on a worker thread, so different chunks must not share a builder.
+        /// @param chunk identifies the chunk.
+        /// @returns the builder to be used for this chunk.
+        virtual Messages::ValueMessageBuilder & chunkBuilder(size_t chunk) = 0;
+
+        /// @brief A chunk has been decoded and its results are valid.
+        ///
+        /// Called in chunk order on the thread that called decode().
+        /// @param chunk identifies the chunk.
+        /// @returns false to stop decoding.
+        virtual bool chunkDecoded(size_t chunk) = 0;
+
+        /// @brief A chunk did not start at a message boundary; its results should be dropped.
+        ///
+        /// Called on the thread that called decode().
+        /// @param chunk identifies the chunk.
+        virtual void chunkDiscarded(size_t chunk) = 0;
+
+        /// @brief Called after all chunks are accounted for.
+        virtual void endDecoding() = 0;
+      };
+
+      /// @brief Construct with the templates used to decode the data.
+      /// @param registry contains the templates.
+      explicit ParallelDecoder(TemplateRegistryPtr registry);
+
+      /// @brief Typical destructor
+      ~ParallelDecoder();
+
+      /// @brief How many worker threads to use.
+      /// @param threadCount is the number of threads. Zero means one per processor.
+      void setThreadCount(size_t threadCount);
+
+      /// @brief How much data to aim for in each chunk.
+      /// @param chunkSize is the approximate chunk size in bytes.
+      void setChunkSize(size_t chunkSize);
+
+      /// @brief Apply strict decoding rules.
+      /// @param strict true to apply the rules.
+      void setStrict(bool strict);
+
+      /// @brief Find the first possible reset message at or after a position.
+      /// @param data is the FAST encoded data.
+      /// @param size is the number of bytes of data.
+      /// @param from is the position at which to start searching.
+      /// @returns the position of the reset message, or size if none was found.
+      size_t findResetPoint(const uchar * data, size_t size, size_t from)const;
+
+      /// @brief Decode FAST encoded data.
+      ///
+      /// Returns when all the data has been decoded or the handler has asked
+      /// to stop.
+      /// @param data is the FAST encoded data.  It must begin at a message boundary.
+      /// @param size is the number of bytes of data.
+      /// @param handler receives the results.
+      /// @returns the number of messages decoded, including reset messages.
+      /// @throws EncodingError if the data cannot be decoded.  Results from
+      ///         before the error have been delivered to the handler.
+      size_t decode(const uchar * data, size_t size, ChunkHandler & handler);
+
+      /// @brief Decode a memory mapped FAST file.
+      ///
+      /// The whole file is mapped at once, whatever the file's window size,
+      /// so it must fit in the address space (any file on a 64 bit system).
+      /// @param file is the open file.  It must begin at a message boundary.
+      /// @param handler receives the results.
+      /// @returns the number of messages decoded, including reset messages.
+      /// @throws UsageError if the file cannot be mapped.
+      /// @throws EncodingError if the data cannot be decoded.
+      size_t decode(MappedFile & file, ChunkHandler & handler);
+
+    private:
+      ParallelDecoder(const ParallelDecoder &);
+      ParallelDecoder & operator=(const ParallelDecoder &);
+
+      struct Chunk
+      {
+        Chunk(size_t start)
+          : start_(start)
+          , land_(0)
+          , messageCount_(0)
+          , started_(false)
+          , done_(false)
+          , abandon_(false)
+          , failed_(false)
+        {
+        }
+        size_t start_;
+        size_t land_;
+        size_t messageCount_;
+        bool started_;
+        bool done_;
+        bool abandon_;
+        bool failed_;
+        std::string error_;
+      };
+
+      void worker();
+      void decodeChunk(size_t chunk);
+      bool isResetTemplate(template_id_t id)const;
+
+    private:
+      TemplateRegistryPtr registry_;
+      size_t threadCount_;
+      size_t chunkSize_;
+      bool strict_;
+      size_t pmapBytes_;
+      std::vector<template_id_t> resetIds_;
+
+      // state used during decode()
+      const uchar * data_;
+      size_t size_;
+      ChunkHandler * handler_;
+      std::vector<Chunk> chunks_;
+      size_t nextChunk_;
+      size_t chainChunk_;
+      size_t maxInFlight_;
+      bool stopping_;
+      boost::mutex mutex_;
+      boost::condition_variable condition_;
+    };
+
+    /// @brief A ParallelDecoder::ChunkHandler that delivers messages in their original order.
+    ///
+    /// Each chunk's messages are held in memory until all earlier chunks have been
+    /// delivered, then they are passed to the consumer one at a time.
+    class QuickFAST_Export OrderedMessageHandler : public ParallelDecoder::ChunkHandler
+    {
+    public:
+      /// @brief Construct
+      /// @param consumer receives the decoded messages in order.
+      explicit OrderedMessageHandler(MessageConsumer & consumer);
+      virtual ~OrderedMessageHandler();
+
+      ///////////////////////////
+      // Implement ChunkHandler
+      virtual void startDecoding(size_t chunkCount);
+      virtual Messages::ValueMessageBuilder & chunkBuilder(size_t chunk);
+      virtual bool chunkDecoded(size_t chunk);
+      virtual void chunkDiscarded(size_t chunk);
+      virtual void endDecoding();
+
+    private:
+      class ChunkCollector;
+      typedef boost::shared_ptr<ChunkCollector> ChunkCollectorPtr;
+      std::vector<ChunkCollectorPtr> collectors_;
+      MessageConsumer & consumer_;
+    };
+  }
+}
+#endif // PARALLELDECODER_H
@@ -0,0 +1,19 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef PARALLELDECODER_FWD_H
+#define PARALLELDECODER_FWD_H
+#ifndef QUICKFAST_HEADERS
+#error Please include <Application/QuickFAST.h> preferably as a precompiled header file.
+#endif //QUICKFAST_HEADERS
+
+namespace QuickFAST{
+  namespace Codecs{
+    class ParallelDecoder;
+    class OrderedMessageHandler;
+  }
+}
+#endif // PARALLELDECODER_FWD_H
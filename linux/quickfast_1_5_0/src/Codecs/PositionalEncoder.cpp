@@ -0,0 +1,640 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "PositionalEncoder.h"
+#include <Codecs/Encoder.h>
+#include <Codecs/Template.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/FieldInstruction.h>
+#include <Codecs/FieldInstructionTemplateRef.h>
+#include <Codecs/FieldInstructionUInt32.h>
+#include <Common/Exceptions.h>
+
+using namespace ::QuickFAST;
+using namespace ::QuickFAST::Codecs;
+
+PositionalEncoder::PositionalEncoder(Encoder & encoder, DataDestination & destination)
+  : encoder_(encoder)
+  , destination_(destination)
+  , pmapDepth_(0)
+{
+}
+
+PositionalEncoder::~PositionalEncoder()
+{
+}
+
+bool
+PositionalEncoder::findSlot(template_id_t templateId, const std::string & name, size_t & slot)
+{
+  TemplateCPtr templatePtr;
+  if(!encoder_.getTemplateRegistry()->getTemplate(templateId, templatePtr))
+  {
+    return false;
+  }
+  return findSlot(SegmentBodyCPtr(templatePtr), name, slot);
+}
+
+bool
+PositionalEncoder::findSlot(const SegmentBodyCPtr & segment, const std::string & name, size_t & slot)
+{
+  size_t position = 0;
+  if(countSlots(segment, name, position))
+  {
+    slot = position;
+    return true;
+  }
+  return false;
+}
+
+bool
+PositionalEncoder::countSlots(const SegmentBodyCPtr & segment, const std::string & name, size_t & slot)
+{
+  size_t instructionCount = segment->size();
+  for(size_t nField = 0; nField < instructionCount; ++nField)
+  {
+    const FieldInstructionCPtr & instruction = segment->getInstruction(nField);
+    if(instruction->fieldInstructionType() == ValueType::TEMPLATEREF)
+    {
+      // the fields of a static templateRef are numbered in line.
+      const FieldInstructionStaticTemplateRef * reference =
+        dynamic_cast<const FieldInstructionStaticTemplateRef *>(instruction.get());
+      TemplateCPtr target;
+      if(reference != 0
+        && encoder_.findTemplate(reference->templateName(), reference->templateNamespace(), target)
+        && countSlots(target, name, slot))
+      {
+        return true;
+      }
+    }
+    else
+    {
+      if(instruction->getIdentity().name() == name)
+      {
+        return true;
+      }
+      ++slot;
+    }
+  }
+  return false;
+}
+
+void
+PositionalEncoder::startMessage(template_id_t templateId)
+{
+  frames_.clear();
+  pmapDepth_ = 0;
+
+  TemplateCPtr templatePtr;
+  if(!encoder_.getTemplateRegistry()->getTemplate(templateId, templatePtr))
+  {
+    throw EncodingError("[ERR D9] Unknown template ID.");
+  }
+  destination_.startMessage(templateId);
+  if(templatePtr->getReset())
+  {
+    encoder_.reset(true);
+  }
+
+  size_t pmap = pushPresenceMap(templatePtr->presenceMapBitCount());
+  DataDestination::BufferHandle header = destination_.startBuffer();
+  destination_.startBuffer();
+  // can we "copy" the template ID?
+  if(templateId == encoder_.getTemplateId())
+  {
+    pmaps_[pmap]->setNextField(false);
+  }
+  else
+  {
+    pmaps_[pmap]->setNextField(true);
+    FieldInstruction::encodeUnsignedInteger(destination_, encoder_.getWorkingBuffer(), templateId);
+    encoder_.setTemplateId(templateId);
+  }
+  pushFrame(MESSAGE, templatePtr, pmap);
+  frames_.back().pmapBuffer_ = header;
+}
+
+void
+PositionalEncoder::endMessage()
+{
+  if(frames_.empty())
+  {
+    throw UsageError("Coding Error", "PositionalEncoder::endMessage without startMessage.");
+  }
+  finishSegment();
+  if(frames_.size() != 1 || frames_.back().kind_ != MESSAGE)
+  {
+    throw UsageError("Coding Error", "PositionalEncoder group or sequence not ended before endMessage.");
+  }
+  Frame & frame = frames_.back();
+  DataDestination::BufferHandle savedBuffer = destination_.getBuffer();
+  destination_.selectBuffer(frame.pmapBuffer_);
+  static Messages::FieldIdentity pmapIdentity("PMAP", "Message");
+  destination_.startField(pmapIdentity);
+  pmaps_[frame.pmap_]->encode(destination_);
+  destination_.endField(pmapIdentity);
+  destination_.selectBuffer(savedBuffer);
+  destination_.endMessage();
+  frames_.pop_back();
+  pmapDepth_ = 0;
+}
+
+void
+PositionalEncoder::addValue(int64 value)
+{
+  value_.setSigned(value);
+  encodeNext();
+}
+
+void
+PositionalEncoder::addValue(uint64 value)
+{
+  value_.setUnsigned(value);
+  encodeNext();
+}
+
+void
+PositionalEncoder::addValue(int32 value)
+{
+  value_.setSigned(value);
+  encodeNext();
+}
+
+void
+PositionalEncoder::addValue(uint32 value)
+{
+  value_.setUnsigned(value);
+  encodeNext();
+}
+
+void
+PositionalEncoder::addValue(int16 value)
+{
+  value_.setSigned(value);
+  encodeNext();
+}
+
+void
+PositionalEncoder::addValue(uint16 value)
+{
+  value_.setUnsigned(value);
+  encodeNext();
+}
+
+void
+PositionalEncoder::addValue(int8 value)
+{
+  value_.setSigned(value);
+  encodeNext();
+}
+
+void
+PositionalEncoder::addValue(uchar value)
+{
+  value_.setUnsigned(value);
+  encodeNext();
+}
+
+void
+PositionalEncoder::addValue(const Decimal & value)
+{
+  value_.setDecimal(value);
+  encodeNext();
+}
+
+void
+PositionalEncoder::addValue(const unsigned char * value, size_t length)
+{
+  value_.setString(value, length);
+  encodeNext();
+}
+
+void
+PositionalEncoder::addValue(const std::string & value)
+{
+  value_.setString(reinterpret_cast<const unsigned char *>(value.data()), value.size());
+  encodeNext();
+}
+
+void
+PositionalEncoder::addAbsent()
+{
+  value_.clear();
+  encodeNext();
+}
+
+void
+PositionalEncoder::skipTo(size_t slot)
+{
+  if(frames_.empty())
+  {
+    throw UsageError("Coding Error", "PositionalEncoder::skipTo without startMessage.");
+  }
+  while(frames_[frames_.back().owner_].slot_ < slot)
+  {
+    addAbsent();
+  }
+}
+
+void
+PositionalEncoder::startGroup()
+{
+  const FieldInstruction & instruction = requireInstruction(ValueType::GROUP, "Next field is not a group.");
+  SegmentBodyPtr segment;
+  if(!instruction.getSegmentBody(segment))
+  {
+    encoder_.reportFatal("[ERR U08]", "Segment not defined for Group instruction.");
+    // still here in exception-free mode, but there is nothing to encode the group with.
+    throw EncodingError("[ERR U08] Segment not defined for Group instruction.");
+  }
+  if(!instruction.isMandatory())
+  {
+    pmaps_[frames_.back().pmap_]->setNextField(true);
+  }
+  destination_.startField(instruction.getIdentity());
+  advance();
+  openSegment(GROUP, segment, &instruction);
+}
+
+void
+PositionalEncoder::endGroup()
+{
+  const FieldInstruction * instruction = closeSegment(GROUP, "PositionalEncoder::endGroup does not match startGroup.");
+  destination_.endField(instruction->getIdentity());
+}
+
+void
+PositionalEncoder::startSequence(size_t length)
+{
+  const FieldInstruction & instruction = requireInstruction(ValueType::SEQUENCE, "Next field is not a sequence.");
+  SegmentBodyPtr segment;
+  if(!instruction.getSegmentBody(segment))
+  {
+    encoder_.reportFatal("[ERR U07]", "SegmentBody not defined for Sequence instruction.");
+    throw EncodingError("[ERR U07] SegmentBody not defined for Sequence instruction.");
+  }
+  size_t pmap = frames_.back().pmap_;
+  destination_.startField(instruction.getIdentity());
+  value_.setUnsigned(length);
+  FieldInstructionCPtr lengthInstruction;
+  if(segment->getLengthInstruction(lengthInstruction))
+  {
+    lengthInstruction->encode(destination_, *pmaps_[pmap], encoder_, value_);
+  }
+  else
+  {
+    FieldInstructionUInt32 defaultLengthInstruction;
+    defaultLengthInstruction.setPresence(instruction.isMandatory());
+    defaultLengthInstruction.encode(destination_, *pmaps_[pmap], encoder_, value_);
+  }
+  advance();
+  pushFrame(SEQUENCE, segment, pmap);
+  frames_.back().instruction_ = &instruction;
+  frames_.back().remaining_ = length;
+}
+
+void
+PositionalEncoder::startSequenceEntry()
+{
+  if(frames_.empty() || frames_.back().kind_ != SEQUENCE)
+  {
+    throw UsageError("Coding Error", "PositionalEncoder::startSequenceEntry outside a sequence.");
+  }
+  Frame & sequence = frames_.back();
+  if(sequence.remaining_ == 0)
+  {
+    throw UsageError("Coding Error", "PositionalEncoder sequence has more entries than its length.");
+  }
+  --sequence.remaining_;
+  SegmentBodyCPtr segment = sequence.segment_;
+  openSegment(ENTRY, segment, sequence.instruction_);
+}
+
+void
+PositionalEncoder::endSequenceEntry()
+{
+  closeSegment(ENTRY, "PositionalEncoder::endSequenceEntry does not match startSequenceEntry.");
+}
+
+void
+PositionalEncoder::endSequence()
+{
+  if(frames_.empty() || frames_.back().kind_ != SEQUENCE)
+  {
+    throw UsageError("Coding Error", "PositionalEncoder::endSequence does not match startSequence.");
+  }
+  if(frames_.back().remaining_ != 0)
+  {
+    throw UsageError("Coding Error", "PositionalEncoder sequence has fewer entries than its length.");
+  }
+  destination_.endField(frames_.back().instruction_->getIdentity());
+  frames_.pop_back();
+}
+
+const FieldInstruction *
+PositionalEncoder::nextInstruction()
+{
+  while(!frames_.empty())
+  {
+    Frame & frame = frames_.back();
+    if(frame.kind_ == SEQUENCE)
+    {
+      return 0;
+    }
+    if(frame.position_ < frame.segment_->size())
+    {
+      const FieldInstructionCPtr & instruction = frame.segment_->getInstruction(frame.position_);
+      if(instruction->fieldInstructionType() != ValueType::TEMPLATEREF)
+      {
+        return instruction.get();
+      }
+      ++frame.position_;
+      const FieldInstructionStaticTemplateRef * reference =
+        dynamic_cast<const FieldInstructionStaticTemplateRef *>(instruction.get());
+      if(reference == 0)
+      {
+        encoder_.reportFatal("[ERR I1]", "Encoding dynamic templates is not supported.");
+        continue;
+      }
+      TemplateCPtr target;
+      if(!encoder_.findTemplate(reference->templateName(), reference->templateNamespace(), target))
+      {
+        encoder_.reportFatal("[ERR D9]", "Unknown template name for static templateref.", instruction->getIdentity());
+        continue;
+      }
+      size_t pmap = frame.pmap_;
+      size_t owner = frame.owner_;
+      pushFrame(MERGED, target, pmap);
+      frames_.back().owner_ = owner;
+    }
+    else if(frame.kind_ == MERGED)
+    {
+      frames_.pop_back();
+    }
+    else
+    {
+      return 0;
+    }
+  }
+  return 0;
+}
+
+const FieldInstruction &
+PositionalEncoder::requireInstruction(ValueType::Type type, const char * message)
+{
+  const FieldInstruction * instruction = nextInstruction();
+  if(instruction == 0 || instruction->fieldInstructionType() != type)
+  {
+    throw UsageError("Coding Error", message);
+  }
+  return *instruction;
+}
+
+void
+PositionalEncoder::encodeNext()
+{
+  const FieldInstruction * instruction = nextInstruction();
+  if(instruction == 0)
+  {
+    throw UsageError("Coding Error", "PositionalEncoder has more values than the segment has fields.");
+  }
+  if(value_.isPresent(instruction->getIdentity()))
+  {
+    ValueType::Type type = instruction->fieldInstructionType();
+    if(type == ValueType::GROUP || type == ValueType::SEQUENCE)
+    {
+      throw UsageError("Coding Error", "PositionalEncoder value supplied for a group or sequence.");
+    }
+  }
+  destination_.startField(instruction->getIdentity());
+  instruction->encode(destination_, *pmaps_[frames_.back().pmap_], encoder_, value_);
+  destination_.endField(instruction->getIdentity());
+  advance();
+}
+
+void
+PositionalEncoder::advance()
+{
+  Frame & frame = frames_.back();
+  ++frame.position_;
+  ++frames_[frame.owner_].slot_;
+}
+
+void
+PositionalEncoder::finishSegment()
+{
+  while(nextInstruction() != 0)
+  {
+    addAbsent();
+  }
+}
+
+void
+PositionalEncoder::pushFrame(FrameKind kind, const SegmentBodyCPtr & segment, size_t pmap)
+{
+  Frame frame;
+  frame.kind_ = kind;
+  frame.segment_ = segment;
+  frame.position_ = 0;
+  frame.slot_ = 0;
+  frame.owner_ = frames_.size();
+  frame.pmap_ = pmap;
+  frame.pmapBuffer_ = 0;
+  frame.instruction_ = 0;
+  frame.remaining_ = 0;
+  frames_.push_back(frame);
+}
+
+size_t
+PositionalEncoder::pushPresenceMap(size_t bitCount)
+{
+  if(pmapDepth_ == pmaps_.size())
+  {
+    pmaps_.push_back(boost::shared_ptr<PresenceMap>(new PresenceMap(bitCount)));
+  }
+  else
+  {
+    pmaps_[pmapDepth_]->reset(bitCount);
+  }
+  return pmapDepth_++;
+}
+
+void
+PositionalEncoder::openSegment(FrameKind kind, const SegmentBodyCPtr & segment, const FieldInstruction * instruction)
+{
+  // The presence map goes at the end of the current buffer;
+  // the body starts a new one.  (See Encoder::encodeGroup)
+  size_t presenceMapBits = segment->presenceMapBitCount();
+  DataDestination::BufferHandle pmapBuffer = destination_.getBuffer();
+  if(presenceMapBits > 0)
+  {
+    destination_.startBuffer();
+  }
+  pushFrame(kind, segment, pushPresenceMap(presenceMapBits));
+  frames_.back().pmapBuffer_ = pmapBuffer;
+  frames_.back().instruction_ = instruction;
+}
+
+const FieldInstruction *
+PositionalEncoder::closeSegment(FrameKind kind, const char * message)
+{
+  if(frames_.empty())
+  {
+    throw UsageError("Coding Error", message);
+  }
+  finishSegment();
+  if(frames_.back().kind_ != kind)
+  {
+    throw UsageError("Coding Error", message);
+  }
+  Frame & frame = frames_.back();
+  const FieldInstruction * instruction = frame.instruction_;
+  if(frame.segment_->presenceMapBitCount() > 0)
+  {
+    DataDestination::BufferHandle bodyBuffer = destination_.getBuffer();
+    destination_.selectBuffer(frame.pmapBuffer_);
+    static Messages::FieldIdentity pmapIdentity("PMAP", "Group");
+    destination_.startField(pmapIdentity);
+    pmaps_[frame.pmap_]->encode(destination_);
+    destination_.endField(pmapIdentity);
+    destination_.selectBuffer(bodyBuffer);
+  }
+  --pmapDepth_;
+  frames_.pop_back();
+  return instruction;
+}
+
+///////////////////
+// ValueAccessor
+
+PositionalEncoder::ValueAccessor::ValueAccessor()
+  : kind_(NONE)
+  , signed_(0)
+  , unsigned_(0)
+{
+}
+
+void
+PositionalEncoder::ValueAccessor::setSigned(int64 value)
+{
+  kind_ = SIGNED;
+  signed_ = value;
+}
+
+void
+PositionalEncoder::ValueAccessor::setUnsigned(uint64 value)
+{
+  kind_ = UNSIGNED;
+  unsigned_ = value;
+}
+
+void
+PositionalEncoder::ValueAccessor::setDecimal(const Decimal & value)
+{
+  kind_ = DECIMAL;
+  decimal_ = value;
+}
+
+void
+PositionalEncoder::ValueAccessor::setString(const unsigned char * value, size_t length)
+{
+  kind_ = STRING;
+  string_.assign(value, length);
+}
+
+void
+PositionalEncoder::ValueAccessor::clear()
+{
+  kind_ = NONE;
+}
+
+bool
+PositionalEncoder::ValueAccessor::isPresent(const Messages::FieldIdentity & /*identity*/)const
+{
+  return kind_ != NONE;
+}
+
+bool
+PositionalEncoder::ValueAccessor::getUnsignedInteger(const Messages::FieldIdentity & /*identity*/, ValueType::Type /*type*/, uint64 & value)const
+{
+  if(kind_ == UNSIGNED)
+  {
+    value = unsigned_;
+    return true;
+  }
+  else if(kind_ == SIGNED)
+  {
+    value = uint64(signed_);
+    return true;
+  }
+  return false;
+}
+
+bool
+PositionalEncoder::ValueAccessor::getSignedInteger(const Messages::FieldIdentity & /*identity*/, ValueType::Type /*type*/, int64 & value)const
+{
+  if(kind_ == SIGNED)
+  {
+    value = signed_;
+    return true;
+  }
+  else if(kind_ == UNSIGNED)
+  {
+    value = int64(unsigned_);
+    return true;
+  }
+  return false;
+}
+
+bool
+PositionalEncoder::ValueAccessor::getDecimal(const Messages::FieldIdentity & /*identity*/, ValueType::Type /*type*/, Decimal & value)const
+{
+  if(kind_ == DECIMAL)
+  {
+    value = decimal_;
+    return true;
+  }
+  return false;
+}
+
+bool
+PositionalEncoder::ValueAccessor::getString(const Messages::FieldIdentity & /*identity*/, ValueType::Type /*type*/, const StringBuffer *& value)const
+{
+  if(kind_ == STRING)
+  {
+    value = &string_;
+    return true;
+  }
+  return false;
+}
+
+bool
+PositionalEncoder::ValueAccessor::getGroup(const Messages::FieldIdentity & /*identity*/, const MessageAccessor *& /*group*/)const
+{
+  return false;
+}
+
+bool
+PositionalEncoder::ValueAccessor::getSequenceLength(const Messages::FieldIdentity & /*identity*/, size_t & /*length*/)const
+{
+  return false;
+}
+
+bool
+PositionalEncoder::ValueAccessor::getSequenceEntry(const Messages::FieldIdentity & /*identity*/, size_t /*index*/, const MessageAccessor *& /*entry*/)const
+{
+  return false;
+}
+
+const std::string &
+PositionalEncoder::ValueAccessor::getApplicationType()const
+{
+  return nada_;
+}
+
+const std::string &
+PositionalEncoder::ValueAccessor::getApplicationTypeNs()const
+{
+  return nada_;
+}
@@ -0,0 +1,231 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef POSITIONALENCODER_H
+#define POSITIONALENCODER_H
+#include "PositionalEncoder_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Decimal.h>
+#include <Common/StringBuffer.h>
+#include <Codecs/Encoder_fwd.h>
+#include <Codecs/DataDestination.h>
+#include <Codecs/PresenceMap.h>
+#include <Codecs/SegmentBody_fwd.h>
+#include <Codecs/FieldInstruction_fwd.h>
+#include <Messages/MessageAccessor.h>
+
+namespace QuickFAST{
+  namespace Codecs{
+    /// @brief Encode a message from values supplied in template order.
+    ///
+    /// This is the encoding counterpart of ValueMessageBuilder.  Rather than
+    /// building a Message and letting the Encoder look up each field by
+    /// identity, the application supplies the values in the order the
+    /// template defines the fields.  Each value is encoded as it arrives:
+    /// the field operator is applied and the presence map bit is set, so
+    /// encoding a message is linear in the number of fields and nothing
+    /// is allocated per field.
+    ///
+    /// The fields of a static templateRef are supplied in line as though they
+    /// were part of the referencing segment.  Dynamic templateRefs cannot be
+    /// encoded.
+    ///
+    /// Typical use:
+    /// <pre>
+    ///   encoder.startMessage(templateId);
+    ///   encoder.addValue(uint32(price));
+    ///   encoder.addAbsent();            // optional field not present
+    ///   encoder.startSequence(2);
+    ///     encoder.startSequenceEntry(); ... encoder.endSequenceEntry();
+    ///     encoder.startSequenceEntry(); ... encoder.endSequenceEntry();
+    ///   encoder.endSequence();
+    ///   encoder.endMessage();
+    /// </pre>
+    /// Fields that remain when a segment ends are encoded as absent, as are
+    /// the fields passed over by skipTo().  Use findSlot() once, up front, to
+    /// translate a field name into the position used by skipTo().
+    ///
+    /// The Encoder's dictionaries are shared with Encoder::encodeMessage, so the
+    /// two may be mixed on the same stream.
+    class QuickFAST_Export PositionalEncoder
+    {
+    public:
+      /// @brief Construct
+      /// @param encoder supplies the templates and dictionaries.
+      /// @param destination receives the encoded messages.
+      PositionalEncoder(Encoder & encoder, DataDestination & destination);
+      ~PositionalEncoder();
+
+      /// @brief Find the position of a field within a template.
+      /// @param templateId identifies the template.
+      /// @param name is the name of a field at the top level of the template.
+      /// @param[out] slot receives the position, for use with skipTo().
+      /// @returns false if the template or the field is unknown.
+      bool findSlot(template_id_t templateId, const std::string & name, size_t & slot);
+
+      /// @brief Find the position of a field within a group or sequence entry.
+      /// @param segment is the body of the group or sequence.
+      /// @param name is the name of a field in that segment.
+      /// @param[out] slot receives the position, for use with skipTo().
+      /// @returns false if the field is unknown.
+      bool findSlot(const SegmentBodyCPtr & segment, const std::string & name, size_t & slot);
+
+      /// @brief Begin encoding a message.
+      ///
+      /// Any message that was not finished (because an exception was thrown, for
+      /// example) is abandoned.
+      /// @param templateId identifies the template with which to encode the message.
+      /// @throws EncodingError if the template is unknown.
+      void startMessage(template_id_t templateId);
+
+      /// @brief Finish the message.  Any fields not supplied are encoded as absent.
+      void endMessage();
+
+      /// @brief Encode the next field.
+      /// @param value is the value of the field.
+      void addValue(int64 value);
+      /// @brief Encode the next field.
+      /// @param value is the value of the field.
+      void addValue(uint64 value);
+      /// @brief Encode the next field.
+      /// @param value is the value of the field.
+      void addValue(int32 value);
+      /// @brief Encode the next field.
+      /// @param value is the value of the field.
+      void addValue(uint32 value);
+      /// @brief Encode the next field.
+      /// @param value is the value of the field.
+      void addValue(int16 value);
+      /// @brief Encode the next field.
+      /// @param value is the value of the field.
+      void addValue(uint16 value);
+      /// @brief Encode the next field.
+      /// @param value is the value of the field.
+      void addValue(int8 value);
+      /// @brief Encode the next field.
+      /// @param value is the value of the field.
+      void addValue(uchar value);
+      /// @brief Encode the next field.
+      /// @param value is the value of the field.
+      void addValue(const Decimal & value);
+      /// @brief Encode the next field.
+      /// @param value points to the value of a string or byte vector field.
+      /// @param length is the length of the value
+      void addValue(const unsigned char * value, size_t length);
+      /// @brief Encode the next field.
+      /// @param value is the value of a string or byte vector field.
+      void addValue(const std::string & value);
+
+      /// @brief Encode the next field as absent.
+      void addAbsent();
+
+      /// @brief Encode fields as absent until the position given by findSlot() is reached.
+      /// @param slot is the position of the next field to be supplied.
+      void skipTo(size_t slot);
+
+      /// @brief Begin the group that is the next field.
+      void startGroup();
+      /// @brief Finish the group.  Any fields not supplied are encoded as absent.
+      void endGroup();
+
+      /// @brief Begin the sequence that is the next field.
+      /// @param length is the number of entries that will follow.
+      void startSequence(size_t length);
+      /// @brief Begin an entry in the sequence.
+      void startSequenceEntry();
+      /// @brief Finish the entry.  Any fields not supplied are encoded as absent.
+      void endSequenceEntry();
+      /// @brief Finish the sequence.
+      void endSequence();
+
+    private:
+      /// A single value offered to one field instruction.
+      class ValueAccessor : public Messages::MessageAccessor
+      {
+      public:
+        ValueAccessor();
+        void setSigned(int64 value);
+        void setUnsigned(uint64 value);
+        void setDecimal(const Decimal & value);
+        void setString(const unsigned char * value, size_t length);
+        void clear();
+
+        virtual bool isPresent(const Messages::FieldIdentity & identity)const;
+        virtual bool getUnsignedInteger(const Messages::FieldIdentity & identity, ValueType::Type type, uint64 & value)const;
+        virtual bool getSignedInteger(const Messages::FieldIdentity & identity, ValueType::Type type, int64 & value)const;
+        virtual bool getDecimal(const Messages::FieldIdentity & identity, ValueType::Type type, Decimal & value)const;
+        virtual bool getString(const Messages::FieldIdentity & identity, ValueType::Type type, const StringBuffer *& value)const;
+        virtual bool getGroup(const Messages::FieldIdentity & identity, const MessageAccessor *& group)const;
+        virtual bool getSequenceLength(const Messages::FieldIdentity & identity, size_t & length)const;
+        virtual bool getSequenceEntry(const Messages::FieldIdentity & identity, size_t index, const MessageAccessor *& entry)const;
+        virtual const std::string & getApplicationType()const;
+        virtual const std::string & getApplicationTypeNs()const;
+
+      private:
+        enum Kind
+        {
+          NONE,
+          SIGNED,
+          UNSIGNED,
+          DECIMAL,
+          STRING
+        };
+        Kind kind_;
+        int64 signed_;
+        uint64 unsigned_;
+        Decimal decimal_;
+        StringBuffer string_;
+        std::string nada_;
+      };
+
+      enum FrameKind
+      {
+        MESSAGE,   // a template; owns a presence map
+        GROUP,     // a group; owns a presence map
+        ENTRY,     // a sequence entry; owns a presence map
+        SEQUENCE,  // between startSequence and endSequence
+        MERGED     // a static templateRef; shares its parent's presence map
+      };
+
+      struct Frame
+      {
+        FrameKind kind_;
+        SegmentBodyCPtr segment_;
+        size_t position_;
+        size_t slot_;
+        size_t owner_;
+        size_t pmap_;
+        DataDestination::BufferHandle pmapBuffer_;
+        const FieldInstruction * instruction_;
+        size_t remaining_;
+      };
+
+    private:
+      PositionalEncoder(const PositionalEncoder &);
+      PositionalEncoder & operator=(const PositionalEncoder &);
+
+      const FieldInstruction * nextInstruction();
+      const FieldInstruction & requireInstruction(ValueType::Type type, const char * message);
+      void encodeNext();
+      void advance();
+      void finishSegment();
+      void pushFrame(FrameKind kind, const SegmentBodyCPtr & segment, size_t pmap);
+      size_t pushPresenceMap(size_t bitCount);
+      void openSegment(FrameKind kind, const SegmentBodyCPtr & segment, const FieldInstruction * instruction);
+      const FieldInstruction * closeSegment(FrameKind kind, const char * message);
+      bool countSlots(const SegmentBodyCPtr & segment, const std::string & name, size_t & slot);
+
+    private:
+      Encoder & encoder_;
+      DataDestination & destination_;
+      ValueAccessor value_;
+      std::vector<Frame> frames_;
+      std::vector<boost::shared_ptr<PresenceMap> > pmaps_;
+      size_t pmapDepth_;
+    };
+  }
+}
+#endif // POSITIONALENCODER_H
@@ -164,7 +164,7 @@ PresenceMap::encode(DataDestination & destination)
   }
 }
 
-void
+bool
 PresenceMap::decode(Codecs::DataSource & source)
 {
   reset();
@@ -172,7 +172,7 @@ PresenceMap::decode(Codecs::DataSource & source)
   uchar byte = 0;
   if(!source.getByte(byte))
   {
-    throw EncodingError("[ERR U03] EOF while decoding presence map.");
+    return false;
   }
   size_t pos = 0;
   while((byte & stopBit) == 0)
@@ -180,7 +180,7 @@ PresenceMap::decode(Codecs::DataSource & source)
     appendByte(pos, byte);
     if(!source.getByte(byte))
     {
-      throw EncodingError("[ERR U03] EOF while decoding presence map.");
+      return false;
     }
   }
   appendByte(pos, byte);
@@ -194,6 +194,7 @@ PresenceMap::decode(Codecs::DataSource & source)
     }
     (*vout_) << std::dec << std::endl;
   }
+  return true;
 }
 
 void
@@ -231,7 +232,7 @@ PresenceMap::reset(size_t bitCount)
 {
   if(bitCount > 0)
   {
-    size_t bytes = (bitCount + 7)/8;
+    size_t bytes = (bitCount + 6)/7;
     if(bytes > byteCapacity_)
     {
       externalBuffer_.reset(new uchar[bytes]);
@@ -33,7 +33,8 @@ namespace QuickFAST{
 
       /// @brief Read a presence map from a data source.
       /// @param source provides the data.
-      void decode(DataSource & source);
+      /// @returns false if the source ran out of data before the stop bit.
+      bool decode(DataSource & source);
 
       /// @brief Decode directly from a buffer which must be complete in memory.
       ///
@@ -84,6 +85,20 @@ namespace QuickFAST{
       /// @returns true if the bit is set
       bool checkSpecificField(size_t bit);
 
+      /// @brief How many bits have been checked since the last rewind() or reset()?
+      ///
+      /// Intended for analysis tools.  Use checkSpecificField() to find the value of a bit.
+      /// @returns the number of the next bit to be checked.
+      size_t bitPosition()const
+      {
+        size_t bit = bytePosition_ * 7;
+        for(uchar mask = startByteMask; mask != bitMask_ && mask != 0; mask >>= 1)
+        {
+          ++bit;
+        }
+        return bit;
+      }
+
       /// @brief Reinitialize the presence map to be empty with room for bitCount fields.
       /// @param bitCount how many fields can be represented in the presence map.
       void reset(size_t bitCount = 0);
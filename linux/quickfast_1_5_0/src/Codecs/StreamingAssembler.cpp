@@ -24,10 +24,17 @@ StreamingAssembler::StreamingAssembler(
   , waitForCompleteMessage_(waitForCompleteMessage)
   , receiver_(0)
   , currentBuffer_(0)
+  , nextBuffer_(0)
+  , joinedEnd_(0)
   , headerIsComplete_(false)
   , skipBlock_(false)
   , blockSize_(0)
   , inDecoder_(false)
+  , resumable_(false)
+  , starved_(false)
+  , startBuffer_(0)
+  , startPosition_(0)
+  , buffersHeld_(0)
   , messageCount_(0)
   , byteCount_(0)
   , messageLimit_(0)
@@ -44,6 +51,12 @@ StreamingAssembler::serviceQueue(
 {
   // save the receiver so callbacks from the decoder can find it.
   receiver_ = &receiver;
+  if(resumable_)
+  {
+    bool result = serviceResumable();
+    receiver_ = 0;
+    return result;
+  }
   bool more = true;
   while(more && !stopping_)
   {
@@ -80,6 +93,11 @@ StreamingAssembler::serviceQueue(
       skipBlock_ = false;
       if(messageAvailable() > 0)
       {
+        if(joinedEnd_ != 0)
+        {
+          // let the whole message be contiguous if it has arrived.
+          extendBuffer(joinContiguous());
+        }
         // Set this to indicate we block during decoding
         inDecoder_ = true;
         try
@@ -88,20 +106,19 @@ StreamingAssembler::serviceQueue(
           {
             decoder_.reset();
           }
-          decoder_.decodeMessage(*this, builder_);
+          if(!decoder_.decodeMessage(*this, builder_))
+          {
+            more = reportDecoderError();
+          }
         }
         catch(std::exception & ex)
         {
           more = builder_.reportDecodingError(ex.what());
-          if(!more)
-          {
-            stopping_ = true;
-            if(currentBuffer_ != 0)
-            {
-              receiver.releaseBuffer(currentBuffer_);
-              currentBuffer_ = 0;
-            }
-          }
+        }
+        if(!more)
+        {
+          stopping_ = true;
+          releaseBuffers(receiver);
         }
         inDecoder_ = false;
       }
@@ -115,10 +132,149 @@ StreamingAssembler::serviceQueue(
   return !stopping_;
 }
 
+bool
+StreamingAssembler::serviceResumable()
+{
+  bool more = true;
+  while(more && !stopping_)
+  {
+    // remember where this message starts in case it must be decoded again.
+    starved_ = false;
+    startBuffer_ = currentBuffer_;
+    startPosition_ = currentPosition();
+    decoder_.beginCheckpoint();
+
+    blockSize_ = 0;
+    skipBlock_ = false;
+    if(!headerAnalyzer_.analyzeHeader(*this, blockSize_, skipBlock_)
+      || messageAvailable() <= 0)
+    {
+      // incomplete header or no data.  Try again when more arrives.
+      rollbackMessage();
+      more = false;
+      if(holdsEveryBuffer())
+      {
+        builder_.reportDecodingError("Message header does not fit in the receive buffers.");
+        stopping_ = true;
+      }
+    }
+    else
+    {
+      try
+      {
+        if(reset_)
+        {
+          decoder_.reset();
+        }
+        if(decoder_.decodeMessage(*this, builder_))
+        {
+          commitMessage();
+        }
+        else if(starved_)
+        {
+          // the partial message was ignored; decode it again later.
+          decoder_.clearError();
+          rollbackMessage();
+          more = false;
+          if(holdsEveryBuffer())
+          {
+            // No buffer is left to receive the rest of the message.
+            builder_.reportDecodingError("Message does not fit in the receive buffers.");
+            stopping_ = true;
+          }
+        }
+        else
+        {
+          commitMessage();
+          more = reportDecoderError();
+        }
+      }
+      catch(std::exception & ex)
+      {
+        commitMessage();
+        more = builder_.reportDecodingError(ex.what());
+      }
+      if(!more && !starved_)
+      {
+        stopping_ = true;
+      }
+    }
+  }
+  if(stopping_)
+  {
+    releaseHeldBuffers();
+  }
+  return !stopping_;
+}
+
+void
+StreamingAssembler::rollbackMessage()
+{
+  decoder_.rollbackCheckpoint();
+  headerAnalyzer_.reset();
+  if(currentBuffer_ != 0)
+  {
+    heldBuffers_.push(currentBuffer_);
+    currentBuffer_ = 0;
+  }
+  // replay the held buffers ahead of any buffers already waiting to be replayed
+  heldBuffers_.push(replayBuffers_);
+  replayBuffers_.push(heldBuffers_);
+  DataSource::reset();
+  currentBuffer_ = replayBuffers_.pop();
+  if(currentBuffer_ != 0)
+  {
+    size_t position = (currentBuffer_ == startBuffer_) ? startPosition_ : 0;
+    restartBuffer(currentBuffer_->get(), currentBuffer_->used(), position);
+  }
+  startBuffer_ = 0;
+  startPosition_ = 0;
+}
+
+void
+StreamingAssembler::commitMessage()
+{
+  decoder_.endCheckpoint();
+  Communication::LinkedBuffer * buffer = heldBuffers_.pop();
+  while(buffer != 0)
+  {
+    receiver_->releaseBuffer(buffer);
+    --buffersHeld_;
+    buffer = heldBuffers_.pop();
+  }
+}
+
+bool
+StreamingAssembler::holdsEveryBuffer() const
+{
+  // The receiver grows its pool, if it can, before reporting that it has no data,
+  // so if every buffer is still here none will ever arrive.
+  // A receiver with no pool is being fed buffers from outside.
+  size_t pool = receiver_->buffersAllocated();
+  return pool != 0 && buffersHeld_ >= pool;
+}
+
+void
+StreamingAssembler::releaseHeldBuffers()
+{
+  if(receiver_ == 0)
+  {
+    return;
+  }
+  heldBuffers_.push(replayBuffers_);
+  if(currentBuffer_ != 0)
+  {
+    heldBuffers_.push(currentBuffer_);
+    currentBuffer_ = 0;
+  }
+  commitMessage();
+}
+
 void
 StreamingAssembler::receiverStarted(Communication::Receiver & /*receiver*/)
 {
   decoder_.setStrict(strict_);
+  decoder_.setExceptionFree(exceptionFree_ || resumable_);
   if(builder_.wantLog(Common::Logger::QF_LOG_INFO))
   {
     builder_.logMessage(Common::Logger::QF_LOG_INFO, "Start receiver.");
@@ -134,11 +290,15 @@ StreamingAssembler::receiverStopped(Communication::Receiver & receiver)
   }
 
   stopping_ = true;
-  if(currentBuffer_ != 0)
+  releaseBuffers(receiver);
+  heldBuffers_.push(replayBuffers_);
+  Communication::LinkedBuffer * buffer = heldBuffers_.pop();
+  while(buffer != 0)
   {
-    receiver.releaseBuffer(currentBuffer_);
-    currentBuffer_ = 0;
+    receiver.releaseBuffer(buffer);
+    buffer = heldBuffers_.pop();
   }
+  buffersHeld_ = 0;
 }
 
 
@@ -146,6 +306,39 @@ bool
 StreamingAssembler::getBuffer(const uchar *& buffer, size_t & size)
 {
   size = 0;
+  if(resumable_)
+  {
+    if(receiver_ == 0)
+    {
+      throw UsageError(
+        "Internal Error",
+        "StreamingAssembler::readByte called in the wrong scope.");
+    }
+    // keep the buffer until the message is decoded; never wait for more.
+    if(currentBuffer_ != 0)
+    {
+      heldBuffers_.push(currentBuffer_);
+    }
+    currentBuffer_ = replayBuffers_.pop();
+    if(currentBuffer_ == 0)
+    {
+      currentBuffer_ = receiver_->getBuffer(false);
+      if(currentBuffer_ != 0)
+      {
+        ++buffersHeld_;
+      }
+    }
+    if(currentBuffer_ == 0)
+    {
+      starved_ = true;
+      return false;
+    }
+    buffer = currentBuffer_->get();
+    size = currentBuffer_->used();
+    return size > 0;
+  }
+  Communication::LinkedBuffer * pending = nextBuffer_;
+  nextBuffer_ = 0;
   if(currentBuffer_ != 0)
   {
     if(receiver_ == 0)
@@ -154,24 +347,84 @@ StreamingAssembler::getBuffer(const uchar *& buffer, size_t & size)
         "Internal Error",
         "StreamingAssembler::readByte called in the wrong scope.");
     }
-    receiver_->releaseBuffer(currentBuffer_);
-    currentBuffer_ = 0;
+    releaseBuffers(*receiver_);
   }
 
-  // Look for a new buffer.  If we're in the decoder, wait for it.
-  if(inDecoder_)
+  if(pending != 0)
+  {
+    currentBuffer_ = pending;
+  }
+  else
   {
-    receiver_->waitBuffer();
+    // Look for a new buffer.  If we're in the decoder, wait for it.
+    if(inDecoder_)
+    {
+      receiver_->waitBuffer();
+    }
+    currentBuffer_ = receiver_->getBuffer(inDecoder_);
   }
-  currentBuffer_ = receiver_->getBuffer(inDecoder_);
   if(currentBuffer_ != 0)
   {
     buffer = currentBuffer_->get();
     size = currentBuffer_->used();
+    if(receiver_->ringBuffer())
+    {
+      joinedEnd_ = buffer + size;
+      size += joinContiguous();
+    }
   }
   return size > 0;
 }
 
+size_t
+StreamingAssembler::joinContiguous()
+{
+  // Deliver any buffers that have already arrived and are adjacent in the
+  // receiver's ring along with the current buffer.  Never waits.
+  size_t joined = 0;
+  while(nextBuffer_ == 0)
+  {
+    Communication::LinkedBuffer * next = receiver_->getBuffer(false);
+    if(next == 0)
+    {
+      break;
+    }
+    if(receiver_->follows(joinedEnd_, next))
+    {
+      joinedBuffers_.push(next);
+      joinedEnd_ += next->used();
+      joined += next->used();
+    }
+    else
+    {
+      nextBuffer_ = next;
+    }
+  }
+  return joined;
+}
+
+void
+StreamingAssembler::releaseBuffers(Communication::Receiver & receiver)
+{
+  if(currentBuffer_ != 0)
+  {
+    receiver.releaseBuffer(currentBuffer_);
+    currentBuffer_ = 0;
+  }
+  Communication::LinkedBuffer * buffer = joinedBuffers_.pop();
+  while(buffer != 0)
+  {
+    receiver.releaseBuffer(buffer);
+    buffer = joinedBuffers_.pop();
+  }
+  if(nextBuffer_ != 0)
+  {
+    receiver.releaseBuffer(nextBuffer_);
+    nextBuffer_ = 0;
+  }
+  joinedEnd_ = 0;
+}
+
 int
 StreamingAssembler::messageAvailable()
 {
@@ -42,6 +42,23 @@ namespace QuickFAST
 
       virtual ~StreamingAssembler();
 
+      /// @brief Decode without ever blocking for more data.
+      ///
+      /// If the data runs out in the middle of a message the partial message is
+      /// discarded, the decoder's dictionary is rolled back, and the message is
+      /// decoded again from the beginning when more data arrives.  The buffers
+      /// holding the message are retained until it is decoded, so
+      /// bufferCount * bufferSize must exceed the largest expected message
+      /// (or Receiver::setBufferLimit() must let the pool grow that large).
+      /// A message that fills every buffer is reported as a decoding error
+      /// and decoding stops.
+      /// Implies exception-free decoding.
+      /// @param resumable true to enable.
+      void setResumable(bool resumable = true)
+      {
+        resumable_ = resumable;
+      }
+
       /// @brief set the maximum number of messages to decode
       /// @param messageLimit is the number of messages to decode
       void setMessageLimit(size_t messageLimit)
@@ -73,6 +90,15 @@ namespace QuickFAST
       StreamingAssembler(const StreamingAssembler &);
       StreamingAssembler();
 
+    private:
+      size_t joinContiguous();
+      void releaseBuffers(Communication::Receiver & receiver);
+      bool serviceResumable();
+      void rollbackMessage();
+      void commitMessage();
+      void releaseHeldBuffers();
+      bool holdsEveryBuffer() const;
+
     private:
       HeaderAnalyzer & headerAnalyzer_;
       Messages::ValueMessageBuilder & builder_;
@@ -86,12 +112,34 @@ namespace QuickFAST
       // buffer from which data is being pulled
       Communication::LinkedBuffer * currentBuffer_;
 
+      // Support for receivers with ring buffers
+      // buffers adjacent to currentBuffer_ that are being delivered with it.
+      Communication::BufferQueue joinedBuffers_;
+      // the first buffer that was not adjacent
+      Communication::LinkedBuffer * nextBuffer_;
+      // end of the data being delivered.
+      const uchar * joinedEnd_;
+
       bool headerIsComplete_;
       bool skipBlock_;
       size_t blockSize_;
 
       bool inDecoder_;
 
+      // Support for resumable decoding
+      bool resumable_;
+      // true if getBuffer ran out of data
+      bool starved_;
+      // buffer and position at which the current message started
+      Communication::LinkedBuffer * startBuffer_;
+      size_t startPosition_;
+      // buffers consumed by the current message; released when it is decoded
+      Communication::BufferQueue heldBuffers_;
+      // buffers to be delivered again before asking the receiver for more
+      Communication::BufferQueue replayBuffers_;
+      // buffers taken from the receiver and not yet released
+      size_t buffersHeld_;
+
       size_t messageCount_;
       size_t byteCount_;
       size_t messageLimit_;
@@ -156,6 +156,21 @@ namespace QuickFAST
 #endif
   }
 
+  /// @brief Full memory barrier.
+  ///
+  /// Neither the compiler nor the processor may move loads or stores across this call.
+  inline
+  void memory_barrier()
+  {
+#if defined(_WIN32)
+    MemoryBarrier();
+#elif defined(__GNUC__)
+    __sync_synchronize();
+#else
+    membar_enter();
+#endif
+  }
+
   /// @brief compare and swap long longs
   ///
   /// @param target the long long to be updated
@@ -0,0 +1,125 @@
+// Copyright (c) 2009, 2010, 2011, Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef ATOMICRING_H
+#define ATOMICRING_H
+#include <Common/AtomicOps.h>
+namespace QuickFAST
+{
+  ///@brief A bounded queue with many producers and one consumer.
+  ///
+  /// Producers claim a slot with a single compare-and-swap; they never wait for
+  /// each other or for the consumer.  Each slot carries a sequence number that
+  /// tells the consumer when the producer has finished filling it, and tells
+  /// producers when the consumer has emptied it.
+  ///
+  /// push() may be called from any thread. pop() must be called from
+  /// only one thread at a time.
+  template<typename Entry>
+  class AtomicRing
+  {
+  public:
+    ///@brief Construct
+    ///@param capacity is the number of entries the ring can hold.  It is rounded up to a power of two.
+    explicit AtomicRing(size_t capacity)
+      : capacity_(1)
+      , enqueue_(0)
+      , dequeue_(0)
+    {
+      while(capacity_ < capacity)
+      {
+        capacity_ <<= 1;
+      }
+      mask_ = capacity_ - 1;
+      slots_.reset(new Slot[capacity_]);
+      for(size_t nSlot = 0; nSlot < capacity_; ++nSlot)
+      {
+        slots_[nSlot].sequence_ = long(nSlot);
+      }
+    }
+
+    ///@brief The number of entries the ring can hold.
+    size_t capacity()const
+    {
+      return capacity_;
+    }
+
+    ///@brief Add an entry.
+    ///@param entry is copied into the ring.
+    ///@returns false if the ring is full.
+    bool push(const Entry & entry)
+    {
+      long position = enqueue_;
+      for(;;)
+      {
+        Slot & slot = slots_[size_t(position) & mask_];
+        long difference = long((unsigned long)slot.sequence_ - (unsigned long)position);
+        if(difference == 0)
+        {
+          if(CASLong(&enqueue_, position, long((unsigned long)position + 1)))
+          {
+            slot.entry_ = entry;
+            memory_barrier();
+            slot.sequence_ = long((unsigned long)position + 1);
+            return true;
+          }
+        }
+        else if(difference < 0)
+        {
+          return false;
+        }
+        position = enqueue_;
+      }
+    }
+
+    ///@brief Remove the oldest entry (consumer only).
+    ///@param[out] entry receives the entry.
+    ///@returns false if the ring is empty.
+    bool pop(Entry & entry)
+    {
+      Slot & slot = slots_[size_t(dequeue_) & mask_];
+      if(slot.sequence_ != long((unsigned long)dequeue_ + 1))
+      {
+        return false;
+      }
+      memory_barrier();
+      entry = slot.entry_;
+      slot.entry_ = Entry();
+      memory_barrier();
+      slot.sequence_ = long((unsigned long)dequeue_ + capacity_);
+      dequeue_ = long((unsigned long)dequeue_ + 1);
+      return true;
+    }
+
+    ///@brief Is the ring empty? (consumer only)
+    bool empty()const
+    {
+      return slots_[size_t(dequeue_) & mask_].sequence_ != long((unsigned long)dequeue_ + 1);
+    }
+
+  private:
+    AtomicRing(const AtomicRing &);
+    AtomicRing & operator=(const AtomicRing &);
+
+    struct Slot
+    {
+      volatile long sequence_;
+      Entry entry_;
+    };
+
+  private:
+    size_t capacity_;
+    size_t mask_;
+    boost::scoped_array<Slot> slots_;
+    // producers and the consumer update these; keep them on separate cache lines.
+    char pad0_[64];
+    volatile long enqueue_;
+    char pad1_[64];
+    long dequeue_;
+  };
+}
+#endif // ATOMICRING_H
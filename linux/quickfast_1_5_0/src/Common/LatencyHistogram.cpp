@@ -0,0 +1,80 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "LatencyHistogram.h"
+
+using namespace QuickFAST;
+
+const unsigned int LatencyHistogram::subBucketBits;
+const uint64 LatencyHistogram::subBucketCount;
+const unsigned int LatencyHistogram::highestBit;
+const uint64 LatencyHistogram::highestValue;
+const size_t LatencyHistogram::bucketCount;
+
+LatencyHistogram::LatencyHistogram()
+  : count_(0)
+  , sum_(0)
+  , min_(highestValue)
+  , max_(0)
+{
+  std::fill(counts_, counts_ + bucketCount, uint64(0));
+}
+
+double
+LatencyHistogram::mean() const
+{
+  uint64 count = count_;
+  return count == 0 ? 0.0 : double(sum_) / double(count);
+}
+
+uint64
+LatencyHistogram::bucketHighest(size_t index)
+{
+  if(index < 2 * subBucketCount)
+  {
+    return index;
+  }
+  unsigned int shift = static_cast<unsigned int>(index / subBucketCount) - 1;
+  uint64 lowest = (subBucketCount + index % subBucketCount) << shift;
+  return lowest + (uint64(1) << shift) - 1;
+}
+
+uint64
+LatencyHistogram::valueAtPercentile(double percentile) const
+{
+  uint64 count = count_;
+  if(count == 0)
+  {
+    return 0;
+  }
+  uint64 target = uint64(ceil(percentile / 100.0 * double(count)));
+  if(target == 0)
+  {
+    target = 1;
+  }
+  uint64 seen = 0;
+  for(size_t index = 0; index < bucketCount; ++index)
+  {
+    seen += counts_[index];
+    if(seen >= target)
+    {
+      return std::min(bucketHighest(index), max_);
+    }
+  }
+  return max_;
+}
+
+void
+LatencyHistogram::writeSummary(std::ostream & out) const
+{
+  out << "count=" << count()
+    << " mean=" << uint64(mean() + 0.5)
+    << " min=" << min()
+    << " p50=" << valueAtPercentile(50.0)
+    << " p90=" << valueAtPercentile(90.0)
+    << " p99=" << valueAtPercentile(99.0)
+    << " p99.9=" << valueAtPercentile(99.9)
+    << " p99.99=" << valueAtPercentile(99.99)
+    << " max=" << max();
+}
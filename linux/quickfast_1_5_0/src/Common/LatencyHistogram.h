@@ -0,0 +1,134 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+#include "LatencyHistogram_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+#if defined(_MSC_VER)
+# include <intrin.h>
+#endif
+
+namespace QuickFAST
+{
+  /// @brief Count durations in log-linear buckets, as HdrHistogram does.
+  ///
+  /// Each power of two is divided into subBucketCount equal buckets, so every
+  /// value is counted with a relative error under 1/subBucketCount (about 3%)
+  /// from one nanosecond to over an hour, in a fixed array of counts.
+  /// Recording a value is a bit scan, a shift and an increment.
+  ///
+  /// One thread records.  Any thread may read; it sees the counts as they were
+  /// at some point while it was reading.
+  class QuickFAST_Export LatencyHistogram
+  {
+  public:
+    /// @brief Each power of two is split into 2^subBucketBits buckets.
+    static const unsigned int subBucketBits = 5;
+    /// @brief Buckets per power of two.
+    static const uint64 subBucketCount = uint64(1) << subBucketBits;
+    /// @brief Values are counted exactly up to here.
+    static const unsigned int highestBit = 42;
+    /// @brief Larger values are counted as this.
+    static const uint64 highestValue = (uint64(1) << highestBit) - 1;
+    /// @brief The number of buckets.
+    static const size_t bucketCount = size_t((highestBit - subBucketBits + 1) * subBucketCount);
+
+    LatencyHistogram();
+
+    /// @brief Count one value.
+    /// @param value usually nanoseconds.
+    void record(uint64 value)
+    {
+      if(value > highestValue)
+      {
+        value = highestValue;
+      }
+      ++counts_[bucketIndex(value)];
+      ++count_;
+      sum_ += value;
+      if(value < min_)
+      {
+        min_ = value;
+      }
+      if(value > max_)
+      {
+        max_ = value;
+      }
+    }
+
+    /// @brief How many values have been recorded.
+    uint64 count() const
+    {
+      return count_;
+    }
+
+    /// @brief The smallest value recorded, or zero if none.
+    uint64 min() const
+    {
+      return count_ == 0 ? 0 : min_;
+    }
+
+    /// @brief The largest value recorded.
+    uint64 max() const
+    {
+      return max_;
+    }
+
+    /// @brief The mean of the values recorded, or zero if none.
+    double mean() const;
+
+    /// @brief The value at or below which a percentage of the values fall.
+    /// @param percentile from 0 to 100.
+    /// @returns the top of the bucket holding that value; never more than max().
+    uint64 valueAtPercentile(double percentile) const;
+
+    /// @brief Write count, mean, percentiles and max on one line.
+    void writeSummary(std::ostream & out) const;
+
+    /// @brief The bucket that counts a value.
+    static size_t bucketIndex(uint64 value)
+    {
+      if(value < 2 * subBucketCount)
+      {
+        return size_t(value);
+      }
+      unsigned int shift = highBit(value) - subBucketBits;
+      return size_t((shift + 1) * subBucketCount + ((value >> shift) - subBucketCount));
+    }
+
+    /// @brief The largest value counted by a bucket.
+    static uint64 bucketHighest(size_t index);
+
+  private:
+    static unsigned int highBit(uint64 value)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+      unsigned long bit;
+      _BitScanReverse64(&bit, value);
+      return bit;
+#elif defined(__GNUC__)
+      return 63 - __builtin_clzll(value);
+#else
+      unsigned int bit = 0;
+      while(value >>= 1)
+      {
+        ++bit;
+      }
+      return bit;
+#endif
+    }
+
+  private:
+    uint64 counts_[bucketCount];
+    uint64 count_;
+    uint64 sum_;
+    uint64 min_;
+    uint64 max_;
+  };
+}
+#endif // LATENCYHISTOGRAM_H
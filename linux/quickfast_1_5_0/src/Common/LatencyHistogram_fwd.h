@@ -0,0 +1,17 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef LATENCYHISTOGRAM_FWD_H
+#define LATENCYHISTOGRAM_FWD_H
+#ifndef QUICKFAST_HEADERS
+#error Please include <Application/QuickFAST.h> preferably as a precompiled header file.
+#endif //QUICKFAST_HEADERS
+
+namespace QuickFAST
+{
+  class LatencyHistogram;
+}
+#endif // LATENCYHISTOGRAM_FWD_H
@@ -0,0 +1,177 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "LatencyTracker.h"
+#include <csignal>
+#if !defined(_WIN32)
+# include <time.h>
+#endif // _WIN32
+
+using namespace QuickFAST;
+
+namespace
+{
+  // incremented by the signal handler; each dumping thread remembers the last value it saw.
+  volatile std::sig_atomic_t dumpSignals = 0;
+
+  extern "C" void noteDumpSignal(int)
+  {
+    dumpSignals = dumpSignals + 1;
+  }
+}
+
+LatencyTracker::LatencyTracker()
+  : packetTime_(0)
+  , lastTemplateId_(0)
+  , lastDecode_(0)
+{
+}
+
+LatencyTracker::~LatencyTracker()
+{
+  stopDumping();
+}
+
+uint64
+LatencyTracker::now()
+{
+#if defined(_WIN32)
+  FILETIME fileTime;
+  ::GetSystemTimeAsFileTime(&fileTime);
+  uint64 ticks = (uint64(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime;
+  // 100ns ticks since 1601-01-01
+  return (ticks - 116444736000000000ULL) * 100;
+#else // _WIN32
+  struct timespec current;
+  clock_gettime(CLOCK_REALTIME, &current);
+  return uint64(current.tv_sec) * 1000000000 + current.tv_nsec;
+#endif // _WIN32
+}
+
+LatencyHistogram &
+LatencyTracker::findDecodeHistogram(template_id_t templateId)
+{
+  // only this thread adds histograms, so it may look without the lock.
+  DecodeHistograms::iterator it = decodeHistograms_.find(templateId);
+  if(it == decodeHistograms_.end())
+  {
+    HistogramPtr histogram(new LatencyHistogram);
+    boost::mutex::scoped_lock lock(decodeMutex_);
+    it = decodeHistograms_.insert(DecodeHistograms::value_type(templateId, histogram)).first;
+  }
+  return *it->second;
+}
+
+const LatencyHistogram *
+LatencyTracker::decodeTime(template_id_t templateId) const
+{
+  boost::mutex::scoped_lock lock(decodeMutex_);
+  DecodeHistograms::const_iterator it = decodeHistograms_.find(templateId);
+  if(it == decodeHistograms_.end())
+  {
+    return 0;
+  }
+  return it->second.get();
+}
+
+void
+LatencyTracker::writeText(std::ostream & out) const
+{
+  out << "queue_wait_ns ";
+  queueWait_.writeSummary(out);
+  out << std::endl;
+  out << "end_to_end_ns ";
+  endToEnd_.writeSummary(out);
+  out << std::endl;
+  boost::mutex::scoped_lock lock(decodeMutex_);
+  for(DecodeHistograms::const_iterator it = decodeHistograms_.begin(); it != decodeHistograms_.end(); ++it)
+  {
+    out << "decode_ns template=" << it->first << ' ';
+    it->second->writeSummary(out);
+    out << std::endl;
+  }
+}
+
+void
+LatencyTracker::dump()
+{
+  boost::mutex::scoped_lock lock(dumpMutex_);
+  if(filename_ == "cout")
+  {
+    writeText(std::cout);
+  }
+  else if(filename_ == "cerr")
+  {
+    writeText(std::cerr);
+  }
+  else if(!filename_.empty())
+  {
+    std::ofstream out(filename_.c_str());
+    writeText(out);
+  }
+}
+
+void
+LatencyTracker::startDumping(const std::string & filename, unsigned int intervalMilliseconds)
+{
+  stopDumping();
+  {
+    boost::mutex::scoped_lock lock(dumpMutex_);
+    filename_ = filename;
+  }
+  thread_.reset(new boost::thread(boost::bind(&LatencyTracker::run, this, intervalMilliseconds)));
+}
+
+void
+LatencyTracker::stopDumping()
+{
+  if(thread_)
+  {
+    thread_->interrupt();
+    thread_->join();
+    thread_.reset();
+    dump();
+  }
+}
+
+void
+LatencyTracker::run(unsigned int intervalMilliseconds)
+{
+  const unsigned int pollMilliseconds = 100;
+  std::sig_atomic_t signalsSeen = dumpSignals;
+  unsigned int sinceDump = 0;
+  try
+  {
+    for(;;)
+    {
+      boost::this_thread::sleep(boost::posix_time::milliseconds(pollMilliseconds));
+      sinceDump += pollMilliseconds;
+      if(signalsSeen != dumpSignals || (intervalMilliseconds != 0 && sinceDump >= intervalMilliseconds))
+      {
+        signalsSeen = dumpSignals;
+        sinceDump = 0;
+        dump();
+      }
+    }
+  }
+  catch(const boost::thread_interrupted &)
+  {
+    // stopDumping() was called.
+  }
+}
+
+void
+LatencyTracker::dumpOnSignal(int signalNumber)
+{
+#if !defined(_WIN32)
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = noteDumpSignal;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  sigaction(signalNumber, &action, 0);
+#else // _WIN32
+  (void)signalNumber;
+#endif // _WIN32
+}
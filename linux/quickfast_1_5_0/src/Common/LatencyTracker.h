@@ -0,0 +1,143 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef LATENCYTRACKER_H
+#define LATENCYTRACKER_H
+#include "LatencyTracker_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/LatencyHistogram.h>
+#include <Common/Types.h>
+
+namespace QuickFAST
+{
+  /// @brief Measure the time packets and messages spend in each stage of decoding.
+  ///
+  /// Timestamps are taken when a packet is received (or taken from the kernel,
+  /// see PacketRingReceiver), when it is dequeued for decoding, when decoding
+  /// a message starts and when the builder's endMessage() returns.  From them
+  /// three kinds of LatencyHistogram are kept, all in nanoseconds:
+  ///  - queue wait: from receive to dequeue,
+  ///  - decode time: from decode start to endMessage, for each template ID,
+  ///  - end to end: from receiving the packet that held the message to endMessage.
+  ///
+  /// All timestamps are nanoseconds since 1970-01-01 UTC, the time base of
+  /// LinkedBuffer::timestamp().  The Receiver and Decoder call this from the
+  /// thread that services the queue, one thread at a time.
+  ///
+  /// The histograms can be written to a file periodically, when a signal
+  /// arrives, or both.
+  class QuickFAST_Export LatencyTracker
+  {
+  public:
+    LatencyTracker();
+    /// @brief Stops dumping.
+    ~LatencyTracker();
+
+    /// @brief The current time in nanoseconds since 1970-01-01 UTC.
+    static uint64 now();
+
+    /// @brief A packet has been taken from the queue to be decoded.
+    /// @param receiveTime when it was received; zero if unknown.
+    void packetDequeued(uint64 receiveTime)
+    {
+      uint64 time = now();
+      if(receiveTime != 0 && receiveTime <= time)
+      {
+        queueWait_.record(time - receiveTime);
+      }
+      packetTime_ = receiveTime;
+    }
+
+    /// @brief A message has been decoded and passed to the builder.
+    /// @param templateId identifies the message's template.
+    /// @param decodeStart from now() when decoding started.
+    void messageDecoded(template_id_t templateId, uint64 decodeStart)
+    {
+      uint64 time = now();
+      decodeHistogram(templateId).record(time - decodeStart);
+      if(packetTime_ != 0 && packetTime_ <= time)
+      {
+        endToEnd_.record(time - packetTime_);
+      }
+    }
+
+    /// @brief Time from receive to dequeue.
+    const LatencyHistogram & queueWait() const
+    {
+      return queueWait_;
+    }
+
+    /// @brief Time from receive to endMessage.
+    const LatencyHistogram & endToEnd() const
+    {
+      return endToEnd_;
+    }
+
+    /// @brief Time to decode messages for one template.
+    /// @returns zero if no message for the template has been decoded.
+    const LatencyHistogram * decodeTime(template_id_t templateId) const;
+
+    /// @brief Write a summary line for each histogram.
+    void writeText(std::ostream & out) const;
+
+    /// @brief Write the summary to the file given to startDumping().
+    void dump();
+
+    /// @brief Write the summary on a thread of this tracker's own.
+    ///
+    /// It is written every intervalMilliseconds, whenever the signal
+    /// set by dumpOnSignal() arrives, and when dumping stops.
+    /// @param filename names the file; cout or cerr for the standard streams.
+    ///        A file is rewritten on each dump.
+    /// @param intervalMilliseconds zero to dump only on the signal.
+    ///        Intervals are rounded up to a tenth of a second.
+    void startDumping(const std::string & filename, unsigned int intervalMilliseconds);
+
+    /// @brief Dump once more, then stop dumping.
+    void stopDumping();
+
+    /// @brief Have every tracker dump when this signal arrives.
+    ///
+    /// The handler only notes the signal; the dumping threads notice it
+    /// within a tenth of a second.  Does nothing on Windows.
+    /// @param signalNumber such as SIGUSR1
+    static void dumpOnSignal(int signalNumber);
+
+  private:
+    LatencyTracker(const LatencyTracker &);
+    LatencyTracker & operator=(const LatencyTracker &);
+
+    LatencyHistogram & decodeHistogram(template_id_t templateId)
+    {
+      if(lastDecode_ == 0 || lastTemplateId_ != templateId)
+      {
+        lastDecode_ = &findDecodeHistogram(templateId);
+        lastTemplateId_ = templateId;
+      }
+      return *lastDecode_;
+    }
+    LatencyHistogram & findDecodeHistogram(template_id_t templateId);
+    void run(unsigned int intervalMilliseconds);
+
+  private:
+    typedef boost::shared_ptr<LatencyHistogram> HistogramPtr;
+    typedef std::map<template_id_t, HistogramPtr> DecodeHistograms;
+
+    LatencyHistogram queueWait_;
+    LatencyHistogram endToEnd_;
+    uint64 packetTime_;
+    template_id_t lastTemplateId_;
+    LatencyHistogram * lastDecode_;
+    // guards adding to decodeHistograms_ against writeText().
+    mutable boost::mutex decodeMutex_;
+    DecodeHistograms decodeHistograms_;
+
+    boost::mutex dumpMutex_;
+    std::string filename_;
+    boost::scoped_ptr<boost::thread> thread_;
+  };
+}
+#endif // LATENCYTRACKER_H
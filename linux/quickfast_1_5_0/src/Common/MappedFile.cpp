@@ -0,0 +1,225 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "MappedFile.h"
+#if !defined(_WIN32)
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif // _WIN32
+
+using namespace ::QuickFAST;
+
+MappedFile::MappedFile()
+: fileSize_(0)
+, windowSize_(0)
+, discardRetired_(false)
+#if defined(_WIN32)
+, file_(INVALID_HANDLE_VALUE)
+, mapping_(NULL)
+#else // _WIN32
+, file_(-1)
+#endif // _WIN32
+{
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+bool
+MappedFile::open(const std::string & filename, size_t windowSize)
+{
+  close();
+#if defined(_WIN32)
+  file_ = ::CreateFileA(
+    filename.c_str(),
+    GENERIC_READ,
+    FILE_SHARE_READ,
+    NULL,
+    OPEN_EXISTING,
+    FILE_FLAG_SEQUENTIAL_SCAN,
+    NULL);
+  if(file_ == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+  LARGE_INTEGER size;
+  if(!::GetFileSizeEx(file_, &size))
+  {
+    close();
+    return false;
+  }
+  fileSize_ = uint64(size.QuadPart);
+  if(fileSize_ > 0)
+  {
+    // an empty file cannot be mapped.
+    mapping_ = ::CreateFileMapping(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(mapping_ == NULL)
+    {
+      close();
+      return false;
+    }
+  }
+#else // _WIN32
+  file_ = ::open(filename.c_str(), O_RDONLY);
+  if(file_ < 0)
+  {
+    return false;
+  }
+  struct stat status;
+  if(::fstat(file_, &status) != 0)
+  {
+    close();
+    return false;
+  }
+  fileSize_ = uint64(status.st_size);
+#endif // _WIN32
+
+  if(windowSize == 0)
+  {
+    windowSize = (sizeof(void *) >= 8) ? size_t(1) << 30 : size_t(1) << 26;
+  }
+  size_t unit = granularity();
+  windowSize_ = ((windowSize + unit - 1) / unit) * unit;
+  return true;
+}
+
+void
+MappedFile::close()
+{
+  unmapWindow(previous_, false);
+  unmapWindow(current_, false);
+#if defined(_WIN32)
+  if(mapping_ != NULL)
+  {
+    ::CloseHandle(mapping_);
+    mapping_ = NULL;
+  }
+  if(file_ != INVALID_HANDLE_VALUE)
+  {
+    ::CloseHandle(file_);
+    file_ = INVALID_HANDLE_VALUE;
+  }
+#else // _WIN32
+  if(file_ >= 0)
+  {
+    ::close(file_);
+    file_ = -1;
+  }
+#endif // _WIN32
+  fileSize_ = 0;
+}
+
+bool
+MappedFile::isOpen() const
+{
+#if defined(_WIN32)
+  return file_ != INVALID_HANDLE_VALUE;
+#else // _WIN32
+  return file_ >= 0;
+#endif // _WIN32
+}
+
+const unsigned char *
+MappedFile::map(uint64 offset, size_t length)
+{
+  if(offset + length > fileSize_ || !isOpen())
+  {
+    return 0;
+  }
+  if(current_.contains(offset, length))
+  {
+    return current_.base_ + size_t(offset - current_.offset_);
+  }
+  if(previous_.contains(offset, length))
+  {
+    return previous_.base_ + size_t(offset - previous_.offset_);
+  }
+  // Move the window.  Keep the current window so recent results remain valid.
+  unmapWindow(previous_, discardRetired_);
+  previous_ = current_;
+  current_ = Window();
+  if(!mapWindow(current_, offset, length))
+  {
+    return 0;
+  }
+  return current_.base_ + size_t(offset - current_.offset_);
+}
+
+bool
+MappedFile::mapWindow(Window & window, uint64 offset, size_t length)
+{
+  uint64 start = offset - (offset % granularity());
+  uint64 end = start + windowSize_;
+  if(end < offset + length)
+  {
+    end = offset + length;
+  }
+  if(end > fileSize_)
+  {
+    end = fileSize_;
+  }
+  size_t mapLength = size_t(end - start);
+#if defined(_WIN32)
+  void * base = ::MapViewOfFile(
+    mapping_,
+    FILE_MAP_READ,
+    DWORD(start >> 32),
+    DWORD(start & 0xFFFFFFFF),
+    mapLength);
+  if(base == NULL)
+  {
+    return false;
+  }
+#else // _WIN32
+  void * base = ::mmap(0, mapLength, PROT_READ, MAP_SHARED, file_, off_t(start));
+  if(base == MAP_FAILED)
+  {
+    return false;
+  }
+  (void)::madvise(base, mapLength, MADV_SEQUENTIAL);
+#endif // _WIN32
+  window.base_ = static_cast<unsigned char *>(base);
+  window.offset_ = start;
+  window.length_ = mapLength;
+  return true;
+}
+
+void
+MappedFile::unmapWindow(Window & window, bool discard)
+{
+  if(window.base_ == 0)
+  {
+    return;
+  }
+#if defined(_WIN32)
+  ::UnmapViewOfFile(window.base_);
+#else // _WIN32
+  ::munmap(window.base_, window.length_);
+#if defined(POSIX_FADV_DONTNEED)
+  if(discard)
+  {
+    // we won't be back.  Don't let these pages crowd out others.
+    (void)::posix_fadvise(file_, off_t(window.offset_), off_t(window.length_), POSIX_FADV_DONTNEED);
+  }
+#endif // POSIX_FADV_DONTNEED
+#endif // _WIN32
+  window = Window();
+}
+
+size_t
+MappedFile::granularity()
+{
+#if defined(_WIN32)
+  SYSTEM_INFO info;
+  ::GetSystemInfo(&info);
+  return info.dwAllocationGranularity;
+#else // _WIN32
+  long pageSize = ::sysconf(_SC_PAGESIZE);
+  return pageSize > 0 ? size_t(pageSize) : 4096;
+#endif // _WIN32
+}
@@ -0,0 +1,120 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+#ifndef QUICKFAST_HEADERS
+#error Please include <Application/QuickFAST.h> preferably as a precompiled header file.
+#endif //QUICKFAST_HEADERS
+
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+
+namespace QuickFAST{
+  /// @brief Read-only access to a file through memory mapping.
+  ///
+  /// The data is used in place in the operating system's page cache: no copy
+  /// is made and opening the file does not read it.
+  ///
+  /// At most two windows of the file are mapped at any one time, so files larger
+  /// than the available address space can be read.  map() moves the window forward
+  /// as needed, retaining the previous window so that data recently returned by
+  /// map() remains valid until the window moves again.
+  /// Windows are mapped with sequential read-ahead advice.  Optionally pages
+  /// belonging to a retired window are dropped from the page cache so reading a
+  /// large file once does not evict everything else (see setDiscardRetired()).
+  class QuickFAST_Export MappedFile
+  {
+  public:
+    MappedFile();
+    ~MappedFile();
+
+    /// @brief Open and map a file.
+    /// @param filename names the file.
+    /// @param windowSize is the number of bytes to map at once.
+    ///        Zero selects 1GB on 64 bit systems or 64MB on 32 bit systems.
+    ///        The file is mapped in one piece if it fits.
+    /// @returns true if the file was opened.
+    bool open(const std::string & filename, size_t windowSize = 0);
+
+    /// @brief Unmap and close the file.
+    void close();
+
+    /// @brief Is a file open?
+    bool isOpen() const;
+
+    /// @brief The size of the open file.
+    uint64 size() const
+    {
+      return fileSize_;
+    }
+
+    /// @brief The number of bytes mapped at once.
+    size_t windowSize() const
+    {
+      return windowSize_;
+    }
+
+    /// @brief Drop the pages of retired windows from the page cache.
+    ///
+    /// Off by default: the pages are dropped even if another process is
+    /// reading the same file.  Has no effect on Windows.
+    /// @param discard true to drop the pages.
+    void setDiscardRetired(bool discard)
+    {
+      discardRetired_ = discard;
+    }
+
+    /// @brief Access data from the file.
+    ///
+    /// The result remains valid until map() has moved the window twice more,
+    /// which cannot happen until at least windowSize() bytes beyond it have been mapped.
+    /// @param offset of the first byte needed.
+    /// @param length the number of contiguous bytes needed.
+    ///        It may exceed windowSize(), in which case the window is enlarged to cover it.
+    /// @returns a pointer to the data or zero if the range is not within the file.
+    const unsigned char * map(uint64 offset, size_t length);
+
+  private:
+    MappedFile(const MappedFile &);
+    MappedFile & operator=(const MappedFile &);
+
+    struct Window
+    {
+      Window()
+        : base_(0)
+        , offset_(0)
+        , length_(0)
+      {
+      }
+      bool contains(uint64 offset, size_t length) const
+      {
+        return base_ != 0 && offset >= offset_ && offset + length <= offset_ + length_;
+      }
+      unsigned char * base_;
+      uint64 offset_;
+      size_t length_;
+    };
+
+    bool mapWindow(Window & window, uint64 offset, size_t length);
+    void unmapWindow(Window & window, bool discard);
+    static size_t granularity();
+
+  private:
+    uint64 fileSize_;
+    size_t windowSize_;
+    bool discardRetired_;
+    Window current_;
+    Window previous_;
+#if defined(_WIN32)
+    HANDLE file_;
+    HANDLE mapping_;
+#else // _WIN32
+    int file_;
+#endif // _WIN32
+  };
+}
+#endif // MAPPEDFILE_H
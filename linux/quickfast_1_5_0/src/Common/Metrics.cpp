@@ -0,0 +1,316 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "Metrics.h"
+#include <Common/AtomicCounter.h>
+#include <Common/Exceptions.h>
+
+using namespace QuickFAST;
+
+#if defined(_MSC_VER)
+# define QUICKFAST_THREAD_LOCAL __declspec(thread)
+#else
+# define QUICKFAST_THREAD_LOCAL __thread
+#endif
+
+namespace
+{
+  // slot number + 1; zero until the thread first counts something.
+  QUICKFAST_THREAD_LOCAL size_t threadSlotPlusOne = 0;
+
+  boost::mutex slotMutex;
+  // private slots that have never been used or whose thread has exited.
+  std::vector<size_t> freeSlots;
+  size_t slotsIssued = 0;
+  AtomicCounter sharedSlotsIssued;
+
+  struct SlotOwner
+  {
+    size_t slot_;
+  };
+
+  // Called as a thread with a private slot exits.  The mutex orders the
+  // thread's last plain adds before the next owner's.
+  void releaseSlot(SlotOwner * owner)
+  {
+    boost::mutex::scoped_lock lock(slotMutex);
+    freeSlots.push_back(owner->slot_);
+    delete owner;
+  }
+
+  boost::thread_specific_ptr<SlotOwner> slotOwner(releaseSlot);
+
+  void appendValue(std::ostream & out, double value)
+  {
+    // counts are integers; print them without an exponent.
+    if(value == floor(value) && fabs(value) < 1e15)
+    {
+      out << static_cast<int64>(value);
+    }
+    else
+    {
+      out << std::setprecision(15) << value;
+    }
+  }
+}
+
+const size_t MetricCounter::slotCount;
+const size_t MetricCounter::sharedSlotCount;
+const size_t MetricCounter::cacheLineSize;
+
+MetricCounter::MetricCounter()
+  : storage_(new unsigned char[(slotCount + sharedSlotCount + 1) * cacheLineSize])
+  , slots_(0)
+{
+  size_t misalignment = reinterpret_cast<size_t>(storage_) % cacheLineSize;
+  slots_ = storage_ + (misalignment == 0 ? 0 : cacheLineSize - misalignment);
+  for(size_t nSlot = 0; nSlot < slotCount + sharedSlotCount; ++nSlot)
+  {
+    slot_(nSlot) = 0;
+  }
+}
+
+MetricCounter::~MetricCounter()
+{
+  delete [] storage_;
+}
+
+uint64
+MetricCounter::value() const
+{
+  uint64 sum = 0;
+  for(size_t nSlot = 0; nSlot < slotCount + sharedSlotCount; ++nSlot)
+  {
+    sum += slot_(nSlot);
+  }
+  return sum;
+}
+
+size_t
+MetricCounter::threadSlot()
+{
+  if(threadSlotPlusOne == 0)
+  {
+    size_t slot = slotCount;
+    {
+      boost::mutex::scoped_lock lock(slotMutex);
+      if(!freeSlots.empty())
+      {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+      }
+      else if(slotsIssued < slotCount)
+      {
+        slot = slotsIssued++;
+      }
+    }
+    if(slot < slotCount)
+    {
+      SlotOwner * owner = new SlotOwner;
+      owner->slot_ = slot;
+      slotOwner.reset(owner);
+    }
+    else
+    {
+      slot = slotCount + size_t(++sharedSlotsIssued) % sharedSlotCount;
+    }
+    threadSlotPlusOne = slot + 1;
+  }
+  return threadSlotPlusOne - 1;
+}
+
+void
+MetricCounter::sharedIncrement(size_t slot, uint64 count)
+{
+#if defined(_WIN32)
+  ::InterlockedExchangeAdd64(reinterpret_cast<volatile LONGLONG *>(&slot_(slot)), LONGLONG(count));
+#else
+  __sync_fetch_and_add(&slot_(slot), count);
+#endif
+}
+
+MetricGauge::MetricGauge()
+  : value_(0)
+{
+}
+
+struct MetricsRegistry::Metric
+{
+  Metric()
+    : type_(COUNTER)
+    , owner_(0)
+  {
+  }
+  std::string name_;
+  std::string help_;
+  std::string labels_;
+  Type type_;
+  const void * owner_;
+  boost::scoped_ptr<MetricCounter> counter_;
+  boost::scoped_ptr<MetricGauge> gauge_;
+  Sampler sampler_;
+};
+
+MetricsRegistry::MetricsRegistry()
+{
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+}
+
+MetricsRegistry &
+MetricsRegistry::instance()
+{
+  static MetricsRegistry registry;
+  return registry;
+}
+
+MetricsRegistry::Metric &
+MetricsRegistry::find(
+  const std::string & name,
+  const std::string & help,
+  const std::string & labels,
+  Type type,
+  const void * owner)
+{
+  // the key sorts by name first so each name's metrics are adjacent.
+  MetricPtr & metric = metrics_[name + '{' + labels + '}'];
+  if(!metric)
+  {
+    metric.reset(new Metric);
+    metric->name_ = name;
+    metric->help_ = help;
+    metric->labels_ = labels;
+    metric->type_ = type;
+    metric->owner_ = owner;
+  }
+  else if(metric->owner_ != owner)
+  {
+    // sharing would leave the other owner holding a metric that remove() destroys.
+    throw UsageError("Metrics", ("Metric is already registered by another owner: " + name + '{' + labels + '}').c_str());
+  }
+  return *metric;
+}
+
+MetricCounter &
+MetricsRegistry::counter(
+  const std::string & name,
+  const std::string & help,
+  const std::string & labels,
+  const void * owner)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  Metric & metric = find(name, help, labels, COUNTER, owner);
+  if(!metric.counter_)
+  {
+    metric.counter_.reset(new MetricCounter);
+  }
+  return *metric.counter_;
+}
+
+MetricGauge &
+MetricsRegistry::gauge(
+  const std::string & name,
+  const std::string & help,
+  const std::string & labels,
+  const void * owner)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  Metric & metric = find(name, help, labels, GAUGE, owner);
+  if(!metric.gauge_)
+  {
+    metric.gauge_.reset(new MetricGauge);
+  }
+  return *metric.gauge_;
+}
+
+void
+MetricsRegistry::addSampler(
+  const std::string & name,
+  const std::string & help,
+  const std::string & labels,
+  Type type,
+  const Sampler & sampler,
+  const void * owner)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  Metric & metric = find(name, help, labels, type, owner);
+  metric.sampler_ = sampler;
+}
+
+void
+MetricsRegistry::remove(const void * owner)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  MetricMap::iterator it = metrics_.begin();
+  while(it != metrics_.end())
+  {
+    if(it->second->owner_ == owner)
+    {
+      metrics_.erase(it++);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+void
+MetricsRegistry::snapshot(std::vector<Sample> & samples) const
+{
+  samples.clear();
+  boost::mutex::scoped_lock lock(mutex_);
+  samples.reserve(metrics_.size());
+  for(MetricMap::const_iterator it = metrics_.begin(); it != metrics_.end(); ++it)
+  {
+    const Metric & metric = *it->second;
+    Sample sample;
+    sample.name_ = metric.name_;
+    sample.help_ = metric.help_;
+    sample.labels_ = metric.labels_;
+    sample.type_ = metric.type_;
+    sample.value_ = 0.0;
+    if(metric.counter_)
+    {
+      sample.value_ = double(metric.counter_->value());
+    }
+    else if(metric.gauge_)
+    {
+      sample.value_ = double(metric.gauge_->value());
+    }
+    else if(metric.sampler_)
+    {
+      sample.value_ = metric.sampler_();
+    }
+    samples.push_back(sample);
+  }
+}
+
+void
+MetricsRegistry::writePrometheus(std::ostream & out) const
+{
+  std::vector<Sample> samples;
+  snapshot(samples);
+  const std::string * previousName = 0;
+  for(size_t nSample = 0; nSample < samples.size(); ++nSample)
+  {
+    const Sample & sample = samples[nSample];
+    if(previousName == 0 || *previousName != sample.name_)
+    {
+      out << "# HELP " << sample.name_ << ' ' << sample.help_ << '\n';
+      out << "# TYPE " << sample.name_ << (sample.type_ == COUNTER ? " counter" : " gauge") << '\n';
+      previousName = &sample.name_;
+    }
+    out << sample.name_;
+    if(!sample.labels_.empty())
+    {
+      out << '{' << sample.labels_ << '}';
+    }
+    out << ' ';
+    appendValue(out, sample.value_);
+    out << '\n';
+  }
+}
@@ -0,0 +1,224 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef METRICS_H
+#define METRICS_H
+#include "Metrics_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+
+namespace QuickFAST
+{
+  /// @brief A count that may be incremented by many threads without contention.
+  ///
+  /// Each thread adds to a slot of its own, on a cache line of its own, so
+  /// incrementing costs a plain add and never moves a cache line between
+  /// cores.  value() sums the slots without stopping the writers.
+  ///
+  /// Up to slotCount threads at a time have private slots.  A thread's slot
+  /// is released when the thread exits and may be given to a later thread.
+  /// Threads that find every private slot taken use the shared slots, which
+  /// are only ever updated with an atomic add.
+  class QuickFAST_Export MetricCounter
+  {
+  public:
+    /// @brief The number of private thread slots.
+    static const size_t slotCount = 64;
+    /// @brief The number of slots shared by threads without a private slot.
+    static const size_t sharedSlotCount = 8;
+    /// @brief Slots are this far apart.
+    static const size_t cacheLineSize = 64;
+
+    MetricCounter();
+    ~MetricCounter();
+
+    /// @brief Count something.
+    /// @param count how much to add.
+    void increment(uint64 count = 1)
+    {
+      size_t slot = threadSlot();
+      if(slot < slotCount)
+      {
+        slot_(slot) += count;
+      }
+      else
+      {
+        sharedIncrement(slot, count);
+      }
+    }
+
+    /// @brief The sum of the counts from all threads.
+    uint64 value() const;
+
+    /// @brief The slot for the calling thread.
+    /// @returns a private slot below slotCount, or a shared slot.
+    static size_t threadSlot();
+
+  private:
+    volatile uint64 & slot_(size_t slot) const
+    {
+      return *reinterpret_cast<volatile uint64 *>(slots_ + slot * cacheLineSize);
+    }
+    void sharedIncrement(size_t slot, uint64 count);
+
+  private:
+    MetricCounter(const MetricCounter &);
+    MetricCounter & operator=(const MetricCounter &);
+
+  private:
+    unsigned char * storage_;
+    unsigned char * slots_;
+  };
+
+  /// @brief A value that goes up and down, such as a queue depth.
+  ///
+  /// The last value set wins.  The value has a cache line to itself so
+  /// setting it does not disturb neighboring data.
+  class QuickFAST_Export MetricGauge
+  {
+  public:
+    MetricGauge();
+
+    /// @brief Set the value
+    void set(int64 value)
+    {
+      value_ = value;
+    }
+
+    /// @brief The most recent value
+    int64 value() const
+    {
+      return value_;
+    }
+
+  private:
+    unsigned char padBefore_[MetricCounter::cacheLineSize];
+    volatile int64 value_;
+    unsigned char padAfter_[MetricCounter::cacheLineSize];
+  };
+
+  /// @brief A set of named counters and gauges that can be exported together.
+  ///
+  /// Each metric has a name, a help string and a set of labels in Prometheus
+  /// syntax (name="value",...) that distinguishes it from other metrics with
+  /// the same name.  A metric is one of
+  ///  - a MetricCounter or MetricGauge owned by the registry and updated by the code being measured, or
+  ///  - a sampler: a function called when a snapshot is taken.  Samplers
+  ///    export statistics that are already kept elsewhere, such as the
+  ///    Receiver's counts, without adding any work to the code being measured.
+  ///
+  /// Every metric is registered on behalf of an owner, and remove() discards all
+  /// the metrics registered for an owner.  A name and labels belong to one owner
+  /// at a time: registering them for a different owner throws UsageError.  Registering, removing and taking
+  /// snapshots are serialized by a mutex, but the threads that update counters
+  /// and gauges never lock it.
+  class QuickFAST_Export MetricsRegistry
+  {
+  public:
+    /// @brief The kinds of metrics.
+    enum Type
+    {
+      COUNTER,
+      GAUGE
+    };
+
+    /// @brief A function that reads a metric.
+    typedef boost::function<double ()> Sampler;
+
+    /// @brief The value of one metric at the time of a snapshot.
+    struct Sample
+    {
+      /// @brief The metric name
+      std::string name_;
+      /// @brief A description of the metric
+      std::string help_;
+      /// @brief Labels that distinguish this metric from others with the same name
+      std::string labels_;
+      /// @brief COUNTER or GAUGE
+      Type type_;
+      /// @brief The value
+      double value_;
+    };
+
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    /// @brief The registry shared by the whole process.
+    static MetricsRegistry & instance();
+
+    /// @brief Find or create a counter.
+    /// @param name the metric name, e.g. "quickfast_decoder_messages_total"
+    /// @param help a description of the metric
+    /// @param labels distinguish this counter from others with the same name.
+    /// @param owner on whose behalf the counter is registered.
+    /// @returns the counter.  It lives until remove(owner).
+    /// @throws UsageError if another owner registered the name and labels.
+    MetricCounter & counter(
+      const std::string & name,
+      const std::string & help,
+      const std::string & labels,
+      const void * owner);
+
+    /// @brief Find or create a gauge.
+    /// @param name the metric name
+    /// @param help a description of the metric
+    /// @param labels distinguish this gauge from others with the same name.
+    /// @param owner on whose behalf the gauge is registered.
+    /// @returns the gauge.  It lives until remove(owner).
+    /// @throws UsageError if another owner registered the name and labels.
+    MetricGauge & gauge(
+      const std::string & name,
+      const std::string & help,
+      const std::string & labels,
+      const void * owner);
+
+    /// @brief Register a metric that is read by calling a function.
+    /// @param name the metric name
+    /// @param help a description of the metric
+    /// @param labels distinguish this metric from others with the same name.
+    /// @param type COUNTER or GAUGE
+    /// @param sampler is called for each snapshot until remove(owner).
+    /// @param owner on whose behalf the metric is registered.
+    /// @throws UsageError if another owner registered the name and labels.
+    void addSampler(
+      const std::string & name,
+      const std::string & help,
+      const std::string & labels,
+      Type type,
+      const Sampler & sampler,
+      const void * owner);
+
+    /// @brief Discard all metrics registered for an owner.
+    void remove(const void * owner);
+
+    /// @brief Read every metric.
+    /// @param samples receives the values, ordered by name.
+    void snapshot(std::vector<Sample> & samples) const;
+
+    /// @brief Write every metric in the Prometheus text exposition format.
+    void writePrometheus(std::ostream & out) const;
+
+  private:
+    MetricsRegistry(const MetricsRegistry &);
+    MetricsRegistry & operator=(const MetricsRegistry &);
+
+    struct Metric;
+    typedef boost::shared_ptr<Metric> MetricPtr;
+    typedef std::map<std::string, MetricPtr> MetricMap;
+
+    Metric & find(
+      const std::string & name,
+      const std::string & help,
+      const std::string & labels,
+      Type type,
+      const void * owner);
+
+  private:
+    mutable boost::mutex mutex_;
+    MetricMap metrics_;
+  };
+}
+#endif // METRICS_H
@@ -0,0 +1,192 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "MetricsExporter.h"
+#include <Common/Metrics.h>
+#include <Common/AtomicOps.h>
+
+#if !defined(_WIN32)
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif // _WIN32
+
+using namespace QuickFAST;
+
+const uint32 MetricsExporter::sharedMagic;
+
+MetricsExporter::MetricsExporter(MetricsRegistry & registry)
+  : registry_(registry)
+  , shared_(0)
+  , sharedSize_(0)
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+  stop();
+  unmapShared();
+}
+
+void
+MetricsExporter::setPrometheusFile(const std::string & filename)
+{
+  boost::mutex::scoped_lock lock(exportMutex_);
+  filename_ = filename;
+}
+
+bool
+MetricsExporter::setSharedMemory(const std::string & filename, size_t size)
+{
+  boost::mutex::scoped_lock lock(exportMutex_);
+  unmapShared();
+  if(size <= sizeof(SharedHeader))
+  {
+    return false;
+  }
+  void * address = 0;
+#if defined(_WIN32)
+  HANDLE file = ::CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE,
+    FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if(file == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+  HANDLE mapping = ::CreateFileMapping(file, NULL, PAGE_READWRITE, 0, DWORD(size), NULL);
+  ::CloseHandle(file);
+  if(mapping == NULL)
+  {
+    return false;
+  }
+  address = ::MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+  ::CloseHandle(mapping);
+#else // _WIN32
+  int fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+  if(fd < 0)
+  {
+    return false;
+  }
+  if(::ftruncate(fd, off_t(size)) == 0)
+  {
+    address = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(address == MAP_FAILED)
+    {
+      address = 0;
+    }
+  }
+  ::close(fd);
+#endif // _WIN32
+  if(address == 0)
+  {
+    return false;
+  }
+  shared_ = static_cast<unsigned char *>(address);
+  sharedSize_ = size;
+  SharedHeader * header = reinterpret_cast<SharedHeader *>(shared_);
+  header->magic_ = sharedMagic;
+  header->version_ = 1;
+  header->generation_ = 0;
+  header->length_ = 0;
+  return true;
+}
+
+void
+MetricsExporter::unmapShared()
+{
+  if(shared_ != 0)
+  {
+#if defined(_WIN32)
+    ::UnmapViewOfFile(shared_);
+#else // _WIN32
+    ::munmap(shared_, sharedSize_);
+#endif // _WIN32
+    shared_ = 0;
+    sharedSize_ = 0;
+  }
+}
+
+void
+MetricsExporter::exportNow()
+{
+  boost::mutex::scoped_lock lock(exportMutex_);
+  if(filename_.empty() && shared_ == 0)
+  {
+    return;
+  }
+  std::ostringstream text;
+  registry_.writePrometheus(text);
+  if(!filename_.empty())
+  {
+    std::string temporary = filename_ + ".tmp";
+    {
+      std::ofstream out(temporary.c_str());
+      out << text.str();
+    }
+#if defined(_WIN32)
+    ::MoveFileExA(temporary.c_str(), filename_.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else // _WIN32
+    std::rename(temporary.c_str(), filename_.c_str());
+#endif // _WIN32
+  }
+  if(shared_ != 0)
+  {
+    writeShared(text.str());
+  }
+}
+
+void
+MetricsExporter::writeShared(const std::string & text)
+{
+  SharedHeader * header = reinterpret_cast<SharedHeader *>(shared_);
+  size_t capacity = sharedSize_ - sizeof(SharedHeader);
+  size_t length = text.size();
+  if(length > capacity)
+  {
+    // cut at the end of a line
+    std::string::size_type lineEnd = text.rfind('\n', capacity - 1);
+    length = lineEnd == std::string::npos ? 0 : lineEnd + 1;
+  }
+  header->generation_ = header->generation_ + 1;
+  memory_barrier();
+  memcpy(shared_ + sizeof(SharedHeader), text.data(), length);
+  header->length_ = length;
+  memory_barrier();
+  header->generation_ = header->generation_ + 1;
+}
+
+void
+MetricsExporter::start(unsigned int intervalMilliseconds)
+{
+  stop();
+  thread_.reset(new boost::thread(boost::bind(&MetricsExporter::run, this, intervalMilliseconds)));
+}
+
+void
+MetricsExporter::stop()
+{
+  if(thread_)
+  {
+    thread_->interrupt();
+    thread_->join();
+    thread_.reset();
+  }
+}
+
+void
+MetricsExporter::run(unsigned int intervalMilliseconds)
+{
+  try
+  {
+    for(;;)
+    {
+      exportNow();
+      boost::this_thread::sleep(boost::posix_time::milliseconds(intervalMilliseconds));
+    }
+  }
+  catch(const boost::thread_interrupted &)
+  {
+    // stop() was called.
+  }
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+#include "MetricsExporter_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Metrics_fwd.h>
+#include <Common/Types.h>
+
+namespace QuickFAST
+{
+  /// @brief Publish the metrics in a MetricsRegistry periodically.
+  ///
+  /// The metrics are written in the Prometheus text format to either or both of
+  ///  - a file, replaced atomically on each export so a reader (such as the
+  ///    node_exporter textfile collector) never sees a partial file, and
+  ///  - a shared memory page: a file (usually in /dev/shm) mapped into memory.
+  ///
+  /// The shared memory page starts with a SharedHeader followed by the text.
+  /// The generation is odd while the text is being rewritten.  A reader
+  /// copies the text, then checks that the generation was even and did not
+  /// change while it was copying.  Text that does not fit is cut off at the
+  /// end of a line.
+  ///
+  /// Exports run on a thread of their own, so they never delay the threads
+  /// that receive and decode data.
+  class QuickFAST_Export MetricsExporter
+  {
+  public:
+    /// @brief The layout of the start of the shared memory page.
+    struct SharedHeader
+    {
+      /// @brief sharedMagic
+      uint32 magic_;
+      /// @brief The layout version (1)
+      uint32 version_;
+      /// @brief Odd while the text is being written.
+      volatile uint64 generation_;
+      /// @brief Bytes of text following the header.
+      volatile uint64 length_;
+    };
+    /// @brief Identifies a QuickFAST metrics page: "QFMX"
+    static const uint32 sharedMagic = 0x584D4651;
+
+    /// @brief Construct
+    /// @param registry holds the metrics to export.
+    explicit MetricsExporter(MetricsRegistry & registry);
+    /// @brief Stops exporting.
+    ~MetricsExporter();
+
+    /// @brief Write the metrics to a file.
+    /// @param filename names the file.  It is written as filename.tmp then renamed.
+    void setPrometheusFile(const std::string & filename);
+
+    /// @brief Write the metrics to a shared memory page.
+    /// @param filename names the file to be mapped, e.g. /dev/shm/quickfast_metrics.
+    /// @param size of the page in bytes, including the header.
+    /// @returns true if the file was mapped.
+    bool setSharedMemory(const std::string & filename, size_t size = 65536);
+
+    /// @brief Export once, now.
+    void exportNow();
+
+    /// @brief Export periodically on a thread of this exporter's own.
+    /// @param intervalMilliseconds the time between exports.
+    void start(unsigned int intervalMilliseconds);
+
+    /// @brief Stop exporting periodically.
+    void stop();
+
+  private:
+    MetricsExporter(const MetricsExporter &);
+    MetricsExporter & operator=(const MetricsExporter &);
+
+    void run(unsigned int intervalMilliseconds);
+    void writeShared(const std::string & text);
+    void unmapShared();
+
+  private:
+    MetricsRegistry & registry_;
+    std::string filename_;
+    unsigned char * shared_;
+    size_t sharedSize_;
+    boost::mutex exportMutex_;
+    boost::scoped_ptr<boost::thread> thread_;
+  };
+}
+#endif // METRICSEXPORTER_H
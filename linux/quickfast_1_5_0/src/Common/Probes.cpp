@@ -0,0 +1,23 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "Probes.h"
+
+#if QUICKFAST_HAS_PROBES
+// A tracer increments a probe's semaphore while it is attached.
+# define QUICKFAST_PROBE_SEMAPHORE(name) \
+  volatile unsigned short quickfast_##name##_semaphore \
+    __attribute__((section(".probes"))) = 0
+extern "C"
+{
+  QUICKFAST_PROBE_SEMAPHORE(packet_received);
+  QUICKFAST_PROBE_SEMAPHORE(gap_detected);
+  QUICKFAST_PROBE_SEMAPHORE(gap_filled);
+  QUICKFAST_PROBE_SEMAPHORE(gap_skipped);
+  QUICKFAST_PROBE_SEMAPHORE(decode_begin);
+  QUICKFAST_PROBE_SEMAPHORE(decode_end);
+  QUICKFAST_PROBE_SEMAPHORE(sequence_entry);
+  QUICKFAST_PROBE_SEMAPHORE(decode_error);
+}
+#endif // QUICKFAST_HAS_PROBES
@@ -0,0 +1,67 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef PROBES_H
+#define PROBES_H
+
+// Static tracepoints (USDT) for tracing with bpftrace, perf or SystemTap.
+//
+// Each probe compiles to a single nop plus a note in the .note.stapsdt
+// section that tells the tracer where the nop is and where to find the
+// arguments, so an unattached probe costs essentially nothing.  Attaching a
+// tracer turns the nop into a breakpoint and increments the probe's semaphore,
+// so code that must do extra work to feed a probe can test
+// QUICKFAST_PROBE_ENABLED(name) first.  For example:
+//   bpftrace -e 'usdt:./libQuickFAST.so:quickfast:decode_end { @[arg0] = count(); }'
+//
+// The probes, all in the "quickfast" provider:
+//   packet_received(void * receiver, size_t bytes)
+//   gap_detected(uint64 firstMissing, uint64 firstPresent)
+//   gap_filled(uint64 sequenceNumber, uint64 gapEnd)       a recovered packet inside a gap
+//   gap_skipped(uint64 firstMissing, uint64 firstPresent)  the gap was given up on
+//   decode_begin(uint32 templateId)
+//   decode_end(uint32 templateId, int success)
+//   sequence_entry(size_t entry, size_t length)
+//   decode_error(uint32 templateId, const char * error)
+//
+// Probes are compiled in on Linux when <sys/sdt.h> (systemtap-sdt-dev or
+// systemtap-sdt-devel) is available.  Define QUICKFAST_NO_PROBES to leave them out.
+
+#if defined(__linux__) && !defined(QUICKFAST_NO_PROBES) && defined(__has_include)
+# if __has_include(<sys/sdt.h>)
+#  define _SDT_HAS_SEMAPHORES 1
+#  include <sys/sdt.h>
+#  define QUICKFAST_HAS_PROBES 1
+# endif
+#endif
+
+#if !defined(QUICKFAST_HAS_PROBES)
+# define QUICKFAST_HAS_PROBES 0
+#endif
+
+#if QUICKFAST_HAS_PROBES
+// The semaphores are defined in Probes.cpp.  The tracer finds them by name.
+# define QUICKFAST_PROBE_SEMAPHORE(name) \
+  extern "C" volatile unsigned short quickfast_##name##_semaphore
+QUICKFAST_PROBE_SEMAPHORE(packet_received);
+QUICKFAST_PROBE_SEMAPHORE(gap_detected);
+QUICKFAST_PROBE_SEMAPHORE(gap_filled);
+QUICKFAST_PROBE_SEMAPHORE(gap_skipped);
+QUICKFAST_PROBE_SEMAPHORE(decode_begin);
+QUICKFAST_PROBE_SEMAPHORE(decode_end);
+QUICKFAST_PROBE_SEMAPHORE(sequence_entry);
+QUICKFAST_PROBE_SEMAPHORE(decode_error);
+# undef QUICKFAST_PROBE_SEMAPHORE
+# define QUICKFAST_PROBE_ENABLED(name) (quickfast_##name##_semaphore != 0)
+# define QUICKFAST_PROBE1(name, a) DTRACE_PROBE1(quickfast, name, a)
+# define QUICKFAST_PROBE2(name, a, b) DTRACE_PROBE2(quickfast, name, a, b)
+#else
+# define QUICKFAST_PROBE_ENABLED(name) false
+# define QUICKFAST_PROBE1(name, a) do {} while(0)
+# define QUICKFAST_PROBE2(name, a, b) do {} while(0)
+#endif
+
+#endif // PROBES_H
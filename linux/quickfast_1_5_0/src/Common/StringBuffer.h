@@ -542,6 +542,60 @@ namespace QuickFAST
       size_ = length;
     }
 
+    /// @brief replace the last "count" bytes with data from the character buffer
+    ///
+    /// The work done is proportional to the size of the change.  No allocation
+    /// happens unless the result is larger than the current capacity.
+    /// @param count is the number of bytes to remove from the end (limited to size())
+    /// @param source points to the data to be appended
+    /// @param length is the number of bytes to be appended
+    void replaceBack(
+      size_t count,
+      const unsigned char * source,
+      size_t length
+      )
+    {
+      if(count > size_)
+      {
+        count = size_;
+      }
+      size_t kept = size_ - count;
+      reserve(kept + length);
+      unsigned char* buffer = getBuffer();
+      std::memcpy(buffer + kept, source, length);
+      size_ = kept + length;
+      buffer[size_] = 0;
+    }
+
+    /// @brief replace the first "count" bytes with data from the character buffer
+    ///
+    /// The bytes that are kept are moved within the buffer.  No allocation
+    /// happens unless the result is larger than the current capacity.
+    /// @param count is the number of bytes to remove from the front (limited to size())
+    /// @param source points to the data to be prepended
+    /// @param length is the number of bytes to be prepended
+    void replaceFront(
+      size_t count,
+      const unsigned char * source,
+      size_t length
+      )
+    {
+      if(count > size_)
+      {
+        count = size_;
+      }
+      size_t kept = size_ - count;
+      reserve(kept + length);
+      unsigned char* buffer = getBuffer();
+      if(length != count)
+      {
+        std::memmove(buffer + length, buffer + count, kept);
+      }
+      std::memcpy(buffer, source, length);
+      size_ = kept + length;
+      buffer[size_] = 0;
+    }
+
     /// @brief cast to a standard string.
     operator std::string() const
     {
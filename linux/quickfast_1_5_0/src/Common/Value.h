@@ -191,6 +191,32 @@ namespace QuickFAST{
       setValue(reinterpret_cast<const unsigned char*>(value.c_str()), value.length());
     }
 
+    /// @brief replace the end of a string value in place
+    ///
+    /// Only meaningful if isString() is true.
+    /// @param count is the number of bytes to remove from the end of the string
+    /// @param value points to the bytes to be appended
+    /// @param length is the number of bytes to be appended
+    void replaceStringBack(size_t count, const unsigned char * value, size_t length)
+    {
+      class_ = STRING;
+      cachedString_ = true;
+      string_.replaceBack(count, value, length);
+    }
+
+    /// @brief replace the start of a string value in place
+    ///
+    /// Only meaningful if isString() is true.
+    /// @param count is the number of bytes to remove from the front of the string
+    /// @param value points to the bytes to be prepended
+    /// @param length is the number of bytes to be prepended
+    void replaceStringFront(size_t count, const unsigned char * value, size_t length)
+    {
+      class_ = STRING;
+      cachedString_ = true;
+      string_.replaceFront(count, value, length);
+    }
+
     /// @brief check for class and value equality
     bool operator == (const Value & rhs) const
     {
@@ -170,6 +170,35 @@ WorkingBuffer::append(const WorkingBuffer & rhs)
   }
 }
 
+void
+WorkingBuffer::append(const uchar * data, size_t length)
+{
+  if(reverse_)
+  {
+    if(startPos_ < length)
+    {
+      grow(capacity_ + length);
+    }
+    std::memcpy(buffer_.get() + startPos_ - length, data, length);
+    startPos_ -= length;
+  }
+  else
+  {
+    if(endPos_ + length > capacity_)
+    {
+      // grow geometrically so a series of short appends doesn't reallocate each time.
+      size_t newCapacity = capacity_ * 3 / 2;
+      if(newCapacity < endPos_ + length)
+      {
+        newCapacity = endPos_ + length;
+      }
+      grow(newCapacity);
+    }
+    std::memcpy(buffer_.get() + endPos_, data, length);
+    endPos_ += length;
+  }
+}
+
 void
 WorkingBuffer::toString(std::string & result) const
 {
@@ -105,6 +105,14 @@ namespace QuickFAST{
     /// @param rhs the buffer to be appended
     void append(const WorkingBuffer & rhs);
 
+    ///@brief Append raw data to a working buffer
+    ///
+    /// if reverse append to the front of this buffer else append to the back
+    ///
+    /// @param data points to the data to be appended
+    /// @param length is the number of bytes to be appended
+    void append(const uchar * data, size_t length);
+
     /// @brief A convenience method: copy contents to a std::string
     void toString(std::string & result) const;
 
@@ -11,12 +11,51 @@ using namespace Communication;
 boost::asio::io_service AsioService::sharedIoService_;
 AtomicCounter AsioService::sharedRunningThreadCount_;
 
+namespace
+{
+  typedef boost::shared_ptr<boost::asio::io_service> IoServicePtr;
+  typedef std::map<std::string, IoServicePtr> NamedIoServices;
+  NamedIoServices namedIoServices;
+  boost::mutex namedIoServicesMutex;
+
+  typedef boost::shared_ptr<AtomicCounter> AtomicCounterPtr;
+  typedef std::map<const boost::asio::io_service *, boost::weak_ptr<AtomicCounter> > ThreadCounts;
+  ThreadCounts threadCounts;
+  boost::mutex threadCountsMutex;
+
+  // the running thread count for an io service, shared while any AsioService uses it.
+  AtomicCounterPtr threadCountFor(const boost::asio::io_service & ioService)
+  {
+    boost::mutex::scoped_lock lock(threadCountsMutex);
+    boost::weak_ptr<AtomicCounter> & entry = threadCounts[&ioService];
+    AtomicCounterPtr count = entry.lock();
+    if(!count)
+    {
+      count.reset(new AtomicCounter);
+      entry = count;
+    }
+    return count;
+  }
+}
+
+boost::asio::io_service &
+AsioService::namedIoService(const std::string & name)
+{
+  boost::mutex::scoped_lock lock(namedIoServicesMutex);
+  IoServicePtr & ioService = namedIoServices[name];
+  if(!ioService)
+  {
+    ioService.reset(new boost::asio::io_service);
+  }
+  return *ioService;
+}
+
 AsioService::AsioService()
   : stopping_(false)
   , threadCount_(0)
   , threadCapacity_(0)
+  , runningThreadCount_(&sharedRunningThreadCount_)
   , ioService_(sharedIoService_)
-  , usingSharedService_(true)
   , logger_(0)
 {
 //  std::cout << "Create ASIO service(shared): " << (void *) this << std::endl;
@@ -26,8 +65,9 @@ AsioService::AsioService(boost::asio::io_service & ioService)
   : stopping_(false)
   , threadCount_(0)
   , threadCapacity_(0)
+  , threadCountLifetime_(threadCountFor(ioService))
+  , runningThreadCount_(threadCountLifetime_.get())
   , ioService_(ioService)
-  , usingSharedService_(false)
   , logger_(0)
 {
 //  std::cout << "Create ASIO service(specific): " << (void *) this << " :: " << (void *) &ioService <<  std::endl;
@@ -79,38 +119,79 @@ AsioService::runThreads(size_t threadCount /*= 0*/, bool useThisThread /* = true
   while(threadCount_ < threadCount)
   {
     threads_[threadCount_].reset(
-      new boost::thread(boost::bind(&AsioService::run, this)));
+      new boost::thread(boost::bind(&AsioService::runPlaced, this, threadCount_)));
     ++threadCount_;
   }
   if(useThisThread)
   {
-    run();
+    runPlaced(threadCount_);
     joinThreads();
   }
 }
 
 void
-AsioService::run()
+AsioService::runPlaced(size_t thread)
 {
-  long tc = 0;
-  if(usingSharedService_)
-  {
-    tc = ++sharedRunningThreadCount_;
-  }
-  else
+  std::string problems;
+  if(!placement_.apply(thread, problems))
   {
-    tc = ++runningThreadCount_;
+    if(logger_ != 0)
+    {
+      if(logger_->wantLog(Common::Logger::QF_LOG_WARNING))
+      {
+        logger_->logMessage(Common::Logger::QF_LOG_WARNING, problems);
+      }
+    }
+    else
+    {
+      std::cerr << problems << std::endl;
+    }
   }
+  runLoop(thread);
+}
+
+void
+AsioService::run()
+{
+  runLoop(0);
+}
+
+void
+AsioService::runLoop(size_t thread)
+{
+  long tc = ++*runningThreadCount_;
 //  std::ostringstream msg;
 //  msg << '{' << (void *) this << " :: " << (void *) &ioService_ << "} Starting AsioService thread #" << tc << std::endl;
 //  std::cout << msg.str();
 
+  IdleStrategy idle;
+  if(!idleStrategies_.empty())
+  {
+    idle = idleStrategies_[thread % idleStrategies_.size()];
+  }
+
   size_t count = 1;
   while(! stopping_ && count != 0)
   {
     try
     {
-      count = ioService_.run();
+      if(idle.blocks())
+      {
+        count = ioService_.run();
+      }
+      else if(ioService_.poll() != 0)
+      {
+        idle.reset();
+      }
+      else if(ioService_.stopped())
+      {
+        // out of work (or stopped): where run() would return.
+        count = 0;
+      }
+      else
+      {
+        idle.idle();
+      }
     }
     catch (const std::exception & ex)
     {
@@ -128,6 +209,6 @@ AsioService::run()
 //  msg2 << '{' << (void *) this << " :: " << (void *) &ioService_ << "} Stopping AsioService thread #" << tc << std::endl;
 //  std::cout << msg2.str();
 
-  --runningThreadCount_;
+  --*runningThreadCount_;
 }
 
@@ -11,6 +11,8 @@
 #include <Common/QuickFAST_Export.h>
 #include <Common/Logger_fwd.h>
 #include <Common/AtomicCounter.h>
+#include <Communication/ThreadPlacement.h>
+#include <Communication/IdleStrategy.h>
 
 // In gcc including asio.hpp in precompiled headers causes problems
 #include <boost/asio.hpp>
@@ -24,6 +26,10 @@ namespace QuickFAST
     /// Normal case is for all classes derived from AsioService to share
     /// the same boost::io_service.  The alternate constructor gives the
     /// application more control if it is needed.
+    ///
+    /// To give each group of connections an event loop of its own, construct
+    /// them with the same namedIoService(), and use setThreadPlacement() to pin
+    /// the threads that run each loop to the CPUs near the network card.
     class QuickFAST_Export AsioService
     {
     public:
@@ -39,6 +45,36 @@ namespace QuickFAST
       /// @param logger to which messages will be written
       void setLogger(Common::Logger & logger);
 
+      /// @brief Pin, name and prioritize the threads that run the event loop.
+      ///
+      /// Applies to threads started by later calls to runThreads().  Thread n
+      /// takes slot n of the placement; if this thread joins in it takes the slot
+      /// after the last additional thread.
+      /// @param placement describes where the threads should run.
+      void setThreadPlacement(const ThreadPlacement & placement)
+      {
+        placement_ = placement;
+      }
+
+      /// @brief Where the threads that run the event loop will run.
+      const ThreadPlacement & threadPlacement() const
+      {
+        return placement_;
+      }
+
+      /// @brief Decide how the threads that run the event loop wait for events.
+      ///
+      /// By default threads block in io_service::run().  Thread n uses
+      /// strategy n, cycling through the strategies if there are more threads
+      /// than strategies; run() called directly uses the first.  Threads with a
+      /// polling strategy call io_service::poll() in a loop and idle between calls.
+      /// Applies to threads started by later calls to run() or runThreads().
+      /// @param strategies the strategies.  Empty for blocking threads.
+      void setIdleStrategies(const std::vector<IdleStrategy> & strategies)
+      {
+        idleStrategies_ = strategies;
+      }
+
       /// @brief Run the event loop with this threads and threadCount additional threads.
       void runThreads(size_t threadCount = 0, bool useThisThread = true);
 
@@ -108,17 +144,28 @@ namespace QuickFAST
         ioService_.post(handler);
       }
 
+      /// @brief Find or create an io service by name.
+      ///
+      /// Every AsioService constructed with the io service for a name shares
+      /// one event loop.  The io service lives until the program exits.
+      /// @param name identifies the io service.
+      /// @returns the io service for that name.
+      static boost::asio::io_service & namedIoService(const std::string & name);
+
       /// @brief Attempt to determine how many threads are available to ASIO
+      ///
+      /// Counts the threads running the io service on behalf of any
+      /// AsioService that uses it, such as every connection sharing a namedIoService().
       /// @returns the number of threads.
       long runningThreadCount()const
       {
-        if(usingSharedService_)
-        {
-          return sharedRunningThreadCount_;
-        }
-        return runningThreadCount_;
+        return *runningThreadCount_;
       }
 
+    private:
+      void runPlaced(size_t thread);
+      void runLoop(size_t thread);
+
     private:
       // if no io_service is specified, this one
       // will be used (shared among all users)
@@ -132,10 +179,13 @@ namespace QuickFAST
       size_t threadCount_;
       size_t threadCapacity_;
 
-      AtomicCounter runningThreadCount_;
+      // shared by the AsioServices that use the same external io service.
+      boost::shared_ptr<AtomicCounter> threadCountLifetime_;
+      AtomicCounter * runningThreadCount_;
       boost::asio::io_service & ioService_;
-      bool usingSharedService_;
       Common::Logger * logger_;
+      ThreadPlacement placement_;
+      std::vector<IdleStrategy> idleStrategies_;
     };
   }
 }
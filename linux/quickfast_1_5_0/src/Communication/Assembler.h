@@ -13,6 +13,8 @@
 #include <Codecs/Decoder.h>
 #include <Communication/LinkedBuffer.h>
 #include <Common/Logger.h>
+#include <Common/Metrics_fwd.h>
+#include <Common/Exceptions.h>
 
 namespace QuickFAST{
   namespace Communication
@@ -36,6 +38,7 @@ namespace QuickFAST{
         , logger_(logger)
         , strict_(true)
         , reset_(false)
+        , exceptionFree_(false)
       {
       }
 
@@ -57,6 +60,27 @@ namespace QuickFAST{
       /// @returns true if receiving should continue; false to stop receiving
       virtual bool serviceQueue(Receiver & receiver) = 0;
 
+      /// @brief Can this Assembler process one buffer at a time via serviceBuffer()?
+      ///
+      /// If so the Receiver may pass a buffer directly to the Assembler rather
+      /// than queueing it (see Receiver::setInlineService()).
+      virtual bool supportsInlineService() const
+      {
+        return false;
+      }
+
+      /// @brief Process one buffer that did not go through the queue.
+      ///
+      /// Called only if supportsInlineService() returns true, on a thread that
+      /// is responsible for servicing the Receiver's queue.
+      /// @param receiver supplied the buffer.
+      /// @param buffer is the buffer to be processed.  It must be released to the receiver.
+      /// @returns true if receiving should continue; false to stop receiving
+      virtual bool serviceBuffer(Receiver & /*receiver*/, LinkedBuffer * /*buffer*/)
+      {
+        throw UsageError("Coding Error", "This Assembler does not support inline service.");
+      }
+
       ///////////////////
       // Implement Logger
       virtual bool wantLog(unsigned short level)
@@ -93,6 +117,24 @@ namespace QuickFAST{
         strict_ = strict;
       }
 
+      /// @brief set the flag to report decoding errors via error codes rather than exceptions.
+      /// @param exceptionFree is true to enable exception-free decoding
+      void setExceptionFree(bool exceptionFree = true)
+      {
+        exceptionFree_ = exceptionFree;
+      }
+
+      /// @brief Export this assembler's metrics, and its decoder's.
+      ///
+      /// Assemblers that keep metrics of their own override this, and call
+      /// the base version, too.
+      /// @param registry receives the metrics.
+      /// @param labels distinguish these metrics from others', e.g. connection="1"
+      virtual void registerMetrics(MetricsRegistry & registry, const std::string & labels)
+      {
+        decoder_.setMetrics(&registry, labels);
+      }
+
       /// @brief Provide direct access to the decoder.
       Codecs::Decoder & decoder()
       {
@@ -109,7 +151,26 @@ namespace QuickFAST{
       bool strict_;
       /// Reset the decoder for every message
       bool reset_;
-
+      /// Decoder records errors rather than throwing
+      bool exceptionFree_;
+
+      /// @brief Pass an error recorded by an exception-free decoder to the logger.
+      ///
+      /// The error text is formatted only if the logger wants warnings;
+      /// otherwise only the error code is passed along.
+      /// Clears the error from the decoder.
+      /// @returns the logger's verdict: true to continue decoding.
+      bool reportDecoderError()
+      {
+        std::string message(decoder_.getErrorCode());
+        if(wantLog(Common::Logger::QF_LOG_WARNING))
+        {
+          message += ' ';
+          message += decoder_.getErrorMessage();
+        }
+        decoder_.clearError();
+        return reportDecodingError(message);
+      }
 
     };
   }
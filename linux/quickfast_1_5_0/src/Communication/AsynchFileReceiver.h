@@ -111,6 +111,11 @@ namespace QuickFAST
       }
 
     private:
+      // Implement Receiver method
+      virtual bool supportsRingBuffer() const
+      {
+        return true;
+      }
 
       void handleReceiveFromFile(
         const boost::system::error_code& error,
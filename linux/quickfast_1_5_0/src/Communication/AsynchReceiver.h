@@ -42,6 +42,8 @@ namespace QuickFAST
 
       virtual void runThreads(size_t threadCount = 0, bool useThisThread = true)
       {
+        ioService_.setThreadPlacement(threadPlacement_);
+        ioService_.setIdleStrategies(idleStrategies_);
         ioService_.runThreads(threadCount, useThisThread);
       }
 
@@ -59,6 +61,7 @@ namespace QuickFAST
 
       virtual void run()
       {
+        ioService_.setIdleStrategies(idleStrategies_);
         ioService_.run();
       }
 
@@ -104,7 +107,7 @@ namespace QuickFAST
             //  msg << "AR:{"<< (void *) this <<  "} making idle buffers available" << std::endl;
             //  std::cout << msg.str() << std::flush;
             //}
-            idleBufferPool_.push(idleBuffers_);
+            recycleIdleBuffers(lock);
             // be sure we have a read request in progress
             startReceive(lock);
             // promote any ancoming messages to outgoing
@@ -152,9 +155,29 @@ namespace QuickFAST
         const boost::system::error_code& error,
         LinkedBuffer * buffer,
         size_t bytesReceived)
+      {
+        handleCoalescedReceive(error, buffer, bytesReceived, 0);
+      }
+
+      /// @brief handle I/O completion that may have received several packets at once
+      ///
+      /// Like handleReceive().
+      /// @param error indicates status of the receive
+      /// @param buffer into which the receive happened
+      /// @param bytesReceived How much data is in the buffer
+      /// @param segmentSize if nonzero and less than bytesReceived the buffer holds
+      ///        several packets of this size (the last may be shorter).  Each packet
+      ///        is queued separately.
+      void handleCoalescedReceive(
+        const boost::system::error_code& error,
+        LinkedBuffer * buffer,
+        size_t bytesReceived,
+        size_t segmentSize)
       {
         // should this thread service the queue?
         bool service = false;
+        // or process this buffer at once?
+        LinkedBuffer * inlineBuffer = 0;
         { // Scope for lock
           boost::mutex::scoped_lock lock(bufferMutex_);
           --readsInProgress_;
@@ -176,11 +199,31 @@ namespace QuickFAST
             }
             else
             {
-              ++packetsQueued_;
               bytesReceived_ += bytesReceived;
-              largestPacket_ = std::max(largestPacket_, bytesReceived);
               buffer->setUsed(bytesReceived);
-              if(queue_.push(buffer, lock))
+              stampReceived(buffer, lock);
+              QUICKFAST_PROBE2(packet_received, this, bytesReceived);
+              ringAccept(bytesReceived);
+              bool needService = false;
+              if(segmentSize != 0 && bytesReceived > segmentSize)
+              {
+                needService = queueSegments(buffer, segmentSize, lock);
+              }
+              else
+              {
+                ++packetsQueued_;
+                largestPacket_ = std::max(largestPacket_, bytesReceived);
+                if(inlineService_ && queue_.startDirectService(lock))
+                {
+                  // Nothing else is waiting.  Skip the queue.
+                  inlineBuffer = buffer;
+                }
+                else
+                {
+                  needService = queue_.push(buffer, lock);
+                }
+              }
+              if(needService)
               {
                 // A true return from push means that no one is servicing the queue
                 // Volunteer to service it. If it returns true, then the offer was
@@ -209,6 +252,10 @@ namespace QuickFAST
           // end of scope for lock
         }
 
+        if(inlineBuffer != 0)
+        {
+          service = serviceInline(inlineBuffer);
+        }
         while(service)
         {
           service = serviceQueue();
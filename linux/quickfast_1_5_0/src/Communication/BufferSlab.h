@@ -0,0 +1,269 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef BUFFERSLAB_H
+#define BUFFERSLAB_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "BufferSlab_fwd.h"
+
+#if !defined(_WIN32)
+# include <sys/mman.h>
+# include <unistd.h>
+#endif // _WIN32
+#if defined(__linux__)
+# include <sys/syscall.h>
+#endif // __linux__
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief One block of memory carved into equal sized, cache line aligned buffers.
+    ///
+    /// A Receiver can allocate its LinkedBuffers from slabs rather than
+    /// allocating each buffer separately (see Receiver::setBufferSlabs()).
+    ///
+    /// The slab is mapped directly from the operating system.  On Linux it is
+    /// backed by 2MB huge pages if they were requested and some are reserved
+    /// (vm.nr_hugepages); otherwise transparent huge pages are requested with
+    /// madvise().  Every page is touched when the slab is allocated so the
+    /// page faults happen then rather than when the first packets arrive.
+    /// The slab may also be locked into memory so it is never paged out,
+    /// and on Linux its pages may be placed on a particular NUMA node, the one
+    /// nearest the threads that will use the buffers.
+    class BufferSlab
+    {
+    public:
+      /// @brief Buffers start on a multiple of this many bytes.
+      static const size_t cacheLineSize = 64;
+      /// @brief The size of a huge page on the platforms that support them.
+      static const size_t hugePageSize = 2 * 1024 * 1024;
+
+      BufferSlab()
+        : base_(0)
+        , size_(0)
+        , stride_(0)
+        , count_(0)
+        , hugePages_(false)
+        , locked_(false)
+        , numaNode_(-1)
+      {
+      }
+
+      ~BufferSlab()
+      {
+        release();
+      }
+
+      /// @brief Map the slab.
+      /// @param bufferSize is the capacity of each buffer.  It is rounded up
+      ///        to a multiple of cacheLineSize to find the distance between buffers.
+      /// @param count is the number of buffers to carve from the slab.
+      /// @param hugePages true to try for huge pages.
+      /// @param lockMemory true to lock the slab into memory.  Failure to lock
+      ///        (usually RLIMIT_MEMLOCK) is not an error; see locked().
+      /// @param numaNode if not negative, the NUMA node that should supply the pages.
+      ///        Failure to place the pages is not an error; see numaNode().
+      /// @returns true if the slab was mapped.
+      bool allocate(size_t bufferSize, size_t count, bool hugePages, bool lockMemory, int numaNode = -1)
+      {
+        release();
+        size_t stride = ((bufferSize + cacheLineSize - 1) / cacheLineSize) * cacheLineSize;
+        if(stride == 0)
+        {
+          stride = cacheLineSize;
+        }
+        size_t size = stride * count;
+        size_t unit = pageSize();
+        size = ((size + unit - 1) / unit) * unit;
+        if(size == 0)
+        {
+          size = unit;
+        }
+#if defined(_WIN32)
+        base_ = static_cast<unsigned char *>(
+          ::VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+#else // _WIN32
+# if defined(MAP_HUGETLB)
+        if(hugePages)
+        {
+          size_t hugeSize = ((size + hugePageSize - 1) / hugePageSize) * hugePageSize;
+          void * address = ::mmap(0, hugeSize, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+          if(address != MAP_FAILED)
+          {
+            base_ = static_cast<unsigned char *>(address);
+            size = hugeSize;
+            hugePages_ = true;
+          }
+        }
+# endif // MAP_HUGETLB
+        if(base_ == 0)
+        {
+          void * address = ::mmap(0, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+          if(address != MAP_FAILED)
+          {
+            base_ = static_cast<unsigned char *>(address);
+# if defined(MADV_HUGEPAGE)
+            if(hugePages)
+            {
+              // a hint: the kernel may or may not oblige.
+              (void)::madvise(address, size, MADV_HUGEPAGE);
+            }
+# endif // MADV_HUGEPAGE
+          }
+        }
+#endif // _WIN32
+        if(base_ == 0)
+        {
+          return false;
+        }
+        size_ = size;
+        stride_ = stride;
+        count_ = size / stride;
+
+#if defined(__linux__) && defined(SYS_mbind)
+        if(numaNode >= 0)
+        {
+          // MPOL_PREFERRED: the kernel falls back to other nodes rather than fail.
+          const int preferred = 1;
+          const size_t bitsPerWord = sizeof(unsigned long) * CHAR_BIT;
+          std::vector<unsigned long> nodeMask(size_t(numaNode) / bitsPerWord + 1, 0);
+          nodeMask[size_t(numaNode) / bitsPerWord] = 1UL << (size_t(numaNode) % bitsPerWord);
+          if(::syscall(SYS_mbind, base_, size_, preferred, &nodeMask[0], nodeMask.size() * bitsPerWord + 1, 0) == 0)
+          {
+            numaNode_ = numaNode;
+          }
+        }
+#else // __linux__
+        (void)numaNode;
+#endif // __linux__
+
+        // fault every page in now.
+        for(size_t offset = 0; offset < size_; offset += unit)
+        {
+          base_[offset] = 0;
+        }
+        if(lockMemory)
+        {
+#if defined(_WIN32)
+          locked_ = ::VirtualLock(base_, size_) != 0;
+#else // _WIN32
+          locked_ = ::mlock(base_, size_) == 0;
+#endif // _WIN32
+        }
+        return true;
+      }
+
+      /// @brief Unmap the slab.
+      void release()
+      {
+        if(base_ != 0)
+        {
+#if defined(_WIN32)
+          if(locked_)
+          {
+            ::VirtualUnlock(base_, size_);
+          }
+          ::VirtualFree(base_, 0, MEM_RELEASE);
+#else // _WIN32
+          if(locked_)
+          {
+            ::munlock(base_, size_);
+          }
+          ::munmap(base_, size_);
+#endif // _WIN32
+          base_ = 0;
+          size_ = 0;
+          stride_ = 0;
+          count_ = 0;
+          hugePages_ = false;
+          locked_ = false;
+          numaNode_ = -1;
+        }
+      }
+
+      /// @brief Address of one of the buffers.
+      /// @param index should be < count()
+      unsigned char * at(size_t index) const
+      {
+        return base_ + index * stride_;
+      }
+
+      /// @brief How many buffers does the slab hold?
+      ///
+      /// Space left over when the slab is rounded up to a whole page is
+      /// used for additional buffers, so this may exceed the count requested.
+      size_t count() const
+      {
+        return count_;
+      }
+
+      /// @brief The distance between the start of adjacent buffers.
+      size_t stride() const
+      {
+        return stride_;
+      }
+
+      /// @brief The size of the slab in bytes.
+      size_t size() const
+      {
+        return size_;
+      }
+
+      /// @brief Is the slab backed by explicitly reserved huge pages?
+      ///
+      /// False does not rule out transparent huge pages.
+      bool hugePages() const
+      {
+        return hugePages_;
+      }
+
+      /// @brief Is the slab locked into memory?
+      bool locked() const
+      {
+        return locked_;
+      }
+
+      /// @brief The NUMA node the pages were placed on.
+      /// @returns the node, or -1 if the pages were not placed.
+      int numaNode() const
+      {
+        return numaNode_;
+      }
+
+      /// @brief The size of an ordinary page.
+      static size_t pageSize()
+      {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        ::GetSystemInfo(&info);
+        return info.dwPageSize;
+#else // _WIN32
+        long pageSize = ::sysconf(_SC_PAGESIZE);
+        return pageSize > 0 ? size_t(pageSize) : 4096;
+#endif // _WIN32
+      }
+
+    private:
+      BufferSlab(const BufferSlab &);
+      BufferSlab & operator=(const BufferSlab &);
+
+    private:
+      unsigned char * base_;
+      size_t size_;
+      size_t stride_;
+      size_t count_;
+      bool hugePages_;
+      bool locked_;
+      int numaNode_;
+    };
+  }
+}
+#endif // BUFFERSLAB_H
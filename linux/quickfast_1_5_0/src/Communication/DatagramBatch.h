@@ -0,0 +1,253 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef DATAGRAMBATCH_H
+#define DATAGRAMBATCH_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "DatagramBatch_fwd.h"
+#include <Common/Types.h>
+#include <Common/Exceptions.h>
+#include <boost/asio.hpp>
+
+#if defined(__linux__)
+# include <sys/socket.h>
+# include <netinet/in.h>
+# include <poll.h>
+# include <errno.h>
+#endif // __linux__
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief A set of UDP datagrams to be sent together.
+    ///
+    /// The datagrams are copied into the batch, so the caller's buffers may
+    /// be reused as soon as add() returns.  Each datagram has its own
+    /// destination.
+    ///
+    /// On Linux send() hands the whole batch to the kernel with sendmmsg(),
+    /// one system call for up to capacity() datagrams.  Elsewhere the
+    /// datagrams are sent one at a time.
+    class DatagramBatch
+    {
+    public:
+      /// @brief Construct
+      /// @param capacity is the number of datagrams that fill the batch.
+      explicit DatagramBatch(size_t capacity = 64)
+        : capacity_(capacity == 0 ? 1 : capacity)
+      {
+        entries_.reserve(capacity_);
+      }
+
+      /// @brief Change the number of datagrams that fill the batch.
+      /// @param capacity is the new capacity.  Zero is treated as one.
+      void setCapacity(size_t capacity)
+      {
+        capacity_ = (capacity == 0 ? 1 : capacity);
+        entries_.reserve(capacity_);
+      }
+
+      /// @brief The number of datagrams that fill the batch.
+      size_t capacity()const
+      {
+        return capacity_;
+      }
+
+      /// @brief Add a datagram to the batch.
+      /// @param data points to the payload.
+      /// @param size is the payload length in bytes.
+      /// @param address is the destination IPv4 address in host byte order.
+      /// @param port is the destination port.
+      /// @returns true if the batch is now full.
+      bool add(const unsigned char * data, size_t size, uint32 address, uint16 port)
+      {
+        Entry entry;
+        entry.offset_ = arena_.size();
+        entry.size_ = size;
+        entry.address_ = address;
+        entry.port_ = port;
+        arena_.insert(arena_.end(), data, data + size);
+        entries_.push_back(entry);
+        return full();
+      }
+
+      /// @brief The number of datagrams in the batch.
+      size_t size()const
+      {
+        return entries_.size();
+      }
+
+      /// @brief Is the batch empty?
+      bool empty()const
+      {
+        return entries_.empty();
+      }
+
+      /// @brief Is the batch full?
+      bool full()const
+      {
+        return entries_.size() >= capacity_;
+      }
+
+      /// @brief Access the payload of a datagram.
+      /// @param index selects the datagram.
+      const unsigned char * data(size_t index)const
+      {
+        static const unsigned char nothing = 0;
+        return arena_.empty() ? &nothing : &arena_[0] + entries_[index].offset_;
+      }
+
+      /// @brief Access the payload length of a datagram.
+      /// @param index selects the datagram.
+      size_t length(size_t index)const
+      {
+        return entries_[index].size_;
+      }
+
+      /// @brief Access the destination address of a datagram (host byte order).
+      /// @param index selects the datagram.
+      uint32 address(size_t index)const
+      {
+        return entries_[index].address_;
+      }
+
+      /// @brief Access the destination port of a datagram.
+      /// @param index selects the datagram.
+      uint16 port(size_t index)const
+      {
+        return entries_[index].port_;
+      }
+
+      /// @brief Empty the batch.
+      void clear()
+      {
+        entries_.clear();
+        arena_.clear();
+      }
+
+      /// @brief Send every datagram in the batch.
+      ///
+      /// The batch is not cleared.  If the send fails the datagrams that were
+      /// sent are removed, so the batch holds only those that were not.
+      /// A full send buffer is waited out, even on a non-blocking socket.
+      /// @param socket is an open UDP socket.
+      /// @returns the number of system calls used.
+      /// @throws CommunicationError if a send fails.
+      size_t send(boost::asio::ip::udp::socket & socket)
+      {
+        if(entries_.empty())
+        {
+          return 0;
+        }
+        size_t calls = 0;
+#if defined(__linux__)
+        size_t count = entries_.size();
+        std::vector<struct mmsghdr> headers(count);
+        std::vector<struct iovec> vectors(count);
+        std::vector<struct sockaddr_in> addresses(count);
+        memset(&headers[0], 0, sizeof(struct mmsghdr) * count);
+        memset(&addresses[0], 0, sizeof(struct sockaddr_in) * count);
+        for(size_t nEntry = 0; nEntry < count; ++nEntry)
+        {
+          const Entry & entry = entries_[nEntry];
+          vectors[nEntry].iov_base = const_cast<unsigned char *>(data(nEntry));
+          vectors[nEntry].iov_len = entry.size_;
+          addresses[nEntry].sin_family = AF_INET;
+          addresses[nEntry].sin_addr.s_addr = htonl(entry.address_);
+          addresses[nEntry].sin_port = htons(entry.port_);
+          headers[nEntry].msg_hdr.msg_iov = &vectors[nEntry];
+          headers[nEntry].msg_hdr.msg_iovlen = 1;
+          headers[nEntry].msg_hdr.msg_name = &addresses[nEntry];
+          headers[nEntry].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        }
+        size_t sent = 0;
+        while(sent < count)
+        {
+          int result = sendmmsg(socket.native_handle(), &headers[sent], unsigned(count - sent), 0);
+          ++calls;
+          if(result < 0)
+          {
+            int error = errno;
+            if(error == EINTR)
+            {
+              continue;
+            }
+            if(error == EAGAIN || error == EWOULDBLOCK)
+            {
+              // asio makes the socket non-blocking; wait for room to send.
+              struct pollfd writable;
+              writable.fd = socket.native_handle();
+              writable.events = POLLOUT;
+              writable.revents = 0;
+              if(poll(&writable, 1, -1) >= 0 || errno == EINTR)
+              {
+                continue;
+              }
+              error = errno;
+            }
+            discard(sent);
+            throw CommunicationError(std::string("sendmmsg failed: ") + strerror(error));
+          }
+          sent += size_t(result);
+        }
+#else // __linux__
+        size_t sent = 0;
+        try
+        {
+          // a synchronous send_to waits for room itself.
+          for(; sent < entries_.size(); ++sent)
+          {
+            const Entry & entry = entries_[sent];
+            boost::asio::ip::udp::endpoint endpoint(
+              boost::asio::ip::address_v4(entry.address_), entry.port_);
+            socket.send_to(boost::asio::buffer(data(sent), entry.size_), endpoint);
+            ++calls;
+          }
+        }
+        catch (const boost::system::system_error & error)
+        {
+          discard(sent);
+          throw CommunicationError(std::string("send_to failed: ") + error.what());
+        }
+#endif // __linux__
+        return calls;
+      }
+
+    private:
+      // Remove the first count datagrams.
+      void discard(size_t count)
+      {
+        if(count >= entries_.size())
+        {
+          clear();
+          return;
+        }
+        size_t bytes = entries_[count].offset_;
+        entries_.erase(entries_.begin(), entries_.begin() + count);
+        arena_.erase(arena_.begin(), arena_.begin() + bytes);
+        for(size_t nEntry = 0; nEntry < entries_.size(); ++nEntry)
+        {
+          entries_[nEntry].offset_ -= bytes;
+        }
+      }
+
+      struct Entry
+      {
+        size_t offset_;
+        size_t size_;
+        uint32 address_;
+        uint16 port_;
+      };
+      size_t capacity_;
+      std::vector<Entry> entries_;
+      std::vector<unsigned char> arena_;
+    };
+  }
+}
+#endif // DATAGRAMBATCH_H
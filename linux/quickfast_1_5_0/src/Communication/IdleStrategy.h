@@ -0,0 +1,221 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef IDLESTRATEGY_H
+#define IDLESTRATEGY_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "IdleStrategy_fwd.h"
+#include <Common/Exceptions.h>
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief What a thread does when it has nothing to do.
+    ///
+    /// BLOCK waits in the operating system until work arrives.  This is the
+    /// default and costs nothing while idle, but waking up takes several
+    /// microseconds.  The other modes keep the thread polling:
+    ///  - SPIN checks for work continuously, dedicating a core to the thread.
+    ///  - YIELD spins for a while, then offers the core to other threads between checks.
+    ///  - PARK spins, then yields, then sleeps between checks for periods that
+    ///    double up to a limit.
+    ///
+    /// A polling thread calls idle() each time it finds nothing to do and
+    /// reset() when it finds work.  Each thread needs its own copy.
+    class IdleStrategy
+    {
+    public:
+      /// @brief The idle modes.
+      enum Mode
+      {
+        BLOCK,
+        SPIN,
+        YIELD,
+        PARK
+      };
+
+      /// @brief Construct
+      /// @param mode what to do when idle.
+      /// @param spins how many times to spin before yielding (YIELD and PARK)
+      /// @param yields how many times to yield before sleeping (PARK)
+      /// @param maxParkMicroseconds the longest sleep (PARK)
+      explicit IdleStrategy(
+          Mode mode = BLOCK,
+          size_t spins = 1000,
+          size_t yields = 100,
+          size_t maxParkMicroseconds = 1000)
+        : mode_(mode)
+        , spins_(spins)
+        , yields_(yields)
+        , maxPark_(maxParkMicroseconds == 0 ? 1 : maxParkMicroseconds)
+        , count_(0)
+        , park_(1)
+      {
+      }
+
+      /// @brief What to do when idle.
+      Mode mode() const
+      {
+        return mode_;
+      }
+
+      /// @brief Should the thread wait in the operating system rather than poll?
+      bool blocks() const
+      {
+        return mode_ == BLOCK;
+      }
+
+      /// @brief Nothing to do this time.
+      void idle()
+      {
+        switch(mode_)
+        {
+        case SPIN:
+          pause();
+          break;
+        case YIELD:
+          if(count_ < spins_)
+          {
+            pause();
+          }
+          else
+          {
+            boost::this_thread::yield();
+          }
+          break;
+        case PARK:
+          if(count_ < spins_)
+          {
+            pause();
+          }
+          else if(count_ < spins_ + yields_)
+          {
+            boost::this_thread::yield();
+          }
+          else
+          {
+            boost::this_thread::sleep(boost::posix_time::microseconds(park_));
+            park_ = park_ * 2 > maxPark_ ? maxPark_ : park_ * 2;
+          }
+          break;
+        default:
+          boost::this_thread::yield();
+          break;
+        }
+        ++count_;
+      }
+
+      /// @brief Work was found; start over.
+      void reset()
+      {
+        count_ = 0;
+        park_ = 1;
+      }
+
+      /// @brief Tell the processor this thread is spinning.
+      static void pause()
+      {
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+        __builtin_ia32_pause();
+#elif defined(_WIN32)
+        YieldProcessor();
+#endif
+      }
+
+      /// @brief Parse a list of idle strategies, one per thread.
+      ///
+      /// Strategies are separated by colons (as are the threads in a
+      /// ThreadPlacement).  Each is a mode optionally followed by its limits:
+      ///   block
+      ///   spin
+      ///   yield[,spins]
+      ///   park[,spins[,yields[,maxParkMicroseconds]]]
+      /// For example "spin:park,100,10,500" has the first thread spin and
+      /// the second park.
+      /// @param description the list.
+      /// @param strategies receives the strategies.
+      /// @throws UsageError if the description cannot be parsed.
+      static void parse(const std::string & description, std::vector<IdleStrategy> & strategies)
+      {
+        std::vector<IdleStrategy> result;
+        std::string::size_type start = 0;
+        while(start <= description.size())
+        {
+          std::string::size_type end = description.find(':', start);
+          if(end == std::string::npos)
+          {
+            end = description.size();
+          }
+          std::vector<std::string> fields;
+          std::string::size_type fieldStart = start;
+          while(fieldStart <= end)
+          {
+            std::string::size_type fieldEnd = description.find(',', fieldStart);
+            if(fieldEnd == std::string::npos || fieldEnd > end)
+            {
+              fieldEnd = end;
+            }
+            fields.push_back(description.substr(fieldStart, fieldEnd - fieldStart));
+            fieldStart = fieldEnd + 1;
+          }
+          Mode mode = BLOCK;
+          size_t maxFields = 1;
+          if(fields[0] == "block")
+          {
+            mode = BLOCK;
+          }
+          else if(fields[0] == "spin")
+          {
+            mode = SPIN;
+          }
+          else if(fields[0] == "yield")
+          {
+            mode = YIELD;
+            maxFields = 2;
+          }
+          else if(fields[0] == "park")
+          {
+            mode = PARK;
+            maxFields = 4;
+          }
+          else
+          {
+            throw UsageError("Invalid idle strategy", description.c_str());
+          }
+          if(fields.size() > maxFields)
+          {
+            throw UsageError("Invalid idle strategy", description.c_str());
+          }
+          size_t limits[3] = {1000, 100, 1000};
+          for(size_t nField = 1; nField < fields.size(); ++nField)
+          {
+            const std::string & field = fields[nField];
+            if(field.empty() || field.find_first_not_of("0123456789") != std::string::npos)
+            {
+              throw UsageError("Invalid idle strategy", description.c_str());
+            }
+            limits[nField - 1] = boost::lexical_cast<size_t>(field);
+          }
+          result.push_back(IdleStrategy(mode, limits[0], limits[1], limits[2]));
+          start = end + 1;
+        }
+        strategies.swap(result);
+      }
+
+    private:
+      Mode mode_;
+      size_t spins_;
+      size_t yields_;
+      size_t maxPark_;
+      size_t count_;
+      size_t park_;
+    };
+  }
+}
+#endif // IDLESTRATEGY_H
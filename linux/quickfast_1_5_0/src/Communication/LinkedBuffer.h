@@ -27,6 +27,14 @@ namespace QuickFAST
     ///
     /// A LinkedBuffer also has a flags field containing 32 uncommitted flags that may be
     /// used for whatever purpose is needed.
+    ///
+    /// Receivers record when the data arrived in the timestamp.  Data read from
+    /// a capture file also carries the time it was captured (see captureTime()).
+    ///
+    /// A buffer that received several packets at once (see
+    /// MulticastReceiver::setGenericReceiveOffload()) is delivered as a set of
+    /// segments: LinkedBuffers that view part of the parent buffer's data.
+    /// The parent is reused after all of its segments have been released.
     class LinkedBuffer
     {
     public:
@@ -39,6 +47,11 @@ namespace QuickFAST
         , used_(0)
         , extra_(0)
         , flags_(0)
+        , timestamp_(0)
+        , captureTime_(0)
+        , parent_(0)
+        , segmentsOutstanding_(0)
+        , owned_(true)
       {
       }
 
@@ -52,6 +65,12 @@ namespace QuickFAST
         , capacity_(0)
         , used_(0)
         , extra_(0)
+        , flags_(0)
+        , timestamp_(0)
+        , captureTime_(0)
+        , parent_(0)
+        , segmentsOutstanding_(0)
+        , owned_(false)
       {
       }
 
@@ -65,12 +84,18 @@ namespace QuickFAST
         , capacity_(0)
         , used_(used)
         , extra_(extra)
+        , flags_(0)
+        , timestamp_(0)
+        , captureTime_(0)
+        , parent_(0)
+        , segmentsOutstanding_(0)
+        , owned_(false)
       {
       }
 
       ~LinkedBuffer()
       {
-        if(capacity_ != 0)
+        if(owned_)
         {
           delete[] buffer_;
         }
@@ -121,16 +146,29 @@ namespace QuickFAST
       ///
       void setExternal(const unsigned char * externalBuffer, size_t used, void * extra = 0)
       {
-        if(capacity_ != 0)
+        if(owned_)
         {
           delete[] buffer_;
-          capacity_ = 0;
+          owned_ = false;
         }
+        capacity_ = 0;
         buffer_ = const_cast<unsigned char *>(externalBuffer);
         used_ = used;
         extra_ = extra;
       }
 
+      /// @brief set writable external buffer
+      ///
+      /// Unlike setExternal() the buffer may be filled by a Receiver.
+      /// The memory is not owned by this LinkedBuffer.
+      /// @param externalBuffer where the data will be stored
+      /// @param capacity how many bytes may be stored there
+      void setExternalCapacity(unsigned char * externalBuffer, size_t capacity)
+      {
+        setExternal(externalBuffer, 0);
+        capacity_ = capacity;
+      }
+
       /// @brief Set the number of bytes used in this buffer
       /// @param used byte count
       void setUsed(size_t used)
@@ -171,6 +209,70 @@ namespace QuickFAST
         return extra_;
       }
 
+      /// @brief Record when the data in this buffer arrived.
+      /// @param timestamp is nanoseconds since 1970-01-01 UTC; zero means unknown.
+      void setTimestamp(uint64 timestamp)
+      {
+        timestamp_ = timestamp;
+      }
+
+      /// @brief When did the data in this buffer arrive?
+      /// @returns nanoseconds since 1970-01-01 UTC; zero means unknown.
+      uint64 timestamp() const
+      {
+        return timestamp_;
+      }
+
+      /// @brief Record when the data in this buffer was originally captured.
+      /// @param captureTime is nanoseconds since 1970-01-01 UTC; zero means unknown.
+      void setCaptureTime(uint64 captureTime)
+      {
+        captureTime_ = captureTime;
+      }
+
+      /// @brief When was the data in this buffer captured?
+      ///
+      /// Set only by receivers that replay a capture file.  Unlike timestamp()
+      /// this may be long ago.
+      /// @returns nanoseconds since 1970-01-01 UTC; zero means unknown.
+      uint64 captureTime() const
+      {
+        return captureTime_;
+      }
+
+      /// @brief Make this buffer a view of part of the data in another buffer.
+      /// @param parent is the buffer that holds the data.
+      /// @param offset is where the data for this segment starts in parent.
+      /// @param used is how many bytes are in this segment.
+      void setSegment(LinkedBuffer * parent, size_t offset, size_t used)
+      {
+        setExternal(parent->get() + offset, used);
+        parent_ = parent;
+        timestamp_ = parent->timestamp();
+        captureTime_ = parent->captureTime();
+      }
+
+      /// @brief If this buffer is a segment, the buffer that holds its data.
+      /// @returns the parent buffer or zero if this is not a segment.
+      LinkedBuffer * parent() const
+      {
+        return parent_;
+      }
+
+      /// @brief Record how many segments view this buffer's data.
+      /// @param segments is the number of segments.
+      void setSegmentCount(size_t segments)
+      {
+        segmentsOutstanding_ = segments;
+      }
+
+      /// @brief One of the segments that view this buffer is no longer needed.
+      /// @returns true if this was the last one, so this buffer may be reused.
+      bool releaseSegment()
+      {
+        return --segmentsOutstanding_ == 0;
+      }
+
       /// @brief Set flag bit(s) in this buffer.
       /// @param mask is a mask of the bit(s) to be set
       void setFlag(uint32 mask)
@@ -216,6 +318,11 @@ namespace QuickFAST
       size_t used_;
       void * extra_;
       uint32 flags_;
+      uint64 timestamp_;
+      uint64 captureTime_;
+      LinkedBuffer * parent_;
+      size_t segmentsOutstanding_;
+      bool owned_;
     };
 
   }
@@ -0,0 +1,212 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef MAGICRING_H
+#define MAGICRING_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "MagicRing_fwd.h"
+
+#if !defined(_WIN32)
+# include <sys/mman.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+# include <stdlib.h>
+#endif // _WIN32
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief A ring of memory mapped twice, back-to-back, in virtual memory.
+    ///
+    /// The same physical pages appear at get() and at get() + size(),
+    /// so any span of up to size() bytes that starts within the ring
+    /// can be addressed as one contiguous block, even if it wraps around
+    /// the end of the ring.
+    ///
+    /// On Linux the memory is an anonymous memfd.  On other POSIX systems
+    /// it is an unlinked temporary file.  On Windows it is a pagefile-backed
+    /// section mapped into adjacent views.
+    class MagicRing
+    {
+    public:
+      MagicRing()
+        : base_(0)
+        , size_(0)
+      {
+      }
+
+      ~MagicRing()
+      {
+        release();
+      }
+
+      /// @brief Map the ring.
+      /// @param minimumSize the ring will be at least this big.  It will be
+      ///        rounded up to a multiple of granularity().
+      /// @returns true if the ring was mapped; false if the platform refused.
+      bool allocate(size_t minimumSize)
+      {
+        release();
+        size_t unit = granularity();
+        size_t size = ((minimumSize + unit - 1) / unit) * unit;
+        if(size == 0)
+        {
+          size = unit;
+        }
+#if defined(_WIN32)
+        HANDLE mapping = ::CreateFileMapping(
+          INVALID_HANDLE_VALUE,
+          NULL,
+          PAGE_READWRITE,
+          DWORD((boost::uint64_t(size) >> 32) & 0xFFFFFFFF),
+          DWORD(size & 0xFFFFFFFF),
+          NULL);
+        if(mapping == NULL)
+        {
+          return false;
+        }
+        // Another thread may grab the reserved address range between
+        // VirtualFree and MapViewOfFileEx, so try a few times.
+        for(int attempt = 0; base_ == 0 && attempt < 10; ++attempt)
+        {
+          void * address = ::VirtualAlloc(NULL, 2 * size, MEM_RESERVE, PAGE_NOACCESS);
+          if(address == NULL)
+          {
+            break;
+          }
+          ::VirtualFree(address, 0, MEM_RELEASE);
+          void * low = ::MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size, address);
+          if(low != 0)
+          {
+            void * high = ::MapViewOfFileEx(
+              mapping, FILE_MAP_ALL_ACCESS, 0, 0, size,
+              static_cast<unsigned char *>(address) + size);
+            if(high != 0)
+            {
+              base_ = static_cast<unsigned char *>(low);
+            }
+            else
+            {
+              ::UnmapViewOfFile(low);
+            }
+          }
+        }
+        ::CloseHandle(mapping);
+#else // _WIN32
+        int fd = -1;
+#if defined(SYS_memfd_create)
+        fd = int(::syscall(SYS_memfd_create, "QuickFAST.ring", 0));
+#endif // SYS_memfd_create
+        if(fd < 0)
+        {
+          char name[] = "/tmp/QuickFAST.ringXXXXXX";
+          fd = ::mkstemp(name);
+          if(fd < 0)
+          {
+            return false;
+          }
+          ::unlink(name);
+        }
+        if(::ftruncate(fd, off_t(size)) == 0)
+        {
+          // Reserve address space for both copies, then map the file over each half.
+          void * address = ::mmap(0, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+          if(address != MAP_FAILED)
+          {
+            unsigned char * low = static_cast<unsigned char *>(address);
+            if(::mmap(low, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == low
+              && ::mmap(low + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == low + size)
+            {
+              base_ = low;
+            }
+            else
+            {
+              ::munmap(address, 2 * size);
+            }
+          }
+        }
+        // the mappings keep the memory alive.
+        ::close(fd);
+#endif // _WIN32
+        if(base_ != 0)
+        {
+          size_ = size;
+        }
+        return base_ != 0;
+      }
+
+      /// @brief Unmap the ring.
+      void release()
+      {
+        if(base_ != 0)
+        {
+#if defined(_WIN32)
+          ::UnmapViewOfFile(base_ + size_);
+          ::UnmapViewOfFile(base_);
+#else // _WIN32
+          ::munmap(base_, 2 * size_);
+#endif // _WIN32
+          base_ = 0;
+          size_ = 0;
+        }
+      }
+
+      /// @brief Access the start of the ring.
+      ///
+      /// get()[n] and get()[n + size()] are the same byte for n < size().
+      unsigned char * get() const
+      {
+        return base_;
+      }
+
+      /// @brief The size of the ring (not counting the second mapping)
+      size_t size() const
+      {
+        return size_;
+      }
+
+      /// @brief Address of a position in the ring.
+      /// @param offset any offset; reduced modulo size()
+      unsigned char * at(size_t offset) const
+      {
+        return base_ + (offset % size_);
+      }
+
+      /// @brief Does data at next continue data that ends at end?
+      ///
+      /// end may lie in the second mapping; next always lies in the first.
+      bool follows(const unsigned char * end, const unsigned char * next) const
+      {
+        return next == end || next + size_ == end;
+      }
+
+      /// @brief The ring size must be a multiple of this value.
+      static size_t granularity()
+      {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        ::GetSystemInfo(&info);
+        return info.dwAllocationGranularity;
+#else // _WIN32
+        long pageSize = ::sysconf(_SC_PAGESIZE);
+        return pageSize > 0 ? size_t(pageSize) : 4096;
+#endif // _WIN32
+      }
+
+    private:
+      MagicRing(const MagicRing &);
+      MagicRing & operator=(const MagicRing &);
+
+    private:
+      unsigned char * base_;
+      size_t size_;
+    };
+  }
+}
+#endif // MAGICRING_H
@@ -0,0 +1,23 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef MAGICRING_FWD_H
+#define MAGICRING_FWD_H
+#ifndef QUICKFAST_HEADERS
+#error Please include <Application/QuickFAST.h> preferably as a precompiled header file.
+#endif //QUICKFAST_HEADERS
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    class MagicRing;
+    /// @brief smart pointer to a MagicRing
+    typedef boost::scoped_ptr<MagicRing> MagicRingPtr;
+  }
+}
+#endif // MAGICRING_FWD_H
@@ -0,0 +1,101 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef MAPPEDFILERECEIVER_H
+#define MAPPEDFILERECEIVER_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "MappedFileReceiver_fwd.h"
+#include <Communication/SynchReceiver.h>
+#include <Common/MappedFile.h>
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief A Receiver that delivers a file directly from memory mapped pages.
+    ///
+    /// Like BufferedRawFileReceiver no data is copied into the Receiver's buffers,
+    /// but the file is not read into memory first.  Each buffer points to the next
+    /// chunk of the mapping, and the operating system reads ahead as needed.
+    /// Files larger than the address space are handled by moving the mapped window.
+    class MappedFileReceiver
+      : public SynchReceiver
+    {
+    public:
+      /// @brief Construct given a file name
+      /// @param fileName names the file to be read.
+      /// @param chunkSize the number of bytes delivered in each buffer.
+      /// @param windowSize the number of bytes mapped at once (see MappedFile).
+      ///        bufferCount * chunkSize must be much smaller than windowSize.
+      MappedFileReceiver(
+        const std::string & fileName,
+        size_t chunkSize = 1024 * 1024,
+        size_t windowSize = 0
+        )
+        : fileName_(fileName)
+        , chunkSize_(chunkSize)
+        , windowSize_(windowSize)
+        , position_(0)
+      {
+      }
+
+      ~MappedFileReceiver()
+      {
+      }
+
+      /// @brief Drop the file's pages from the page cache once they are passed.
+      /// @param discard true to drop them (see MappedFile::setDiscardRetired()).
+      void setDiscardRetired(bool discard)
+      {
+        file_.setDiscardRetired(discard);
+      }
+
+    private:
+
+      // Implement Receiver method
+      virtual bool initializeReceiver()
+      {
+        position_ = 0;
+        return file_.open(fileName_, windowSize_) && file_.size() > 0;
+      }
+
+      // Implement Receiver method
+      bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock& lock)
+      {
+        bool result = false;
+        if(!stopping_ && position_ < file_.size())
+        {
+          size_t size = size_t(std::min(uint64(chunkSize_), file_.size() - position_));
+          const unsigned char * data = file_.map(position_, size);
+          if(data != 0)
+          {
+            position_ += size;
+            buffer->setExternal(data, size);
+            (void) acceptFullBuffer(buffer, size, lock);
+            result = true;
+          }
+        }
+        return result;
+      }
+
+      // Implement Receiver method
+      virtual void resetService()
+      {
+        ;
+      }
+
+    private:
+      std::string fileName_;
+      size_t chunkSize_;
+      size_t windowSize_;
+      MappedFile file_;
+      uint64 position_;
+    };
+  }
+}
+#endif // MAPPEDFILERECEIVER_H
@@ -11,6 +11,25 @@
 //#include <Common/QuickFAST_Export.h>
 #include "MulticastReceiver_fwd.h"
 #include <Communication/AsynchReceiver.h>
+#if defined(__linux__)
+# include <sys/types.h>
+# include <sys/socket.h>
+# include <netinet/in.h>
+# include <netinet/udp.h>
+# include <errno.h>
+# include <string.h>
+# if !defined(SOL_UDP)
+#  define SOL_UDP 17
+# endif
+# if !defined(UDP_GRO)
+   // Kernels older than 5.0 reject this option; the receiver falls back to one packet per read.
+#  define UDP_GRO 104
+# endif
+# define QUICKFAST_UDP_GRO
+# if !defined(SO_BUSY_POLL)
+#  define SO_BUSY_POLL 46
+# endif
+#endif
 
 namespace QuickFAST
 {
@@ -44,6 +63,7 @@ namespace QuickFAST
         , socket_(ioService)
         , joined_(false)
         , readInProgress_(false)
+        , gro_(false)
         {
         }
 
@@ -73,6 +93,31 @@ namespace QuickFAST
           return true;
         }
 
+        /// @brief Ask the kernel to coalesce datagrams.  Call after initializeReceiver()
+        /// @returns true if the kernel accepted the request.
+        bool enableGenericReceiveOffload()
+        {
+#if defined(QUICKFAST_UDP_GRO)
+          int on = 1;
+          gro_ = ::setsockopt(socket_.native_handle(), SOL_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+#endif
+          return gro_;
+        }
+
+        /// @brief Ask the kernel to poll the device queue when a read would block.
+        /// @param microseconds how long to poll.
+        /// @returns true if the kernel accepted the request.
+        bool enableBusyPoll(unsigned int microseconds)
+        {
+#if defined(__linux__)
+          int value = int(microseconds);
+          return ::setsockopt(socket_.native_handle(), SOL_SOCKET, SO_BUSY_POLL, &value, sizeof(value)) == 0;
+#else
+          (void)microseconds;
+          return false;
+#endif
+        }
+
         bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock &)
         {
           if(readInProgress_)
@@ -81,6 +126,13 @@ namespace QuickFAST
           }
           readInProgress_ = true;
 //          std::cout << "Start read on feed: " << name_ << std::endl;
+#if defined(QUICKFAST_UDP_GRO)
+          if(gro_)
+          {
+            waitReadable(buffer);
+            return true;
+          }
+#endif
           socket_.async_receive_from(
             boost::asio::buffer(buffer->get(), buffer->capacity()),
             senderEndpoint_,
@@ -93,15 +145,100 @@ namespace QuickFAST
           return true;
         }
 
+#if defined(QUICKFAST_UDP_GRO)
+        // asio cannot deliver the control message that carries the segment size,
+        // so wait until the socket is readable then read with recvmsg.
+        void waitReadable(LinkedBuffer * buffer)
+        {
+          socket_.async_receive(
+            boost::asio::null_buffers(),
+            boost::bind(&MulticastFeed::handleReadable,
+              this,
+              boost::asio::placeholders::error,
+              buffer)
+            );
+        }
+
+        void handleReadable(
+          const boost::system::error_code& error,
+          LinkedBuffer * buffer)
+        {
+          boost::system::error_code result(error);
+          size_t bytesReceived = 0;
+          size_t segmentSize = 0;
+          if(!result)
+          {
+            struct iovec data;
+            data.iov_base = buffer->get();
+            data.iov_len = buffer->capacity();
+            char control[CMSG_SPACE(sizeof(int))];
+            struct msghdr header;
+            memset(&header, 0, sizeof(header));
+            header.msg_iov = &data;
+            header.msg_iovlen = 1;
+            header.msg_control = control;
+            header.msg_controllen = sizeof(control);
+            ssize_t received = ::recvmsg(socket_.native_handle(), &header, MSG_DONTWAIT);
+            if(received >= 0)
+            {
+              bytesReceived = size_t(received);
+              for(struct cmsghdr * message = CMSG_FIRSTHDR(&header);
+                message != 0;
+                message = CMSG_NXTHDR(&header, message))
+              {
+                if(message->cmsg_level == SOL_UDP && message->cmsg_type == UDP_GRO)
+                {
+                  int size = 0;
+                  memcpy(&size, CMSG_DATA(message), sizeof(size));
+                  segmentSize = size_t(size);
+                }
+              }
+              if((header.msg_flags & MSG_TRUNC) != 0)
+              {
+                // The datagrams did not fit in the buffer.  Keep the whole ones;
+                // the partial one at the end is not a packet.
+                size_t kept = 0;
+                if(segmentSize != 0)
+                {
+                  kept = bytesReceived - bytesReceived % segmentSize;
+                }
+                parent_.reportTruncatedReceive(name_, bytesReceived - kept, buffer->capacity());
+                bytesReceived = kept;
+              }
+            }
+            else if((errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) && !parent_.stopping_)
+            {
+              // Spurious wakeup.  Keep waiting.
+              waitReadable(buffer);
+              return;
+            }
+            else
+            {
+              result = boost::system::error_code(errno, boost::asio::error::get_system_category());
+            }
+          }
+          completeReceive(result, buffer, bytesReceived, segmentSize);
+        }
+#endif
+
         void handleReceive(
           const boost::system::error_code& error,
           LinkedBuffer * buffer,
           size_t bytesReceived)
         {
+          completeReceive(error, buffer, bytesReceived, 0);
+        }
+
+        void completeReceive(
+          const boost::system::error_code& error,
+          LinkedBuffer * buffer,
+          size_t bytesReceived,
+          size_t segmentSize)
+        {
 //          std::cout << "Receive on feed: " << name_ << std::endl;
           assert(readInProgress_);
           readInProgress_ = false;
-          parent_.handleReceive(error, buffer, bytesReceived);
+          parent_.handleCoalescedReceive(error, buffer, bytesReceived, segmentSize);
           if(parent_.stopping_)
           {
             if(joined_)
@@ -198,6 +335,11 @@ namespace QuickFAST
         {
           return readInProgress_;
         }
+
+        bool genericReceiveOffload()const
+        {
+          return gro_;
+        }
       private:
         MulticastFeed();
         MulticastFeed(const MulticastFeed &);
@@ -214,6 +356,7 @@ namespace QuickFAST
         boost::asio::ip::udp::socket socket_;
         bool joined_;
         bool readInProgress_;
+        bool gro_;
       };
       typedef boost::shared_ptr<MulticastFeed> MulticastFeedPtr;
       typedef std::vector<MulticastFeedPtr> MulticastFeedVector;
@@ -223,12 +366,18 @@ namespace QuickFAST
       /// @brief Construct
       MulticastReceiver()
         : AsynchReceiver()
+        , groRequested_(false)
+        , busyPoll_(0)
+        , truncatedReceives_(0)
       {
       }
 
       /// @brief construct given shared io_service
       MulticastReceiver(boost::asio::io_service & ioService)
         : AsynchReceiver(ioService)
+        , groRequested_(false)
+        , busyPoll_(0)
+        , truncatedReceives_(0)
       {
       }
 
@@ -246,6 +395,9 @@ namespace QuickFAST
         unsigned short portNumber
         )
         : AsynchReceiver()
+        , groRequested_(false)
+        , busyPoll_(0)
+        , truncatedReceives_(0)
       {
         addFeed(
          "default",
@@ -270,6 +422,9 @@ namespace QuickFAST
         unsigned short portNumber
         )
         : AsynchReceiver(ioService)
+        , groRequested_(false)
+        , busyPoll_(0)
+        , truncatedReceives_(0)
       {
         addFeed(
          "default",
@@ -307,6 +462,49 @@ namespace QuickFAST
         feeds_.push_back(feed);
       }
 
+      /// @brief Let the kernel deliver several datagrams in one buffer (Linux UDP_GRO).
+      ///
+      /// Must be called before start().  Consecutive datagrams from the same
+      /// sender arrive together, which saves a system call per datagram.  Each
+      /// datagram is still passed to the Assembler in a buffer of its own: a
+      /// LinkedBuffer that views the data in place (see LinkedBuffer::setSegment()).
+      ///
+      /// The buffer size passed to start() limits how many datagrams can arrive at
+      /// once.  Use groBufferSize: a read that does not fit is truncated, and the
+      /// datagrams past the end of the buffer are lost (see truncatedReceives()).
+      ///
+      /// Ignored on other platforms or if the kernel does not support it.
+      /// @param gro true to enable generic receive offload.
+      void setGenericReceiveOffload(bool gro = true)
+      {
+        groRequested_ = gro;
+      }
+
+      /// @brief Buffer size that holds the largest read generic receive offload can deliver.
+      static const size_t groBufferSize = 65536;
+
+      /// @brief How many coalesced reads did not fit in the buffer.
+      ///
+      /// The datagrams past the end of the buffer are lost.
+      size_t truncatedReceives()const
+      {
+        return truncatedReceives_;
+      }
+
+      /// @brief Let the kernel busy poll the network device (Linux SO_BUSY_POLL).
+      ///
+      /// Must be called before start().  A read that finds no data polls the
+      /// device queue for up to this long instead of waiting for an interrupt.
+      /// Most useful with a polling IdleStrategy (see Receiver::setIdleStrategies()).
+      /// Raising the value above the net.core.busy_read default needs CAP_NET_ADMIN.
+      ///
+      /// Ignored on other platforms.
+      /// @param microseconds how long to poll; zero for the system default.
+      void setBusyPoll(unsigned int microseconds)
+      {
+        busyPoll_ = microseconds;
+      }
+
       // Implement Receiver method
       virtual bool initializeReceiver()
       {
@@ -326,6 +524,21 @@ namespace QuickFAST
               assembler_->logMessage(Common::Logger::QF_LOG_INFO, msg.str());
             }
             ok = feeds_[nFeed]->initializeReceiver();
+            if(ok && groRequested_ && !feeds_[nFeed]->enableGenericReceiveOffload()
+              && assembler_->wantLog(Common::Logger::QF_LOG_WARNING))
+            {
+              std::stringstream msg;
+              msg << "Generic receive offload is not available for feed " << feeds_[nFeed]->name()
+                << ".  Receiving one packet per read.";
+              assembler_->logMessage(Common::Logger::QF_LOG_WARNING, msg.str());
+            }
+            if(ok && busyPoll_ != 0 && !feeds_[nFeed]->enableBusyPoll(busyPoll_)
+              && assembler_->wantLog(Common::Logger::QF_LOG_WARNING))
+            {
+              std::stringstream msg;
+              msg << "Busy polling is not available for feed " << feeds_[nFeed]->name() << '.';
+              assembler_->logMessage(Common::Logger::QF_LOG_WARNING, msg.str());
+            }
           }
         }
         catch (const std::exception & exception)
@@ -410,8 +623,31 @@ namespace QuickFAST
         return false;
       }
 
+      /// @brief A feed read more data than the buffer could hold.
+      /// @param feedName identifies the feed.
+      /// @param bytesDropped is how much of the buffer was discarded.
+      /// @param capacity is the size of the buffer.
+      void reportTruncatedReceive(const std::string & feedName, size_t bytesDropped, size_t capacity)
+      {
+        {
+          boost::mutex::scoped_lock lock(bufferMutex_);
+          ++truncatedReceives_;
+        }
+        if(assembler_->wantLog(Common::Logger::QF_LOG_WARNING))
+        {
+          std::stringstream msg;
+          msg << "Datagrams on feed " << feedName
+            << " did not fit in a " << capacity << " byte buffer.  Discarding "
+            << bytesDropped << " bytes and any datagrams that followed.";
+          assembler_->logMessage(Common::Logger::QF_LOG_WARNING, msg.str());
+        }
+      }
+
     private:
       MulticastFeedVector feeds_;
+      bool groRequested_;
+      unsigned int busyPoll_;
+      size_t truncatedReceives_;
     };
   }
 }
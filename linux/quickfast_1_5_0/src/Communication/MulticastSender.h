@@ -11,6 +11,9 @@
 //#include <Common/QuickFAST_Export.h>
 #include "MulticastSender_fwd.h"
 #include <Communication/AsynchSender.h>
+#include <Communication/DatagramBatch.h>
+#include <Common/Exceptions.h>
+#include <Common/ByteSwapper.h>
 
 namespace QuickFAST
 {
@@ -18,9 +21,32 @@ namespace QuickFAST
   {
     /// @brief Send Multicast Packets
     /// WARNING: Under construction
+    ///
+    /// In addition to sending one buffer per datagram, the sender can pack
+    /// several encoded messages into each datagram (see setPacking()).
+    /// Packed datagrams carry a header that FixedSizeHeaderAnalyzer can
+    /// read, including a sequence number, and are handed to the kernel
+    /// several at a time using DatagramBatch.
     class MulticastSender : public AsynchSender
     {
     public:
+      /// @brief Interface for an object that sees each packed datagram.
+      class DatagramObserver
+      {
+      public:
+        virtual ~DatagramObserver()
+        {
+        }
+
+        /// @brief A datagram has been packed and is about to be sent.
+        ///
+        /// Called with the sender's packing lock held.
+        /// @param sequenceNumber is the sequence number in the datagram's header.
+        /// @param datagram is the complete datagram, headers included.
+        /// @param size is the length of the datagram.
+        virtual void datagramPacked(uint32 sequenceNumber, const unsigned char * datagram, size_t size) = 0;
+      };
+
       /// @brief Construct given multicast information.
       /// @param recycler to handle empty buffers
       /// @param sendAddress multicast address as a text string
@@ -34,6 +60,29 @@ namespace QuickFAST
         , sendAddress_(sendAddress)
         , portNumber_(portNumber)
         , socket_(ioService_)
+        , maxDatagramSize_(0)
+        , maxMessages_(0)
+        , flushMicroseconds_(0)
+        , packetSizeBytes_(0)
+        , packetBigEndian_(false)
+        , packetPrefixBytes_(0)
+        , packetSuffixBytes_(0)
+        , sequenceOffset_(0)
+        , sequenceLength_(0)
+        , messageSizeBytes_(0)
+        , messageBigEndian_(false)
+        , messagePrefixBytes_(0)
+        , messageSuffixBytes_(0)
+        , sequenceNumber_(0)
+        , messagesInDatagram_(0)
+        , flushTimer_(ioService_.ioService())
+        , timerArmed_(false)
+        , secondaryAddress_(0)
+        , secondaryPort_(0)
+        , observer_(0)
+        , datagramCount_(0)
+        , sendCallCount_(0)
+        , sendErrorCount_(0)
       {
       }
 
@@ -52,6 +101,29 @@ namespace QuickFAST
         , sendAddress_(sendAddress)
         , portNumber_(portNumber)
         , socket_(ioService_)
+        , maxDatagramSize_(0)
+        , maxMessages_(0)
+        , flushMicroseconds_(0)
+        , packetSizeBytes_(0)
+        , packetBigEndian_(false)
+        , packetPrefixBytes_(0)
+        , packetSuffixBytes_(0)
+        , sequenceOffset_(0)
+        , sequenceLength_(0)
+        , messageSizeBytes_(0)
+        , messageBigEndian_(false)
+        , messagePrefixBytes_(0)
+        , messageSuffixBytes_(0)
+        , sequenceNumber_(0)
+        , messagesInDatagram_(0)
+        , flushTimer_(ioService_.ioService())
+        , timerArmed_(false)
+        , secondaryAddress_(0)
+        , secondaryPort_(0)
+        , observer_(0)
+        , datagramCount_(0)
+        , sendCallCount_(0)
+        , sendErrorCount_(0)
       {
       }
 
@@ -69,10 +141,14 @@ namespace QuickFAST
       }
 
       /// @brief Prepare to shut down
+      ///
+      /// Any packed messages are sent first.
       void stop()
       {
         try
         {
+          flush();
+          flushTimer_.cancel();
           socket_.close();
         }
         catch(...)
@@ -153,6 +229,330 @@ namespace QuickFAST
         socket_.async_send_to(buffers, flags, handler, endpoint_);
       }
 
+      /// @brief Pack messages into datagrams.
+      ///
+      /// Once packing is enabled, pack() adds a message to the datagram being
+      /// built.  The datagram is closed when the next message would not fit
+      /// or when it holds maxMessages messages. Closed datagrams are sent
+      /// batchSize at a time, when flushMicroseconds have passed since the first
+      /// unsent message was packed, or when flush() is called.
+      ///
+      /// The timer needs a thread running this sender's io_service.
+      /// @param maxDatagramSize is the size limit for a datagram, headers included
+      ///        (1472 fills an Ethernet frame.)  A larger message is sent alone.
+      /// @param maxMessages limits the messages in a datagram. Zero means no limit.
+      /// @param flushMicroseconds limits how long a message waits to be sent.
+      ///        Zero means until the batch is full or flush() is called.
+      /// @param batchSize is the number of datagrams sent with one system call.
+      void setPacking(
+        size_t maxDatagramSize,
+        size_t maxMessages = 0,
+        uint32 flushMicroseconds = 0,
+        size_t batchSize = 16)
+      {
+        boost::mutex::scoped_lock lock(packMutex_);
+        maxDatagramSize_ = maxDatagramSize;
+        maxMessages_ = maxMessages;
+        flushMicroseconds_ = flushMicroseconds;
+        batch_.setCapacity(batchSize);
+      }
+
+      /// @brief Describe the header at the start of each packed datagram.
+      ///
+      /// The parameters have the same meaning as those of the FixedSizeHeaderAnalyzer
+      /// that will read the header.  The size field holds the number of bytes that
+      /// follow the header.  The other header bytes are zero except for the sequence
+      /// number, which starts at setSequenceNumber() and counts datagrams.
+      /// @param sizeBytes is the number of bytes in the size field.  Zero means no size.
+      /// @param bigEndian is the byte order expected by the analyzer.
+      /// @param prefixBytes is the number of bytes before the size field.
+      /// @param suffixBytes is the number of bytes after the size field.
+      /// @param sequenceOffset is the position of the sequence number in the header.
+      /// @param sequenceLength is the number of bytes in the sequence number. Zero means none.
+      /// @throws UsageError if the sequence number does not fit or overlaps the size field.
+      void setPacketHeader(
+        size_t sizeBytes,
+        bool bigEndian = false,
+        size_t prefixBytes = 0,
+        size_t suffixBytes = 0,
+        size_t sequenceOffset = 0,
+        size_t sequenceLength = 4)
+      {
+        size_t headerSize = prefixBytes + sizeBytes + suffixBytes;
+        if(sequenceLength > 4
+          || (sequenceLength != 0 && sequenceOffset + sequenceLength > headerSize)
+          || (sequenceLength != 0 && sizeBytes != 0
+            && sequenceOffset < prefixBytes + sizeBytes
+            && sequenceOffset + sequenceLength > prefixBytes))
+        {
+          throw UsageError("Coding Error", "Packet sequence number must lie within the header, outside the size field.");
+        }
+        boost::mutex::scoped_lock lock(packMutex_);
+        packetSizeBytes_ = sizeBytes;
+        packetBigEndian_ = bigEndian;
+        packetPrefixBytes_ = prefixBytes;
+        packetSuffixBytes_ = suffixBytes;
+        sequenceOffset_ = sequenceOffset;
+        sequenceLength_ = sequenceLength;
+      }
+
+      /// @brief Describe the header in front of each message in a packed datagram.
+      ///
+      /// The parameters have the same meaning as those of the FixedSizeHeaderAnalyzer
+      /// that will read the header. The size field holds the length of the message.
+      /// @param sizeBytes is the number of bytes in the size field.
+      /// @param bigEndian is the byte order expected by the analyzer.
+      /// @param prefixBytes is the number of (zero) bytes before the size field.
+      /// @param suffixBytes is the number of (zero) bytes after the size field.
+      void setMessageHeader(
+        size_t sizeBytes,
+        bool bigEndian = false,
+        size_t prefixBytes = 0,
+        size_t suffixBytes = 0)
+      {
+        boost::mutex::scoped_lock lock(packMutex_);
+        messageSizeBytes_ = sizeBytes;
+        messageBigEndian_ = bigEndian;
+        messagePrefixBytes_ = prefixBytes;
+        messageSuffixBytes_ = suffixBytes;
+      }
+
+      /// @brief Set the sequence number for the next packed datagram.
+      /// @param sequenceNumber the next sequence number.
+      void setSequenceNumber(uint32 sequenceNumber)
+      {
+        boost::mutex::scoped_lock lock(packMutex_);
+        sequenceNumber_ = sequenceNumber;
+      }
+
+      /// @brief Send each packed datagram to a second group as well.
+      ///
+      /// Both copies go out in the same batch.
+      /// @param address is the dotted IP of the secondary group.
+      /// @param port is the port number of the secondary group.
+      void setSecondary(const std::string & address, unsigned short port)
+      {
+        boost::mutex::scoped_lock lock(packMutex_);
+        secondaryAddress_ = uint32(boost::asio::ip::address_v4::from_string(address).to_ulong());
+        secondaryPort_ = port;
+      }
+
+      /// @brief Show each packed datagram to an observer.
+      /// @param observer sees the datagrams; zero for none. It must outlive the sender.
+      void setDatagramObserver(DatagramObserver * observer)
+      {
+        boost::mutex::scoped_lock lock(packMutex_);
+        observer_ = observer;
+      }
+
+      /// @brief Is the datagram being packed empty?
+      bool datagramEmpty()
+      {
+        boost::mutex::scoped_lock lock(packMutex_);
+        return messagesInDatagram_ == 0;
+      }
+
+      /// @brief Will a message fit in the datagram being packed?
+      /// @param size is the length of the message.
+      bool fits(size_t size)
+      {
+        boost::mutex::scoped_lock lock(packMutex_);
+        return messagesInDatagram_ == 0
+          || packet_.size() + messagePrefixBytes_ + messageSizeBytes_ + messageSuffixBytes_ + size
+            <= maxDatagramSize_;
+      }
+
+      /// @brief Close the datagram being packed; the next message starts a new one.
+      /// @throws CommunicationError if sending a full batch fails.
+      void endDatagram()
+      {
+        boost::mutex::scoped_lock lock(packMutex_);
+        closeDatagram();
+      }
+
+      /// @brief Add a message to the datagram being packed.
+      ///
+      /// The message is copied; the caller may reuse its buffer immediately.
+      /// Call initializeSender() and setPacking() first.
+      /// @param data is the encoded message.
+      /// @param size is the length of the message.
+      /// @throws CommunicationError if sending earlier datagrams fails.  The
+      ///         message has not been packed, and no datagram is left open.
+      void pack(const unsigned char * data, size_t size)
+      {
+        boost::mutex::scoped_lock lock(packMutex_);
+        if(batch_.full())
+        {
+          sendBatch();
+        }
+        size_t needed = messagePrefixBytes_ + messageSizeBytes_ + messageSuffixBytes_ + size;
+        if(messagesInDatagram_ != 0 && packet_.size() + needed > maxDatagramSize_)
+        {
+          closeDatagram();
+        }
+        if(packet_.empty())
+        {
+          packet_.resize(packetPrefixBytes_ + packetSizeBytes_ + packetSuffixBytes_, 0);
+        }
+        packet_.resize(packet_.size() + messagePrefixBytes_, 0);
+        putSize(size, messageSizeBytes_, messageBigEndian_);
+        packet_.resize(packet_.size() + messageSuffixBytes_, 0);
+        packet_.insert(packet_.end(), data, data + size);
+        ++messagesInDatagram_;
+        if(maxMessages_ != 0 && messagesInDatagram_ >= maxMessages_)
+        {
+          // a full batch is sent by the next call so a failure here cannot lose this message.
+          batchDatagram();
+        }
+        if(flushMicroseconds_ != 0 && !timerArmed_)
+        {
+          timerArmed_ = true;
+          flushTimer_.expires_from_now(boost::posix_time::microseconds(flushMicroseconds_));
+          flushTimer_.async_wait(
+            boost::bind(&MulticastSender::flushTimeout, this, boost::asio::placeholders::error));
+        }
+      }
+
+      /// @brief Send everything that has been packed.
+      void flush()
+      {
+        boost::mutex::scoped_lock lock(packMutex_);
+        flushPacked();
+      }
+
+      /// @brief The number of packed datagrams sent.
+      size_t datagramCount()const
+      {
+        return datagramCount_;
+      }
+
+      /// @brief The number of system calls used to send packed datagrams.
+      size_t sendCallCount()const
+      {
+        return sendCallCount_;
+      }
+
+      /// @brief The number of batches of packed datagrams that could not all be sent.
+      ///
+      /// The unsent datagrams are discarded.  Failures when the flush timer
+      /// expires are reported only here; elsewhere CommunicationError is thrown too.
+      size_t sendErrorCount()const
+      {
+        return sendErrorCount_;
+      }
+
+    private:
+      // write a size field in the byte order FixedSizeHeaderAnalyzer reads it.
+      void putSize(size_t value, size_t sizeBytes, bool bigEndian, size_t position)
+      {
+        bool swapNeeded = ByteSwapper::isBigEndian() ? !bigEndian : bigEndian;
+        for(size_t nByte = 0; nByte < sizeBytes; ++nByte)
+        {
+          size_t shift = swapNeeded ? nByte : sizeBytes - 1 - nByte;
+          packet_[position + nByte] = uchar(shift < sizeof(size_t) ? (value >> (shift * 8)) & 0xFF : 0);
+        }
+      }
+
+      void putSize(size_t value, size_t sizeBytes, bool bigEndian)
+      {
+        size_t position = packet_.size();
+        packet_.resize(position + sizeBytes, 0);
+        putSize(value, sizeBytes, bigEndian, position);
+      }
+
+      // written the way FixedSizeHeaderAnalyzer::getSequenceNumber reads it.
+      void putSequence()
+      {
+        for(size_t nByte = 0; nByte < sequenceLength_; ++nByte)
+        {
+          size_t shift = packetBigEndian_ ? sequenceLength_ - 1 - nByte : nByte;
+          packet_[sequenceOffset_ + nByte] = uchar((sequenceNumber_ >> (shift * 8)) & 0xFF);
+        }
+      }
+
+      void closeDatagram()
+      {
+        batchDatagram();
+        if(batch_.full())
+        {
+          sendBatch();
+        }
+      }
+
+      // Finish the datagram being packed and add it to the batch.
+      void batchDatagram()
+      {
+        if(packet_.empty())
+        {
+          return;
+        }
+        size_t headerSize = packetPrefixBytes_ + packetSizeBytes_ + packetSuffixBytes_;
+        putSize(packet_.size() - headerSize, packetSizeBytes_, packetBigEndian_, packetPrefixBytes_);
+        if(sequenceLength_ != 0)
+        {
+          putSequence();
+        }
+        if(observer_ != 0)
+        {
+          observer_->datagramPacked(sequenceNumber_, &packet_[0], packet_.size());
+        }
+        ++sequenceNumber_;
+        batch_.add(&packet_[0], packet_.size(),
+          uint32(endpoint_.address().to_v4().to_ulong()), endpoint_.port());
+        if(secondaryPort_ != 0)
+        {
+          batch_.add(&packet_[0], packet_.size(), secondaryAddress_, secondaryPort_);
+        }
+        packet_.clear();
+        messagesInDatagram_ = 0;
+      }
+
+      void sendBatch()
+      {
+        if(!batch_.empty())
+        {
+          size_t count = batch_.size();
+          try
+          {
+            sendCallCount_ += batch_.send(socket_);
+          }
+          catch (const CommunicationError &)
+          {
+            // The sent datagrams have been removed. Drop the rest too: sending
+            // them later would not help a persistent error and the batch would grow.
+            datagramCount_ += count - batch_.size();
+            ++sendErrorCount_;
+            batch_.clear();
+            throw;
+          }
+          datagramCount_ += count;
+          batch_.clear();
+        }
+      }
+
+      void flushPacked()
+      {
+        closeDatagram();
+        sendBatch();
+      }
+
+      void flushTimeout(const boost::system::error_code & error)
+      {
+        boost::mutex::scoped_lock lock(packMutex_);
+        timerArmed_ = false;
+        if(!error)
+        {
+          try
+          {
+            flushPacked();
+          }
+          catch (const CommunicationError &)
+          {
+            // counted in sendErrorCount_.  Don't throw into the io_service.
+          }
+        }
+      }
+
     private:
 //      AsioService ioService_;
       const std::string & sendAddress_;
@@ -160,6 +560,33 @@ namespace QuickFAST
       boost::asio::ip::address multicastAddress_;
       boost::asio::ip::udp::endpoint endpoint_;
       boost::asio::ip::udp::socket socket_;
+
+      boost::mutex packMutex_;
+      size_t maxDatagramSize_;
+      size_t maxMessages_;
+      uint32 flushMicroseconds_;
+      size_t packetSizeBytes_;
+      bool packetBigEndian_;
+      size_t packetPrefixBytes_;
+      size_t packetSuffixBytes_;
+      size_t sequenceOffset_;
+      size_t sequenceLength_;
+      size_t messageSizeBytes_;
+      bool messageBigEndian_;
+      size_t messagePrefixBytes_;
+      size_t messageSuffixBytes_;
+      uint32 sequenceNumber_;
+      std::vector<unsigned char> packet_;
+      size_t messagesInDatagram_;
+      DatagramBatch batch_;
+      boost::asio::deadline_timer flushTimer_;
+      bool timerArmed_;
+      uint32 secondaryAddress_;
+      unsigned short secondaryPort_;
+      DatagramObserver * observer_;
+      size_t datagramCount_;
+      size_t sendCallCount_;
+      size_t sendErrorCount_;
     };
   }
 }
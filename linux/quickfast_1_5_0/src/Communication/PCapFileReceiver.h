@@ -17,7 +17,10 @@ namespace QuickFAST
 {
   namespace Communication
   {
-    /// A Receiver that reads input from an istream.
+    /// A Receiver that reads packets from a PCap or pcapng file.
+    ///
+    /// Each buffer carries the capture time of its packet (see LinkedBuffer::captureTime()).
+    /// If latency is measured the buffer's timestamp is when the packet was queued.
     class PCapFileReceiver
       : public SynchReceiver
     {
@@ -40,6 +43,16 @@ namespace QuickFAST
       {
       }
 
+      /// @brief Only deliver packets sent to one multicast group and port.
+      ///
+      /// Call before starting the receiver.
+      /// @param group is the destination address. Empty matches any address.
+      /// @param port is the destination port. Zero matches any port.
+      void setFilter(const std::string & group, unsigned short port)
+      {
+        reader_.setFilter(PCapReader::parseAddress(group), port);
+      }
+
     private:
 
       // Implement Receiver method
@@ -65,12 +78,13 @@ namespace QuickFAST
         bool result = reader_.read(pcapBuffer, pcapSize);
         if(result)
         {
-          if(pcapSize <= buffer->capacity())
-          {
-            memcpy(buffer->get(), pcapBuffer, pcapSize);
-            acceptFullBuffer(buffer, pcapSize, lock);
-            result = true;
-          }
+          // Deliver the packet in place from the memory mapped file.
+          buffer->setExternal(pcapBuffer, pcapSize);
+          buffer->setCaptureTime(reader_.timestamp());
+          // Latency is measured from when the packet is queued, not from when it
+          // was captured.  acceptFullBuffer() stamps it if latency is measured.
+          buffer->setTimestamp(0);
+          acceptFullBuffer(buffer, pcapSize, lock);
         }
         return result;
       }
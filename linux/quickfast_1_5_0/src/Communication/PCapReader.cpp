@@ -4,6 +4,8 @@
 //
 #include <Common/QuickFASTPch.h>
 #include "PCapReader.h"
+#include <Common/Exceptions.h>
+#include <boost/asio/ip/address_v4.hpp>
 #ifdef _WIN32
 #include <Winsock2.h>
 #else
@@ -89,6 +91,8 @@ namespace
     DLT_SLIP = 8, /* Serial Line IP */
     DLT_PPP = 9, /* Point-to-point Protocol */
     DLT_FDDI = 10, 	/* FDDI */
+    DLT_RAW = 12, /* raw IP (historical value) */
+    LINKTYPE_RAW = 101, /* raw IP */
     DLT_LINUX_SLL = 113, /* Linux cooked sockets */
     DLT_NULL = 0 /* no link-layer encapsulation */
   };
@@ -205,11 +209,76 @@ namespace
   };
   /* end of libpcap headers */
 
+  // Ethernet types, and the IP protocol for UDP.
+  const uint16 etherTypeIP = 0x0800;
+  const uint16 etherTypeVLAN = 0x8100;
+  const uchar ipProtocolUDP = 17;
+  // ip_header includes the options word, which is usually absent.
+  const size_t minimumIPHeader = 20;
+
+  uint32 toAddress(const ip_address & address)
+  {
+    return (uint32(address.byte1) << 24)
+      | (uint32(address.byte2) << 16)
+      | (uint32(address.byte3) << 8)
+      | uint32(address.byte4);
+  }
+
   static const uint32 nativeMagic = 0xa1b2c3d4;
   static const uint32 swappedMagic = 0xd4c3b2a1;
+  // the same file header, but packet headers hold nanoseconds rather than microseconds.
+  static const uint32 nativeNanoMagic = 0xa1b23c4d;
+  static const uint32 swappedNanoMagic = 0x4d3cb2a1;
 
 #pragma pack(pop)
 
+  /*
+   * pcapng (see the PCAP Next Generation Dump File Format).
+   * Every block starts with its type and total length and ends with the
+   * total length again.  Fields use the byte order of the section header.
+   */
+  const uint32 pcapngSectionHeader = 0x0A0D0D0A;
+  const uint32 pcapngInterfaceDescription = 1;
+  const uint32 pcapngObsoletePacket = 2;
+  const uint32 pcapngSimplePacket = 3;
+  const uint32 pcapngEnhancedPacket = 6;
+  const uint32 pcapngByteOrderMagic = 0x1A2B3C4D;
+  const uint16 pcapngOptionEnd = 0;
+  const uint16 pcapngOptionTsResol = 9;
+  const uint16 pcapngOptionTsOffset = 14;
+  const size_t pcapngBlockOverhead = 12; // type, length, trailing length
+  const size_t pcapngInterfaceFixed = 16; // header + linktype, reserved, snaplen
+  const size_t pcapngEnhancedFixed = 28; // header + interface, timestamp, lengths
+  const size_t pcapngObsoleteFixed = 28;
+  const size_t pcapngSimpleFixed = 12;
+
+  const uint64 nanosecondsPerSecond = 1000000000;
+
+  // pcapng fields are only 4 byte aligned, and options may not be aligned at all.
+  uint32 get32(const unsigned char * p)
+  {
+    uint32 value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+  }
+
+  uint16 get16(const unsigned char * p)
+  {
+    uint16 value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+  }
+
+  // Fields of struct timeval are as wide as a long.
+  template<typename FIELD>
+  uint64 getLong(const ByteSwapper & swap, FIELD field)
+  {
+    if(sizeof(FIELD) == sizeof(uint64))
+    {
+      return swap(uint64(field));
+    }
+    return swap(uint32(field));
+  }
 }
 
 PCapReader::PCapReader()
@@ -218,7 +287,16 @@ PCapReader::PCapReader()
 , ok_(false)
 , usetv32_(false)
 , usetv64_(false)
+, format_(CLASSIC)
 , linktype_(DLT_NULL)
+, timestamp_(0)
+, interfaceId_(0)
+, sourceAddress_(0)
+, destinationAddress_(0)
+, sourcePort_(0)
+, destinationPort_(0)
+, filterAddress_(0)
+, filterPort_(0)
 , swap(false)
 , verbose_(false)
 {
@@ -227,30 +305,25 @@ PCapReader::PCapReader()
 bool
 PCapReader::open(const char * filename, std::ostream * dumpFile)
 {
-  ok_ = true;
-  FILE * file = fopen(filename, "rb");
-  ok_ = file != 0;
+  // The file is mapped, not read, so the packets are delivered
+  // directly from the page cache.
+  ok_ = file_.open(filename);
   if(ok_)
   {
-    fseek(file, 0, SEEK_END);
-    fileSize_ = ftell(file);
-    buffer_.reset(new unsigned char[fileSize_]);
-    fseek(file, 0, SEEK_SET);
-    unsigned char * rawBuffer = buffer_.get();
-    size_t byteCount = fread(rawBuffer, 1, fileSize_, file);
-    fclose(file);
-    ok_ = byteCount == fileSize_;
+    fileSize_ = file_.size();
     if(dumpFile != 0)
     {
       *dumpFile << std::hex << std::setfill('0') <<std::endl;
-      for(size_t pos = 0; pos < byteCount;)
+      for(uint64 pos = 0; pos < fileSize_;)
       {
         *dumpFile << std::setw(4) << pos << ' ';
-        size_t end = pos + 16;
-        for(;pos < end && pos < byteCount; ++pos)
+        size_t lineSize = size_t(std::min(uint64(16), fileSize_ - pos));
+        const unsigned char * line = file_.map(pos, lineSize);
+        for(size_t nByte = 0; nByte < lineSize; ++nByte)
         {
-          *dumpFile << ' ' << std::setw(2) << (short) rawBuffer[pos];
+          *dumpFile << ' ' << std::setw(2) << (short) line[nByte];
         }
+        pos += lineSize;
         *dumpFile << std::endl;
       }
       *dumpFile << std::dec;
@@ -268,31 +341,63 @@ PCapReader::rewind()
 {
   ok_ = true;
   pos_ = 0;
+  interfaces_.clear();
+  timestamp_ = 0;
+  interfaceId_ = 0;
 
   //////////////////////////
   // Process the file header
-  if(fileSize_ - pos_ < sizeof(pcap_file_header))
+  if(fileSize_ - pos_ < sizeof(uint32))
   {
     std::cerr << "Invalid pcap file: no header." << std::endl;
     ok_ = false;
   }
   if(ok_)
   {
-    pcap_file_header * fileHeader = reinterpret_cast<pcap_file_header *>(buffer_.get() + pos_);
+    uint32 magic = get32(file_.map(pos_, sizeof(uint32)));
+    if(magic == pcapngSectionHeader)
+    {
+      // The section header block is processed like any other block.
+      format_ = PCAPNG;
+      if(verbose_)
+      {
+        std::cout << "PCapReader: pcapng file." << std::endl;
+      }
+      return ok_;
+    }
+    if(fileSize_ - pos_ < sizeof(pcap_file_header))
+    {
+      std::cerr << "Invalid pcap file: no header." << std::endl;
+      ok_ = false;
+    }
+  }
+  if(ok_)
+  {
+    const pcap_file_header * fileHeader = reinterpret_cast<const pcap_file_header *>(
+      file_.map(pos_, sizeof(pcap_file_header)));
     pos_ += sizeof(pcap_file_header);
 
-    if(fileHeader->magic != nativeMagic && fileHeader->magic != swappedMagic)
+    uint32 magic = fileHeader->magic;
+    if(magic == nativeMagic || magic == swappedMagic)
+    {
+      format_ = CLASSIC;
+    }
+    else if(magic == nativeNanoMagic || magic == swappedNanoMagic)
+    {
+      format_ = NANOSECOND;
+    }
+    else
     {
       std::cerr << "Invalid pcap file: missing magic." << std::endl;
       ok_ = false;
     }
     if(ok_)
     {
-      swap.setSwap(fileHeader->magic == swappedMagic);
-      assert(swap(fileHeader->magic) == nativeMagic);
+      swap.setSwap(magic == swappedMagic || magic == swappedNanoMagic);
       if(verbose_)
       {
-        std::cout << "PCapReader: Setting swap to : " << (fileHeader->magic == swappedMagic) << std::endl;
+        std::cout << "PCapReader: Setting swap to : " << (magic == swappedMagic || magic == swappedNanoMagic)
+          << (format_ == NANOSECOND ? " nanosecond timestamps" : "") << std::endl;
       }
     }
     linktype_ = swap(fileHeader->linktype);
@@ -313,184 +418,426 @@ PCapReader::read(const unsigned char *& buffer, size_t & size)
   {
     ok_ = false;
     size_t skipped = 0;
-    size_t minBytes = sizeof(pcap_pkthdr) + sizeof(ip_header) + sizeof(udp_header);
-    if(usetv32_)
+    const unsigned char * packet = 0;
+    size_t captured = 0;
+    bool truncated = false;
+    while(!ok_ && nextRecord(packet, captured, truncated))
     {
-      minBytes = sizeof(pcap_pkthdr32) + sizeof(ip_header) + sizeof(udp_header);
+      if(truncated)
+      {
+        skipped += 1;
+      }
+      else
+      {
+        ok_ = parsePacket(packet, captured, buffer, size);
+      }
     }
-    if(usetv64_)
+    if(skipped != 0)
     {
-      minBytes = sizeof(pcap_pkthdr64) + sizeof(ip_header) + sizeof(udp_header);
+      std::cerr << "Warning: ignoring " << skipped << " truncated packets." << std::endl;
     }
+  }
+  return ok_;
+}
 
-    if(verbose_)
+bool
+PCapReader::nextRecord(const unsigned char *& packet, size_t & captured, bool & truncated)
+{
+  if(format_ == PCAPNG)
+  {
+    return nextPcapngRecord(packet, captured, truncated);
+  }
+  return nextClassicRecord(packet, captured, truncated);
+}
+
+bool
+PCapReader::nextClassicRecord(const unsigned char *& packet, size_t & captured, bool & truncated)
+{
+  size_t headerSize = sizeof(pcap_pkthdr);
+  if(format_ == NANOSECOND || usetv32_)
+  {
+    headerSize = sizeof(pcap_pkthdr32);
+  }
+  else if(usetv64_)
+  {
+    headerSize = sizeof(pcap_pkthdr64);
+  }
+  if(verbose_)
+  {
+    std::cout << "PCapReader: Starting read position: " << pos_ << " file size: " << fileSize_
+              << " packet header size: " << headerSize << std::endl;
+  }
+  if(pos_ + headerSize >= fileSize_)
+  {
+    return false;
+  }
+
+  ////////////////////////////
+  // process the packet header
+  size_t expectlen = 0;
+  const unsigned char * header = file_.map(pos_, headerSize);
+  if(format_ == NANOSECOND || usetv32_)
+  {
+    const pcap_pkthdr32 * packetHeader = reinterpret_cast<const pcap_pkthdr32 *>(header);
+    captured = swap(packetHeader->caplen);
+    expectlen = swap(packetHeader->len);
+    uint64 fraction = swap(packetHeader->tv_usec);
+    timestamp_ = uint64(swap(packetHeader->tv_sec)) * nanosecondsPerSecond
+      + (format_ == NANOSECOND ? fraction : fraction * 1000);
+  }
+  else if(usetv64_)
+  {
+    const pcap_pkthdr64 * packetHeader = reinterpret_cast<const pcap_pkthdr64 *>(header);
+    captured = swap(packetHeader->caplen);
+    expectlen = swap(packetHeader->len);
+    timestamp_ = swap(packetHeader->tv_sec) * nanosecondsPerSecond
+      + swap(packetHeader->tv_usec) * 1000;
+  }
+  else
+  {
+    const pcap_pkthdr * packetHeader = reinterpret_cast<const pcap_pkthdr *>(header);
+    captured = swap(packetHeader->caplen);
+    expectlen = swap(packetHeader->len);
+    timestamp_ = getLong(swap, packetHeader->ts.tv_sec) * nanosecondsPerSecond
+      + getLong(swap, packetHeader->ts.tv_usec) * 1000;
+  }
+  pos_ += headerSize;
+  truncated = (captured != expectlen);
+  if(verbose_)
+  {
+    std::cout << "PCapReader: after header position: " << pos_ << " data length: " << captured;
+    if(truncated)
     {
-      std::cout << "PCapReader: Starting read position: " << pos_ << " file size: " << fileSize_
-                << " minimum packet size: " << minBytes << std::endl;
-      if(usetv32_)
-      {
-        std::cout << "PCapReader: reading from 32 bit packet capture" << std::endl;
-      }
-      else if(usetv64_)
+      std::cout << "  Truncated. received 0x"  << std::hex << captured
+                << " expected 0x" << expectlen << std::dec;
+    }
+    std::cout << std::endl;
+  }
+  // map the whole packet so the data can be delivered in place.
+  packet = file_.map(pos_, captured);
+  if(packet == 0)
+  {
+    std::cerr << "Invalid pcap file: last packet is incomplete." << std::endl;
+    pos_ = fileSize_;
+    return false;
+  }
+  pos_ += captured;
+  return true;
+}
+
+bool
+PCapReader::nextPcapngRecord(const unsigned char *& packet, size_t & captured, bool & truncated)
+{
+  while(pos_ + pcapngBlockOverhead <= fileSize_)
+  {
+    const unsigned char * header = file_.map(pos_, 2 * sizeof(uint32));
+    uint32 blockType = get32(header);
+    if(blockType == pcapngSectionHeader)
+    {
+      // The byte order magic follows the block length and decides how to read it.
+      if(pos_ + pcapngBlockOverhead + sizeof(uint32) > fileSize_)
       {
-        std::cout << "PCapReader: reading from 64 bit packet capture" << std::endl;
+        break;
       }
-      else
+      uint32 byteOrder = get32(file_.map(pos_ + 2 * sizeof(uint32), sizeof(uint32)));
+      swap.setSwap(byteOrder != pcapngByteOrderMagic);
+      if(swap(byteOrder) != pcapngByteOrderMagic)
       {
-        std::cout << "PCapReader: reading from unidentified packet capture" << std::endl;
+        std::cerr << "Invalid pcapng file: bad byte order magic." << std::endl;
+        break;
       }
+      // Interface ids are local to a section.
+      interfaces_.clear();
+      header = file_.map(pos_, 2 * sizeof(uint32));
+    }
+    else
+    {
+      blockType = swap(blockType);
+    }
+    size_t blockLength = swap(get32(header + sizeof(uint32)));
+    if(blockLength < pcapngBlockOverhead || pos_ + blockLength > fileSize_)
+    {
+      std::cerr << "Invalid pcapng file: bad block length." << std::endl;
+      break;
+    }
+    const unsigned char * block = file_.map(pos_, blockLength);
+    if(block == 0)
+    {
+      break;
+    }
+    uint64 blockPos = pos_;
+    pos_ += blockLength;
+    if(verbose_)
+    {
+      std::cout << "PCapReader: pcapng block type " << blockType << " at " << blockPos
+        << " length " << blockLength << std::endl;
     }
 
-    while(!ok_ && (pos_ + minBytes < fileSize_))
+    uint32 interfaceId = 0;
+    uint32 high = 0;
+    uint32 low = 0;
+    size_t expectlen = 0;
+    size_t dataOffset = 0;
+    switch(blockType)
     {
-      ////////////////////////////
-      // process the packet header
-      size_t headerPos = pos_;
-      size_t datalen = 0;
-      size_t expectlen = 0;
-      bool truncate = false;
-//      unsigned int dataLinkType = 0;
-
-      if(usetv32_)
+    case pcapngInterfaceDescription:
+      readInterface(block, blockLength);
+      continue;
+    case pcapngEnhancedPacket:
+      if(blockLength < pcapngEnhancedFixed + sizeof(uint32))
       {
-        pcap_pkthdr32 * packetHeader = reinterpret_cast<pcap_pkthdr32 *>(buffer_.get() + pos_);
-        pos_ += sizeof(pcap_pkthdr32);
-        datalen = swap(packetHeader->caplen);
-        expectlen = swap(packetHeader->len);
-        truncate = (packetHeader->caplen != packetHeader->len);
+        continue;
       }
-      else if(usetv64_)
+      interfaceId = swap(get32(block + 8));
+      high = swap(get32(block + 12));
+      low = swap(get32(block + 16));
+      captured = swap(get32(block + 20));
+      expectlen = swap(get32(block + 24));
+      dataOffset = pcapngEnhancedFixed;
+      break;
+    case pcapngObsoletePacket:
+      if(blockLength < pcapngObsoleteFixed + sizeof(uint32))
       {
-        pcap_pkthdr64 * packetHeader = reinterpret_cast<pcap_pkthdr64 *>(buffer_.get() + pos_);
-        pos_ += sizeof(pcap_pkthdr64);
-        datalen = swap(packetHeader->caplen);
-        expectlen = swap(packetHeader->len);
-        truncate = (packetHeader->caplen != packetHeader->len);
+        continue;
       }
-      else
+      interfaceId = swap(get16(block + 8));
+      high = swap(get32(block + 12));
+      low = swap(get32(block + 16));
+      captured = swap(get32(block + 20));
+      expectlen = swap(get32(block + 24));
+      dataOffset = pcapngObsoleteFixed;
+      break;
+    case pcapngSimplePacket:
+      // no timestamp; the captured length is implied by the block length.
+      expectlen = swap(get32(block + 8));
+      captured = std::min(expectlen, blockLength - pcapngSimpleFixed - sizeof(uint32));
+      dataOffset = pcapngSimpleFixed;
+      break;
+    default:
+      // section headers, statistics, name resolution, custom blocks...
+      continue;
+    }
+    if(dataOffset + captured + sizeof(uint32) > blockLength)
+    {
+      std::cerr << "Invalid pcapng file: packet data overruns its block." << std::endl;
+      continue;
+    }
+    if(interfaceId >= interfaces_.size())
+    {
+      std::cerr << "Invalid pcapng file: packet for undescribed interface " << interfaceId << std::endl;
+      continue;
+    }
+    const Interface & capture = interfaces_[interfaceId];
+    interfaceId_ = interfaceId;
+    linktype_ = capture.linktype_;
+    timestamp_ = 0;
+    if(blockType != pcapngSimplePacket)
+    {
+      uint64 units = (uint64(high) << 32) | low;
+      uint64 seconds = units / capture.unitsPerSecond_;
+      uint64 fraction = units % capture.unitsPerSecond_;
+      if(capture.unitsPerSecond_ <= nanosecondsPerSecond)
       {
-        pcap_pkthdr * packetHeader = reinterpret_cast<pcap_pkthdr *>(buffer_.get() + pos_);
-        pos_ += sizeof(pcap_pkthdr);
-        datalen = swap(packetHeader->caplen);
-        expectlen = swap(packetHeader->len);
-        truncate = (packetHeader->caplen != packetHeader->len);
+        fraction = fraction * nanosecondsPerSecond / capture.unitsPerSecond_;
       }
-      if(verbose_)
+      else
       {
-        std::cout << "PCapReader: after header position: " << pos_ << " data length: " << datalen;
+        fraction = uint64(double(fraction) * double(nanosecondsPerSecond) / double(capture.unitsPerSecond_));
       }
-      if(truncate)
+      timestamp_ = uint64(int64(seconds) + capture.offsetSeconds_) * nanosecondsPerSecond + fraction;
+    }
+    packet = block + dataOffset;
+    truncated = (captured != expectlen);
+    return true;
+  }
+  pos_ = fileSize_;
+  return false;
+}
+
+void
+PCapReader::readInterface(const unsigned char * block, size_t blockLength)
+{
+  Interface capture;
+  if(blockLength >= pcapngInterfaceFixed + sizeof(uint32))
+  {
+    capture.linktype_ = swap(get16(block + 8));
+    size_t optionEnd = blockLength - sizeof(uint32);
+    size_t pos = pcapngInterfaceFixed;
+    while(pos + 2 * sizeof(uint16) <= optionEnd)
+    {
+      uint16 code = swap(get16(block + pos));
+      size_t length = swap(get16(block + pos + sizeof(uint16)));
+      pos += 2 * sizeof(uint16);
+      if(code == pcapngOptionEnd || pos + length > optionEnd)
       {
-        pos_ += datalen;
-        skipped+= 1;
-        if(verbose_)
-        {
-          std::cout << "  Truncated. received 0x"  << std::hex << datalen
-                    << " expected 0x" << expectlen << std::dec << std::endl;
-        }
+        break;
       }
-      else
+      if(code == pcapngOptionTsResol && length >= 1)
       {
-        if(verbose_)
-        {
-          std::cout << std::endl;
-        }
-        bool found = false;
-        switch(linktype_)
+        // high bit set: a negative power of two; otherwise a negative power of ten.
+        uchar resolution = block[pos];
+        uint64 units = 1;
+        if(resolution & 0x80)
         {
-        case DLT_EN10MB:
-          {
-            if(verbose_)
-            {
-              std::cout << "PCapReader: Ethernet packet." << std::endl;
-            }
-            pos_ += sizeof(ethernetIIHeader);
-            datalen -= sizeof(ethernetIIHeader);
-            found = true;
-            break;
-          }
-        case DLT_LINUX_SLL:
-          {
-            if(verbose_)
-            {
-              std::cout << "PCapReader: Linux cooked socket packet." << std::endl;
-            }
-            pos_ += sizeof(linuxCookedCaptureHeader);
-            datalen -= sizeof(linuxCookedCaptureHeader);
-            found = true;
-            break;
-          }
-        default:
-          {
-            if(verbose_)
-            {
-              std::cout << "PCapReader: Other type of packet.  Checking for IP protocol flag." << std::endl;
-            }
-            // HACK!look for the IP protocol flag to mark the end of the the link layer header
-            static unsigned short IPProtocol = 0x0008;
-            while(!found && datalen > 2)
-            {
-              unsigned short protocol = *(unsigned short *)(buffer_.get() + pos_);
-              if(swap(protocol) == IPProtocol)
-              {
-                found = true;
-                pos_ += 2;
-                datalen -= 2;
-              }
-              else
-              {
-                pos_ += 1;
-                datalen -= 1;
-              }
-            }
-            break;
-          }
-        }
-        if(found)
-        {
-          ip_header * ipHeader = reinterpret_cast<ip_header *>(buffer_.get() + pos_);
-          // IP header contains its own length expressed in 4 byte units.
-          size_t ipLen = (ipHeader->ver_ihl & 0xF) * 4;
-          pos_ += ipLen;
-          datalen -= ipLen;
-          udp_header * udpHeader = reinterpret_cast<udp_header*>(buffer_.get() + pos_);
-          pos_ += sizeof(udp_header);
-          datalen -= sizeof(udp_header);
-
-          // udplen includes udp header + cargo
-          // udplen is stored in network byte order
-          size_t udplen = ntohs(udpHeader->len);
-
-          buffer = buffer_.get() + pos_;
-          // trust the udp header for actual cargo size
-          // but continue to trust pos_ and datalen (originates in pcap header) for position in buffer.
-          size = udplen - sizeof(udp_header);
-          if(verbose_)
-          {
-            std::cout << "PCapReader: " << headerPos << ": " << pos_ << ' ' << size
-              << "=== 0x" << std::hex  << headerPos << ": 0x" << pos_ << " 0x" << size << std::dec << std::endl;
-          }
-          ok_ = true;
-          pos_ += datalen;
+          units <<= std::min(resolution & 0x7F, 63);
         }
         else
         {
-          if(verbose_)
+          for(uchar power = 0; power < resolution && power < 19; ++power)
           {
-            std::cout << "PCapReader: could not find packet. Skipping " << datalen << " bytes." << std::endl;
+            units *= 10;
           }
-          pos_ += datalen;
-          skipped += 1;
         }
+        capture.unitsPerSecond_ = units;
+      }
+      else if(code == pcapngOptionTsOffset && length >= sizeof(uint64))
+      {
+        uint64 offset;
+        memcpy(&offset, block + pos, sizeof(offset));
+        capture.offsetSeconds_ = int64(swap(offset));
+      }
+      // options are padded to 32 bits
+      pos += (length + 3) & ~size_t(3);
+    }
+  }
+  if(verbose_)
+  {
+    std::cout << "PCapReader: interface " << interfaces_.size()
+      << " link type " << capture.linktype_
+      << " units per second " << capture.unitsPerSecond_ << std::endl;
+  }
+  interfaces_.push_back(capture);
+}
 
+bool
+PCapReader::parsePacket(const unsigned char * packet, size_t datalen, const unsigned char *& buffer, size_t & size)
+{
+  size_t pos = 0;
+  bool found = false;
+  switch(linktype_)
+  {
+  case DLT_EN10MB:
+    {
+      if(verbose_)
+      {
+        std::cout << "PCapReader: Ethernet packet." << std::endl;
       }
+      if(datalen < sizeof(ethernetIIHeader))
+      {
+        break;
+      }
+      const ethernetIIHeader * ethernet = reinterpret_cast<const ethernetIIHeader *>(packet);
+      uint16 etherType = (uint16(ethernet->ether_type[0]) << 8) | ethernet->ether_type[1];
+      pos += sizeof(ethernetIIHeader);
+      // skip 802.1Q VLAN tags: tag control (2 bytes) + real ether type (2 bytes)
+      while(etherType == etherTypeVLAN && pos + 4 <= datalen)
+      {
+        const uchar * tag = packet + pos;
+        etherType = (uint16(tag[2]) << 8) | tag[3];
+        pos += 4;
+      }
+      found = (etherType == etherTypeIP);
+      break;
     }
-    if(skipped != 0)
+  case DLT_LINUX_SLL:
     {
-      std::cerr << "Warning: ignoring " << skipped << " truncated packets." << std::endl;
+      if(verbose_)
+      {
+        std::cout << "PCapReader: Linux cooked socket packet." << std::endl;
+      }
+      pos += sizeof(linuxCookedCaptureHeader);
+      found = true;
+      break;
+    }
+  case DLT_RAW:
+  case LINKTYPE_RAW:
+    {
+      found = true;
+      break;
+    }
+  default:
+    {
+      if(verbose_)
+      {
+        std::cout << "PCapReader: Other type of packet.  Checking for IP protocol flag." << std::endl;
+      }
+      // HACK!look for the IP protocol flag to mark the end of the the link layer header
+      static unsigned short IPProtocol = 0x0008;
+      while(!found && pos + 2 < datalen)
+      {
+        unsigned short protocol = get16(packet + pos);
+        if(swap(protocol) == IPProtocol)
+        {
+          found = true;
+        }
+        pos += found ? 2 : 1;
+      }
+      break;
     }
   }
-  return ok_;
+  const ip_header * ipHeader = 0;
+  size_t ipLen = 0;
+  if(found && pos + minimumIPHeader + sizeof(udp_header) <= datalen)
+  {
+    ipHeader = reinterpret_cast<const ip_header *>(packet + pos);
+    // IP header contains its own length expressed in 4 byte units.
+    ipLen = (ipHeader->ver_ihl & 0xF) * 4;
+    found = (ipHeader->ver_ihl >> 4) == 4
+      && ipHeader->proto == ipProtocolUDP
+      && pos + ipLen + sizeof(udp_header) <= datalen;
+  }
+  else
+  {
+    found = false;
+  }
+  if(!found)
+  {
+    if(verbose_)
+    {
+      std::cout << "PCapReader: not an IPv4 UDP packet. Skipping " << datalen << " bytes." << std::endl;
+    }
+    return false;
+  }
+  pos += ipLen;
+  const udp_header * udpHeader = reinterpret_cast<const udp_header*>(packet + pos);
+  pos += sizeof(udp_header);
+
+  // udplen includes udp header + cargo
+  // udplen is stored in network byte order
+  size_t udplen = ntohs(udpHeader->len);
+  sourceAddress_ = toAddress(ipHeader->saddr);
+  destinationAddress_ = toAddress(ipHeader->daddr);
+  sourcePort_ = ntohs(udpHeader->sport);
+  destinationPort_ = ntohs(udpHeader->dport);
+
+  buffer = packet + pos;
+  // trust the udp header for actual cargo size, but never read past the captured data.
+  size = std::min(udplen - std::min(udplen, sizeof(udp_header)), datalen - pos);
+  if(verbose_)
+  {
+    std::cout << "PCapReader: " << pos_ << ": " << pos << ' ' << size
+      << " from " << sourceAddress_ << ':' << sourcePort_
+      << " to " << destinationAddress_ << ':' << destinationPort_
+      << " at " << timestamp_ << std::endl;
+  }
+  return (filterAddress_ == 0 || filterAddress_ == destinationAddress_)
+    && (filterPort_ == 0 || filterPort_ == destinationPort_);
+}
+
+uint32
+PCapReader::parseAddress(const std::string & address)
+{
+  if(address.empty())
+  {
+    return 0;
+  }
+  boost::system::error_code error;
+  boost::asio::ip::address_v4 parsed = boost::asio::ip::address_v4::from_string(address, error);
+  if(error)
+  {
+    throw UsageError("Invalid IPv4 address", address.c_str());
+  }
+  return uint32(parsed.to_ulong());
 }
 
 void
@@ -504,4 +851,3 @@ PCapReader::seek(size_t address)
 {
   pos_ = address;
 }
-
@@ -13,6 +13,7 @@
 #include <Common/QuickFAST_Export.h>
 #include <Common/Types.h>
 #include <Common/ByteSwapper.h>
+#include <Common/MappedFile.h>
 
 
 namespace QuickFAST
@@ -24,8 +25,18 @@ namespace QuickFAST
     /// A simple file reader that handles only UDP (and multicast) packets.
     /// For more power, see tcpdump and/or winpcap open source projects.
     ///
+    /// Packets that are not IPv4 UDP are skipped.  The addresses of each
+    /// packet are available after it is read, so the packets from several
+    /// multicast channels can be told apart.
+    ///
     /// PCap is the format used by many communication utility data capture packages
-    /// including Wireshark (aka Ethereal) and tcpdump.
+    /// including Wireshark (aka Ethereal) and tcpdump.  Classic pcap files with
+    /// microsecond or nanosecond timestamps are supported, as are pcapng files
+    /// (section header, interface description, enhanced, simple and obsolete
+    /// packet blocks) with any number of interfaces and timestamp resolutions.
+    ///
+    /// The file is memory mapped a window at a time, so files of any size
+    /// can be read in bounded memory.
     class QuickFAST_Export PCapReader
     {
     public:
@@ -59,6 +70,73 @@ namespace QuickFAST
       /// @returns true if the read was successful.  False usually means end of data
       bool read(const unsigned char *& buffer, size_t & size);
 
+      /// @brief When the packet returned by the last read() was captured.
+      /// @returns nanoseconds since 1970-01-01 UTC, or zero if the file does not say.
+      uint64 timestamp()const
+      {
+        return timestamp_;
+      }
+
+      /// @brief The interface that captured the packet returned by the last read().
+      /// @returns the pcapng interface id; always zero for other formats.
+      uint32 interfaceId()const
+      {
+        return interfaceId_;
+      }
+
+      /// @brief Is the file in pcapng format?
+      bool isPcapng()const
+      {
+        return format_ == PCAPNG;
+      }
+
+      /// @brief The destination IPv4 address of the packet returned by the last read().
+      ///
+      /// For multicast data this is the multicast group.
+      /// @returns the address in host byte order.
+      uint32 destinationAddress()const
+      {
+        return destinationAddress_;
+      }
+
+      /// @brief The destination UDP port of the packet returned by the last read().
+      /// @returns the port in host byte order.
+      uint16 destinationPort()const
+      {
+        return destinationPort_;
+      }
+
+      /// @brief The source IPv4 address of the packet returned by the last read().
+      /// @returns the address in host byte order.
+      uint32 sourceAddress()const
+      {
+        return sourceAddress_;
+      }
+
+      /// @brief The source UDP port of the packet returned by the last read().
+      /// @returns the port in host byte order.
+      uint16 sourcePort()const
+      {
+        return sourcePort_;
+      }
+
+      /// @brief Convert a dotted IPv4 address to the form used by this reader.
+      /// @param address is the text form of the address.  Empty means zero.
+      /// @returns the address in host byte order.
+      /// @throws UsageError if the address is not valid.
+      static uint32 parseAddress(const std::string & address);
+
+      /// @brief Only deliver packets sent to one address and port.
+      ///
+      /// Other packets are skipped by read().
+      /// @param address is the destination address in host byte order. Zero matches any address.
+      /// @param port is the destination port.  Zero matches any port.
+      void setFilter(uint32 address, uint16 port)
+      {
+        filterAddress_ = address;
+        filterPort_ = port;
+      }
+
       /// @brief DEBUG ONLY.  Seek to a particular address.
       ///
       /// since there is no tell() method the address probably came from a verbose display.
@@ -69,6 +147,7 @@ namespace QuickFAST
       /// @brief force the reader to expect 64 bit headers even on a 32 bit system.
       ///
       /// Only one of 64bit and 32bit should be set.
+      /// Applies only to microsecond pcap files.
       /// @param state turns the 64bit state on or off (default is off)
       void set64bit(bool state = true)
       {
@@ -78,6 +157,7 @@ namespace QuickFAST
       /// @brief force the reader to expect 32 bit headers even on a 64 bit system.
       ///
       /// Only one of 64bit and 32bit should be set.
+      /// Applies only to microsecond pcap files.
       /// @param state turns the 32bit state on or off (default is off)
       void set32bit(bool state = true)
       {
@@ -85,15 +165,53 @@ namespace QuickFAST
       }
 
     private:
-      boost::scoped_array<unsigned char> buffer_;
-      size_t fileSize_;
-      size_t pos_;
+      enum Format
+      {
+        CLASSIC,     // struct timeval: microseconds
+        NANOSECOND,  // 32 bit seconds and nanoseconds
+        PCAPNG
+      };
+
+      /// The description of a pcapng capture interface.
+      struct Interface
+      {
+        Interface()
+          : linktype_(0)
+          , unitsPerSecond_(1000000)
+          , offsetSeconds_(0)
+        {
+        }
+        uint32 linktype_;
+        uint64 unitsPerSecond_;
+        int64 offsetSeconds_;
+      };
+
+      bool nextRecord(const unsigned char *& packet, size_t & captured, bool & truncated);
+      bool nextClassicRecord(const unsigned char *& packet, size_t & captured, bool & truncated);
+      bool nextPcapngRecord(const unsigned char *& packet, size_t & captured, bool & truncated);
+      void readInterface(const unsigned char * block, size_t blockLength);
+      bool parsePacket(const unsigned char * packet, size_t datalen, const unsigned char *& buffer, size_t & size);
+
+    private:
+      MappedFile file_;
+      uint64 fileSize_;
+      uint64 pos_;
       bool ok_;
       bool usetv32_;  // true forces 32 bit header on 64 bit platform
       bool usetv64_;  // true forces 64 bit header on 32 bit platform
                       // neither usetv32_ nor usetv64_ means use native
                       // both is an (undetected) error.
+      Format format_;
       uint32 linktype_;
+      std::vector<Interface> interfaces_;
+      uint64 timestamp_;
+      uint32 interfaceId_;
+      uint32 sourceAddress_;
+      uint32 destinationAddress_;
+      uint16 sourcePort_;
+      uint16 destinationPort_;
+      uint32 filterAddress_;
+      uint16 filterPort_;
 
       // Important note: swap applies to pcap hader info.  It does NOT apply to
       // network ordered bytes within the message body.
@@ -0,0 +1,271 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "PCapReplayer.h"
+#include <Common/Exceptions.h>
+
+using namespace QuickFAST;
+using namespace Communication;
+
+namespace
+{
+  // Long waits are taken in slices so stop() is noticed promptly.
+  const uint64 waitSlice = 100000000; // 100 msec
+}
+
+PCapReplayer::PCapReplayer()
+  : align_(false)
+  , wordSize_(0)
+  , ttl_(0)
+  , stopping_(false)
+  , packetCount_(0)
+  , batchCount_(0)
+  , maxLateness_(0)
+  , totalLateness_(0)
+  , socket_(ioService_)
+{
+}
+
+PCapReplayer::~PCapReplayer()
+{
+}
+
+void
+PCapReplayer::addCapture(const std::string & filename, const std::string & address, uint16 port)
+{
+  CapturePtr capture(new Capture);
+  capture->filename_ = filename;
+  capture->address_ = PCapReader::parseAddress(address);
+  capture->port_ = port;
+  captures_.push_back(capture);
+}
+
+void
+PCapReplayer::setSpeed(double speed)
+{
+  pacer_.setSpeed(speed);
+}
+
+void
+PCapReplayer::setSpinNanoseconds(uint64 spinNanoseconds)
+{
+  pacer_.setSpinNanoseconds(spinNanoseconds);
+}
+
+void
+PCapReplayer::setBatchSize(size_t batchSize)
+{
+  batch_.setCapacity(batchSize);
+}
+
+void
+PCapReplayer::setAlign(bool align)
+{
+  align_ = align;
+}
+
+void
+PCapReplayer::setWordSize(size_t wordSize)
+{
+  wordSize_ = wordSize;
+}
+
+void
+PCapReplayer::setInterface(const std::string & address)
+{
+  interface_ = address;
+}
+
+void
+PCapReplayer::setTtl(unsigned int ttl)
+{
+  ttl_ = ttl;
+}
+
+void
+PCapReplayer::stop()
+{
+  stopping_ = true;
+}
+
+size_t
+PCapReplayer::replay(size_t passes)
+{
+  stopping_ = false;
+  packetCount_ = 0;
+  batchCount_ = 0;
+  maxLateness_ = 0;
+  totalLateness_ = 0;
+  batch_.clear();
+
+  for(size_t pass = 0; (passes == 0 || pass < passes) && !stopping_; ++pass)
+  {
+    startPass();
+    Capture * capture = earliest();
+    if(capture == 0)
+    {
+      // nothing to send; don't spin forever when passes is zero.
+      break;
+    }
+    while(capture != 0 && !stopping_)
+    {
+      uint64 due = pacer_.deadline(capture->timestamp_);
+      if(batch_.empty())
+      {
+        uint64 current = ReplayPacer::now();
+        while(due > current + waitSlice && !stopping_)
+        {
+          pacer_.waitUntil(current + waitSlice);
+          current = ReplayPacer::now();
+        }
+        if(stopping_)
+        {
+          break;
+        }
+        pacer_.waitUntil(due);
+        if(!pacer_.unpaced())
+        {
+          uint64 lateness = ReplayPacer::now() - due;
+          totalLateness_ += lateness;
+          if(lateness > maxLateness_)
+          {
+            maxLateness_ = lateness;
+          }
+        }
+      }
+      else if(due > ReplayPacer::now())
+      {
+        // the rest of the batch was due together; this one must wait.
+        flush();
+        continue;
+      }
+      uint32 address = capture->address_;
+      if(address == 0)
+      {
+        address = capture->reader_.destinationAddress();
+      }
+      uint16 port = capture->port_;
+      if(port == 0)
+      {
+        port = capture->reader_.destinationPort();
+      }
+      if(batch_.add(capture->data_, capture->size_, address, port))
+      {
+        flush();
+      }
+      ++packetCount_;
+      advance(*capture);
+      capture = earliest();
+    }
+    flush();
+  }
+  return packetCount_;
+}
+
+void
+PCapReplayer::startPass()
+{
+  bool first = true;
+  uint64 start = 0;
+  for(Captures::iterator it = captures_.begin(); it != captures_.end(); ++it)
+  {
+    Capture & capture = **it;
+    if(!capture.open_)
+    {
+      if(wordSize_ == 32)
+      {
+        capture.reader_.set32bit(true);
+      }
+      else if(wordSize_ == 64)
+      {
+        capture.reader_.set64bit(true);
+      }
+      if(!capture.reader_.open(capture.filename_.c_str()))
+      {
+        throw CommunicationError("Can't read PCap file: " + capture.filename_);
+      }
+      capture.open_ = true;
+    }
+    else
+    {
+      capture.reader_.rewind();
+    }
+    capture.offset_ = 0;
+    advance(capture);
+    if(align_ && capture.pending_)
+    {
+      capture.offset_ = capture.timestamp_;
+      capture.timestamp_ = 0;
+    }
+    if(capture.pending_ && (first || capture.timestamp_ < start))
+    {
+      start = capture.timestamp_;
+      first = false;
+    }
+  }
+  pacer_.start(start);
+}
+
+void
+PCapReplayer::advance(Capture & capture)
+{
+  capture.pending_ = capture.reader_.read(capture.data_, capture.size_);
+  if(capture.pending_)
+  {
+    uint64 timestamp = capture.reader_.timestamp();
+    capture.timestamp_ = (timestamp > capture.offset_) ? timestamp - capture.offset_ : 0;
+  }
+}
+
+PCapReplayer::Capture *
+PCapReplayer::earliest()
+{
+  Capture * result = 0;
+  for(Captures::iterator it = captures_.begin(); it != captures_.end(); ++it)
+  {
+    Capture * capture = it->get();
+    if(capture->pending_ && (result == 0 || capture->timestamp_ < result->timestamp_))
+    {
+      result = capture;
+    }
+  }
+  return result;
+}
+
+void
+PCapReplayer::flush()
+{
+  if(!batch_.empty())
+  {
+    sendBatch(batch_);
+    ++batchCount_;
+    batch_.clear();
+  }
+}
+
+void
+PCapReplayer::openSocket()
+{
+  socket_.open(boost::asio::ip::udp::v4());
+  socket_.set_option(boost::asio::ip::multicast::enable_loopback(true));
+  if(!interface_.empty())
+  {
+    socket_.set_option(boost::asio::ip::multicast::outbound_interface(
+      boost::asio::ip::address_v4::from_string(interface_)));
+  }
+  if(ttl_ != 0)
+  {
+    socket_.set_option(boost::asio::ip::multicast::hops(int(ttl_)));
+  }
+}
+
+void
+PCapReplayer::sendBatch(DatagramBatch & batch)
+{
+  if(!socket_.is_open())
+  {
+    openSocket();
+  }
+  batch.send(socket_);
+}
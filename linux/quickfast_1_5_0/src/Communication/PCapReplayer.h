@@ -0,0 +1,179 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef PCAPREPLAYER_H
+#define PCAPREPLAYER_H
+#include "PCapReplayer_fwd.h"
+#include <Common/QuickFAST_Export.h>
+#include <Common/Types.h>
+#include <Communication/PCapReader.h>
+#include <Communication/ReplayPacer.h>
+#include <Communication/DatagramBatch.h>
+#include <boost/asio.hpp>
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief Send the UDP packets from PCap captures with their original timing.
+    ///
+    /// The packets from all captures are merged into one stream ordered by
+    /// capture timestamp, and each packet is sent when the capture says it
+    /// arrived (scaled by the speed). Packets that are due at the same time
+    /// -- and every packet when the speed is zero -- are sent as a batch
+    /// in a single system call, so the microbursts in the capture are
+    /// reproduced on the wire.
+    ///
+    /// Each packet goes to the group and port it was captured on unless
+    /// the capture was added with a destination of its own.
+    ///
+    /// The replay runs on the calling thread.  stop() may be called from
+    /// any other thread.
+    class QuickFAST_Export PCapReplayer
+    {
+    public:
+      PCapReplayer();
+      virtual ~PCapReplayer();
+
+      /// @brief Add a capture to be replayed.
+      /// @param filename names a pcap or pcapng file.
+      /// @param address if not empty, the multicast group to which this capture's packets are sent.
+      /// @param port if not zero, the port to which this capture's packets are sent.
+      /// @throws UsageError if the address is not valid.
+      void addCapture(const std::string & filename, const std::string & address = "", uint16 port = 0);
+
+      /// @brief Set the replay speed.
+      /// @param speed multiplies the rate of the capture: 10.0 replays ten times as fast,
+      ///        0.5 at half speed.  Zero sends as fast as possible.  (default 1.0)
+      void setSpeed(double speed);
+
+      /// @brief How close to a deadline to stop sleeping and start spinning.
+      /// @param spinNanoseconds the spin interval. (default 50 microseconds)
+      void setSpinNanoseconds(uint64 spinNanoseconds);
+
+      /// @brief The largest number of datagrams sent in one system call.
+      /// @param batchSize is the limit. (default 64)
+      void setBatchSize(size_t batchSize);
+
+      /// @brief Start every capture at the same moment.
+      ///
+      /// Normally the captures are merged by absolute timestamp.  Aligned
+      /// captures are shifted so their first packets are due together, which
+      /// allows captures taken at different times to be played against
+      /// each other.
+      /// @param align true to align the captures.
+      void setAlign(bool align);
+
+      /// @brief Declare the word size of the system that made a microsecond pcap file.
+      /// @param wordSize 32 or 64; zero means the native size.
+      void setWordSize(size_t wordSize);
+
+      /// @brief Send from a particular interface.
+      /// @param address the dotted IPv4 address of the interface (127.0.0.1 for loopback tests).
+      void setInterface(const std::string & address);
+
+      /// @brief Set the multicast time-to-live.
+      /// @param ttl is the number of hops. Zero leaves the system default.
+      void setTtl(unsigned int ttl);
+
+      /// @brief Replay the captures.
+      /// @param passes is the number of times to replay them; zero means until stop() is called.
+      /// @returns the number of packets sent.
+      /// @throws CommunicationError if a capture cannot be read or a send fails.
+      size_t replay(size_t passes = 1);
+
+      /// @brief Ask a replay in progress to stop.
+      void stop();
+
+      /// @brief The number of packets sent by the last replay.
+      size_t packetCount()const
+      {
+        return packetCount_;
+      }
+
+      /// @brief The number of batches sent by the last replay.
+      size_t batchCount()const
+      {
+        return batchCount_;
+      }
+
+      /// @brief How late the tardiest batch of the last replay was sent.
+      /// @returns nanoseconds; always zero when the speed is zero.
+      uint64 maxLateness()const
+      {
+        return maxLateness_;
+      }
+
+      /// @brief How late a batch was sent, on average.
+      /// @returns nanoseconds; always zero when the speed is zero.
+      uint64 meanLateness()const
+      {
+        return batchCount_ == 0 ? 0 : totalLateness_ / batchCount_;
+      }
+
+    protected:
+      /// @brief Send a batch of datagrams.
+      ///
+      /// The default sends them on a UDP socket.  A subclass may send them
+      /// somewhere else.
+      /// @param batch contains the datagrams.
+      virtual void sendBatch(DatagramBatch & batch);
+
+    private:
+      struct Capture
+      {
+        Capture()
+          : open_(false)
+          , address_(0)
+          , port_(0)
+          , offset_(0)
+          , pending_(false)
+          , timestamp_(0)
+          , data_(0)
+          , size_(0)
+        {
+        }
+        std::string filename_;
+        PCapReader reader_;
+        bool open_;
+        uint32 address_;
+        uint16 port_;
+        uint64 offset_;
+        bool pending_;
+        uint64 timestamp_;
+        const unsigned char * data_;
+        size_t size_;
+      };
+      typedef boost::shared_ptr<Capture> CapturePtr;
+      typedef std::vector<CapturePtr> Captures;
+
+      void startPass();
+      void advance(Capture & capture);
+      Capture * earliest();
+      void flush();
+      void openSocket();
+
+    private:
+      Captures captures_;
+      ReplayPacer pacer_;
+      DatagramBatch batch_;
+      bool align_;
+      size_t wordSize_;
+      std::string interface_;
+      unsigned int ttl_;
+      volatile bool stopping_;
+
+      size_t packetCount_;
+      size_t batchCount_;
+      uint64 maxLateness_;
+      uint64 totalLateness_;
+
+      boost::asio::io_service ioService_;
+      boost::asio::ip::udp::socket socket_;
+    };
+  }
+}
+#endif // PCAPREPLAYER_H
@@ -0,0 +1,576 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef PACKETRINGRECEIVER_H
+#define PACKETRINGRECEIVER_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "PacketRingReceiver_fwd.h"
+#include <Communication/AsynchReceiver.h>
+#include <Communication/PCapReader.h>
+
+#if defined(__linux__)
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+#include <linux/filter.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief Receive UDP packets for many channels from a memory mapped packet ring.
+    ///
+    /// One AF_PACKET socket on a network interface shares a TPACKET_V3 ring
+    /// with the kernel.  A BPF filter attached to the socket keeps only the
+    /// UDP packets sent to the channels (destination address and port) added
+    /// with addFeed(), so a single ring serves any number of channels.
+    ///
+    /// The kernel fills the ring a block at a time and hands a block over when
+    /// it is full or after the block timeout.  Each UDP payload in the block
+    /// is passed to the Assembler in a buffer of its own that views the data
+    /// in place (see LinkedBuffer::setSegment()), and each buffer carries the
+    /// time the kernel received the packet.  No system call is needed per packet.
+    /// A block is returned to the kernel when the Assembler has released all
+    /// of its packets.
+    ///
+    /// Each Receiver buffer holds one block, so the bufferCount passed to start()
+    /// limits how many blocks the Assembler can hold at once.  The bufferSize is
+    /// not used.
+    ///
+    /// The packet socket needs the CAP_NET_RAW capability.  Multicast groups
+    /// are joined on the interface so switches and the network adapter deliver
+    /// them, but no ordinary socket receives the data.
+    ///
+    /// Available on Linux only.
+    class PacketRingReceiver
+      : public AsynchReceiver
+    {
+    public:
+      /// @brief Construct
+      /// @param interfaceName names the network interface, for example "eth0" or "lo".
+      explicit PacketRingReceiver(const std::string & interfaceName)
+        : AsynchReceiver()
+        , interfaceName_(interfaceName)
+        , interfaceIndex_(0)
+        , blockSize_(256 * 1024)
+        , blockCount_(64)
+        , blockTimeout_(1)
+        , descriptor_(static_cast<boost::asio::io_service &>(ioService_))
+        , ring_(0)
+        , ringSize_(0)
+        , nextBlock_(0)
+        , blocksReceived_(0)
+        , kernelPackets_(0)
+        , kernelDrops_(0)
+      {
+      }
+
+      /// @brief construct given shared io_service
+      /// @param ioService an ioService to be shared with other objects
+      /// @param interfaceName names the network interface, for example "eth0" or "lo".
+      PacketRingReceiver(
+        boost::asio::io_service & ioService,
+        const std::string & interfaceName)
+        : AsynchReceiver(ioService)
+        , interfaceName_(interfaceName)
+        , interfaceIndex_(0)
+        , blockSize_(256 * 1024)
+        , blockCount_(64)
+        , blockTimeout_(1)
+        , descriptor_(static_cast<boost::asio::io_service &>(ioService_))
+        , ring_(0)
+        , ringSize_(0)
+        , nextBlock_(0)
+        , blocksReceived_(0)
+        , kernelPackets_(0)
+        , kernelDrops_(0)
+      {
+      }
+
+      ~PacketRingReceiver()
+      {
+        closeSocket();
+        if(ring_ != 0)
+        {
+          ::munmap(ring_, ringSize_);
+        }
+      }
+
+      /// @brief Receive packets sent to a channel.
+      ///
+      /// Call before start().  If no feeds are added all UDP packets are received.
+      /// @param address is the destination (usually a multicast group) as a dotted IP address.
+      ///        Empty matches any address.
+      /// @param portNumber is the destination port.  Zero matches any port.
+      void addFeed(const std::string & address, unsigned short portNumber)
+      {
+        Feed feed;
+        feed.address_ = PCapReader::parseAddress(address);
+        feed.port_ = portNumber;
+        feeds_.push_back(feed);
+      }
+
+      /// @brief Set the shape of the ring.
+      ///
+      /// Call before start().
+      /// @param blockSize is the size of each block.  It must be a multiple of
+      ///        the page size and big enough for the largest packet.
+      /// @param blockCount is the number of blocks in the ring.
+      /// @param blockTimeout is how many milliseconds the kernel waits for a
+      ///        block to fill before handing it over.  Smaller values reduce latency.
+      void setRing(size_t blockSize, size_t blockCount, unsigned int blockTimeout)
+      {
+        blockSize_ = blockSize;
+        blockCount_ = blockCount;
+        blockTimeout_ = blockTimeout;
+      }
+
+      virtual void stop()
+      {
+        AsynchReceiver::pause();
+        boost::system::error_code ignored;
+        descriptor_.cancel(ignored);
+        AsynchReceiver::stop();
+      }
+
+      /// @brief Statistic: How many blocks have been received from the kernel
+      size_t blocksReceived() const
+      {
+        return blocksReceived_;
+      }
+
+      /// @brief Statistic: How many packets passed the filter (according to the kernel)
+      size_t kernelPackets()
+      {
+        updateKernelStatistics();
+        return kernelPackets_;
+      }
+
+      /// @brief Statistic: How many packets the kernel dropped because the ring was full
+      size_t kernelDrops()
+      {
+        updateKernelStatistics();
+        return kernelDrops_;
+      }
+
+    private:
+      // Implement Receiver method
+      virtual bool initializeReceiver()
+      {
+        interfaceIndex_ = ::if_nametoindex(interfaceName_.c_str());
+        if(interfaceIndex_ == 0)
+        {
+          return fail("Unknown interface");
+        }
+        // Protocol zero: nothing is received until bind(), after the filter is attached.
+        int fd = ::socket(AF_PACKET, SOCK_RAW, 0);
+        if(fd < 0)
+        {
+          return fail("Cannot open packet socket");
+        }
+        descriptor_.assign(fd);
+
+        int version = TPACKET_V3;
+        if(::setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) != 0)
+        {
+          return fail("TPACKET_V3 is not supported");
+        }
+#if defined(PACKET_IGNORE_OUTGOING)
+        int ignoreOutgoing = 1;
+        (void)::setsockopt(fd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &ignoreOutgoing, sizeof(ignoreOutgoing));
+#endif // PACKET_IGNORE_OUTGOING
+
+        std::vector<sock_filter> program;
+        buildFilter(program);
+        sock_fprog filter;
+        filter.len = static_cast<unsigned short>(program.size());
+        filter.filter = &program[0];
+        if(::setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &filter, sizeof(filter)) != 0)
+        {
+          return fail("Cannot attach packet filter");
+        }
+
+        tpacket_req3 request;
+        memset(&request, 0, sizeof(request));
+        request.tp_block_size = static_cast<unsigned int>(blockSize_);
+        request.tp_block_nr = static_cast<unsigned int>(blockCount_);
+        request.tp_frame_size = 2048;
+        request.tp_frame_nr = request.tp_block_nr * (request.tp_block_size / request.tp_frame_size);
+        request.tp_retire_blk_tov = blockTimeout_;
+        if(::setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &request, sizeof(request)) != 0)
+        {
+          return fail("Cannot create packet ring");
+        }
+        ringSize_ = blockSize_ * blockCount_;
+        void * ring = ::mmap(0, ringSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(ring == MAP_FAILED)
+        {
+          return fail("Cannot map packet ring");
+        }
+        ring_ = static_cast<unsigned char *>(ring);
+        nextBlock_ = 0;
+
+        sockaddr_ll address;
+        memset(&address, 0, sizeof(address));
+        address.sll_family = AF_PACKET;
+        address.sll_protocol = htons(ETH_P_IP);
+        address.sll_ifindex = interfaceIndex_;
+        if(::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+        {
+          return fail("Cannot bind packet socket");
+        }
+        joinGroups();
+        return true;
+      }
+
+      // Implement Receiver method
+      bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock&)
+      {
+        if(blockReady())
+        {
+          // No need to ask the kernel.
+          ioService_.post(
+            boost::bind(&PacketRingReceiver::handleReadable,
+              this,
+              boost::system::error_code(),
+              buffer));
+        }
+        else
+        {
+          waitReadable(buffer);
+        }
+        return true;
+      }
+
+      // Return the block to the kernel as soon as the Assembler is done with it.
+      virtual void releaseSegmentedBuffer(LinkedBuffer * buffer)
+      {
+        releaseBlock(buffer);
+        AsynchReceiver::releaseSegmentedBuffer(buffer);
+      }
+
+    private:
+      struct Feed
+      {
+        uint32 address_;
+        uint16 port_;
+      };
+
+      tpacket_block_desc * block(size_t index) const
+      {
+        return reinterpret_cast<tpacket_block_desc *>(ring_ + index * blockSize_);
+      }
+
+      bool blockReady() const
+      {
+        bool ready = (block(nextBlock_)->hdr.bh1.block_status & TP_STATUS_USER) != 0;
+        // do not read the block before seeing its status.
+        __sync_synchronize();
+        return ready;
+      }
+
+      void releaseBlock(LinkedBuffer * buffer)
+      {
+        tpacket_block_desc * descriptor = static_cast<tpacket_block_desc *>(buffer->extra());
+        if(descriptor != 0)
+        {
+          buffer->setExtra(0);
+          // finish reading the block before giving it back.
+          __sync_synchronize();
+          descriptor->hdr.bh1.block_status = TP_STATUS_KERNEL;
+        }
+      }
+
+      void waitReadable(LinkedBuffer * buffer)
+      {
+        descriptor_.async_read_some(
+          boost::asio::null_buffers(),
+          boost::bind(&PacketRingReceiver::handleReadable,
+            this,
+            boost::asio::placeholders::error,
+            buffer)
+          );
+      }
+
+      void handleReadable(
+        const boost::system::error_code& error,
+        LinkedBuffer * buffer)
+      {
+        bool ready = !error && !stopping_ && blockReady();
+        if(!error && !ready && !stopping_)
+        {
+          // The socket is readable before the next block is retired.
+          waitReadable(buffer);
+          return;
+        }
+        bool service = false;
+        { // Scope for lock
+          boost::mutex::scoped_lock lock(bufferMutex_);
+          --readsInProgress_;
+          if(ready)
+          {
+            tpacket_block_desc * descriptor = block(nextBlock_);
+            nextBlock_ = (nextBlock_ + 1) % blockCount_;
+            service = acceptBlock(descriptor, buffer, lock);
+          }
+          else
+          {
+            idleBufferPool_.push(buffer);
+            // ignore errors during state transitions
+            if(error && !paused_ && !stopping_)
+            {
+              ++errorPackets_;
+              if(!assembler_->reportCommunicationError(error.message()))
+              {
+                stop();
+              }
+            }
+          }
+          startReceive(lock);
+        }
+        while(service)
+        {
+          service = serviceQueue();
+        }
+        if(stopping_)
+        {
+          closeSocket();
+        }
+      }
+
+      /// Queue the UDP payloads in a block.  The lock must be held.
+      /// @returns true if this thread should service the queue.
+      bool acceptBlock(
+        tpacket_block_desc * descriptor,
+        LinkedBuffer * buffer,
+        boost::mutex::scoped_lock & lock)
+      {
+        ++blocksReceived_;
+        buffer->setExternal(reinterpret_cast<unsigned char *>(descriptor), descriptor->hdr.bh1.blk_len, descriptor);
+        size_t segments = 0;
+        bool needService = false;
+        const unsigned char * packet = buffer->get() + descriptor->hdr.bh1.offset_to_first_pkt;
+        for(uint32 nPacket = 0; nPacket < descriptor->hdr.bh1.num_pkts; ++nPacket)
+        {
+          const tpacket3_hdr * header = reinterpret_cast<const tpacket3_hdr *>(packet);
+          const unsigned char * payload = 0;
+          size_t size = 0;
+          if(udpPayload(header, payload, size))
+          {
+            ++packetsReceived_;
+            if(paused_)
+            {
+              ++pausedPackets_;
+            }
+            else if(size == 0)
+            {
+              ++emptyPackets_;
+            }
+            else
+            {
+              LinkedBuffer * segment = allocateSegment(lock);
+              segment->setSegment(buffer, payload - buffer->get(), size);
+              segment->setTimestamp(uint64(header->tp_sec) * 1000000000 + header->tp_nsec);
+              ++segments;
+              ++packetsQueued_;
+              bytesReceived_ += size;
+              QUICKFAST_PROBE2(packet_received, this, size);
+              largestPacket_ = std::max(largestPacket_, size);
+              needService = queue_.push(segment, lock);
+            }
+          }
+          packet += header->tp_next_offset;
+        }
+        if(segments == 0)
+        {
+          releaseBlock(buffer);
+          idleBufferPool_.push(buffer);
+          return false;
+        }
+        buffer->setSegmentCount(segments);
+        return needService && queue_.startService(lock);
+      }
+
+      /// Find the UDP payload in a packet that passed the filter.
+      static bool udpPayload(const tpacket3_hdr * header, const unsigned char *& payload, size_t & size)
+      {
+        const unsigned char * frame = reinterpret_cast<const unsigned char *>(header);
+        const sockaddr_ll * link = reinterpret_cast<const sockaddr_ll *>(
+          frame + TPACKET_ALIGN(sizeof(tpacket3_hdr)));
+        if(link->sll_pkttype == PACKET_OUTGOING || header->tp_net < header->tp_mac)
+        {
+          return false;
+        }
+        size_t captured = header->tp_snaplen - (header->tp_net - header->tp_mac);
+        const unsigned char * ip = frame + header->tp_net;
+        size_t ipLength = (ip[0] & 0xF) * 4;
+        if(captured < ipLength + 8 || (ip[0] >> 4) != 4 || ip[9] != IPPROTO_UDP)
+        {
+          return false;
+        }
+        const unsigned char * udp = ip + ipLength;
+        size_t udpLength = (size_t(udp[4]) << 8) | udp[5];
+        if(udpLength < 8)
+        {
+          return false;
+        }
+        payload = udp + 8;
+        size = std::min(udpLength, captured - ipLength) - 8;
+        return true;
+      }
+
+      static sock_filter instruction(unsigned short code, unsigned char jt, unsigned char jf, uint32 k)
+      {
+        sock_filter result;
+        result.code = code;
+        result.jt = jt;
+        result.jf = jf;
+        result.k = k;
+        return result;
+      }
+
+      /// Accept unfragmented IPv4 UDP packets (Ethernet framing) for the feeds.
+      void buildFilter(std::vector<sock_filter> & program) const
+      {
+        const uint32 accept = 0x40000;
+        program.push_back(instruction(BPF_LD | BPF_H | BPF_ABS, 0, 0, 12));   // ether type
+        program.push_back(instruction(BPF_JMP | BPF_JEQ | BPF_K, 0, 5, ETH_P_IP));
+        program.push_back(instruction(BPF_LD | BPF_B | BPF_ABS, 0, 0, 23));   // IP protocol
+        program.push_back(instruction(BPF_JMP | BPF_JEQ | BPF_K, 0, 3, IPPROTO_UDP));
+        program.push_back(instruction(BPF_LD | BPF_H | BPF_ABS, 0, 0, 20));   // flags and fragment offset
+        // more fragments or a nonzero offset: reject first fragments as well as later ones.
+        program.push_back(instruction(BPF_JMP | BPF_JSET | BPF_K, 1, 0, 0x3FFF));
+        program.push_back(instruction(BPF_JMP | BPF_JA, 0, 0, 1));
+        program.push_back(instruction(BPF_RET | BPF_K, 0, 0, 0));
+        program.push_back(instruction(BPF_LDX | BPF_B | BPF_MSH, 0, 0, 14));  // X = IP header length
+        for(size_t nFeed = 0; nFeed < feeds_.size(); ++nFeed)
+        {
+          const Feed & feed = feeds_[nFeed];
+          if(feed.address_ != 0)
+          {
+            program.push_back(instruction(BPF_LD | BPF_W | BPF_ABS, 0, 0, 30)); // destination address
+            program.push_back(instruction(BPF_JMP | BPF_JEQ | BPF_K, 0, feed.port_ != 0 ? 3 : 1, feed.address_));
+          }
+          if(feed.port_ != 0)
+          {
+            program.push_back(instruction(BPF_LD | BPF_H | BPF_IND, 0, 0, 16)); // destination port
+            program.push_back(instruction(BPF_JMP | BPF_JEQ | BPF_K, 0, 1, feed.port_));
+          }
+          program.push_back(instruction(BPF_RET | BPF_K, 0, 0, accept));
+        }
+        program.push_back(instruction(BPF_RET | BPF_K, 0, 0, feeds_.empty() ? accept : 0));
+      }
+
+      void joinGroups()
+      {
+        for(size_t nFeed = 0; nFeed < feeds_.size(); ++nFeed)
+        {
+          uint32 address = feeds_[nFeed].address_;
+          if(!IN_MULTICAST(address))
+          {
+            continue;
+          }
+          // One socket per group: a socket may join only a few groups.
+          // It is never bound, so it receives no data.
+          int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+          ip_mreqn request;
+          memset(&request, 0, sizeof(request));
+          request.imr_multiaddr.s_addr = htonl(address);
+          request.imr_ifindex = interfaceIndex_;
+          if(fd >= 0 && ::setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request)) == 0)
+          {
+            memberships_.push_back(fd);
+          }
+          else
+          {
+            if(fd >= 0)
+            {
+              ::close(fd);
+            }
+            if(assembler_->wantLog(Common::Logger::QF_LOG_WARNING))
+            {
+              std::stringstream msg;
+              msg << "PacketRingReceiver: Cannot join multicast group "
+                << ((address >> 24) & 0xFF) << '.' << ((address >> 16) & 0xFF) << '.'
+                << ((address >> 8) & 0xFF) << '.' << (address & 0xFF)
+                << " on " << interfaceName_ << ": " << strerror(errno);
+              assembler_->logMessage(Common::Logger::QF_LOG_WARNING, msg.str());
+            }
+          }
+        }
+      }
+
+      void closeSocket()
+      {
+        // closing the sockets leaves the groups.
+        for(size_t nMember = 0; nMember < memberships_.size(); ++nMember)
+        {
+          ::close(memberships_[nMember]);
+        }
+        memberships_.clear();
+        if(descriptor_.is_open())
+        {
+          updateKernelStatistics();
+          boost::system::error_code ignored;
+          descriptor_.close(ignored);
+        }
+      }
+
+      void updateKernelStatistics()
+      {
+        if(descriptor_.is_open())
+        {
+          // reading the statistics resets them.
+          tpacket_stats_v3 statistics;
+          socklen_t length = sizeof(statistics);
+          if(::getsockopt(descriptor_.native_handle(), SOL_PACKET, PACKET_STATISTICS, &statistics, &length) == 0)
+          {
+            kernelPackets_ += statistics.tp_packets;
+            kernelDrops_ += statistics.tp_drops;
+          }
+        }
+      }
+
+      bool fail(const char * problem)
+      {
+        int error = errno;
+        std::stringstream msg;
+        msg << "PacketRingReceiver: " << problem << " (" << interfaceName_ << "): " << strerror(error);
+        assembler_->logMessage(Common::Logger::QF_LOG_SERIOUS, msg.str());
+        closeSocket();
+        return false;
+      }
+
+    private:
+      std::string interfaceName_;
+      unsigned int interfaceIndex_;
+      size_t blockSize_;
+      size_t blockCount_;
+      unsigned int blockTimeout_;
+      std::vector<Feed> feeds_;
+      boost::asio::posix::stream_descriptor descriptor_;
+      std::vector<int> memberships_;
+      unsigned char * ring_;
+      size_t ringSize_;
+      size_t nextBlock_;
+      size_t blocksReceived_;
+      size_t kernelPackets_;
+      size_t kernelDrops_;
+    };
+  }
+}
+#endif // __linux__
+#endif // PACKETRINGRECEIVER_H
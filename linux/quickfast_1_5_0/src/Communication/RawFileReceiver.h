@@ -47,6 +47,12 @@ namespace QuickFAST
         return stream_.good() && !stream_.eof();
       }
 
+      // Implement Receiver method
+      virtual bool supportsRingBuffer() const
+      {
+        return true;
+      }
+
       // Implement Receiver method
       bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock& lock)
       {
@@ -12,7 +12,14 @@
 #include "Receiver_fwd.h"
 #include <Communication/Assembler.h>
 #include <Communication/SingleServerBufferQueue.h>
+#include <Communication/MagicRing.h>
+#include <Communication/BufferSlab.h>
+#include <Communication/ThreadPlacement.h>
+#include <Communication/IdleStrategy.h>
 #include <Common/Exceptions.h>
+#include <Common/Metrics.h>
+#include <Common/LatencyTracker.h>
+#include <Common/Probes.h>
 
 namespace QuickFAST
 {
@@ -23,7 +30,19 @@ namespace QuickFAST
     {
     public:
       Receiver()
-        : bufferSize_(1500)
+        : assembler_(0)
+        , bufferSize_(1500)
+        , ringRequested_(false)
+        , ringHead_(0)
+        , slabsRequested_(false)
+        , hugePages_(false)
+        , lockBuffers_(false)
+        , slabBuffersUsed_(0)
+        , bufferNumaNode_(-1)
+        , bufferLimit_(0)
+        , buffersAllocated_(0)
+        , inlineRequested_(false)
+        , inlineService_(false)
         , paused_(false)
         , stopping_(false)
         , readsInProgress_(0)
@@ -34,15 +53,20 @@ namespace QuickFAST
         , pausedPackets_(0)
         , emptyPackets_(0)
         , packetsQueued_(0)
-        , batchesProcessed_(0)
-        , packetsProcessed_(0)
-        , bytesProcessed_(0)
         , largestPacket_(0)
+        , bufferPoolGrowths_(0)
+        , coalescedReceives_(0)
+        , metrics_(0)
+        , latency_(0)
       {
       }
 
       virtual ~Receiver()
       {
+        if(metrics_ != 0)
+        {
+          metrics_->remove(this);
+        }
       }
 
       /// @brief Start accepting packets.  Returns immediately
@@ -58,20 +82,18 @@ namespace QuickFAST
         bool result = false;
         assembler_ = & assembler;
         bufferSize_ = bufferSize;
+        inlineService_ = inlineRequested_ && assembler.supportsInlineService();
         if(initializeReceiver())
         {
           assembler_->receiverStarted(*this);
+          if(ringRequested_ && supportsRingBuffer())
+          {
+            startRing(bufferCount);
+          }
 
           // Allocate initial set of buffers
           boost::mutex::scoped_lock lock(bufferMutex_);
-
-          for(size_t nBuffer = 0; nBuffer < bufferCount; ++nBuffer)
-          {
-            BufferLifetime buffer(new LinkedBuffer(bufferSize));
-            /// bufferLifetimes_ is used only to clean up on object destruction
-            bufferLifetimes_.push_back(buffer);
-            idleBufferPool_.push(buffer.get());
-          }
+          allocateBuffers(bufferCount);
           startReceive(lock);
           result = true;
         }
@@ -84,15 +106,114 @@ namespace QuickFAST
       void addBuffers(
         size_t bufferCount = 1)
       {
-        boost::mutex::scoped_lock lock(bufferMutex_);
-
-        for(size_t nBuffer = 0; nBuffer < bufferCount; ++nBuffer)
+        if(ring_)
         {
-          BufferLifetime buffer(new LinkedBuffer(bufferSize_));
-          /// bufferLifetimes_ is used only to clean up on object destruction
-          bufferLifetimes_.push_back(buffer);
-          idleBufferPool_.push(buffer.get());
+          throw UsageError("Coding Error", "Buffers cannot be added to a Receiver that uses a ring buffer.");
         }
+        boost::mutex::scoped_lock lock(bufferMutex_);
+        allocateBuffers(bufferCount);
+      }
+
+      /// @brief Carve the buffers from cache line aligned slabs of memory.
+      ///
+      /// Must be called before start().  See BufferSlab for details.
+      /// Ignored if a ring buffer is in use.
+      /// @param hugePages true to back the slabs with huge pages if possible.
+      /// @param lockMemory true to lock the slabs into memory.
+      void setBufferSlabs(bool hugePages = true, bool lockMemory = false)
+      {
+        slabsRequested_ = true;
+        hugePages_ = hugePages;
+        lockBuffers_ = lockMemory;
+      }
+
+      /// @brief Place the buffer slabs on a NUMA node.
+      ///
+      /// Must be called before start().  Has no effect unless setBufferSlabs()
+      /// is also called.  Use the node local to the threads that will receive
+      /// and decode the data (see ThreadPlacement::numaNode()).
+      /// @param numaNode the node, or -1 to leave placement to the operating system.
+      void setBufferNumaNode(int numaNode)
+      {
+        bufferNumaNode_ = numaNode;
+      }
+
+      /// @brief Pin, name and prioritize the threads started by runThreads().
+      ///
+      /// Must be called before runThreads().
+      /// @param placement describes where the threads should run.
+      void setThreadPlacement(const ThreadPlacement & placement)
+      {
+        threadPlacement_ = placement;
+      }
+
+      /// @brief Decide how idle threads wait: block, or poll for work.
+      ///
+      /// Must be called before start().  The strategies apply, one per thread,
+      /// to the threads started by runThreads() (see AsioService::setIdleStrategies()).
+      /// The first also applies to the thread that services the queue while it
+      /// waits for more data.
+      /// @param strategies the strategies.  Empty for blocking threads.
+      void setIdleStrategies(const std::vector<IdleStrategy> & strategies)
+      {
+        idleStrategies_ = strategies;
+        queue_.setIdleStrategy(strategies.empty() ? IdleStrategy() : strategies.front());
+      }
+
+      /// @brief Pass a packet straight to the Assembler when nothing else is waiting.
+      ///
+      /// Must be called before start().  When a packet arrives and no thread is
+      /// servicing the queue and no other packets are waiting, the receiving thread
+      /// processes it at once rather than queueing it.  Otherwise, or if the
+      /// Assembler does not support it (see Assembler::supportsInlineService()),
+      /// packets are queued as usual.
+      /// @param inlineService true to enable inline service.
+      void setInlineService(bool inlineService = true)
+      {
+        inlineRequested_ = inlineService;
+      }
+
+      /// @brief Let the buffer pool grow when a read could not start for lack of a buffer.
+      ///
+      /// Each time it happens the number of buffers is doubled, up to the limit.
+      /// Ignored if a ring buffer is in use.
+      /// @param maximumBufferCount is the most buffers to allocate.  Zero (the default)
+      ///        means the pool grows only when addBuffers() is called.
+      void setBufferLimit(size_t maximumBufferCount)
+      {
+        bufferLimit_ = maximumBufferCount;
+      }
+
+      /// @brief Receive into a ring buffer that is mapped twice in virtual memory.
+      ///
+      /// Must be called before start().  Each read continues where the previous
+      /// one ended, so consecutive buffers are adjacent in memory and an Assembler
+      /// can treat several of them as one contiguous block (see follows()).
+      /// The ring holds bufferCount * bufferSize bytes (rounded up to a page).
+      ///
+      /// Ignored by receivers that deliver packets rather than a byte stream, or
+      /// if the platform cannot map the ring.  In that case ordinary buffers are used.
+      /// @param ring true to request a ring buffer
+      void setRingBuffer(bool ring = true)
+      {
+        ringRequested_ = ring;
+      }
+
+      /// @brief Is this receiver using a ring buffer?
+      bool ringBuffer() const
+      {
+        return ring_.get() != 0;
+      }
+
+      /// @brief Is the data in next adjacent to data that ends at end?
+      ///
+      /// Only possible when a ring buffer is in use.
+      /// @param end points just past the last byte of earlier data from this receiver.
+      /// @param next a buffer received after that data.
+      /// @returns true if next's data can be addressed as a continuation of the earlier data.
+      bool follows(const unsigned char * end, const LinkedBuffer * next) const
+      {
+        return ring_ && ring_->follows(end, next->get());
       }
 
       ////////////////////////////////////////////////////////////////////
@@ -194,7 +315,7 @@ namespace QuickFAST
           {
             boost::mutex::scoped_lock lock(bufferMutex_);
             // add any idle buffers to pool
-            idleBufferPool_.push(idleBuffers_);
+            recycleIdleBuffers(lock);
             startReceive(lock);
             queue_.refresh(lock, wait && !stopping_);
           }
@@ -202,8 +323,12 @@ namespace QuickFAST
         }
         if(next != 0)
         {
-          ++packetsProcessed_;
-          bytesProcessed_ += next->used();
+          packetsProcessed_.increment();
+          bytesProcessed_.increment(next->used());
+          if(latency_ != 0)
+          {
+            latency_->packetDequeued(next->timestamp());
+          }
         }
         return next;
       }
@@ -231,7 +356,7 @@ namespace QuickFAST
           {
             boost::mutex::scoped_lock lock(bufferMutex_);
             // add any idle buffers to pool
-            idleBufferPool_.push(idleBuffers_);
+            recycleIdleBuffers(lock);
             startReceive(lock);
             queue_.refresh(lock, wait);
             available = 0;
@@ -253,7 +378,19 @@ namespace QuickFAST
         //std::ostringstream msg;
         //msg << "{" << (void *)this << "} Release buffer " << (void *)buffer << std::endl;
         //std::cout << msg.str();
-        idleBuffers_.push(buffer);
+        LinkedBuffer * parent = buffer->parent();
+        if(parent == 0)
+        {
+          idleBuffers_.push(buffer);
+        }
+        else
+        {
+          idleSegments_.push(buffer);
+          if(parent->releaseSegment())
+          {
+            releaseSegmentedBuffer(parent);
+          }
+        }
       }
       // Assembler support routines
       /////////////////////////////
@@ -273,6 +410,93 @@ namespace QuickFAST
         return readsInProgress_ == 0;
       }
 
+      /// @brief Can this receiver read into a ring buffer?
+      ///
+      /// True only for stream receivers that never have more than one
+      /// read in progress.
+      virtual bool supportsRingBuffer() const
+      {
+        return false;
+      }
+
+      /// @brief Account for data accepted into a ring buffer.
+      ///
+      /// Call with the lock held when a filled buffer is queued.
+      /// The next read starts immediately after this data.
+      /// @param bytesReceived how much data was accepted
+      void ringAccept(size_t bytesReceived)
+      {
+        if(ring_)
+        {
+          ringHead_ = (ringHead_ + bytesReceived) % ring_->size();
+        }
+      }
+
+      /// @brief Make buffers released by the Assembler available for reading again.
+      /// scoped_lock parameter means a mutex must be locked
+      void recycleIdleBuffers(boost::mutex::scoped_lock&)
+      {
+        idleBufferPool_.push(idleBuffers_);
+        segmentPool_.push(idleSegments_);
+      }
+
+      /// @brief Get a LinkedBuffer to be used as a segment (see LinkedBuffer::setSegment()).
+      ///
+      /// It is returned to the segment pool when the Assembler releases it.
+      /// scoped_lock parameter means a mutex must be locked
+      LinkedBuffer * allocateSegment(boost::mutex::scoped_lock&)
+      {
+        LinkedBuffer * segment = segmentPool_.pop();
+        if(segment == 0)
+        {
+          BufferLifetime lifetime(new LinkedBuffer);
+          bufferLifetimes_.push_back(lifetime);
+          segment = lifetime.get();
+        }
+        return segment;
+      }
+
+      /// @brief All of the segments that view a buffer have been released.
+      ///
+      /// Called by the Assembler's thread from releaseBuffer() without the lock.
+      /// Receivers that must do something before the buffer is reused may
+      /// override this, and should then call this method.
+      /// @param buffer is the buffer that held the data for the segments.
+      virtual void releaseSegmentedBuffer(LinkedBuffer * buffer)
+      {
+        idleBuffers_.push(buffer);
+      }
+
+      /// @brief Queue a buffer that received several packets as one segment per packet.
+      ///
+      /// Each segment is a LinkedBuffer that views the data in place.  Every
+      /// segment is segmentSize bytes except possibly the last.
+      /// scoped_lock parameter means a mutex must be locked
+      /// @param buffer holds the packets.  buffer->used() has been set.
+      /// @param segmentSize is the size of each packet.
+      /// @param lock to be sure we have it.
+      /// @returns true if no one is servicing the queue (see SingleServerBufferQueue::push)
+      bool queueSegments(
+        LinkedBuffer * buffer,
+        size_t segmentSize,
+        boost::mutex::scoped_lock& lock)
+      {
+        ++coalescedReceives_;
+        size_t used = buffer->used();
+        buffer->setSegmentCount((used + segmentSize - 1) / segmentSize);
+        bool needService = false;
+        for(size_t offset = 0; offset < used; offset += segmentSize)
+        {
+          LinkedBuffer * segment = allocateSegment(lock);
+          size_t size = std::min(segmentSize, used - offset);
+          segment->setSegment(buffer, offset, size);
+          ++packetsQueued_;
+          largestPacket_ = std::max(largestPacket_, size);
+          needService = queue_.push(segment, lock);
+        }
+        return needService;
+      }
+
       /// @brief Receive a new buffer full if possible
       /// scoped_lock parameter means a mutex must be locked
       void startReceive(boost::mutex::scoped_lock& lock)
@@ -284,6 +508,10 @@ namespace QuickFAST
           LinkedBuffer *buffer = idleBufferPool_.pop();
           if(buffer != 0)
           {
+            if(ring_)
+            {
+              buffer->setExternalCapacity(ring_->at(ringHead_), bufferSize_);
+            }
             ++readsInProgress_;
             if(fillBuffer(buffer, lock))
             {
@@ -302,6 +530,127 @@ namespace QuickFAST
             //msg << "{" << (void *)this << "} Trying to read. No buffer available\n";
             //std::cout << msg.str();
             ++noBufferAvailable_;
+            more = growBufferPool();
+          }
+        }
+      }
+
+    protected:
+      /// @brief Record when a buffer was received, if latency is being measured.
+      /// scoped_lock parameter means a mutex must be locked
+      void stampReceived(LinkedBuffer * buffer, boost::mutex::scoped_lock&)
+      {
+        if(latency_ != 0)
+        {
+          buffer->setTimestamp(LatencyTracker::now());
+        }
+      }
+
+    private:
+      /// @brief Sample one statistic for registerMetrics.
+      template<typename Statistic>
+      void addMetric(
+        const char * name,
+        const char * help,
+        const std::string & labels,
+        Statistic (Receiver::*statistic)() const,
+        MetricsRegistry::Type type = MetricsRegistry::COUNTER)
+      {
+        metrics_->addSampler(name, help, labels, type,
+          boost::bind(&Receiver::sample<Statistic>, this, statistic), this);
+      }
+
+      /// The receiving statistics are guarded by bufferMutex_; the
+      /// processing statistics are MetricCounters and need no lock.
+      template<typename Statistic>
+      double sample(Statistic (Receiver::*statistic)() const)
+      {
+        boost::mutex::scoped_lock lock(bufferMutex_);
+        return double((this->*statistic)());
+      }
+
+      /// @brief Add buffers to the idle pool.  The lock must be held.
+      void allocateBuffers(size_t bufferCount)
+      {
+        for(size_t nBuffer = 0; nBuffer < bufferCount; ++nBuffer)
+        {
+          // ring buffers are views into the ring assigned when a read starts.
+          BufferLifetime buffer(ring_ ? new LinkedBuffer : newBuffer(bufferCount - nBuffer));
+          /// bufferLifetimes_ is used only to clean up on object destruction
+          bufferLifetimes_.push_back(buffer);
+          idleBufferPool_.push(buffer.get());
+          ++buffersAllocated_;
+        }
+      }
+
+      /// @brief Create one buffer; from a slab if slabs were requested.
+      /// @param remaining is how many more buffers are wanted, to size a new slab.
+      LinkedBuffer * newBuffer(size_t remaining)
+      {
+        if(slabsRequested_)
+        {
+          if(slabs_.empty() || slabBuffersUsed_ == slabs_.back()->count())
+          {
+            BufferSlabPtr slab(new BufferSlab);
+            if(slab->allocate(bufferSize_, remaining, hugePages_, lockBuffers_, bufferNumaNode_))
+            {
+              slabs_.push_back(slab);
+              slabBuffersUsed_ = 0;
+            }
+            else
+            {
+              slabsRequested_ = false;
+              // addBuffers() may be called before start() supplies the assembler.
+              if(assembler_ != 0 && assembler_->wantLog(Common::Logger::QF_LOG_WARNING))
+              {
+                assembler_->logMessage(Common::Logger::QF_LOG_WARNING,
+                  "Buffer slab is not available.  Using ordinary buffers.");
+              }
+              return new LinkedBuffer(bufferSize_);
+            }
+          }
+          LinkedBuffer * buffer = new LinkedBuffer;
+          buffer->setExternalCapacity(slabs_.back()->at(slabBuffersUsed_++), bufferSize_);
+          return buffer;
+        }
+        return new LinkedBuffer(bufferSize_);
+      }
+
+      /// @brief Double the buffer pool, up to bufferLimit_.  The lock must be held.
+      /// @returns true if any buffers were added.
+      bool growBufferPool()
+      {
+        if(ring_ || buffersAllocated_ >= bufferLimit_)
+        {
+          return false;
+        }
+        size_t growth = buffersAllocated_;
+        if(growth == 0)
+        {
+          growth = 1;
+        }
+        if(growth > bufferLimit_ - buffersAllocated_)
+        {
+          growth = bufferLimit_ - buffersAllocated_;
+        }
+        allocateBuffers(growth);
+        ++bufferPoolGrowths_;
+        return true;
+      }
+
+      void startRing(size_t bufferCount)
+      {
+        // Outstanding buffers hold at most (bufferCount - 1) * bufferSize bytes
+        // ending at ringHead_, so a ring this big is never overrun by the next read.
+        ring_.reset(new MagicRing);
+        ringHead_ = 0;
+        if(!ring_->allocate(bufferCount * bufferSize_))
+        {
+          ring_.reset();
+          if(assembler_->wantLog(Common::Logger::QF_LOG_WARNING))
+          {
+            assembler_->logMessage(Common::Logger::QF_LOG_WARNING,
+              "Ring buffer is not available.  Using ordinary buffers.");
           }
         }
       }
@@ -345,6 +694,33 @@ namespace QuickFAST
         return noBufferAvailable_;
       }
 
+      /// @brief Statistic: How many buffers have been allocated
+      /// @returns the size of the buffer pool
+      size_t buffersAllocated() const
+      {
+        return buffersAllocated_;
+      }
+
+      /// @brief Statistic: How many times did the buffer pool grow automatically
+      /// @returns the number of times the pool grew (see setBufferLimit())
+      size_t bufferPoolGrowths() const
+      {
+        return bufferPoolGrowths_;
+      }
+
+      /// @brief Are the buffers carved from slabs backed by reserved huge pages?
+      bool hugePageBuffers() const
+      {
+        return !slabs_.empty() && slabs_.front()->hugePages();
+      }
+
+      /// @brief The NUMA node on which the buffer slabs were placed.
+      /// @returns the node or -1 if they were not placed (see setBufferNumaNode()).
+      int bufferNumaNode() const
+      {
+        return slabs_.empty() ? -1 : slabs_.front()->numaNode();
+      }
+
       /// @brief Statistic: How many packets have been received
       /// @returns the number of packets that have been received
       size_t packetsReceived() const
@@ -363,21 +739,28 @@ namespace QuickFAST
       /// @returns the number of batches
       size_t batchesProcessed() const
       {
-        return batchesProcessed_;
+        return size_t(batchesProcessed_.value());
+      }
+
+      /// @brief Statistic: How many packets were processed without being queued
+      /// @returns the number of packets passed straight to the Assembler (see setInlineService())
+      size_t buffersServicedInline() const
+      {
+        return size_t(buffersServicedInline_.value());
       }
 
       /// @brief Statistic: How many packets have been processed
       /// @returns the number of packets that have been processed.
       size_t packetsProcessed() const
       {
-        return packetsProcessed_;
+        return size_t(packetsProcessed_.value());
       }
 
       /// @brief Statistic: How many bytes have been processed
       /// @returns the number of bytes that have been processed.
       size_t bytesProcessed() const
       {
-        return bytesProcessed_;
+        return size_t(bytesProcessed_.value());
       }
 
       /// @brief Statistic: How many received packets had errors
@@ -409,6 +792,13 @@ namespace QuickFAST
         return bytesReceived_;
       }
 
+      /// @brief Statistic: How many receives delivered more than one packet
+      /// @returns the number of buffers that were split into segments
+      size_t coalescedReceives() const
+      {
+        return coalescedReceives_;
+      }
+
       /// @brief Statistic: How big was the largest packet received
       /// @returns the number of bytes in the largest packet
       size_t largestPacket() const
@@ -420,11 +810,72 @@ namespace QuickFAST
       size_t bytesReadable() const
       {
         // todo: we *could* ask the socket how much data is waiting
-        return bytesReceived_ - bytesProcessed_;
+        return bytesReceived_ - bytesProcessed();
+      }
+
+      /// @brief Approximately how many packets are waiting to be decoded
+      size_t queueDepth() const
+      {
+        return packetsQueued_ + buffersServicedInline() - packetsProcessed();
       }
       // Statistics
       /////////////
 
+      /// @brief Measure how long packets wait to be decoded.
+      ///
+      /// Buffers are stamped with the time they are received, unless the
+      /// receiver has a more accurate time from the kernel, and the wait is
+      /// recorded when they are taken from the queue.
+      /// @param latency is not owned by the receiver and must outlive it; zero to stop measuring.
+      void setLatencyTracker(LatencyTracker * latency)
+      {
+        latency_ = latency;
+      }
+
+      /// @brief Export the statistics through a MetricsRegistry.
+      ///
+      /// The statistics are read when a snapshot is taken, so this adds nothing
+      /// to the cost of receiving.  Reading takes the buffer mutex.  The metrics are removed when the Receiver is
+      /// destroyed.
+      /// @param registry receives the metrics.
+      /// @param labels distinguish this receiver's metrics from others', e.g. connection="1"
+      void registerMetrics(MetricsRegistry & registry, const std::string & labels)
+      {
+        metrics_ = &registry;
+        addMetric("quickfast_receiver_packets_received_total", "Packets received.",
+          labels, &Receiver::packetsReceived);
+        addMetric("quickfast_receiver_bytes_received_total", "Bytes received.",
+          labels, &Receiver::bytesReceived);
+        addMetric("quickfast_receiver_no_buffer_total", "Reads that could not start for lack of a buffer.",
+          labels, &Receiver::noBufferAvailable);
+        addMetric("quickfast_receiver_error_packets_total", "Reads that completed with an error.",
+          labels, &Receiver::packetsWithErrors);
+        addMetric("quickfast_receiver_paused_packets_total", "Packets discarded while paused.",
+          labels, &Receiver::pausedPackets);
+        addMetric("quickfast_receiver_empty_packets_total", "Empty packets received.",
+          labels, &Receiver::emptyPackets);
+        addMetric("quickfast_receiver_packets_queued_total", "Packets queued for decoding.",
+          labels, &Receiver::packetsQueued);
+        addMetric("quickfast_receiver_packets_inline_total", "Packets decoded on the receiving thread.",
+          labels, &Receiver::buffersServicedInline);
+        addMetric("quickfast_receiver_batches_total", "Batches of packets taken from the queue.",
+          labels, &Receiver::batchesProcessed);
+        addMetric("quickfast_receiver_packets_processed_total", "Packets passed to the assembler.",
+          labels, &Receiver::packetsProcessed);
+        addMetric("quickfast_receiver_bytes_processed_total", "Bytes passed to the assembler.",
+          labels, &Receiver::bytesProcessed);
+        addMetric("quickfast_receiver_coalesced_receives_total", "Reads that delivered several datagrams.",
+          labels, &Receiver::coalescedReceives);
+        addMetric("quickfast_receiver_buffer_pool_growths_total", "Times the buffer pool grew.",
+          labels, &Receiver::bufferPoolGrowths);
+        addMetric("quickfast_receiver_buffers_allocated", "Buffers in the pool.",
+          labels, &Receiver::buffersAllocated, MetricsRegistry::GAUGE);
+        addMetric("quickfast_receiver_largest_packet_bytes", "The largest packet received.",
+          labels, &Receiver::largestPacket, MetricsRegistry::GAUGE);
+        addMetric("quickfast_receiver_queue_depth", "Packets waiting to be decoded.",
+          labels, &Receiver::queueDepth, MetricsRegistry::GAUGE);
+      }
+
     protected:
 
       /// @brief Service the queeue of full buffers
@@ -435,7 +886,7 @@ namespace QuickFAST
       /// @returns true if more service is needed
       bool serviceQueue()
       {
-          ++batchesProcessed_;
+          batchesProcessed_.increment();
           if(!assembler_->serviceQueue(*this))
           {
             stop();
@@ -454,12 +905,37 @@ namespace QuickFAST
           //  msg << "{" << (void *)this << "} no idle buffers available." << std::endl;
           //  std::cout << msg.str();
           //}
-          idleBufferPool_.push(idleBuffers_);
+          recycleIdleBuffers(lock);
           startReceive(lock);
           // see if this thread is still needed to service the queue
           return queue_.endService(!stopping_, lock);
       }
 
+      /// @brief Process one buffer that bypassed the queue.
+      ///
+      /// The calling thread must have claimed service with
+      /// SingleServerBufferQueue::startDirectService().
+      /// @param buffer is the buffer to be processed.
+      /// @returns true if more service is needed (see serviceQueue())
+      bool serviceInline(LinkedBuffer * buffer)
+      {
+        buffersServicedInline_.increment();
+        packetsProcessed_.increment();
+        bytesProcessed_.increment(buffer->used());
+        if(latency_ != 0)
+        {
+          latency_->packetDequeued(buffer->timestamp());
+        }
+        if(!assembler_->serviceBuffer(*this, buffer))
+        {
+          stop();
+        }
+        boost::mutex::scoped_lock lock(bufferMutex_);
+        recycleIdleBuffers(lock);
+        startReceive(lock);
+        return queue_.endService(!stopping_, lock);
+      }
+
     protected:
       /// The assembler to receive full buffers
       Assembler * assembler_;
@@ -484,9 +960,52 @@ namespace QuickFAST
       /// @brief Buffers waiting to be filled
       BufferCollection idleBufferPool_;
 
+      /// @brief Segments released by the Assembler; like idleBuffers_
+      BufferCollection idleSegments_;
+
+      /// @brief Segments waiting to view part of a buffer (see queueSegments())
+      BufferCollection segmentPool_;
+
       /// @brief All buffers have the same size
       size_t bufferSize_;
 
+      /// @brief setRingBuffer() was called.
+      bool ringRequested_;
+
+      /// @brief If present, buffers are views into this ring.
+      MagicRingPtr ring_;
+
+      /// @brief Offset in ring_ at which the next read starts.
+      size_t ringHead_;
+
+      /// @brief setBufferSlabs() was called (and slabs are still available).
+      bool slabsRequested_;
+      /// @brief Try to back slabs with huge pages.
+      bool hugePages_;
+      /// @brief Lock slabs into memory.
+      bool lockBuffers_;
+      /// @brief Memory for the buffers if slabs are used.
+      std::vector<BufferSlabPtr> slabs_;
+      /// @brief How many buffers have been carved from the newest slab.
+      size_t slabBuffersUsed_;
+      /// @brief The NUMA node for new slabs, or -1.
+      int bufferNumaNode_;
+
+      /// @brief Where the threads started by runThreads() run.
+      ThreadPlacement threadPlacement_;
+      /// @brief How the threads started by runThreads() wait.
+      std::vector<IdleStrategy> idleStrategies_;
+
+      /// @brief The buffer pool may grow to this many buffers.
+      size_t bufferLimit_;
+      /// @brief The buffer pool has this many buffers.
+      size_t buffersAllocated_;
+
+      /// @brief setInlineService() was called.
+      bool inlineRequested_;
+      /// @brief Packets may bypass the queue (inlineRequested_ and the Assembler supports it)
+      bool inlineService_;
+
       /// @brief temporarily ignore incoming packets
       bool paused_;
 
@@ -513,13 +1032,22 @@ namespace QuickFAST
       /// Packets containing valid data: queued to be processed
       size_t packetsQueued_;
       /// Batches of packets collected by queue_
-      size_t batchesProcessed_;
+      /// (this and the other processing counts are updated without bufferMutex_)
+      MetricCounter batchesProcessed_;
       /// Individual packets in the batches
-      size_t packetsProcessed_;
+      MetricCounter packetsProcessed_;
       /// Bytes in the processed packets.
-      size_t bytesProcessed_;
+      MetricCounter bytesProcessed_;
       /// Largest single packet received
       size_t largestPacket_;
+      /// Times the buffer pool grew because no buffer was available
+      size_t bufferPoolGrowths_;
+      /// Buffers that were split into segments
+      size_t coalescedReceives_;
+      /// Packets processed without being queued
+      MetricCounter buffersServicedInline_;
+      MetricsRegistry * metrics_;
+      LatencyTracker * latency_;
     };
   }
 }
@@ -0,0 +1,142 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef REPLAYPACER_H
+#define REPLAYPACER_H
+// All inline, do not export.
+//#include <Common/QuickFAST_Export.h>
+#include "ReplayPacer_fwd.h"
+#include <Common/Types.h>
+
+#if !defined(_WIN32)
+# include <time.h>
+#endif // _WIN32
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief Schedule sends to reproduce the timing of a capture.
+    ///
+    /// Capture times and deadlines are in nanoseconds.  start() anchors the
+    /// schedule: the packet captured at the anchor time is due immediately
+    /// and later packets are due after the same gap, divided by the speed.
+    ///
+    /// waitUntil() sleeps until the deadline is close, then spins for the
+    /// rest of the wait.  Sleeping alone cannot hit a deadline more closely
+    /// than the scheduler's wakeup latency (tens of microseconds);
+    /// spinning alone burns a core through every gap in the capture.
+    class ReplayPacer
+    {
+    public:
+      ReplayPacer()
+        : speed_(1.0)
+        , spinNanoseconds_(50000)
+        , captureStart_(0)
+        , wallStart_(0)
+      {
+      }
+
+      /// @brief Set the replay speed.
+      /// @param speed multiplies the rate of the capture: 2.0 replays twice as fast,
+      ///        0.5 at half speed.  Zero sends as fast as possible.
+      void setSpeed(double speed)
+      {
+        speed_ = speed;
+      }
+
+      /// @brief The replay speed.
+      double speed()const
+      {
+        return speed_;
+      }
+
+      /// @brief Is the capture timing being ignored?
+      bool unpaced()const
+      {
+        return speed_ <= 0.0;
+      }
+
+      /// @brief How close to a deadline waitUntil() stops sleeping and starts spinning.
+      ///
+      /// Zero never spins; a value larger than any gap never sleeps.
+      /// @param spinNanoseconds the spin interval (default 50 microseconds).
+      void setSpinNanoseconds(uint64 spinNanoseconds)
+      {
+        spinNanoseconds_ = spinNanoseconds;
+      }
+
+      /// @brief Anchor the schedule.
+      /// @param captureTime is the capture time that is due now.
+      void start(uint64 captureTime)
+      {
+        captureStart_ = captureTime;
+        wallStart_ = now();
+      }
+
+      /// @brief When is a packet due?
+      /// @param captureTime is when the packet was captured.
+      /// @returns the deadline in the time base of now().
+      uint64 deadline(uint64 captureTime)const
+      {
+        if(unpaced() || captureTime <= captureStart_)
+        {
+          return wallStart_;
+        }
+        return wallStart_ + uint64(double(captureTime - captureStart_) / speed_);
+      }
+
+      /// @brief Wait for a deadline.
+      ///
+      /// Returns immediately if the deadline has passed.
+      /// @param deadline in the time base of now().
+      void waitUntil(uint64 deadline)const
+      {
+        uint64 current = now();
+        while(current + spinNanoseconds_ < deadline)
+        {
+          uint64 wake = deadline - spinNanoseconds_;
+#if defined(_WIN32)
+          boost::this_thread::sleep(boost::posix_time::microseconds((wake - current) / 1000));
+#else // _WIN32
+          struct timespec when;
+          when.tv_sec = time_t(wake / 1000000000);
+          when.tv_nsec = long(wake % 1000000000);
+          // an interrupted sleep simply goes around again.
+          clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &when, 0);
+#endif // _WIN32
+          current = now();
+        }
+        while(current < deadline)
+        {
+          current = now();
+        }
+      }
+
+      /// @brief Read the monotonic clock used for deadlines.
+      /// @returns nanoseconds since an arbitrary epoch.
+      static uint64 now()
+      {
+#if defined(_WIN32)
+        static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+        return uint64((boost::posix_time::microsec_clock::universal_time() - epoch).total_microseconds()) * 1000;
+#else // _WIN32
+        struct timespec current;
+        clock_gettime(CLOCK_MONOTONIC, &current);
+        return uint64(current.tv_sec) * 1000000000 + uint64(current.tv_nsec);
+#endif // _WIN32
+      }
+
+    private:
+      double speed_;
+      uint64 spinNanoseconds_;
+      uint64 captureStart_;
+      uint64 wallStart_;
+    };
+  }
+}
+#endif // REPLAYPACER_H
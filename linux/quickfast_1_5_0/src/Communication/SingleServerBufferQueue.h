@@ -11,6 +11,7 @@
 //#include <Common/QuickFAST_Export.h>
 #include "SingleServerBufferQueue_fwd.h"
 #include <Communication/BufferQueue.h>
+#include <Communication/IdleStrategy.h>
 
 namespace QuickFAST
 {
@@ -52,6 +53,17 @@ namespace QuickFAST
       {
       }
 
+      /// @brief Decide how the service thread waits in refresh().
+      ///
+      /// By default it blocks on a condition variable.  A polling strategy
+      /// releases the mutex and checks again instead, so buffers pushed by
+      /// other threads are seen without a wakeup.
+      /// @param idle is the strategy.
+      void setIdleStrategy(const IdleStrategy & idle)
+      {
+        idle_ = idle;
+      }
+
       /// @brief Push a buffer onto the queue.
       ///
       /// The unused scoped lock parameter indicates this method should be protected.
@@ -103,6 +115,27 @@ namespace QuickFAST
         return busy_;
       }
 
+      /// @brief Take responsibility for servicing the queue without pushing a buffer.
+      ///
+      /// Succeeds only if no thread is servicing the queue and no buffers are
+      /// waiting, so a buffer in hand can be processed at once without
+      /// getting ahead of earlier buffers.  If this method returns true the
+      /// calling thread MUST call endService() (and service any buffers it
+      /// reports) when it is done.
+      ///
+      /// The unused scoped lock parameter indicates this method should be protected.
+      ///
+      /// @returns true if the calling thread is now servicing the queue.
+      bool startDirectService(boost::mutex::scoped_lock &)
+      {
+        if(busy_ || !incoming_.isEmpty() || !outgoing_.isEmpty())
+        {
+          return false;
+        }
+        busy_ = true;
+        return true;
+      }
+
       /// @brief Service the next entry
       ///
       /// No locking is required because the queue should be serviced
@@ -172,12 +205,22 @@ namespace QuickFAST
           //msg << "Q:{"<< (void *) this <<  "} wait" << std::endl;
           //std::cout << msg.str() << std::flush;
 
-          condition_.wait(lock);
+          if(idle_.blocks())
+          {
+            condition_.wait(lock);
+          }
+          else
+          {
+            lock.unlock();
+            idle_.idle();
+            lock.lock();
+          }
           wasEmpty = incoming_.isEmpty();
         }
         if(!wasEmpty)
         {
           outgoing_.push(incoming_);
+          idle_.reset();
         }
         return !wasEmpty;
       }
@@ -213,6 +256,8 @@ namespace QuickFAST
       BufferQueue outgoing_;
       boost::condition_variable condition_;
       bool busy_;
+      // used only by the service thread.
+      IdleStrategy idle_;
       // todo: statistics would be interesting
     };
   }
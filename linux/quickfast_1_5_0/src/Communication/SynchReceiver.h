@@ -59,6 +59,9 @@ namespace QuickFAST
           ++packetsQueued_;
           largestPacket_ = std::max(largestPacket_, bytesReceived);
           buffer->setUsed(bytesReceived);
+          stampReceived(buffer, lock);
+          QUICKFAST_PROBE2(packet_received, this, bytesReceived);
+          ringAccept(bytesReceived);
           needService = queue_.push(buffer, lock);
         }
         else
@@ -79,7 +82,9 @@ namespace QuickFAST
           boost::mutex::scoped_lock lock(bufferMutex_);
           service = queue_.startService(lock);
         }
-        while(service && !stopping_)
+        // Data queued before the end of the input was reached must still
+        // be processed, so service the queue at least once even if stopping.
+        while(service)
         {
           service = serviceQueue();
           ++count;
@@ -91,10 +96,10 @@ namespace QuickFAST
       // Implement Receiver public methods
       virtual void run()
       {
-        while(!stopping_)
+        do
         {
           tryServiceQueue();
-        }
+        } while(!stopping_);
       }
 
       virtual void run_one()
@@ -134,7 +139,7 @@ namespace QuickFAST
         {
           // If we're using this thread, that's all that is needed.
           // so ignore threadCount
-          run();
+          runPlaced();
         }
         else
         {
@@ -142,7 +147,7 @@ namespace QuickFAST
           // more than one thread servicing a synchronous data source,
           // so only start the one.
           thread_.reset(
-            new boost::thread(boost::bind(&SynchReceiver::run, this)));
+            new boost::thread(boost::bind(&SynchReceiver::runPlaced, this)));
         }
       }
 
@@ -160,6 +165,18 @@ namespace QuickFAST
         return true;
       }
 
+    private:
+      void runPlaced()
+      {
+        // only one thread services a synchronous data source.
+        std::string problems;
+        if(!threadPlacement_.apply(0, problems) && assembler_->wantLog(Common::Logger::QF_LOG_WARNING))
+        {
+          assembler_->logMessage(Common::Logger::QF_LOG_WARNING, problems);
+        }
+        run();
+      }
+
     private:
       boost::scoped_ptr<boost::thread> thread_;
     };
@@ -181,6 +181,11 @@ namespace QuickFAST
       }
 
     private:
+      // Implement Receiver method
+      virtual bool supportsRingBuffer() const
+      {
+        return true;
+      }
 
       bool fillBuffer(LinkedBuffer * buffer, boost::mutex::scoped_lock& lock)
       {
@@ -0,0 +1,257 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+#include "ThreadPlacement.h"
+#include <Common/Exceptions.h>
+
+#if defined(__linux__)
+# include <pthread.h>
+# include <sched.h>
+# include <dirent.h>
+#endif // __linux__
+
+using namespace QuickFAST;
+using namespace Communication;
+
+namespace
+{
+  const ThreadPlacement::CpuSet unpinned;
+
+  unsigned int parseCpu(const std::string & cpuList, const std::string & text)
+  {
+    if(text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+    {
+      throw UsageError("Invalid CPU list", cpuList.c_str());
+    }
+    return boost::lexical_cast<unsigned int>(text);
+  }
+}
+
+ThreadPlacement::ThreadPlacement()
+  : priority_(0)
+{
+}
+
+void
+ThreadPlacement::addThread(const CpuSet & cpus)
+{
+  slots_.push_back(cpus);
+}
+
+void
+ThreadPlacement::addThreads(const std::string & cpuList)
+{
+  std::vector<CpuSet> slots;
+  std::string::size_type slotStart = 0;
+  while(slotStart <= cpuList.size())
+  {
+    std::string::size_type slotEnd = cpuList.find(':', slotStart);
+    if(slotEnd == std::string::npos)
+    {
+      slotEnd = cpuList.size();
+    }
+    CpuSet cpus;
+    std::string::size_type itemStart = slotStart;
+    while(itemStart < slotEnd)
+    {
+      std::string::size_type itemEnd = cpuList.find(',', itemStart);
+      if(itemEnd == std::string::npos || itemEnd > slotEnd)
+      {
+        itemEnd = slotEnd;
+      }
+      std::string item = cpuList.substr(itemStart, itemEnd - itemStart);
+      std::string::size_type dash = item.find('-');
+      unsigned int first = parseCpu(cpuList, item.substr(0, dash));
+      unsigned int last = first;
+      if(dash != std::string::npos)
+      {
+        last = parseCpu(cpuList, item.substr(dash + 1));
+      }
+      if(last < first)
+      {
+        throw UsageError("Invalid CPU list", cpuList.c_str());
+      }
+      for(unsigned int cpu = first; cpu <= last; ++cpu)
+      {
+        cpus.push_back(cpu);
+      }
+      itemStart = itemEnd + 1;
+    }
+    if(cpus.empty())
+    {
+      throw UsageError("Invalid CPU list", cpuList.c_str());
+    }
+    slots.push_back(cpus);
+    slotStart = slotEnd + 1;
+  }
+  slots_.insert(slots_.end(), slots.begin(), slots.end());
+}
+
+void
+ThreadPlacement::setName(const std::string & name)
+{
+  name_ = name;
+}
+
+void
+ThreadPlacement::setPriority(int priority)
+{
+  priority_ = priority;
+}
+
+bool
+ThreadPlacement::empty() const
+{
+  return slots_.empty() && name_.empty() && priority_ == 0;
+}
+
+const ThreadPlacement::CpuSet &
+ThreadPlacement::cpus(size_t thread) const
+{
+  if(slots_.empty())
+  {
+    return unpinned;
+  }
+  return slots_[thread % slots_.size()];
+}
+
+int
+ThreadPlacement::numaNode(size_t thread) const
+{
+  const CpuSet & threadCpus = cpus(thread);
+  if(threadCpus.empty())
+  {
+    return -1;
+  }
+  return cpuNumaNode(threadCpus.front());
+}
+
+bool
+ThreadPlacement::apply(size_t thread, std::string & problems) const
+{
+  std::ostringstream msg;
+  const CpuSet & threadCpus = cpus(thread);
+  if(!threadCpus.empty() && !pinThisThread(threadCpus))
+  {
+    msg << "Cannot pin thread " << thread << " to CPU";
+    for(size_t nCpu = 0; nCpu < threadCpus.size(); ++nCpu)
+    {
+      msg << (nCpu == 0 ? ' ' : ',') << threadCpus[nCpu];
+    }
+    msg << ". ";
+  }
+  if(!name_.empty())
+  {
+    std::ostringstream name;
+    name << name_ << '-' << thread;
+    if(!nameThisThread(name.str()))
+    {
+      msg << "Cannot name thread " << name.str() << ". ";
+    }
+  }
+  if(priority_ != 0 && !setThisThreadPriority(priority_))
+  {
+    msg << "Cannot set thread " << thread << " to real time priority " << priority_ << ". ";
+  }
+  problems = msg.str();
+  return problems.empty();
+}
+
+bool
+ThreadPlacement::pinThisThread(const CpuSet & cpus)
+{
+#if defined(__linux__)
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  for(size_t nCpu = 0; nCpu < cpus.size(); ++nCpu)
+  {
+    if(cpus[nCpu] >= CPU_SETSIZE)
+    {
+      return false;
+    }
+    CPU_SET(cpus[nCpu], &cpuSet);
+  }
+  return ::pthread_setaffinity_np(::pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#elif defined(_WIN32)
+  DWORD_PTR mask = 0;
+  for(size_t nCpu = 0; nCpu < cpus.size(); ++nCpu)
+  {
+    if(cpus[nCpu] >= sizeof(mask) * CHAR_BIT)
+    {
+      return false;
+    }
+    mask |= DWORD_PTR(1) << cpus[nCpu];
+  }
+  return ::SetThreadAffinityMask(::GetCurrentThread(), mask) != 0;
+#else
+  (void)cpus;
+  return false;
+#endif
+}
+
+bool
+ThreadPlacement::nameThisThread(const std::string & name)
+{
+#if defined(__linux__)
+  // the kernel rejects names longer than 15 characters.
+  return ::pthread_setname_np(::pthread_self(), name.substr(0, 15).c_str()) == 0;
+#else
+  (void)name;
+  return false;
+#endif
+}
+
+bool
+ThreadPlacement::setThisThreadPriority(int priority)
+{
+#if defined(__linux__)
+  sched_param param;
+  memset(&param, 0, sizeof(param));
+  param.sched_priority = priority;
+  return ::pthread_setschedparam(::pthread_self(), SCHED_FIFO, &param) == 0;
+#elif defined(_WIN32)
+  (void)priority;
+  return ::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#else
+  (void)priority;
+  return false;
+#endif
+}
+
+int
+ThreadPlacement::cpuNumaNode(unsigned int cpu)
+{
+#if defined(__linux__)
+  // /sys/devices/system/cpu/cpuN contains a link named nodeM
+  std::ostringstream path;
+  path << "/sys/devices/system/cpu/cpu" << cpu;
+  DIR * dir = ::opendir(path.str().c_str());
+  if(dir == 0)
+  {
+    return -1;
+  }
+  int node = -1;
+  struct dirent * entry;
+  while(node < 0 && (entry = ::readdir(dir)) != 0)
+  {
+    const char * name = entry->d_name;
+    if(strncmp(name, "node", 4) == 0 && name[4] >= '0' && name[4] <= '9')
+    {
+      node = atoi(name + 4);
+    }
+  }
+  ::closedir(dir);
+  return node;
+#elif defined(_WIN32)
+  UCHAR node = 0;
+  if(cpu > 255 || !::GetNumaProcessorNode(UCHAR(cpu), &node) || node == 0xFF)
+  {
+    return -1;
+  }
+  return node;
+#else
+  (void)cpu;
+  return -1;
+#endif
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifdef _MSC_VER
+# pragma once
+#endif
+#ifndef THREADPLACEMENT_H
+#define THREADPLACEMENT_H
+#include "ThreadPlacement_fwd.h"
+#include <Common/QuickFAST_Export.h>
+
+namespace QuickFAST
+{
+  namespace Communication
+  {
+    /// @brief Where and how the threads that run an event loop should run.
+    ///
+    /// Each thread started by AsioService::runThreads() (and the calling
+    /// thread if it joins in) takes the next slot: thread n is pinned to the
+    /// CPUs listed for slot n, cycling through the slots if there are more
+    /// threads than slots.  Threads are named "<name>-<n>" so they can be told
+    /// apart in top, perf and the debugger, and may be given a real time
+    /// (SCHED_FIFO) priority.
+    ///
+    /// Placement is best effort: a thread that cannot be pinned, named or
+    /// prioritized (usually for lack of privilege) still runs.  apply()
+    /// reports what could not be done.
+    class QuickFAST_Export ThreadPlacement
+    {
+    public:
+      /// @brief The CPUs available to one thread.
+      typedef std::vector<unsigned int> CpuSet;
+
+      ThreadPlacement();
+
+      /// @brief Pin the next thread slot to a set of CPUs.
+      /// @param cpus for the slot.  An empty set leaves the thread unpinned.
+      void addThread(const CpuSet & cpus);
+
+      /// @brief Pin thread slots from a text description.
+      ///
+      /// Slots are separated by colons.  Each slot is a comma separated list
+      /// of CPUs or ranges of CPUs: "2:3:4-7,12" pins the first thread to
+      /// CPU 2, the second to CPU 3 and the third to CPUs 4 through 7 and 12.
+      /// @param cpuList the description.
+      /// @throws UsageError if the description cannot be parsed.
+      void addThreads(const std::string & cpuList);
+
+      /// @brief Name the threads.
+      /// @param name prefix for the thread names.  Linux limits a thread name to
+      ///        15 characters, so keep it short.
+      void setName(const std::string & name);
+
+      /// @brief Run the threads at a real time priority.
+      /// @param priority the SCHED_FIFO priority (1 to 99); zero for normal scheduling.
+      ///        On Windows any nonzero value means THREAD_PRIORITY_TIME_CRITICAL.
+      void setPriority(int priority);
+
+      /// @brief Does this placement change anything?
+      bool empty() const;
+
+      /// @brief How many thread slots have CPUs assigned?
+      size_t slotCount() const
+      {
+        return slots_.size();
+      }
+
+      /// @brief The CPUs for a thread.
+      /// @param thread the thread number.
+      /// @returns the CPUs; empty if the thread is not pinned.
+      const CpuSet & cpus(size_t thread) const;
+
+      /// @brief The NUMA node local to a thread.
+      /// @param thread the thread number.
+      /// @returns the node of the first CPU the thread is pinned to, or -1 if
+      ///          the thread is not pinned or the node cannot be determined.
+      int numaNode(size_t thread) const;
+
+      /// @brief Place the calling thread.
+      /// @param thread the thread number.
+      /// @param problems receives a description of anything that could not be done.
+      /// @returns true if everything requested was done.
+      bool apply(size_t thread, std::string & problems) const;
+
+      /// @brief Pin the calling thread to a set of CPUs.
+      /// @returns true if successful.
+      static bool pinThisThread(const CpuSet & cpus);
+
+      /// @brief Name the calling thread.
+      /// @returns true if successful.
+      static bool nameThisThread(const std::string & name);
+
+      /// @brief Set the real time priority of the calling thread.
+      /// @returns true if successful.
+      static bool setThisThreadPriority(int priority);
+
+      /// @brief Find the NUMA node to which a CPU belongs.
+      /// @returns the node or -1 if it cannot be determined.
+      static int cpuNumaNode(unsigned int cpu);
+
+    private:
+      std::vector<CpuSet> slots_;
+      std::string name_;
+      int priority_;
+    };
+  }
+}
+#endif // THREADPLACEMENT_H
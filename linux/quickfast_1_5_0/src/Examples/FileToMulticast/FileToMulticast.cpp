@@ -5,6 +5,7 @@
 #include <Examples/ExamplesPch.h>
 #include "FileToMulticast.h"
 #include <Communication/MulticastSender.h>
+#include <Communication/ReplayPacer.h>
 #include <Examples/StopWatch.h>
 using namespace QuickFAST;
 using namespace Examples;
@@ -23,16 +24,16 @@ FileToMulticast::FileToMulticast()
 , sendCount_(1)
 , sendMicroseconds_(500)
 , burst_(1)
+, spinMicroseconds_(50)
 , pauseEveryPass_(false)
 , pauseEveryMessage_(false)
 , verbose_(false)
 , dataFile_(0)
-, strand_(ioService_)
-, timer_(ioService_)
 , bufferSize_(0)
 , nPass_(0)
 , nMsg_(0)
 , totalMessageCount_(0)
+, destinationAddress_(0)
 {
 }
 
@@ -84,6 +85,16 @@ FileToMulticast::parseSingleArg(int argc, char * argv[])
       burst_ = boost::lexical_cast<size_t>(argv[1]);
       consumed = 2;
     }
+    else if(opt == "-i" && argc > 1)
+    {
+      interfaceAddress_ = argv[1];
+      consumed = 2;
+    }
+    else if(opt == "-spin" && argc > 1)
+    {
+      spinMicroseconds_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
     else if(opt == "-c" && argc > 1)
     {
       sendCount_ = boost::lexical_cast<size_t>(argv[1]);
@@ -128,6 +139,7 @@ FileToMulticast::usage(std::ostream & out) const
 {
   out << "  -a dotted_ip  : Multicast send address (default is " << sendAddress_ << ")" << std::endl;
   out << "  -p port       : Multicast port number (default " << portNumber_ << ")" << std::endl;
+  out << "  -i dotted_ip  : Interface from which to send (127.0.0.1 for loopback testing)" << std::endl;
   out << "  -f datafile   : File containing FAST encoded messages. (required)" << std::endl;
   out << "  -n indexfile  : File produced as an echo file with message boundaries" << std::endl;
   out << "                  by the InterpretFAST program." << std::endl;
@@ -136,6 +148,8 @@ FileToMulticast::usage(std::ostream & out) const
   out << "  -r burst/sec  : Rate at which to send bursts of messages expressed as bursts per second (default = 2000)" << std::endl;
   out << "                : zero means send continuously." << std::endl;
   out << "  -b msg/burst  : Messages per burst(default = 1)" << std::endl;
+  out << "                  A burst is sent with one system call where supported." << std::endl;
+  out << "  -spin usec    : Spin rather than sleep this close to a burst (default " << spinMicroseconds_ << ")" << std::endl;
   out << "  -c count      : How many times to send the file (passes)" << std::endl;
   out << "                  (default 1; 0 means forever.)" << std::endl;
   out << "  -pausemessage : Wait for 'Enter' before every message." << std::endl;
@@ -173,6 +187,8 @@ FileToMulticast::applyArgs()
       ioService_,
       *this,
       sendAddress_, portNumber_));
+    destinationAddress_ = boost::asio::ip::address_v4::from_string(sendAddress_).to_ulong();
+    batch_.setCapacity(burst_);
   }
   catch (std::exception& e)
   {
@@ -257,16 +273,32 @@ FileToMulticast::run()
   try
   {
     sender_->initializeSender();
+    if(!interfaceAddress_.empty())
+    {
+      sender_->socket().set_option(boost::asio::ip::multicast::outbound_interface(
+        boost::asio::ip::address_v4::from_string(interfaceAddress_)));
+    }
     if(verbose_)
     {
       std::cout << "Sending " << messageIndex_.size() << " messages. "
         << "Largest is " << bufferSize_ << " bytes." << std::endl;
     }
 
-    strand_.dispatch(
-        strand_.wrap(boost::bind(&FileToMulticast::sendBurst, this)));
+    // Each burst is due a fixed interval after the start, so a late
+    // burst does not delay the ones that follow it.
+    Communication::ReplayPacer pacer;
+    pacer.setSpinNanoseconds(uint64(spinMicroseconds_) * 1000);
+    pacer.start(0);
+    uint64 burstTime = 0;
     StopWatch lapse;
-    this->ioService_.run();
+    while(sendBurst())
+    {
+      if(sendMicroseconds_ != 0)
+      {
+        burstTime += uint64(sendMicroseconds_) * 1000;
+        pacer.waitUntil(pacer.deadline(burstTime));
+      }
+    }
     unsigned long sendLapse = lapse.freeze();
     std::cout << "sent "
       << totalMessageCount_
@@ -294,20 +326,12 @@ FileToMulticast::run()
   return 0;
 }
 
-void
+bool
 FileToMulticast::sendBurst()
 {
+  bool more = true;
   try
   {
-    // set the next timeout
-    if(sendMicroseconds_ != 0)
-    {
-      timer_.expires_from_now(boost::posix_time::microseconds(sendMicroseconds_));
-      timer_.async_wait(
-        strand_.wrap(boost::bind(&FileToMulticast::sendBurst, this))
-        );
-    }
-
     for(size_t nBurstMsg = 0; nBurstMsg < burst_; ++nBurstMsg)
     {
       if(nMsg_ >= messageIndex_.size())
@@ -316,8 +340,8 @@ FileToMulticast::sendBurst()
         nPass_ += 1;
         if(nPass_ >= sendCount_ && sendCount_ != 0)
         {
-          ioService_.stopService();
-          return;
+          more = false;
+          break;
         }
         if(verbose_)
         {
@@ -325,6 +349,8 @@ FileToMulticast::sendBurst()
         }
         if(pauseEveryPass_)
         {
+          batch_.send(sender_->socket());
+          batch_.clear();
           waitForEnter();
         }
         nMsg_ = 0;
@@ -336,6 +362,8 @@ FileToMulticast::sendBurst()
       }
       if(pauseEveryMessage_)
       {
+        batch_.send(sender_->socket());
+        batch_.clear();
         waitForEnter();
       }
 
@@ -350,14 +378,17 @@ FileToMulticast::sendBurst()
       size_t bytesRead = fread(buffer_.get(), 1, messageLength, dataFile_);
       if(bytesRead == 0){} // avoid "Unused local" warning
       assert (bytesRead == messageLength);
-      sender_->send(boost::asio::buffer(buffer_.get(), messageLength));
+      batch_.add(buffer_.get(), messageLength, destinationAddress_, portNumber_);
     }
+    batch_.send(sender_->socket());
+    batch_.clear();
   }
   catch (std::exception& e)
   {
     std::cerr << e.what() << std::endl;
-    ioService_.stopService();
+    more = false;
   }
+  return more;
 }
 
 
@@ -8,6 +8,7 @@
 #include <Communication/AsioService.h>
 #include <Communication/MulticastSender_fwd.h>
 #include <Communication/BufferRecycler.h>
+#include <Communication/DatagramBatch.h>
 #include <stdio.h>
 
 namespace QuickFAST{
@@ -19,6 +20,10 @@ namespace QuickFAST{
     /// to identify the message boundaries in a FAST encoded data file.
     /// It multicasts each message in a separate datagram.
     ///
+    /// Bursts are scheduled against the start of the run rather than the
+    /// end of the previous burst, so the rate does not drift, and the
+    /// messages in a burst are handed to the kernel in one batch.
+    ///
     /// Use the -? command line option for more information.
     ///
     /// This program is not really FAST-aware. It is just part of a testing
@@ -45,7 +50,7 @@ namespace QuickFAST{
 
     private:
       bool parseIndexFile();
-      void sendBurst();
+      bool sendBurst();
 
     private:
       virtual int parseSingleArg(int argc, char * argv[]);
@@ -54,18 +59,18 @@ namespace QuickFAST{
     private:
       unsigned short portNumber_;
       std::string sendAddress_;
+      std::string interfaceAddress_;
       std::string dataFileName_;
       std::string indexFileName_;
       size_t sendCount_;
       size_t sendMicroseconds_;
       size_t burst_;
+      size_t spinMicroseconds_;
       bool pauseEveryPass_;
       bool pauseEveryMessage_;
       bool verbose_;
 
       Communication::AsioService ioService_;
-      boost::asio::strand strand_;
-      boost::asio::deadline_timer timer_;
 
       Application::CommandArgParser commandArgParser_;
       FILE * dataFile_;
@@ -80,6 +85,8 @@ namespace QuickFAST{
       size_t nMsg_;
       size_t totalMessageCount_;
       Communication::MulticastSenderPtr sender_;
+      Communication::DatagramBatch batch_;
+      uint32 destinationAddress_;
     };
   }
 }
@@ -30,6 +30,13 @@ PCapToMulticast::PCapToMulticast()
 , pauseEveryPass_(false)
 , pauseEveryMessage_(false)
 , verbose_(false)
+, replay_(false)
+, speed_(1.0)
+, spinMicroseconds_(50)
+, batchSize_(64)
+, originalGroups_(false)
+, align_(false)
+, wordSize_(0)
 , socket_(ioService_)
 , strand_(ioService_)
 , timer_(ioService_)
@@ -58,11 +65,46 @@ PCapToMulticast::parseSingleArg(int argc, char * argv[])
   std::string opt(argv[0]);
   try
   {
-    if(opt == "-f")
+    if(opt == "-f" && argc > 1)
     {
-      dataFileName_ = argv[1];
+      if(dataFileName_.empty())
+      {
+        dataFileName_ = argv[1];
+      }
+      dataFileNames_.push_back(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-speed" && argc > 1)
+    {
+      speed_ = boost::lexical_cast<double>(argv[1]);
+      replay_ = true;
+      consumed = 2;
+    }
+    else if(opt == "-spin" && argc > 1)
+    {
+      spinMicroseconds_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-batch" && argc > 1)
+    {
+      batchSize_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-i" && argc > 1)
+    {
+      interfaceAddress_ = argv[1];
       consumed = 2;
     }
+    else if(opt == "-original")
+    {
+      originalGroups_ = true;
+      consumed = 1;
+    }
+    else if(opt == "-align")
+    {
+      align_ = true;
+      consumed = 1;
+    }
     else if(opt == "-p" && argc > 1)
     {
       portNumber_ = boost::lexical_cast<unsigned short>(argv[1]);
@@ -111,12 +153,14 @@ PCapToMulticast::parseSingleArg(int argc, char * argv[])
     {
       pcapReader_.set32bit(true);
       pcapReader_.set64bit(false);
+      wordSize_ = 32;
       consumed = 1;
     }
     else if(opt == "-64")
     {
       pcapReader_.set32bit(false);
       pcapReader_.set64bit(true);
+      wordSize_ = 64;
       consumed = 1;
     }
     else if(opt == "-v")
@@ -150,6 +194,17 @@ PCapToMulticast::usage(std::ostream & out) const
   out << "  -64                : Data file was captured on 64 bit system." << std::endl;
   out << "  -packetchecksum n  : size of packet checksum (default is 4)" << std::endl;
   out << "  -v                 : Noise to the console while it runs" << std::endl;
+  out << "Timestamp replay:" << std::endl;
+  out << "  -speed x           : Send each packet when the capture says it arrived." << std::endl;
+  out << "                       x multiplies the capture rate: 10 is ten times as fast, 0.5 half as fast," << std::endl;
+  out << "                       0 is as fast as possible. -r, -b and the pause options are ignored." << std::endl;
+  out << "  -f datafile        : May be repeated.  The captures are merged by timestamp." << std::endl;
+  out << "  -original          : Send to the group and port on which each packet was captured" << std::endl;
+  out << "                       rather than to -a and -p." << std::endl;
+  out << "  -align             : Start all captures together rather than by absolute time." << std::endl;
+  out << "  -spin usec         : Spin rather than sleep this close to a send time (default 50)" << std::endl;
+  out << "  -batch n           : Most packets to send in one system call (default 64)" << std::endl;
+  out << "  -i dotted_ip       : Interface from which to send (127.0.0.1 for loopback testing)" << std::endl;
 }
 
 bool
@@ -164,6 +219,31 @@ PCapToMulticast::applyArgs()
       std::cerr << "ERROR: -f [datafile] option is required." << std::endl;
       commandArgParser_.usage(std::cerr);
     }
+    if(dataFileNames_.size() > 1)
+    {
+      replay_ = true;
+    }
+    if(replay_)
+    {
+      replayer_.setSpeed(speed_);
+      replayer_.setSpinNanoseconds(uint64(spinMicroseconds_) * 1000);
+      replayer_.setBatchSize(batchSize_);
+      replayer_.setAlign(align_);
+      replayer_.setWordSize(wordSize_);
+      replayer_.setInterface(interfaceAddress_);
+      for(size_t nFile = 0; nFile < dataFileNames_.size(); ++nFile)
+      {
+        if(originalGroups_)
+        {
+          replayer_.addCapture(dataFileNames_[nFile]);
+        }
+        else
+        {
+          replayer_.addCapture(dataFileNames_[nFile], sendAddress_, portNumber_);
+        }
+      }
+      return ok;
+    }
     ok = ok && pcapReader_.open(dataFileName_.c_str());// for debugging dump to->, &std::cout);
 
     multicastAddress_ = boost::asio::ip::address::from_string(sendAddress_);
@@ -182,6 +262,10 @@ PCapToMulticast::applyArgs()
 int
 PCapToMulticast::run()
 {
+  if(replay_)
+  {
+    return runReplay();
+  }
   try
   {
     if(verbose_)
@@ -220,6 +304,39 @@ PCapToMulticast::run()
   return 0;
 }
 
+int
+PCapToMulticast::runReplay()
+{
+  try
+  {
+    StopWatch lapse;
+    size_t sent = replayer_.replay(sendCount_);
+    unsigned long sendLapse = lapse.freeze();
+    std::cout << "sent "
+      << sent
+      << " messages in "
+      << replayer_.batchCount()
+      << " batches in "
+      << sendLapse
+      << " milliseconds." << std::endl;
+    if(speed_ > 0.0)
+    {
+      std::cout << "Lateness: mean "
+        << std::fixed << std::setprecision(3)
+        << double(replayer_.meanLateness()) / 1000.0
+        << " usec. max "
+        << double(replayer_.maxLateness()) / 1000.0
+        << " usec." << std::endl;
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
 void
 PCapToMulticast::sendBurst()
 {
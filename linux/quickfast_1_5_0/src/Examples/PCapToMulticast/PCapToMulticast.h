@@ -8,6 +8,7 @@
 #define PCAP_SUPPORT_IS_HEREx
 #include <Application/CommandArgParser.h>
 #include <Communication/PCapReader.h>
+#include <Communication/PCapReplayer.h>
 #include <boost/asio.hpp>
 #include <stdio.h>
 
@@ -20,6 +21,9 @@ namespace QuickFAST{
     /// to identify the message boundaries in a FAST encoded data file.
     /// It multicasts each message in a separate datagram.
     ///
+    /// With the -speed option the packets are sent with the timing recorded
+    /// in the capture, and several captures may be merged (see PCapReplayer.)
+    ///
     /// Use the -? command line option for more information.
     ///
     /// This program is not really FAST-aware. It is just part of a testing
@@ -43,6 +47,7 @@ namespace QuickFAST{
 
     private:
       void sendBurst();
+      int runReplay();
 
     private:
       virtual int parseSingleArg(int argc, char * argv[]);
@@ -61,6 +66,15 @@ namespace QuickFAST{
       bool force64_;
       size_t packetChecksumSize_;
       bool verbose_;
+      std::vector<std::string> dataFileNames_;
+      bool replay_;
+      double speed_;
+      size_t spinMicroseconds_;
+      size_t batchSize_;
+      bool originalGroups_;
+      bool align_;
+      std::string interfaceAddress_;
+      size_t wordSize_;
 
       boost::asio::io_service ioService_;
       boost::asio::ip::address multicastAddress_;
@@ -72,6 +86,7 @@ namespace QuickFAST{
       Application::CommandArgParser commandArgParser_;
 //      FILE * dataFile_;
       Communication::PCapReader pcapReader_;
+      Communication::PCapReplayer replayer_;
       size_t nPass_;
       size_t nMsg_;
       size_t totalMessageCount_;
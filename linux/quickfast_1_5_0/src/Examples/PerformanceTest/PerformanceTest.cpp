@@ -7,9 +7,13 @@
 #include "PerformanceTest.h"
 #include <Codecs/DataSourceStream.h>
 #include <Codecs/DataSourceBufferedStream.h>
+#include <Codecs/DataSourceMappedFile.h>
 #include <Codecs/SynchronousDecoder.h>
 #include <Codecs/TemplateRegistry.h>
 #include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/ParallelDecoder.h>
+#include <Codecs/PCapChannelDecoder.h>
+#include <Common/MappedFile.h>
 
 #include <Examples/MessagePerformance.h>
 #include <PerformanceTest/NullMessage.h>
@@ -20,6 +24,116 @@
 using namespace QuickFAST;
 using namespace Examples;
 
+namespace
+{
+  /// Give each chunk of a parallel decode its own PerformanceBuilder,
+  /// and total the statistics for the chunks that are kept.
+  class ParallelPerformanceHandler : public Codecs::ParallelDecoder::ChunkHandler
+  {
+  public:
+    ParallelPerformanceHandler()
+      : msgCount_(0)
+      , fieldCount_(0)
+      , sequenceEntryCount_(0)
+    {
+    }
+
+    virtual void startDecoding(size_t chunkCount)
+    {
+      builders_.clear();
+      for(size_t nChunk = 0; nChunk < chunkCount; ++nChunk)
+      {
+        builders_.push_back(BuilderPtr(new PerformanceBuilder));
+      }
+    }
+
+    virtual Messages::ValueMessageBuilder & chunkBuilder(size_t chunk)
+    {
+      return *builders_[chunk];
+    }
+
+    virtual bool chunkDecoded(size_t chunk)
+    {
+      msgCount_ += builders_[chunk]->msgCount();
+      fieldCount_ += builders_[chunk]->fieldCount();
+      sequenceEntryCount_ += builders_[chunk]->sequenceEntryCount();
+      builders_[chunk].reset();
+      return true;
+    }
+
+    virtual void chunkDiscarded(size_t chunk)
+    {
+      builders_[chunk].reset();
+    }
+
+    virtual void endDecoding()
+    {
+      builders_.clear();
+    }
+
+  public:
+    size_t msgCount_;
+    size_t fieldCount_;
+    size_t sequenceEntryCount_;
+  private:
+    typedef boost::shared_ptr<PerformanceBuilder> BuilderPtr;
+    std::vector<BuilderPtr> builders_;
+  };
+
+  /// Decode every channel found in a PCap file, each with its own PerformanceBuilder.
+  class PerformanceChannelDecoder : public Codecs::PCapChannelDecoder
+  {
+  public:
+    explicit PerformanceChannelDecoder(Codecs::TemplateRegistryPtr registry)
+      : registry_(registry)
+    {
+    }
+
+    size_t msgCount()const
+    {
+      size_t count = 0;
+      for(size_t nBuilder = 0; nBuilder < builders_.size(); ++nBuilder)
+      {
+        count += builders_[nBuilder]->msgCount();
+      }
+      return count;
+    }
+
+    size_t fieldCount()const
+    {
+      size_t count = 0;
+      for(size_t nBuilder = 0; nBuilder < builders_.size(); ++nBuilder)
+      {
+        count += builders_[nBuilder]->fieldCount();
+      }
+      return count;
+    }
+
+    size_t sequenceEntryCount()const
+    {
+      size_t count = 0;
+      for(size_t nBuilder = 0; nBuilder < builders_.size(); ++nBuilder)
+      {
+        count += builders_[nBuilder]->sequenceEntryCount();
+      }
+      return count;
+    }
+
+  protected:
+    virtual void unknownChannel(const std::string & group, unsigned short port)
+    {
+      BuilderPtr builder(new PerformanceBuilder);
+      builders_.push_back(builder);
+      addChannel(group, port, registry_, *builder);
+    }
+
+  private:
+    Codecs::TemplateRegistryPtr registry_;
+    typedef boost::shared_ptr<PerformanceBuilder> BuilderPtr;
+    std::vector<BuilderPtr> builders_;
+  };
+}
+
 PerformanceTest::PerformanceTest()
   : resetOnMessage_(false)
   , strict_(true)
@@ -31,6 +145,11 @@ PerformanceTest::PerformanceTest()
   , interpret_(false)
   , headerBytes_(0)
   , echo_(false)
+  , mapFile_(false)
+  , parallel_(false)
+  , pcap_(false)
+  , threadCount_(0)
+  , chunkSize_(16 * 1024 * 1024)
 {
 }
 
@@ -112,6 +231,27 @@ PerformanceTest::parseSingleArg(int argc, char * argv[])
       echo_ = true;
       consumed = 1;
     }
+    else if(opt == "-mmap")
+    {
+      mapFile_ = true;
+      consumed = 1;
+    }
+    else if(opt == "-parallel" && argc > 1)
+    {
+      parallel_ = true;
+      threadCount_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
+    else if(opt == "-pcap")
+    {
+      pcap_ = true;
+      consumed = 1;
+    }
+    else if(opt == "-chunk" && argc > 1)
+    {
+      chunkSize_ = boost::lexical_cast<size_t>(argv[1]);
+      consumed = 2;
+    }
   }
   catch (std::exception & ex)
   {
@@ -135,6 +275,12 @@ PerformanceTest::usage(std::ostream & out) const
   out << "  -null       : Use null message to receive fields." << std::endl;
   out << "  -s          : Toggle 'strict decoding rules' (default true)." << std::endl;
   out << "  -hfix n     : Skip n byte header before each message" << std::endl;
+  out << "  -mmap       : Decode the FAST file in place from memory mapped pages." << std::endl;
+  out << "  -parallel n : Split the file at dictionary resets and decode using n threads (0 means one per processor)." << std::endl;
+  out << "                The file is memory mapped.  -r, -head, -hfix and -e are not supported." << std::endl;
+  out << "  -chunk n    : Approximate size in bytes of the pieces decoded in parallel (default 16MB)." << std::endl;
+  out << "  -pcap       : The FAST file is a PCap capture.  Every multicast channel in it is decoded" << std::endl;
+  out << "                separately, in parallel (use -parallel n to set the number of threads)." << std::endl;
   out << std::endl;
   out << " THE FOLLOWING INVALIDATES THE PERFORMANCE TEST NUMBERS, OF COURSE." << std::endl;
   out << "  -e          : Echo input to standard out in hex; include message and field boundaries (for debugging)" << std::endl;
@@ -256,30 +402,85 @@ PerformanceTest::run()
       {
         std::cout << "Decoding input; pass " << nPass + 1 << " of " << count_ << std::endl;
       }
-      fastFile_.seekg(0, std::ios::beg);
-      Codecs::DataSourceBufferedStream source(fastFile_);
-      if(echo_)
+      size_t messageCount = 0;
+      size_t fieldCount = 0;
+      size_t sequenceEntryCount = 0;
+      unsigned long decodeLapse = 0;
+      if(pcap_)
       {
-        source.setEcho(std::cout, Codecs::DataSource::HEX, true, true);
+        PerformanceChannelDecoder decoder(templateRegistry);
+        decoder.setStrict(strict_);
+        decoder.setThreadCount(threadCount_);
+        StopWatch decodeTimer;
+        {
+          PROFILE_POINT("Main");
+          decoder.decode(fastFileName_);
+        }//PROFILE_POINT
+        decodeLapse = decodeTimer.freeze();
+        (*performanceFile_) << "Channels: " << decoder.channelCount() << std::endl;
+        messageCount = decoder.msgCount();
+        fieldCount = decoder.fieldCount();
+        sequenceEntryCount = decoder.sequenceEntryCount();
       }
-
-      PerformanceBuilder builder;
-      Codecs::SynchronousDecoder decoder(templateRegistry);
-      decoder.setResetOnMessage(resetOnMessage_);
-      decoder.setStrict(strict_);
-      decoder.setLimit(head_);
-      decoder.setHeaderBytes(headerBytes_);
-      StopWatch decodeTimer;
+      else if(parallel_)
+      {
+        MappedFile file;
+        if(!file.open(fastFileName_))
+        {
+          std::cerr << "ERROR: Can't open FAST Message file: " << fastFileName_ << std::endl;
+          return -1;
+        }
+        ParallelPerformanceHandler handler;
+        Codecs::ParallelDecoder decoder(templateRegistry);
+        decoder.setStrict(strict_);
+        decoder.setThreadCount(threadCount_);
+        decoder.setChunkSize(chunkSize_);
+        StopWatch decodeTimer;
+        {
+          PROFILE_POINT("Main");
+          decoder.decode(file, handler);
+        }//PROFILE_POINT
+        decodeLapse = decodeTimer.freeze();
+        messageCount = handler.msgCount_;
+        fieldCount = handler.fieldCount_;
+        sequenceEntryCount = handler.sequenceEntryCount_;
+      }
+      else
       {
-        PROFILE_POINT("Main");
-        decoder.decode(source, builder);
-      }//PROFILE_POINT
-      unsigned long decodeLapse = decodeTimer.freeze();
-      size_t messageCount = builder.msgCount();//handler.getMessageCount();
-//      size_t groupCount = builder.groupCount();
-      size_t fieldCount = builder.fieldCount();
-//      size_t sequenceCount = builder.sequenceCount();
-      size_t sequenceEntryCount = builder.sequenceEntryCount();
+        boost::scoped_ptr<Codecs::DataSource> sourcePtr;
+        if(mapFile_)
+        {
+          sourcePtr.reset(new Codecs::DataSourceMappedFile(fastFileName_));
+        }
+        else
+        {
+          fastFile_.seekg(0, std::ios::beg);
+          sourcePtr.reset(new Codecs::DataSourceBufferedStream(fastFile_));
+        }
+        Codecs::DataSource & source = *sourcePtr;
+        if(echo_)
+        {
+          source.setEcho(std::cout, Codecs::DataSource::HEX, true, true);
+        }
+
+        PerformanceBuilder builder;
+        Codecs::SynchronousDecoder decoder(templateRegistry);
+        decoder.setResetOnMessage(resetOnMessage_);
+        decoder.setStrict(strict_);
+        decoder.setLimit(head_);
+        decoder.setHeaderBytes(headerBytes_);
+        StopWatch decodeTimer;
+        {
+          PROFILE_POINT("Main");
+          decoder.decode(source, builder);
+        }//PROFILE_POINT
+        decodeLapse = decodeTimer.freeze();
+        messageCount = builder.msgCount();//handler.getMessageCount();
+//        size_t groupCount = builder.groupCount();
+        fieldCount = builder.fieldCount();
+//        size_t sequenceCount = builder.sequenceCount();
+        sequenceEntryCount = builder.sequenceEntryCount();
+      }
       (*performanceFile_)
 #ifdef _DEBUG
         << "[debug] "
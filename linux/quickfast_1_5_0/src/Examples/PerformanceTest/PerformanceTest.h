@@ -54,6 +54,11 @@ namespace QuickFAST{
       size_t interpret_;
       size_t headerBytes_;
       bool echo_;
+      bool mapFile_;
+      bool parallel_;
+      bool pcap_;
+      size_t threadCount_;
+      size_t chunkSize_;
 
       Codecs::XMLTemplateParser parser_;
       Application::CommandArgParser commandArgParser_;
@@ -0,0 +1,194 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#include <Examples/ExamplesPch.h>
+#include "TemplateOptimizer.h"
+#include <Codecs/OperatorOptimizer.h>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/MessageConsumer.h>
+#include <Codecs/Decoder.h>
+#include <Messages/Message.h>
+
+using namespace QuickFAST;
+using namespace Examples;
+
+namespace
+{
+  /// Pass each decoded message to the optimizer along with the id of the template that decoded it.
+  class OptimizingConsumer : public Codecs::MessageConsumer
+  {
+  public:
+    OptimizingConsumer(Codecs::OperatorOptimizer & optimizer, Application::DecoderConnection & connection)
+      : optimizer_(optimizer)
+      , connection_(connection)
+    {
+    }
+
+    virtual bool consumeMessage(Messages::Message & message)
+    {
+      optimizer_.observe(connection_.decoder().getTemplateId(), message);
+      return true;
+    }
+
+    virtual bool reportDecodingError(const std::string & errorMessage)
+    {
+      std::cerr << "Decoding error: " << errorMessage << std::endl;
+      return false;
+    }
+
+    virtual bool reportCommunicationError(const std::string & errorMessage)
+    {
+      std::cerr << "Communication error: " << errorMessage << std::endl;
+      return false;
+    }
+
+    virtual void decodingStarted()
+    {
+    }
+
+    virtual void decodingStopped()
+    {
+    }
+
+    virtual bool wantLog(unsigned short level)
+    {
+      return level <= Common::Logger::QF_LOG_SERIOUS;
+    }
+
+    virtual bool logMessage(unsigned short level, const std::string & logMessage)
+    {
+      std::cerr << logMessage << std::endl;
+      return true;
+    }
+
+  private:
+    Codecs::OperatorOptimizer & optimizer_;
+    Application::DecoderConnection & connection_;
+  };
+}
+
+TemplateOptimizer::TemplateOptimizer()
+{
+}
+
+TemplateOptimizer::~TemplateOptimizer()
+{
+}
+
+bool
+TemplateOptimizer::init(int argc, char * argv[])
+{
+  commandArgParser_.addHandler(this);
+  return commandArgParser_.parse(argc, argv);
+}
+
+int
+TemplateOptimizer::parseSingleArg(int argc, char * argv[])
+{
+  int consumed = 0;
+  std::string opt(argv[0]);
+  try
+  {
+    if(opt == "-out" && argc > 1)
+    {
+      outputFileName_ = argv[1];
+      consumed = 2;
+    }
+    else
+    {
+      consumed = configuration_.parseSingleArg(argc, argv);
+    }
+  }
+  catch (std::exception & ex)
+  {
+    std::cerr << ex.what() << " while interpreting " << opt << std::endl;
+    consumed = 0;
+  }
+  return consumed;
+}
+
+void
+TemplateOptimizer::usage(std::ostream & out) const
+{
+  configuration_.usage(out);
+  out << std::endl;
+  out << "  -out file            : Write the template file with the chosen operators applied to file." << std::endl;
+  out << "                         The report of the operators chosen is always written to standard output." << std::endl;
+  out << std::endl;
+}
+
+bool
+TemplateOptimizer::applyArgs()
+{
+  bool ok = true;
+  if(configuration_.templateFileName().empty())
+  {
+    ok = false;
+    std::cerr << "ERROR: -t [templatefile] option is required." << std::endl;
+  }
+  if(!ok)
+  {
+    commandArgParser_.usage(std::cerr);
+  }
+  return ok;
+}
+
+int
+TemplateOptimizer::run()
+{
+  int result = 0;
+  try
+  {
+    std::ifstream templates(configuration_.templateFileName().c_str(),
+#ifdef _WIN32
+      std::ios::in | std::ios::binary
+#else
+      std::ios::in
+#endif
+      );
+    if(!templates.good())
+    {
+      std::cerr << "Can't open template file " << configuration_.templateFileName() << std::endl;
+      return -1;
+    }
+    Codecs::XMLTemplateParser parser;
+    Codecs::TemplateRegistryPtr registry = parser.parse(templates);
+
+    Codecs::OperatorOptimizer optimizer(registry);
+    Application::DecoderConnection connection;
+    connection.setTemplateRegistry(registry);
+    OptimizingConsumer consumer(optimizer, connection);
+    Codecs::GenericMessageBuilder builder(consumer);
+    connection.configure(builder, configuration_);
+    connection.receiver().runThreads(0, true);
+
+    optimizer.report(std::cout);
+
+    if(!outputFileName_.empty())
+    {
+      templates.clear();
+      templates.seekg(0, std::ios::beg);
+      std::ofstream out(outputFileName_.c_str());
+      if(!out.good())
+      {
+        std::cerr << "Can't open output file " << outputFileName_ << std::endl;
+        return -1;
+      }
+      optimizer.rewriteTemplates(templates, out);
+    }
+  }
+  catch (std::exception & e)
+  {
+    std::cerr << e.what() << std::endl;
+    result = -1;
+  }
+  return result;
+}
+
+void
+TemplateOptimizer::fini()
+{
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+//
+#ifndef TEMPLATEOPTIMIZER_H
+#define TEMPLATEOPTIMIZER_H
+
+#include <Application/CommandArgParser.h>
+#include <Application/DecoderConnection.h>
+#include <Codecs/OperatorOptimizer_fwd.h>
+
+namespace QuickFAST{
+  namespace Examples{
+    /// @brief Decode captured FAST traffic and choose field operators that would encode it in fewer bytes.
+    ///
+    /// Every decoded message is handed to a Codecs::OperatorOptimizer.  When the input is exhausted
+    /// a report of the operator chosen for each field and the expected compression gain is written
+    /// to standard output, and optionally a copy of the template file with those operators applied.
+    ///
+    /// Run the program with a -? command line option for detailed usage information.
+    class TemplateOptimizer : public Application::CommandArgHandler
+    {
+    public:
+      TemplateOptimizer();
+      ~TemplateOptimizer();
+
+      /// @brief parse command line arguments, and initialize.
+      /// @param argc from main
+      /// @param argv from main
+      /// @returns true if everything is ok.
+      bool init(int argc, char * argv[]);
+      /// @brief run the program
+      /// @returns a value to be used as an exit code of the program (0 means all is well)
+      int run();
+      /// @brief do final cleanup after a run.
+      void fini();
+
+    private:
+      virtual int parseSingleArg(int argc, char * argv[]);
+      virtual void usage(std::ostream & out) const;
+      virtual bool applyArgs();
+
+    private:
+      Application::CommandArgParser commandArgParser_;
+      Application::DecoderConfiguration configuration_;
+      std::string outputFileName_;
+    };
+  }
+}
+#endif // TEMPLATEOPTIMIZER_H
@@ -85,6 +85,8 @@ namespace QuickFAST{
       virtual void addValue(const FieldIdentity & identity, ValueType::Type type, const Decimal& value) = 0;
       /// @brief Add a field to the set.
       ///
+      /// The value may point directly into the buffer being decoded.  It is valid
+      /// only until this method returns, so a builder that retains the value must copy it.
       /// @param identity identifies this field
       /// @param type is the type of data to be added
       /// @param value is the value to be assigned.
@@ -0,0 +1,139 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/NoHeaderAnalyzer.h>
+#include <Codecs/StreamingAssembler.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/MessageConsumer.h>
+#include <Messages/Message.h>
+#include <Communication/BufferSlab.h>
+#include <Communication/RawFileReceiver.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const char template_xml[] =
+    "<templates>"
+    "  <template name=\"slab\" id=\"2\">"
+    "     <uInt32 name=\"seq\" id=\"1\"><increment/></uInt32>"
+    "  </template>"
+    "</templates>"
+    ;
+
+  class SlabConsumer : public Codecs::MessageConsumer
+  {
+  public:
+    SlabConsumer()
+      : messageCount_(0)
+      , errorCount_(0)
+      , seq_(0)
+    {
+    }
+
+    virtual bool consumeMessage(Messages::Message & message)
+    {
+      ++messageCount_;
+      Messages::FieldCPtr value;
+      if(message.getField("seq", value))
+      {
+        seq_ = value->toUInt32();
+      }
+      return true;
+    }
+    virtual bool wantLog(unsigned short /*level*/)
+    {
+      return false;
+    }
+    virtual bool logMessage(unsigned short /*level*/, const std::string & /*logMessage*/)
+    {
+      return true;
+    }
+    virtual bool reportDecodingError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual bool reportCommunicationError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual void decodingStarted()
+    {
+    }
+    virtual void decodingStopped()
+    {
+    }
+
+  public: // because this is a test class
+    size_t messageCount_;
+    size_t errorCount_;
+    uint32 seq_;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(TestBufferSlab)
+{
+  Communication::BufferSlab slab;
+  // huge pages are usually not reserved on a test machine; either way the slab works.
+  BOOST_REQUIRE(slab.allocate(100, 10, true, false));
+  BOOST_CHECK(slab.count() >= 10u);
+  BOOST_CHECK_EQUAL(slab.stride(), 128u);
+  BOOST_CHECK(slab.size() >= slab.count() * slab.stride());
+  for(size_t nBuffer = 0; nBuffer < slab.count(); ++nBuffer)
+  {
+    unsigned char * buffer = slab.at(nBuffer);
+    BOOST_CHECK_EQUAL(reinterpret_cast<size_t>(buffer) % 64, 0u);
+    memset(buffer, int(nBuffer), 100);
+  }
+  BOOST_CHECK_EQUAL(slab.at(3)[99], 3);
+  BOOST_CHECK_EQUAL(slab.at(4)[0], 4);
+  slab.release();
+  BOOST_CHECK_EQUAL(slab.count(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(TestReceiverBufferPoolGrowth)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  // The first message sets seq = 1; the rest increment it.
+  const size_t messageCount = 1000;
+  std::string fast("\xE0\x82\x81", 3);
+  for(size_t nMessage = 1; nMessage < messageCount; ++nMessage)
+  {
+    fast += char(0x80);
+  }
+  std::istringstream input(fast);
+
+  Codecs::NoHeaderAnalyzer headerAnalyzer;
+  SlabConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+  Codecs::StreamingAssembler assembler(
+      templateRegistry,
+      headerAnalyzer,
+      builder);
+  Communication::RawFileReceiver receiver(input);
+  receiver.setBufferSlabs(false, false);
+  receiver.setBufferLimit(8);
+
+  // one small buffer: the receiver runs out and the pool must grow.
+  BOOST_REQUIRE(receiver.start(assembler, 5, 1));
+  receiver.run();
+
+  BOOST_CHECK_EQUAL(consumer.errorCount_, 0u);
+  BOOST_CHECK_EQUAL(consumer.messageCount_, messageCount);
+  BOOST_CHECK_EQUAL(consumer.seq_, messageCount);
+  BOOST_CHECK(receiver.bufferPoolGrowths() > 0);
+  BOOST_CHECK(receiver.buffersAllocated() > 1);
+  BOOST_CHECK(receiver.buffersAllocated() <= 8);
+}
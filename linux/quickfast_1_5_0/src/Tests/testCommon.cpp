@@ -12,6 +12,7 @@
 #include <Common/WorkingBuffer.h>
 #include <Common/Exceptions.h>
 #include <Common/Decimal.h>
+#include <Common/MappedFile.h>
 
 using namespace QuickFAST;
 BOOST_AUTO_TEST_CASE(TestLinkedBuffer)
@@ -375,6 +376,17 @@ BOOST_AUTO_TEST_CASE(TestStringBuffer)
   s2 += "?";
   BOOST_CHECK(s2.capacity() > capacity);
   BOOST_CHECK(s2.growCount() == 2);
+
+  String10 s4("ABCDEF");
+  s4.replaceBack(2, ut1, 3);
+  BOOST_CHECK(s4 == "ABCDHel");
+  s4.replaceFront(3, ut2, 1);
+  BOOST_CHECK(s4 == "WDHel");
+  s4.replaceFront(0, ut2, 2);
+  BOOST_CHECK(s4 == "WoWDHel");
+  s4.replaceBack(100, ut1, 5);
+  BOOST_CHECK(s4 == "Hello");
+  BOOST_CHECK(s4.growCount() == 0);
 }
 
 BOOST_AUTO_TEST_CASE(TestWorkingBuffer)
@@ -504,3 +516,47 @@ BOOST_AUTO_TEST_CASE(TestDecimal)
   BOOST_CHECK_GT(f, g);
 
 }
+
+BOOST_AUTO_TEST_CASE(TestMappedFile)
+{
+  boost::filesystem::path path =
+    boost::filesystem::temp_directory_path() / "QuickFASTTestMappedFile.dat";
+  const size_t fileSize = 100000;
+  {
+    std::ofstream out(path.string().c_str(), std::ios::out | std::ios::binary);
+    for(size_t pos = 0; pos < fileSize; ++pos)
+    {
+      out.put(char(pos % 251));
+    }
+  }
+
+  {
+    // a small window forces the mapping to move.
+    MappedFile file;
+    BOOST_REQUIRE(file.open(path.string(), 4096));
+    BOOST_CHECK_EQUAL(file.size(), fileSize);
+    const unsigned char * data = file.map(0, 100);
+    BOOST_REQUIRE(data != 0);
+    BOOST_CHECK_EQUAL(data[99], 99);
+
+    // straddles several windows
+    data = file.map(50000, 10000);
+    BOOST_REQUIRE(data != 0);
+    bool match = true;
+    for(size_t pos = 0; pos < 10000; ++pos)
+    {
+      match = match && data[pos] == (50000 + pos) % 251;
+    }
+    BOOST_CHECK(match);
+
+    // the previous window is still mapped
+    const unsigned char * next = file.map(60000, 10);
+    BOOST_REQUIRE(next != 0);
+    BOOST_CHECK_EQUAL(next[0], 60000 % 251);
+    BOOST_CHECK_EQUAL(data[0], 50000 % 251);
+
+    BOOST_CHECK(file.map(fileSize - 10, 11) == 0);
+    BOOST_CHECK(file.map(fileSize - 10, 10) != 0);
+  }
+  boost::filesystem::remove(path);
+}
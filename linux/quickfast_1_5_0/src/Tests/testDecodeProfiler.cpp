@@ -0,0 +1,127 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/DecodeProfiler.h>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/DataDestination.h>
+#include <Codecs/DataSourceString.h>
+#include <Codecs/SingleMessageConsumer.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Messages/Message.h>
+#include <Messages/FieldIdentity.h>
+#include <Messages/FieldUInt32.h>
+#include <Messages/FieldInt64.h>
+#include <Messages/FieldAscii.h>
+#include <Messages/FieldSequence.h>
+#include <Messages/Sequence.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const char template_xml[] =
+    "<templates xmlns=\"http://www.fixprotocol.org/ns/fast/td/1.1\">"
+    "  <template name=\"trade\" id=\"1\">"
+    "    <uInt32 name=\"SeqNum\"><increment/></uInt32>"
+    "    <int64 name=\"Price\"/>"
+    "    <sequence name=\"Legs\">"
+    "      <length name=\"NoLegs\"/>"
+    "      <string name=\"Leg\"><copy/></string>"
+    "    </sequence>"
+    "  </template>"
+    "</templates>"
+    ;
+
+  // a message holds a reference to each field's identity, so these must outlive it.
+  const Messages::FieldIdentity identity_SeqNum("SeqNum");
+  const Messages::FieldIdentity identity_Price("Price");
+  const Messages::FieldIdentity identity_Legs("Legs");
+  const Messages::FieldIdentity identity_NoLegs("NoLegs");
+  const Messages::FieldIdentity identity_Leg("Leg");
+
+  const size_t messageCount = 50;
+}
+
+BOOST_AUTO_TEST_CASE(TestDecodeProfiler)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr registry = parser.parse(templateStream);
+
+  Codecs::Encoder encoder(registry);
+  Codecs::DataDestination destination;
+  for(size_t nMessage = 0; nMessage < messageCount; ++nMessage)
+  {
+    Messages::Message message(3);
+    message.addField(identity_SeqNum, Messages::FieldUInt32::create(uint32(1000 + nMessage)));
+    message.addField(identity_Price, Messages::FieldInt64::create(int64(1000000)));
+    Messages::SequencePtr legs(new Messages::Sequence(identity_NoLegs, 1));
+    Messages::FieldSetPtr leg(new Messages::FieldSet(1));
+    leg->addField(identity_Leg, Messages::FieldAscii::create("LEG"));
+    legs->addEntry(leg);
+    message.addField(identity_Legs, Messages::FieldSequence::create(legs));
+    encoder.encodeMessage(destination, 1, message);
+  }
+  std::string fastString;
+  destination.toString(fastString);
+
+  Codecs::DecodeProfiler profiler;
+  Codecs::Decoder decoder(registry);
+  decoder.setProfiler(&profiler);
+  Codecs::DataSourceString source(fastString);
+  for(size_t nMessage = 0; nMessage < messageCount; ++nMessage)
+  {
+    Codecs::SingleMessageConsumer consumer;
+    Codecs::GenericMessageBuilder builder(consumer);
+    BOOST_REQUIRE(decoder.decodeMessage(source, builder));
+  }
+  BOOST_CHECK_EQUAL(profiler.messageCount(), messageCount);
+
+  const Codecs::DecodeProfiler::TemplateStatistics * trade = profiler.findTemplate(1);
+  BOOST_REQUIRE(trade != 0);
+  BOOST_CHECK_EQUAL(trade->messages_, messageCount);
+  BOOST_CHECK_EQUAL(trade->bytes_, fastString.size());
+
+  // incremented: present once, then derived from the dictionary.
+  const Codecs::DecodeProfiler::FieldStatistics * seqNum = profiler.findField(1, "SeqNum");
+  BOOST_REQUIRE(seqNum != 0);
+  BOOST_CHECK_EQUAL(seqNum->count_, messageCount);
+  BOOST_CHECK_EQUAL(seqNum->bytes_, 2u);
+  BOOST_CHECK_EQUAL(seqNum->pmapChecks_, messageCount);
+  BOOST_CHECK_EQUAL(seqNum->pmapSet_, 1u);
+  BOOST_CHECK_EQUAL(seqNum->dictionaryReads_, messageCount - 1);
+  BOOST_CHECK_EQUAL(seqNum->dictionaryMisses_, 0u);
+  BOOST_CHECK_EQUAL(seqNum->operatorName_, "increment");
+
+  // no operator: three bytes every time, no presence bit, no dictionary.
+  const Codecs::DecodeProfiler::FieldStatistics * price = profiler.findField(1, "Price");
+  BOOST_REQUIRE(price != 0);
+  BOOST_CHECK_EQUAL(price->bytes_, 3 * messageCount);
+  BOOST_CHECK_EQUAL(price->pmapChecks_, 0u);
+  BOOST_CHECK_EQUAL(price->dictionaryReads_, 0u);
+
+  // the sequence is charged for its length and entry presence maps, not its fields.
+  const Codecs::DecodeProfiler::FieldStatistics * legs = profiler.findField(1, "Legs");
+  BOOST_REQUIRE(legs != 0);
+  BOOST_CHECK_EQUAL(legs->bytes_, 2 * messageCount);
+  const Codecs::DecodeProfiler::FieldStatistics * leg = profiler.findField(1, "Leg");
+  BOOST_REQUIRE(leg != 0);
+  BOOST_CHECK_EQUAL(leg->count_, messageCount);
+  BOOST_CHECK_EQUAL(leg->bytes_, 3u);
+  BOOST_CHECK_EQUAL(leg->pmapChecks_, messageCount);
+  BOOST_CHECK_EQUAL(leg->pmapSet_, 1u);
+
+  BOOST_CHECK(seqNum->bytes_ + price->bytes_ + legs->bytes_ + leg->bytes_ < trade->bytes_);
+
+  std::stringstream report;
+  profiler.report(report, Codecs::DecodeProfiler::BY_BYTES);
+  BOOST_CHECK(report.str().find("trade/Price (nop)") < report.str().find("trade/SeqNum (increment)"));
+}
@@ -0,0 +1,274 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Application/EncoderConnection.h>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/FixedSizeHeaderAnalyzer.h>
+#include <Codecs/MessagePerPacketAssembler.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/MessageConsumer.h>
+#include <Messages/Message.h>
+#include <Messages/FieldIdentity.h>
+#include <Messages/FieldUInt32.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const char template_xml[] =
+    "<templates>"
+    "  <template name=\"pub\" id=\"2\">"
+    "     <uInt32 name=\"producer\" id=\"1\"><copy/></uInt32>"
+    "     <uInt32 name=\"count\" id=\"2\"><delta/></uInt32>"
+    "  </template>"
+    "</templates>"
+    ;
+
+  const size_t producerCount = 4;
+  const size_t messagesPerProducer = 500;
+
+  class PublicationConsumer : public Codecs::MessageConsumer
+  {
+  public:
+    PublicationConsumer()
+      : errorCount_(0)
+      , next_(producerCount, 0)
+      , outOfOrder_(0)
+      , total_(0)
+    {
+    }
+
+    virtual bool consumeMessage(Messages::Message & message)
+    {
+      Messages::FieldCPtr producer;
+      Messages::FieldCPtr count;
+      if(message.getField("producer", producer) && message.getField("count", count))
+      {
+        size_t nProducer = producer->toUInt32();
+        if(nProducer >= producerCount || next_[nProducer] != count->toUInt32())
+        {
+          ++outOfOrder_;
+        }
+        else
+        {
+          ++next_[nProducer];
+        }
+        ++total_;
+      }
+      return true;
+    }
+    virtual bool wantLog(unsigned short /*level*/)
+    {
+      return false;
+    }
+    virtual bool logMessage(unsigned short /*level*/, const std::string & /*logMessage*/)
+    {
+      return true;
+    }
+    virtual bool reportDecodingError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual bool reportCommunicationError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual void decodingStarted()
+    {
+    }
+    virtual void decodingStopped()
+    {
+    }
+
+  public: // because this is a test class
+    size_t errorCount_;
+    std::vector<uint32> next_;
+    size_t outOfOrder_;
+    size_t total_;
+  };
+
+  Messages::MessageCPtr makeMessage(
+    Codecs::TemplateRegistryPtr & registry,
+    uint32 producer,
+    uint32 count)
+  {
+    static const Messages::FieldIdentity identity_producer("producer");
+    static const Messages::FieldIdentity identity_count("count");
+    Messages::MessagePtr message(new Messages::Message(registry->maxFieldCount()));
+    message->addField(identity_producer, Messages::FieldUInt32::create(producer));
+    message->addField(identity_count, Messages::FieldUInt32::create(count));
+    return message;
+  }
+
+  void produce(
+    Application::EncoderConnection * connection,
+    std::vector<Messages::MessageCPtr> * messages)
+  {
+    for(size_t nMessage = 0; nMessage < messages->size(); ++nMessage)
+    {
+      connection->publish(2, (*messages)[nMessage]);
+    }
+  }
+
+  void receiveAll(boost::asio::ip::udp::socket & socket, std::vector<std::string> & datagrams)
+  {
+    unsigned char buffer[2000];
+    boost::system::error_code error;
+    for(size_t nWait = 0; nWait < 100 && socket.available(error) == 0; ++nWait)
+    {
+      boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    while(socket.available(error) > 0)
+    {
+      size_t bytes = socket.receive(boost::asio::buffer(buffer, sizeof(buffer)));
+      datagrams.push_back(std::string(reinterpret_cast<char *>(buffer), bytes));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestEncoderConnectionPublish)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  // Loopback unicast stands in for the A and B groups.
+  boost::asio::io_service ioService;
+  boost::asio::ip::address loopback = boost::asio::ip::address::from_string("127.0.0.1");
+  boost::asio::ip::udp::socket receiverA(ioService, boost::asio::ip::udp::endpoint(loopback, 0));
+  boost::asio::ip::udp::socket receiverB(ioService, boost::asio::ip::udp::endpoint(loopback, 0));
+  receiverA.set_option(boost::asio::socket_base::receive_buffer_size(1 << 20));
+  receiverB.set_option(boost::asio::socket_base::receive_buffer_size(1 << 20));
+
+  Application::EncoderConfiguration configuration;
+  configuration.setPrimaryGroup("127.0.0.1", receiverA.local_endpoint().port());
+  configuration.setSecondaryGroup("127.0.0.1", receiverB.local_endpoint().port());
+  configuration.setMaxDatagramSize(200);
+  configuration.setQueueSize(64);
+  configuration.setRetransmitPackets(8);
+  configuration.setPacketHeaderMessageSizeBytes(2);
+  configuration.setPacketHeaderPrefixCount(4);
+  configuration.setSequenceNumberPosition(0, 4);
+  configuration.setMessageHeaderMessageSizeBytes(2);
+
+  Application::EncoderConnection connection;
+  connection.setTemplateRegistry(templateRegistry);
+  connection.configure(configuration);
+  connection.start();
+
+  // each producer publishes its own messages in order; the queue is small so they contend for it.
+  std::vector<std::vector<Messages::MessageCPtr> > messages(producerCount);
+  boost::thread_group producers;
+  for(size_t nProducer = 0; nProducer < producerCount; ++nProducer)
+  {
+    for(size_t nMessage = 0; nMessage < messagesPerProducer; ++nMessage)
+    {
+      messages[nProducer].push_back(makeMessage(templateRegistry, uint32(nProducer), uint32(nMessage)));
+    }
+    producers.create_thread(boost::bind(produce, &connection, &messages[nProducer]));
+  }
+  producers.join_all();
+  connection.stop();
+
+  BOOST_CHECK_EQUAL(connection.messageCount(), producerCount * messagesPerProducer);
+  BOOST_CHECK_EQUAL(connection.encodingErrorCount(), 0u);
+
+  std::vector<std::string> datagramsA;
+  std::vector<std::string> datagramsB;
+  receiveAll(receiverA, datagramsA);
+  receiveAll(receiverB, datagramsB);
+  BOOST_REQUIRE_EQUAL(datagramsA.size(), connection.packetCount());
+  BOOST_REQUIRE(datagramsA == datagramsB);
+
+  bool bigEndian = true;
+  Codecs::FixedSizeHeaderAnalyzer packetHeaderAnalyzer(2, bigEndian, 4, 0, 0, 4);
+  Codecs::FixedSizeHeaderAnalyzer messageHeaderAnalyzer(2, bigEndian);
+  PublicationConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+  Codecs::MessagePerPacketAssembler assembler(
+    templateRegistry, packetHeaderAnalyzer, messageHeaderAnalyzer, builder);
+  for(size_t nDatagram = 0; nDatagram < datagramsA.size(); ++nDatagram)
+  {
+    const unsigned char * data = reinterpret_cast<const unsigned char *>(datagramsA[nDatagram].data());
+    BOOST_CHECK(datagramsA[nDatagram].size() <= 200u);
+    BOOST_CHECK_EQUAL(packetHeaderAnalyzer.getSequenceNumber(data), 1 + nDatagram);
+    assembler.decodeBuffer(data, datagramsA[nDatagram].size());
+  }
+  BOOST_CHECK_EQUAL(consumer.errorCount_, 0u);
+  BOOST_CHECK_EQUAL(consumer.outOfOrder_, 0u);
+  BOOST_CHECK_EQUAL(consumer.total_, producerCount * messagesPerProducer);
+
+  // the last eight packets can be sent again; older ones are gone.
+  uint32 last = uint32(datagramsA.size());
+  std::string packet;
+  BOOST_CHECK(connection.fetchPacket(last, packet));
+  BOOST_CHECK(packet == datagramsA[last - 1]);
+  BOOST_CHECK(!connection.fetchPacket(last - 8, packet));
+  BOOST_CHECK(!connection.fetchPacket(last + 1, packet));
+  BOOST_CHECK_EQUAL(connection.retransmit(last - 9, last), 8u);
+  std::vector<std::string> resent;
+  receiveAll(receiverA, resent);
+  BOOST_REQUIRE_EQUAL(resent.size(), 8u);
+  BOOST_CHECK(resent[0] == datagramsA[last - 8]);
+  BOOST_CHECK(resent[7] == datagramsA[last - 1]);
+}
+
+BOOST_AUTO_TEST_CASE(TestEncoderConnectionErrorRecovery)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  boost::asio::io_service ioService;
+  boost::asio::ip::udp::socket receiver(ioService,
+    boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), 0));
+
+  Application::EncoderConfiguration configuration;
+  configuration.setPrimaryGroup("127.0.0.1", receiver.local_endpoint().port());
+  configuration.setPacketHeaderMessageSizeBytes(2);
+  configuration.setPacketHeaderPrefixCount(4);
+  configuration.setSequenceNumberPosition(0, 4);
+  configuration.setMessageHeaderMessageSizeBytes(2);
+
+  Application::EncoderConnection connection;
+  connection.setTemplateRegistry(templateRegistry);
+  connection.configure(configuration);
+  connection.start();
+  connection.publish(2, makeMessage(templateRegistry, 1, 0));
+  connection.publish(99, makeMessage(templateRegistry, 1, 1)); // no such template
+  connection.publish(2, makeMessage(templateRegistry, 1, 1));
+  connection.stop();
+  BOOST_CHECK_EQUAL(connection.messageCount(), 2u);
+  BOOST_CHECK_EQUAL(connection.encodingErrorCount(), 1u);
+
+  std::vector<std::string> datagrams;
+  receiveAll(receiver, datagrams);
+  bool bigEndian = true;
+  Codecs::FixedSizeHeaderAnalyzer packetHeaderAnalyzer(2, bigEndian, 4, 0, 0, 4);
+  Codecs::FixedSizeHeaderAnalyzer messageHeaderAnalyzer(2, bigEndian);
+  PublicationConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+  Codecs::MessagePerPacketAssembler assembler(
+    templateRegistry, packetHeaderAnalyzer, messageHeaderAnalyzer, builder);
+  for(size_t nDatagram = 0; nDatagram < datagrams.size(); ++nDatagram)
+  {
+    assembler.decodeBuffer(
+      reinterpret_cast<const unsigned char *>(datagrams[nDatagram].data()),
+      datagrams[nDatagram].size());
+  }
+  // the reset message keeps the decoder's dictionary in step.
+  BOOST_CHECK_EQUAL(consumer.errorCount_, 0u);
+  BOOST_CHECK_EQUAL(consumer.total_, 2u);
+  BOOST_CHECK_EQUAL(consumer.outOfOrder_, 0u);
+}
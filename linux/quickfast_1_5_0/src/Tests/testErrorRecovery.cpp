@@ -11,6 +11,11 @@
 #include <Codecs/FixedSizeHeaderAnalyzer.h>
 #include <Codecs/NoHeaderAnalyzer.h>
 #include <Codecs/PacketSequencingAssembler.h>
+#include <Codecs/MessagePerPacketAssembler.h>
+#include <Codecs/StreamingAssembler.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/MessageConsumer.h>
+#include <Messages/Message.h>
 #include <Messages/FieldIdentity.h>
 #include <Messages/SequentialSingleValueBuilder.h>
 #include <Communication/RecoveryFeed.h>
@@ -30,6 +35,72 @@ namespace
     "</templates>"
     ;
 
+  const char increment_template_xml[] =
+    "<templates>"
+    "  <template name=\"resumable\" id=\"2\">"
+    "     <uInt32 name=\"seq\" id=\"1\"><increment/></uInt32>"
+    "     <uInt32 name=\"data\" id=\"2\"/>"
+    "  </template>"
+    "</templates>"
+    ;
+
+  class CountingConsumer : public Codecs::MessageConsumer
+  {
+  public:
+    CountingConsumer()
+      : messageCount_(0)
+      , errorCount_(0)
+      , seq_(0)
+      , data_(0)
+    {
+    }
+
+    virtual bool consumeMessage(Messages::Message & message)
+    {
+      ++messageCount_;
+      Messages::FieldCPtr value;
+      if(message.getField("seq", value))
+      {
+        seq_ = value->toUInt32();
+      }
+      if(message.getField("data", value))
+      {
+        data_ = value->toUInt32();
+      }
+      return true;
+    }
+    virtual bool wantLog(unsigned short /*level*/)
+    {
+      return false;
+    }
+    virtual bool logMessage(unsigned short /*level*/, const std::string & /*logMessage*/)
+    {
+      return true;
+    }
+    virtual bool reportDecodingError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual bool reportCommunicationError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual void decodingStarted()
+    {
+    }
+    virtual void decodingStopped()
+    {
+    }
+
+  public: // because this is a test class
+    size_t messageCount_;
+    size_t errorCount_;
+    uint32 seq_;
+    uint32 data_;
+  };
+
   struct Packet{
     sequence_t sequenceNumber;
     uchar pmap;
@@ -491,3 +562,144 @@ BOOST_AUTO_TEST_CASE(TestPacketSequencingAssemblerGapFill)
   BOOST_CHECK_EQUAL(builder.value(3), reinterpret_cast<std::ptrdiff_t> (buffer14.extra()));
   BOOST_CHECK_EQUAL(builder.value(4), reinterpret_cast<std::ptrdiff_t> (buffer15.extra()));
 }
+
+BOOST_AUTO_TEST_CASE(TestExceptionFreeDecoding)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  Codecs::NoHeaderAnalyzer packetHeaderAnalyzer;
+  Codecs::NoHeaderAnalyzer messageHeaderAnalyzer;
+  Messages::SequentialSingleValueBuilder<uint32> builder;
+  Codecs::MessagePerPacketAssembler assembler(
+      templateRegistry,
+      packetHeaderAnalyzer,
+      messageHeaderAnalyzer,
+      builder);
+  assembler.setExceptionFree();
+  TestReceiver receiver;
+  assembler.receiverStarted(receiver);
+  BOOST_CHECK(assembler.decoder().getExceptionFree());
+  builder.reset();
+
+  unsigned char good1[] = {0xC0, 0x81, 0x85};
+  unsigned char truncated[] = {0xC0, 0x81, 0x05};
+  unsigned char unknown[] = {0xC0, 0x82, 0x85};
+  unsigned char good2[] = {0xC0, 0x81, 0x86};
+  Communication::LinkedBuffer good1Buffer(good1, sizeof(good1));
+  Communication::LinkedBuffer truncatedBuffer(truncated, sizeof(truncated));
+  Communication::LinkedBuffer unknownBuffer(unknown, sizeof(unknown));
+  Communication::LinkedBuffer good2Buffer(good2, sizeof(good2));
+  Communication::LinkedBuffer good3Buffer(good1, sizeof(good1));
+
+  // A truncated message is reported, then decoding resumes with the next packet
+  receiver.acceptBuffer(&good1Buffer);
+  receiver.acceptBuffer(&truncatedBuffer);
+  receiver.acceptBuffer(&good2Buffer);
+  assembler.serviceQueue(receiver);
+  BOOST_CHECK(builder.hasError());
+  BOOST_REQUIRE_EQUAL(builder.valueCount(), 2);
+  BOOST_CHECK_EQUAL(builder.value(0), 5);
+  BOOST_CHECK_EQUAL(builder.value(1), 6);
+  BOOST_CHECK(!assembler.decoder().hasError());
+
+  // An unknown template is reported the same way
+  builder.reset();
+  receiver.acceptBuffer(&unknownBuffer);
+  assembler.serviceQueue(receiver);
+  BOOST_CHECK(builder.hasError());
+  BOOST_CHECK_EQUAL(builder.message().substr(0, 8), "[ERR D9]");
+  BOOST_CHECK_EQUAL(builder.valueCount(), 0);
+
+  builder.reset();
+  receiver.acceptBuffer(&good3Buffer);
+  assembler.serviceQueue(receiver);
+  BOOST_CHECK(!builder.hasError());
+  BOOST_REQUIRE_EQUAL(builder.valueCount(), 1);
+  BOOST_CHECK_EQUAL(builder.value(0), 5);
+}
+
+BOOST_AUTO_TEST_CASE(TestResumableStreamingAssembler)
+{
+  std::stringstream templateStream(increment_template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  Codecs::NoHeaderAnalyzer headerAnalyzer;
+  CountingConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+  Codecs::StreamingAssembler assembler(
+      templateRegistry,
+      headerAnalyzer,
+      builder);
+  assembler.setResumable();
+  TestReceiver receiver;
+  assembler.receiverStarted(receiver);
+
+  // message 1: seq = 5, data = 1.
+  // message 2: seq incremented to 6, data = 2 -- split across three buffers.
+  unsigned char part1[] = {0xE0, 0x82, 0x85, 0x81, 0x80};
+  unsigned char part2[] = {0x01};
+  unsigned char part3[] = {0x82};
+  Communication::LinkedBuffer buffer1(part1, sizeof(part1));
+  Communication::LinkedBuffer buffer2(part2, sizeof(part2));
+  Communication::LinkedBuffer buffer3(part3, sizeof(part3));
+
+  receiver.acceptBuffer(&buffer1);
+  BOOST_CHECK(assembler.serviceQueue(receiver));
+  BOOST_CHECK_EQUAL(consumer.messageCount_, 1);
+  BOOST_CHECK_EQUAL(consumer.seq_, 5);
+  BOOST_CHECK_EQUAL(consumer.data_, 1);
+
+  // still incomplete: the partial message must not be delivered
+  receiver.acceptBuffer(&buffer2);
+  BOOST_CHECK(assembler.serviceQueue(receiver));
+  BOOST_CHECK_EQUAL(consumer.messageCount_, 1);
+
+  // complete: the increment must be applied exactly once
+  receiver.acceptBuffer(&buffer3);
+  BOOST_CHECK(assembler.serviceQueue(receiver));
+  BOOST_CHECK_EQUAL(consumer.messageCount_, 2);
+  BOOST_CHECK_EQUAL(consumer.seq_, 6);
+  BOOST_CHECK_EQUAL(consumer.data_, 0x82);
+  BOOST_CHECK_EQUAL(consumer.errorCount_, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestResumableMessageLargerThanBuffers)
+{
+  std::stringstream templateStream(increment_template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  Codecs::NoHeaderAnalyzer headerAnalyzer;
+  CountingConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+  Codecs::StreamingAssembler assembler(
+      templateRegistry,
+      headerAnalyzer,
+      builder);
+  assembler.setResumable();
+  TestReceiver receiver;
+  // a pool of two buffers can never hold message 2.
+  receiver.addBuffers(2);
+  assembler.receiverStarted(receiver);
+
+  unsigned char part1[] = {0xE0, 0x82, 0x85, 0x81, 0x80};
+  unsigned char part2[] = {0x01};
+  Communication::LinkedBuffer buffer1(part1, sizeof(part1));
+  Communication::LinkedBuffer buffer2(part2, sizeof(part2));
+
+  receiver.acceptBuffer(&buffer1);
+  BOOST_CHECK(assembler.serviceQueue(receiver));
+  BOOST_CHECK_EQUAL(consumer.messageCount_, 1);
+
+  // both buffers are held by the incomplete message: report it rather than stall.
+  receiver.acceptBuffer(&buffer2);
+  BOOST_CHECK(!assembler.serviceQueue(receiver));
+  BOOST_CHECK_EQUAL(consumer.messageCount_, 1);
+  BOOST_CHECK_EQUAL(consumer.errorCount_, 1);
+}
@@ -2401,3 +2401,81 @@ BOOST_AUTO_TEST_CASE(test_issue_31)
   BOOST_CHECK_EQUAL(result, testString);
   BOOST_CHECK(pmap == pmapResult);
 }
+
+namespace
+{
+  // one byte at a time, least significant group first: the obvious stop bit encoding.
+  std::string referenceSignedEncoding(int64 value)
+  {
+    std::string result;
+    uchar byte = stopBit;
+    bool more = true;
+    while(more)
+    {
+      byte |= static_cast<uchar>(value & dataBits);
+      more = !((value >> 6) == 0 || (value >> 6) == -1);
+      value >>= dataShift;
+      result.insert(result.begin(), static_cast<char>(byte));
+      byte = 0;
+    }
+    return result;
+  }
+
+  std::string referenceUnsignedEncoding(uint64 value)
+  {
+    std::string result;
+    uchar byte = stopBit;
+    do
+    {
+      byte |= static_cast<uchar>(value & dataBits);
+      value >>= dataShift;
+      result.insert(result.begin(), static_cast<char>(byte));
+      byte = 0;
+    } while(value != 0);
+    return result;
+  }
+
+  std::string encodedSigned(int64 value)
+  {
+    Codecs::DataDestination destination;
+    WorkingBuffer buffer;
+    Codecs::FieldInstruction::encodeSignedInteger(destination, buffer, value);
+    std::string result;
+    destination.toString(result);
+    return result;
+  }
+
+  std::string encodedUnsigned(uint64 value)
+  {
+    Codecs::DataDestination destination;
+    WorkingBuffer buffer;
+    Codecs::FieldInstruction::encodeUnsignedInteger(destination, buffer, value);
+    std::string result;
+    destination.toString(result);
+    return result;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testStopBitIntegerEncoding)
+{
+  // Check every length boundary.
+  for(unsigned int bit = 0; bit < 64; ++bit)
+  {
+    uint64 power = uint64(1) << bit;
+    uint64 unsignedValues[] = {power - 1, power, power + 1, ~power};
+    for(size_t n = 0; n < sizeof(unsignedValues)/sizeof(unsignedValues[0]); ++n)
+    {
+      BOOST_CHECK(encodedUnsigned(unsignedValues[n]) == referenceUnsignedEncoding(unsignedValues[n]));
+      int64 value = static_cast<int64>(unsignedValues[n]);
+      BOOST_CHECK(encodedSigned(value) == referenceSignedEncoding(value));
+      BOOST_CHECK(encodedSigned(-value) == referenceSignedEncoding(-value));
+    }
+  }
+  BOOST_CHECK(encodedSigned(0) == std::string("\x80"));
+  BOOST_CHECK(encodedSigned(-1) == std::string("\xFF"));
+  BOOST_CHECK(encodedSigned(942755) == std::string("\x39\x45\xa3"));
+  BOOST_CHECK(encodedSigned(-942755) == std::string("\x46\x3a\xdd"));
+  BOOST_CHECK(encodedUnsigned(0) == std::string("\x80"));
+  BOOST_CHECK_EQUAL(encodedSigned(int64(0x8000000000000000ULL)).size(), 10u);
+  BOOST_CHECK_EQUAL(encodedUnsigned(~uint64(0)).size(), 10u);
+}
@@ -1244,6 +1244,70 @@ BOOST_AUTO_TEST_CASE(testAsciiTailMandatory)
   BOOST_CHECK(pmap == pmapResult);
 }
 
+BOOST_AUTO_TEST_CASE(testAsciiDeltaRollback)
+{
+  //  Not in spec
+  // Delta updates the dictionary entry in place; a rollback must restore it.
+  // <string id="1" presence="mandatory" name="Security"> <delta/> </string>
+  // Input    Prior   Encoded     FAST Hex/Binary
+  // ABCD     Empty   0 ABCD      80 41 42 43 C4
+  // ABCEF    ABCD    1 EF        81 45 C6        (rolled back)
+  // XYBCD    ABCD    -1 XY       FE 58 D9
+  const char testData[] = "\x80\x41\x42\x43\xC4\x81\x45\xC6\xFE\x58\xD9";
+  std::string testString(testData, sizeof(testData)-1);
+  Codecs::DataSourceString source(testString);
+
+  Codecs::DictionaryIndexer indexer;
+  Codecs::PresenceMap pmap(1);
+
+  Codecs::FieldInstructionAscii field("Security", "");
+  field.setPresence(true);
+  field.setFieldOp(Codecs::FieldOpPtr(new Codecs::FieldOpDelta));
+  field.indexDictionaries(indexer, "global", "", "");
+  Codecs::TemplateRegistryPtr registry(new Codecs::TemplateRegistry(3,3,indexer.size()));
+  field.finalize(*registry);
+
+  Codecs::Decoder decoder(registry);
+
+  Codecs::SingleMessageConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+
+  builder.startMessage("UNIT_TEST", "", 10);
+  field.decode(source, pmap, decoder, builder);
+  BOOST_REQUIRE(builder.endMessage(builder));
+  Messages::Message fieldSet1(1);
+  fieldSet1.swap(consumer.message());
+
+  decoder.beginCheckpoint();
+  builder.startMessage("UNIT_TEST", "", 10);
+  field.decode(source, pmap, decoder, builder);
+  BOOST_REQUIRE(builder.endMessage(builder));
+  Messages::Message fieldSet2(1);
+  fieldSet2.swap(consumer.message());
+  decoder.rollbackCheckpoint();
+
+  builder.startMessage("UNIT_TEST", "", 10);
+  field.decode(source, pmap, decoder, builder);
+  BOOST_REQUIRE(builder.endMessage(builder));
+  Messages::Message fieldSet3(1);
+  fieldSet3.swap(consumer.message());
+
+  uchar byte;
+  BOOST_CHECK(!source.getByte(byte));
+
+  Messages::FieldSet::const_iterator pFieldEntry = fieldSet1.begin();
+  BOOST_REQUIRE(pFieldEntry != fieldSet1.end());
+  BOOST_CHECK_EQUAL(pFieldEntry->getField()->toAscii(), "ABCD");
+
+  pFieldEntry = fieldSet2.begin();
+  BOOST_REQUIRE(pFieldEntry != fieldSet2.end());
+  BOOST_CHECK_EQUAL(pFieldEntry->getField()->toAscii(), "ABCEF");
+
+  pFieldEntry = fieldSet3.begin();
+  BOOST_REQUIRE(pFieldEntry != fieldSet3.end());
+  BOOST_CHECK_EQUAL(pFieldEntry->getField()->toAscii(), "XYBCD");
+}
+
 BOOST_AUTO_TEST_CASE(testAppendix_3_2_6) // SPEC ERROR: _3 s/b _1
 {
   // Multiple Pmap Slot Example  Optional Positive Decimal with individual field operators
@@ -0,0 +1,100 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/IdleStrategy.h>
+#include <Communication/AsioService.h>
+#include <Communication/SingleServerBufferQueue.h>
+#include <Communication/LinkedBuffer.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  void setFlag(bool * flag, const boost::system::error_code &)
+  {
+    *flag = true;
+  }
+
+  void pushLater(
+    Communication::SingleServerBufferQueue * queue,
+    boost::mutex * mutex,
+    Communication::LinkedBuffer * buffer)
+  {
+    boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    boost::mutex::scoped_lock lock(*mutex);
+    queue->push(buffer, lock);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestIdleStrategyParse)
+{
+  std::vector<Communication::IdleStrategy> strategies;
+  Communication::IdleStrategy::parse("spin:park,10,5,200:block:yield,50", strategies);
+  BOOST_REQUIRE_EQUAL(strategies.size(), 4u);
+  BOOST_CHECK_EQUAL(strategies[0].mode(), Communication::IdleStrategy::SPIN);
+  BOOST_CHECK_EQUAL(strategies[1].mode(), Communication::IdleStrategy::PARK);
+  BOOST_CHECK(strategies[2].blocks());
+  BOOST_CHECK_EQUAL(strategies[3].mode(), Communication::IdleStrategy::YIELD);
+
+  BOOST_CHECK_THROW(Communication::IdleStrategy::parse("doze", strategies), UsageError);
+  BOOST_CHECK_THROW(Communication::IdleStrategy::parse("spin,1", strategies), UsageError);
+  BOOST_CHECK_THROW(Communication::IdleStrategy::parse("park,1,2,3,4", strategies), UsageError);
+  BOOST_CHECK_THROW(Communication::IdleStrategy::parse("yield,x", strategies), UsageError);
+  BOOST_CHECK_THROW(Communication::IdleStrategy::parse("spin:", strategies), UsageError);
+  // a bad description changes nothing.
+  BOOST_CHECK_EQUAL(strategies.size(), 4u);
+
+  // parking backs off but keeps going.
+  Communication::IdleStrategy park(Communication::IdleStrategy::PARK, 2, 2, 50);
+  for(size_t nIdle = 0; nIdle < 20; ++nIdle)
+  {
+    park.idle();
+  }
+  park.reset();
+}
+
+BOOST_AUTO_TEST_CASE(TestPollingEventLoop)
+{
+  boost::asio::io_service ioService;
+  Communication::AsioService service(ioService);
+  std::vector<Communication::IdleStrategy> strategies;
+  Communication::IdleStrategy::parse("spin:park,10,10,100", strategies);
+  service.setIdleStrategies(strategies);
+
+  bool expired = false;
+  boost::asio::deadline_timer timer(ioService, boost::posix_time::milliseconds(20));
+  timer.async_wait(boost::bind(&setFlag, &expired, boost::asio::placeholders::error));
+
+  // both threads poll until the timer fires, then run out of work and return.
+  service.startThreads(2);
+  service.joinThreads();
+  BOOST_CHECK(expired);
+}
+
+BOOST_AUTO_TEST_CASE(TestPollingQueueWait)
+{
+  boost::mutex mutex;
+  Communication::SingleServerBufferQueue queue;
+  queue.setIdleStrategy(Communication::IdleStrategy(Communication::IdleStrategy::YIELD, 100));
+  Communication::LinkedBuffer first(10);
+  Communication::LinkedBuffer second(10);
+
+  boost::mutex::scoped_lock lock(mutex);
+  BOOST_REQUIRE(queue.push(&first, lock));
+  BOOST_REQUIRE(queue.startService(lock));
+  BOOST_CHECK(queue.serviceNext() == &first);
+  BOOST_CHECK(queue.serviceNext() == 0);
+
+  // the lock must be released while polling or the push never happens.
+  boost::thread pusher(boost::bind(&pushLater, &queue, &mutex, &second));
+  BOOST_CHECK(queue.refresh(lock, true));
+  BOOST_CHECK(queue.serviceNext() == &second);
+  BOOST_CHECK(!queue.endService(true, lock));
+  lock.unlock();
+  pusher.join();
+}
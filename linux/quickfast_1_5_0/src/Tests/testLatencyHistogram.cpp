@@ -0,0 +1,130 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Common/LatencyHistogram.h>
+#include <Common/LatencyTracker.h>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/DataDestination.h>
+#include <Codecs/DataSourceString.h>
+#include <Codecs/SingleMessageConsumer.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Messages/Message.h>
+#include <Messages/FieldIdentity.h>
+#include <Messages/FieldUInt32.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const char template_xml[] =
+    "<templates xmlns=\"http://www.fixprotocol.org/ns/fast/td/1.1\">"
+    "  <template name=\"heartbeat\" id=\"3\">"
+    "    <uInt32 name=\"SeqNum\"><increment/></uInt32>"
+    "  </template>"
+    "</templates>"
+    ;
+
+  const Messages::FieldIdentity identity_SeqNum("SeqNum");
+}
+
+BOOST_AUTO_TEST_CASE(TestLatencyHistogramBuckets)
+{
+  // small values are exact.
+  for(uint64 value = 0; value < 2 * LatencyHistogram::subBucketCount; ++value)
+  {
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(value), size_t(value));
+  }
+  // every bucket's range starts just past the previous one's, and is within the precision.
+  for(size_t index = 1; index < LatencyHistogram::bucketCount; ++index)
+  {
+    uint64 lowest = LatencyHistogram::bucketHighest(index - 1) + 1;
+    uint64 highest = LatencyHistogram::bucketHighest(index);
+    BOOST_REQUIRE_EQUAL(LatencyHistogram::bucketIndex(lowest), index);
+    BOOST_REQUIRE_EQUAL(LatencyHistogram::bucketIndex(highest), index);
+    BOOST_REQUIRE((highest - lowest) * LatencyHistogram::subBucketCount <= lowest);
+  }
+  BOOST_CHECK_EQUAL(LatencyHistogram::bucketHighest(LatencyHistogram::bucketCount - 1),
+    LatencyHistogram::highestValue);
+}
+
+BOOST_AUTO_TEST_CASE(TestLatencyHistogramPercentiles)
+{
+  LatencyHistogram histogram;
+  BOOST_CHECK_EQUAL(histogram.valueAtPercentile(99.0), 0u);
+  for(uint64 value = 1; value <= 10000; ++value)
+  {
+    histogram.record(value * 100);
+  }
+  BOOST_CHECK_EQUAL(histogram.count(), 10000u);
+  BOOST_CHECK_EQUAL(histogram.min(), 100u);
+  BOOST_CHECK_EQUAL(histogram.max(), 1000000u);
+  BOOST_CHECK_CLOSE(histogram.mean(), 500050.0, 0.001);
+  BOOST_CHECK_CLOSE(double(histogram.valueAtPercentile(50.0)), 500000.0, 100.0 / LatencyHistogram::subBucketCount);
+  BOOST_CHECK_CLOSE(double(histogram.valueAtPercentile(99.0)), 990000.0, 100.0 / LatencyHistogram::subBucketCount);
+  BOOST_CHECK_EQUAL(histogram.valueAtPercentile(100.0), 1000000u);
+
+  // too large to count exactly
+  histogram.record(~uint64(0));
+  BOOST_CHECK_EQUAL(histogram.max(), LatencyHistogram::highestValue);
+}
+
+BOOST_AUTO_TEST_CASE(TestLatencyTracker)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templates = parser.parse(templateStream);
+
+  const size_t messageCount = 20;
+  Codecs::Encoder encoder(templates);
+  Codecs::DataDestination destination;
+  for(size_t nMessage = 0; nMessage < messageCount; ++nMessage)
+  {
+    Messages::Message message(1);
+    message.addField(identity_SeqNum, Messages::FieldUInt32::create(uint32(nMessage)));
+    encoder.encodeMessage(destination, 3, message);
+  }
+  std::string fastString;
+  destination.toString(fastString);
+
+  LatencyTracker latency;
+  // as if the packet arrived a millisecond ago.
+  latency.packetDequeued(LatencyTracker::now() - 1000000);
+
+  Codecs::Decoder decoder(templates);
+  decoder.setLatencyTracker(&latency);
+  Codecs::DataSourceString source(fastString);
+  for(size_t nMessage = 0; nMessage < messageCount; ++nMessage)
+  {
+    Codecs::SingleMessageConsumer consumer;
+    Codecs::GenericMessageBuilder builder(consumer);
+    BOOST_REQUIRE(decoder.decodeMessage(source, builder));
+  }
+
+  BOOST_CHECK_EQUAL(latency.queueWait().count(), 1u);
+  BOOST_CHECK(latency.queueWait().min() >= 1000000u);
+  BOOST_CHECK_EQUAL(latency.endToEnd().count(), messageCount);
+  BOOST_CHECK(latency.endToEnd().min() >= 1000000u);
+  const LatencyHistogram * decodeTime = latency.decodeTime(3);
+  BOOST_REQUIRE(decodeTime != 0);
+  BOOST_CHECK_EQUAL(decodeTime->count(), messageCount);
+  BOOST_CHECK(latency.decodeTime(4) == 0);
+
+  std::string filename = "/tmp/quickfast_test_latency.txt";
+  latency.startDumping(filename, 0);
+  latency.stopDumping();
+  std::ifstream file(filename.c_str());
+  std::stringstream text;
+  text << file.rdbuf();
+  BOOST_CHECK(text.str().find("queue_wait_ns count=1 ") != std::string::npos);
+  BOOST_CHECK(text.str().find("end_to_end_ns count=20 ") != std::string::npos);
+  BOOST_CHECK(text.str().find("decode_ns template=3 count=20 ") != std::string::npos);
+  std::remove(filename.c_str());
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/NoHeaderAnalyzer.h>
+#include <Codecs/StreamingAssembler.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/MessageConsumer.h>
+#include <Messages/Message.h>
+#include <Communication/MagicRing.h>
+#include <Communication/RawFileReceiver.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const char template_xml[] =
+    "<templates>"
+    "  <template name=\"ring\" id=\"2\">"
+    "     <uInt32 name=\"seq\" id=\"1\"><increment/></uInt32>"
+    "     <uInt32 name=\"data\" id=\"2\"/>"
+    "  </template>"
+    "</templates>"
+    ;
+
+  class RingConsumer : public Codecs::MessageConsumer
+  {
+  public:
+    RingConsumer()
+      : messageCount_(0)
+      , errorCount_(0)
+      , seq_(0)
+      , data_(0)
+    {
+    }
+
+    virtual bool consumeMessage(Messages::Message & message)
+    {
+      ++messageCount_;
+      Messages::FieldCPtr value;
+      if(message.getField("seq", value))
+      {
+        seq_ = value->toUInt32();
+      }
+      if(message.getField("data", value))
+      {
+        data_ = value->toUInt32();
+      }
+      return true;
+    }
+    virtual bool wantLog(unsigned short /*level*/)
+    {
+      return false;
+    }
+    virtual bool logMessage(unsigned short /*level*/, const std::string & /*logMessage*/)
+    {
+      return true;
+    }
+    virtual bool reportDecodingError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual bool reportCommunicationError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual void decodingStarted()
+    {
+    }
+    virtual void decodingStopped()
+    {
+    }
+
+  public: // because this is a test class
+    size_t messageCount_;
+    size_t errorCount_;
+    uint32 seq_;
+    uint32 data_;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(TestMagicRingMirror)
+{
+  Communication::MagicRing ring;
+  BOOST_REQUIRE(ring.allocate(100));
+  size_t size = ring.size();
+  BOOST_CHECK(size >= 100);
+  BOOST_CHECK_EQUAL(size % Communication::MagicRing::granularity(), 0u);
+
+  // write across the end of the ring; read it back from the start.
+  unsigned char * base = ring.get();
+  const char text[] = "wraparound";
+  memcpy(base + size - 4, text, sizeof(text));
+  BOOST_CHECK_EQUAL(std::string(reinterpret_cast<char *>(base), sizeof(text) - 5), std::string(text + 4));
+  BOOST_CHECK(ring.at(size + 3) == base + 3);
+  BOOST_CHECK(ring.follows(base + size, base));
+  BOOST_CHECK(ring.follows(base + 10, base + 10));
+  BOOST_CHECK(!ring.follows(base + 10, base + 11));
+}
+
+BOOST_AUTO_TEST_CASE(TestRingBufferStreaming)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  // enough messages to wrap around the ring at least once.
+  // The first sets seq = 1; the rest increment it.
+  const size_t messageCount = 5000;
+  std::string fast("\xE0\x82\x81\x80", 4);
+  for(size_t nMessage = 1; nMessage < messageCount; ++nMessage)
+  {
+    fast += char(0x80);
+    fast += char(0x80 | (nMessage & 0x7F));
+  }
+  std::istringstream input(fast);
+
+  Codecs::NoHeaderAnalyzer headerAnalyzer;
+  RingConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+  Codecs::StreamingAssembler assembler(
+      templateRegistry,
+      headerAnalyzer,
+      builder);
+  Communication::RawFileReceiver receiver(input);
+  receiver.setRingBuffer();
+
+  // an odd buffer size means messages straddle the reads.
+  BOOST_REQUIRE(receiver.start(assembler, 7, 4));
+  BOOST_CHECK(receiver.ringBuffer());
+  receiver.run();
+
+  BOOST_CHECK_EQUAL(consumer.errorCount_, 0u);
+  BOOST_CHECK_EQUAL(consumer.messageCount_, messageCount);
+  BOOST_CHECK_EQUAL(consumer.seq_, messageCount);
+  BOOST_CHECK_EQUAL(consumer.data_, (messageCount - 1) & 0x7F);
+}
@@ -0,0 +1,225 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Common/Metrics.h>
+#include <Common/MetricsExporter.h>
+#include <Common/Exceptions.h>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/DataDestination.h>
+#include <Codecs/DataSourceString.h>
+#include <Codecs/SingleMessageConsumer.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Messages/Message.h>
+#include <Messages/FieldIdentity.h>
+#include <Messages/FieldUInt32.h>
+#include <Messages/FieldInt64.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const size_t incrementsPerThread = 100000;
+
+  void countMany(MetricCounter * counter)
+  {
+    for(size_t n = 0; n < incrementsPerThread; ++n)
+    {
+      counter->increment();
+    }
+  }
+
+  double fortyTwo()
+  {
+    return 42.0;
+  }
+
+  double findSample(const MetricsRegistry & registry, const std::string & name, const std::string & labels)
+  {
+    std::vector<MetricsRegistry::Sample> samples;
+    registry.snapshot(samples);
+    for(size_t nSample = 0; nSample < samples.size(); ++nSample)
+    {
+      if(samples[nSample].name_ == name && samples[nSample].labels_ == labels)
+      {
+        return samples[nSample].value_;
+      }
+    }
+    return -1.0;
+  }
+
+  const char template_xml[] =
+    "<templates xmlns=\"http://www.fixprotocol.org/ns/fast/td/1.1\">"
+    "  <template name=\"trade\" id=\"7\">"
+    "    <uInt32 name=\"SeqNum\"><increment/></uInt32>"
+    "    <int64 name=\"Price\"/>"
+    "  </template>"
+    "</templates>"
+    ;
+
+  const Messages::FieldIdentity identity_SeqNum("SeqNum");
+  const Messages::FieldIdentity identity_Price("Price");
+}
+
+BOOST_AUTO_TEST_CASE(TestMetricCounterThreads)
+{
+  MetricsRegistry registry;
+  MetricCounter & counter = registry.counter("test_total", "A test.", "", 0);
+  boost::thread first(boost::bind(countMany, &counter));
+  boost::thread second(boost::bind(countMany, &counter));
+  countMany(&counter);
+  first.join();
+  second.join();
+  BOOST_CHECK_EQUAL(counter.value(), 3 * incrementsPerThread);
+  // the same name and labels find the same counter.
+  BOOST_CHECK_EQUAL(&registry.counter("test_total", "A test.", "", 0), &counter);
+}
+
+BOOST_AUTO_TEST_CASE(TestMetricCounterManyThreads)
+{
+  MetricsRegistry registry;
+  MetricCounter & counter = registry.counter("test_total", "A test.", "", 0);
+  // More threads than private slots: some share slots.
+  const size_t threadCount = MetricCounter::slotCount + 2 * MetricCounter::sharedSlotCount;
+  boost::thread_group threads;
+  for(size_t nThread = 0; nThread < threadCount; ++nThread)
+  {
+    threads.create_thread(boost::bind(countMany, &counter));
+  }
+  threads.join_all();
+  BOOST_CHECK_EQUAL(counter.value(), threadCount * incrementsPerThread);
+
+  // The slots of threads that have exited are given to new threads.
+  boost::thread later(boost::bind(countMany, &counter));
+  later.join();
+  BOOST_CHECK_EQUAL(counter.value(), (threadCount + 1) * incrementsPerThread);
+}
+
+BOOST_AUTO_TEST_CASE(TestMetricsRegistry)
+{
+  MetricsRegistry registry;
+  int owner = 0;
+  int otherOwner = 0;
+  registry.counter("test_messages_total", "Messages.", "feed=\"a\"", &owner).increment(3);
+  registry.counter("test_messages_total", "Messages.", "feed=\"b\"", &otherOwner).increment(5);
+  registry.gauge("test_depth", "Depth.", "", &owner).set(-2);
+  registry.addSampler("test_answer", "The answer.", "", MetricsRegistry::GAUGE, fortyTwo, &owner);
+
+  std::ostringstream out;
+  registry.writePrometheus(out);
+  BOOST_CHECK_EQUAL(out.str(),
+    "# HELP test_answer The answer.\n"
+    "# TYPE test_answer gauge\n"
+    "test_answer 42\n"
+    "# HELP test_depth Depth.\n"
+    "# TYPE test_depth gauge\n"
+    "test_depth -2\n"
+    "# HELP test_messages_total Messages.\n"
+    "# TYPE test_messages_total counter\n"
+    "test_messages_total{feed=\"a\"} 3\n"
+    "test_messages_total{feed=\"b\"} 5\n");
+
+  // another owner may not take over a registered metric.
+  BOOST_CHECK_THROW(
+    registry.counter("test_messages_total", "Messages.", "feed=\"a\"", &otherOwner),
+    UsageError);
+  BOOST_CHECK_THROW(
+    registry.addSampler("test_answer", "The answer.", "", MetricsRegistry::GAUGE, fortyTwo, &otherOwner),
+    UsageError);
+
+  registry.remove(&owner);
+  std::vector<MetricsRegistry::Sample> samples;
+  registry.snapshot(samples);
+  BOOST_REQUIRE_EQUAL(samples.size(), 1u);
+  BOOST_CHECK_EQUAL(samples[0].labels_, "feed=\"b\"");
+  BOOST_CHECK_EQUAL(samples[0].value_, 5.0);
+}
+
+BOOST_AUTO_TEST_CASE(TestMetricsExporter)
+{
+  MetricsRegistry registry;
+  registry.counter("test_exported_total", "Exported.", "", 0).increment(7);
+  std::string expected = "test_exported_total 7\n";
+
+  std::string filename = "/tmp/quickfast_test_metrics.prom";
+  std::string sharedName = "/tmp/quickfast_test_metrics.shm";
+  MetricsExporter exporter(registry);
+  exporter.setPrometheusFile(filename);
+  BOOST_REQUIRE(exporter.setSharedMemory(sharedName, 4096));
+  exporter.exportNow();
+
+  std::ifstream file(filename.c_str());
+  std::stringstream text;
+  text << file.rdbuf();
+  BOOST_CHECK(text.str().find(expected) != std::string::npos);
+
+  // read the page as another process would.
+  std::ifstream page(sharedName.c_str(), std::ios::in | std::ios::binary);
+  std::vector<char> contents(4096);
+  page.read(&contents[0], contents.size());
+  BOOST_REQUIRE_EQUAL(page.gcount(), 4096);
+  MetricsExporter::SharedHeader header;
+  memcpy(&header, &contents[0], sizeof(header));
+  BOOST_CHECK_EQUAL(header.magic_, MetricsExporter::sharedMagic);
+  BOOST_CHECK_EQUAL(header.generation_, 2u);
+  std::string shared(&contents[sizeof(header)], size_t(header.length_));
+  BOOST_CHECK_EQUAL(shared, text.str());
+
+  std::remove(filename.c_str());
+  std::remove(sharedName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestDecoderMetrics)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templates = parser.parse(templateStream);
+
+  const size_t messageCount = 10;
+  Codecs::Encoder encoder(templates);
+  Codecs::DataDestination destination;
+  for(size_t nMessage = 0; nMessage < messageCount; ++nMessage)
+  {
+    Messages::Message message(2);
+    message.addField(identity_SeqNum, Messages::FieldUInt32::create(uint32(nMessage)));
+    message.addField(identity_Price, Messages::FieldInt64::create(int64(100)));
+    encoder.encodeMessage(destination, 7, message);
+  }
+  std::string fastString;
+  destination.toString(fastString);
+
+  MetricsRegistry registry;
+  {
+    Codecs::Decoder decoder(templates);
+    decoder.setMetrics(&registry, "connection=\"1\"");
+    Codecs::DataSourceString source(fastString);
+    for(size_t nMessage = 0; nMessage < messageCount; ++nMessage)
+    {
+      Codecs::SingleMessageConsumer consumer;
+      Codecs::GenericMessageBuilder builder(consumer);
+      BOOST_REQUIRE(decoder.decodeMessage(source, builder));
+    }
+    // the last message, cut short.
+    Codecs::DataSourceString truncated(fastString.substr(0, 2));
+    Codecs::SingleMessageConsumer consumer;
+    Codecs::GenericMessageBuilder builder(consumer);
+    BOOST_CHECK_THROW(decoder.decodeMessage(truncated, builder), EncodingError);
+
+    std::string labels = "connection=\"1\",template=\"7\"";
+    BOOST_CHECK_EQUAL(findSample(registry, "quickfast_decoder_messages_total", labels), double(messageCount));
+    BOOST_CHECK_EQUAL(findSample(registry, "quickfast_decoder_fields_total", labels), double(2 * messageCount));
+    BOOST_CHECK_EQUAL(findSample(registry, "quickfast_decoder_errors_total", "connection=\"1\""), 1.0);
+    BOOST_CHECK_EQUAL(findSample(registry, "quickfast_builder_messages_total", "connection=\"1\""), double(messageCount));
+  }
+  // the decoder's metrics go with it.
+  std::vector<MetricsRegistry::Sample> samples;
+  registry.snapshot(samples);
+  BOOST_CHECK(samples.empty());
+}
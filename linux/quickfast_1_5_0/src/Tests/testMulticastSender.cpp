@@ -0,0 +1,278 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/FixedSizeHeaderAnalyzer.h>
+#include <Codecs/MessagePerPacketAssembler.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/MessageConsumer.h>
+#include <Communication/MulticastSender.h>
+#include <Communication/BufferRecycler.h>
+#include <Messages/Message.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const char template_xml[] =
+    "<templates>"
+    "  <template name=\"packed\" id=\"2\">"
+    "     <uInt32 name=\"seq\" id=\"1\"><increment/></uInt32>"
+    "     <uInt32 name=\"data\" id=\"2\"/>"
+    "  </template>"
+    "</templates>"
+    ;
+
+  class PackedConsumer : public Codecs::MessageConsumer
+  {
+  public:
+    PackedConsumer()
+      : errorCount_(0)
+    {
+    }
+
+    virtual bool consumeMessage(Messages::Message & message)
+    {
+      Messages::FieldCPtr seq;
+      Messages::FieldCPtr data;
+      if(message.getField("seq", seq) && message.getField("data", data))
+      {
+        seqs_.push_back(seq->toUInt32());
+        data_.push_back(data->toUInt32());
+      }
+      return true;
+    }
+    virtual bool wantLog(unsigned short /*level*/)
+    {
+      return false;
+    }
+    virtual bool logMessage(unsigned short /*level*/, const std::string & /*logMessage*/)
+    {
+      return true;
+    }
+    virtual bool reportDecodingError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual bool reportCommunicationError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual void decodingStarted()
+    {
+    }
+    virtual void decodingStopped()
+    {
+    }
+
+  public: // because this is a test class
+    std::vector<uint32> seqs_;
+    std::vector<uint32> data_;
+    size_t errorCount_;
+  };
+
+  class NullRecycler : public Communication::BufferRecycler
+  {
+  public:
+    virtual void recycle(Communication::LinkedBuffer * /*emptyBuffer*/)
+    {
+    }
+  };
+
+  /// Encoded message: the first one sets seq; the rest increment it.
+  std::string encodedMessage(size_t nMessage)
+  {
+    std::string fast;
+    if(nMessage == 0)
+    {
+      fast += std::string("\xE0\x82\x81", 3);
+    }
+    else
+    {
+      fast += char(0x80);
+    }
+    fast += char(0x80 | (nMessage & 0x7F));
+    return fast;
+  }
+
+  size_t receiveAll(boost::asio::ip::udp::socket & socket, std::vector<std::string> & datagrams)
+  {
+    size_t count = 0;
+    unsigned char buffer[2000];
+    boost::system::error_code error;
+    while(socket.available(error) > 0)
+    {
+      size_t bytes = socket.receive(boost::asio::buffer(buffer, sizeof(buffer)));
+      datagrams.push_back(std::string(reinterpret_cast<char *>(buffer), bytes));
+      ++count;
+    }
+    return count;
+  }
+
+  void waitForData(boost::asio::ip::udp::socket & socket)
+  {
+    boost::system::error_code error;
+    for(size_t nWait = 0; nWait < 100 && socket.available(error) == 0; ++nWait)
+    {
+      boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestMulticastSenderPacking)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  // Loopback unicast is enough to see the datagrams.
+  boost::asio::io_service ioService;
+  boost::asio::ip::udp::socket receiver(ioService,
+    boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), 0));
+  unsigned short port = receiver.local_endpoint().port();
+
+  NullRecycler recycler;
+  std::string address("127.0.0.1");
+  // a private io_service so run_one() below sees only this sender's timer.
+  boost::asio::io_service senderService;
+  Communication::MulticastSender sender(senderService, recycler, address, port);
+  sender.initializeSender();
+
+  // 4 byte big endian sequence number, then a 2 byte size; 2 byte size in front of each message.
+  const size_t datagramSize = 6 + 10 * 4;
+  sender.setPacking(datagramSize, 0, 0, 4);
+  sender.setPacketHeader(2, true, 4, 0, 0, 4);
+  sender.setMessageHeader(2, true);
+  sender.setSequenceNumber(100);
+
+  const size_t messageCount = 95;
+  for(size_t nMessage = 0; nMessage < messageCount; ++nMessage)
+  {
+    std::string message = encodedMessage(nMessage);
+    sender.pack(reinterpret_cast<const unsigned char *>(message.data()), message.size());
+  }
+  // the first message is longer, so the first datagram holds 9 messages.
+  // the others hold 10.  Two batches of 4 have been sent.
+  BOOST_CHECK_EQUAL(sender.datagramCount(), 8u);
+  sender.flush();
+  BOOST_CHECK_EQUAL(sender.datagramCount(), 10u);
+#if defined(__linux__)
+  BOOST_CHECK_EQUAL(sender.sendCallCount(), 3u);
+#endif // __linux__
+
+  std::vector<std::string> datagrams;
+  waitForData(receiver);
+  boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+  receiveAll(receiver, datagrams);
+  BOOST_REQUIRE_EQUAL(datagrams.size(), 10u);
+
+  bool bigEndian = true;
+  Codecs::FixedSizeHeaderAnalyzer packetHeaderAnalyzer(2, bigEndian, 4, 0, 0, 4);
+  Codecs::FixedSizeHeaderAnalyzer messageHeaderAnalyzer(2, bigEndian);
+  PackedConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+  Codecs::MessagePerPacketAssembler assembler(
+    templateRegistry, packetHeaderAnalyzer, messageHeaderAnalyzer, builder);
+  for(size_t nDatagram = 0; nDatagram < datagrams.size(); ++nDatagram)
+  {
+    const unsigned char * data = reinterpret_cast<const unsigned char *>(datagrams[nDatagram].data());
+    BOOST_CHECK(datagrams[nDatagram].size() <= datagramSize);
+    BOOST_CHECK_EQUAL(packetHeaderAnalyzer.getSequenceNumber(data), 100 + nDatagram);
+    assembler.decodeBuffer(data, datagrams[nDatagram].size());
+  }
+  BOOST_CHECK_EQUAL(consumer.errorCount_, 0u);
+  BOOST_REQUIRE_EQUAL(consumer.seqs_.size(), messageCount);
+  for(size_t nMessage = 0; nMessage < messageCount; ++nMessage)
+  {
+    BOOST_CHECK_EQUAL(consumer.seqs_[nMessage], 1 + nMessage);
+    BOOST_CHECK_EQUAL(consumer.data_[nMessage], nMessage & 0x7F);
+  }
+
+  // flush on count, then on the timer.
+  datagrams.clear();
+  sender.setPacking(datagramSize, 3, 1000, 16);
+  for(size_t nMessage = 0; nMessage < 7; ++nMessage)
+  {
+    std::string message = encodedMessage(messageCount + nMessage);
+    sender.pack(reinterpret_cast<const unsigned char *>(message.data()), message.size());
+  }
+  BOOST_CHECK_EQUAL(sender.datagramCount(), 10u);
+  sender.run_one(); // the flush timer
+  BOOST_CHECK_EQUAL(sender.datagramCount(), 13u);
+  waitForData(receiver);
+  boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+  receiveAll(receiver, datagrams);
+  BOOST_REQUIRE_EQUAL(datagrams.size(), 3u);
+  BOOST_CHECK_EQUAL(datagrams[0].size(), 6u + 3 * 4);
+  BOOST_CHECK_EQUAL(datagrams[2].size(), 6u + 1 * 4);
+
+  BOOST_CHECK_THROW(sender.setPacketHeader(2, true, 0, 0, 0, 4), UsageError);
+}
+
+BOOST_AUTO_TEST_CASE(TestMulticastSenderSendFailure)
+{
+  NullRecycler recycler;
+  std::string address("127.0.0.1");
+  boost::asio::io_service senderService;
+  Communication::MulticastSender sender(senderService, recycler, address, 30001);
+  sender.initializeSender();
+  // one message per datagram, one datagram per batch.
+  sender.setPacking(100, 1, 0, 1);
+  sender.setPacketHeader(2, true, 4, 0, 0, 4);
+  sender.setMessageHeader(2, true);
+
+  std::string message = encodedMessage(0);
+  const unsigned char * data = reinterpret_cast<const unsigned char *>(message.data());
+  sender.pack(data, message.size());
+  BOOST_CHECK_EQUAL(sender.datagramCount(), 0u);
+
+  // sending the first datagram fails, before the second message is packed.
+  sender.socket().close();
+  BOOST_CHECK_THROW(sender.pack(data, message.size()), CommunicationError);
+  BOOST_CHECK_EQUAL(sender.sendErrorCount(), 1u);
+  BOOST_CHECK_EQUAL(sender.datagramCount(), 0u);
+  BOOST_CHECK(sender.datagramEmpty());
+
+  // the failed datagram is not sent again.
+  sender.flush();
+  BOOST_CHECK_EQUAL(sender.sendErrorCount(), 1u);
+}
+
+#if defined(__linux__)
+BOOST_AUTO_TEST_CASE(TestDatagramBatchSendFailure)
+{
+  boost::asio::io_service ioService;
+  boost::asio::ip::udp::socket receiver(ioService,
+    boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), 0));
+  unsigned short port = receiver.local_endpoint().port();
+  boost::asio::ip::udp::socket socket(ioService);
+  socket.open(boost::asio::ip::udp::v4());
+  // non-blocking, as asio leaves a socket that has been used asynchronously.
+  socket.non_blocking(true);
+
+  uint32 loopback = uint32(boost::asio::ip::address_v4::loopback().to_ulong());
+  std::vector<unsigned char> small(10, 'x');
+  // too big for a UDP datagram: the third send fails.
+  std::vector<unsigned char> huge(70000, 'y');
+  Communication::DatagramBatch batch(8);
+  batch.add(&small[0], small.size(), loopback, port);
+  batch.add(&small[0], small.size(), loopback, port);
+  batch.add(&huge[0], huge.size(), loopback, port);
+  batch.add(&small[0], small.size(), loopback, port);
+  BOOST_CHECK_THROW(batch.send(socket), CommunicationError);
+  // only the unsent datagrams remain.
+  BOOST_REQUIRE_EQUAL(batch.size(), 2u);
+  BOOST_CHECK_EQUAL(batch.length(0), huge.size());
+  BOOST_CHECK_EQUAL(batch.data(0)[0], 'y');
+  BOOST_CHECK_EQUAL(batch.length(1), small.size());
+  BOOST_CHECK_EQUAL(batch.data(1)[0], 'x');
+}
+#endif // __linux__
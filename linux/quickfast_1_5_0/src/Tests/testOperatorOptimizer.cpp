@@ -0,0 +1,121 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/OperatorOptimizer.h>
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/DataDestination.h>
+#include <Messages/Message.h>
+#include <Messages/FieldIdentity.h>
+#include <Messages/FieldUInt32.h>
+#include <Messages/FieldInt64.h>
+#include <Messages/FieldAscii.h>
+#include <Messages/FieldSequence.h>
+#include <Messages/Sequence.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  // operators chosen badly on purpose.
+  const char template_xml[] =
+    "<templates xmlns=\"http://www.fixprotocol.org/ns/fast/td/1.1\">"
+    "  <template name=\"trade\" id=\"1\">"
+    "    <uInt32 name=\"SeqNum\"><copy/></uInt32>"
+    "    <string name=\"Venue\"><delta/></string>"
+    "    <int64 name=\"Price\"/>"
+    "    <uInt32 name=\"Size\" presence=\"optional\"><copy/></uInt32>"
+    "    <sequence name=\"Legs\">"
+    "      <length name=\"NoLegs\"/>"
+    "      <string name=\"Leg\"/>"
+    "    </sequence>"
+    "  </template>"
+    "</templates>"
+    ;
+
+  // a message holds a reference to each field's identity, so these must outlive it.
+  const Messages::FieldIdentity identity_SeqNum("SeqNum");
+  const Messages::FieldIdentity identity_Venue("Venue");
+  const Messages::FieldIdentity identity_Price("Price");
+  const Messages::FieldIdentity identity_Size("Size");
+  const Messages::FieldIdentity identity_Legs("Legs");
+  const Messages::FieldIdentity identity_NoLegs("NoLegs");
+  const Messages::FieldIdentity identity_Leg("Leg");
+
+  const size_t messageCount = 200;
+
+  Messages::MessagePtr makeMessage(size_t nMessage)
+  {
+    Messages::MessagePtr message(new Messages::Message(6));
+    message->addField(identity_SeqNum, Messages::FieldUInt32::create(uint32(1000 + nMessage)));
+    message->addField(identity_Venue, Messages::FieldAscii::create("XNAS"));
+    message->addField(identity_Price, Messages::FieldInt64::create(int64(1000000 + (nMessage % 7) * 3)));
+    if(nMessage % 10 == 0)
+    {
+      message->addField(identity_Size, Messages::FieldUInt32::create(uint32(nMessage)));
+    }
+    Messages::SequencePtr legs(new Messages::Sequence(identity_NoLegs, 1));
+    Messages::FieldSetPtr leg(new Messages::FieldSet(1));
+    leg->addField(identity_Leg, Messages::FieldAscii::create("LEG"));
+    legs->addEntry(leg);
+    message->addField(identity_Legs, Messages::FieldSequence::create(legs));
+    return message;
+  }
+
+  size_t encodedSize(Codecs::TemplateRegistryPtr & registry, const std::vector<Messages::MessagePtr> & messages)
+  {
+    Codecs::Encoder encoder(registry);
+    Codecs::DataDestination destination;
+    for(size_t nMessage = 0; nMessage < messages.size(); ++nMessage)
+    {
+      encoder.encodeMessage(destination, 1, *messages[nMessage]);
+    }
+    std::string encoded;
+    destination.toString(encoded);
+    return encoded.size();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestOperatorOptimizer)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr registry = parser.parse(templateStream);
+
+  std::vector<Messages::MessagePtr> messages;
+  Codecs::OperatorOptimizer optimizer(registry);
+  for(size_t nMessage = 0; nMessage < messageCount; ++nMessage)
+  {
+    messages.push_back(makeMessage(nMessage));
+    optimizer.observe(1, *messages.back());
+  }
+  BOOST_CHECK_EQUAL(optimizer.messageCount(), messageCount);
+  size_t currentBytes = encodedSize(registry, messages);
+  BOOST_CHECK_EQUAL(optimizer.currentBytes(), currentBytes);
+  BOOST_CHECK(optimizer.optimizedBytes() < currentBytes);
+
+  std::stringstream report;
+  optimizer.report(report);
+  BOOST_CHECK(report.str().find("trade/SeqNum: copy -> increment") != std::string::npos);
+  BOOST_CHECK(report.str().find("trade/Legs/Leg: nop -> constant value=\"LEG\"") != std::string::npos);
+
+  std::stringstream original(template_xml);
+  std::stringstream rewritten;
+  optimizer.rewriteTemplates(original, rewritten);
+  BOOST_CHECK(rewritten.str().find("<increment/>") != std::string::npos);
+  BOOST_CHECK(rewritten.str().find("<constant value=\"XNAS\"/>") != std::string::npos);
+
+  // the rewritten templates encode the same messages in about the predicted size.
+  Codecs::XMLTemplateParser rewrittenParser;
+  Codecs::TemplateRegistryPtr rewrittenRegistry = rewrittenParser.parse(rewritten);
+  size_t optimizedBytes = encodedSize(rewrittenRegistry, messages);
+  BOOST_CHECK(optimizedBytes < currentBytes);
+  BOOST_CHECK(optimizedBytes <= optimizer.optimizedBytes() + messageCount);
+  BOOST_CHECK(optimizedBytes + messageCount >= optimizer.optimizedBytes());
+}
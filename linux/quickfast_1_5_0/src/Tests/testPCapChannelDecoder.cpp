@@ -0,0 +1,395 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/PCapChannelDecoder.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/MessageConsumer.h>
+#include <Communication/PCapReader.h>
+#include <Messages/Message.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const char template_xml[] =
+    "<templates>"
+    "  <template name=\"channel\" id=\"2\">"
+    "     <uInt32 name=\"seq\" id=\"1\"><increment/></uInt32>"
+    "     <uInt32 name=\"data\" id=\"2\"/>"
+    "  </template>"
+    "</templates>"
+    ;
+
+  class ChannelConsumer : public Codecs::MessageConsumer
+  {
+  public:
+    ChannelConsumer()
+      : errorCount_(0)
+    {
+    }
+
+    virtual bool consumeMessage(Messages::Message & message)
+    {
+      Messages::FieldCPtr seq;
+      Messages::FieldCPtr data;
+      if(message.getField("seq", seq) && message.getField("data", data))
+      {
+        seqs_.push_back(seq->toUInt32());
+        data_.push_back(data->toUInt32());
+      }
+      return true;
+    }
+    virtual bool wantLog(unsigned short /*level*/)
+    {
+      return false;
+    }
+    virtual bool logMessage(unsigned short /*level*/, const std::string & /*logMessage*/)
+    {
+      return true;
+    }
+    virtual bool reportDecodingError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual bool reportCommunicationError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual void decodingStarted()
+    {
+    }
+    virtual void decodingStopped()
+    {
+    }
+
+  public: // because this is a test class
+    std::vector<uint32> seqs_;
+    std::vector<uint32> data_;
+    size_t errorCount_;
+  };
+
+  void put16(std::string & out, uint16 value)
+  {
+    out += char(value >> 8);
+    out += char(value & 0xFF);
+  }
+
+  void putLittle32(std::string & out, uint32 value)
+  {
+    out += char(value & 0xFF);
+    out += char((value >> 8) & 0xFF);
+    out += char((value >> 16) & 0xFF);
+    out += char(value >> 24);
+  }
+
+  /// Build an IPv4/UDP datagram.
+  std::string ipPacket(uint32 group, uint16 port, const std::string & payload, uchar protocol = 17)
+  {
+    std::string packet;
+    packet += char(0x45);
+    packet += char(0);
+    put16(packet, uint16(20 + 8 + payload.size()));
+    put16(packet, 0);
+    put16(packet, 0);
+    packet += char(1);
+    packet += char(protocol);
+    put16(packet, 0);
+    packet += std::string("\x0A\x00\x00\x01", 4);
+    put16(packet, uint16(group >> 16));
+    put16(packet, uint16(group & 0xFFFF));
+    put16(packet, 12345);
+    put16(packet, port);
+    put16(packet, uint16(8 + payload.size()));
+    put16(packet, 0);
+    packet += payload;
+    return packet;
+  }
+
+  /// Wrap an IPv4 datagram in an Ethernet frame.
+  std::string ethernetFrame(const std::string & ip)
+  {
+    std::string frame(12, '\0'); // MAC addresses
+    put16(frame, 0x0800);
+    frame += ip;
+    return frame;
+  }
+
+  /// Append a 32 bit pcap record.
+  void putRecord(std::string & out, const std::string & frame, uint32 seconds = 0, uint32 fraction = 0)
+  {
+    putLittle32(out, seconds);
+    putLittle32(out, fraction);
+    putLittle32(out, uint32(frame.size()));
+    putLittle32(out, uint32(frame.size()));
+    out += frame;
+  }
+
+  /// Append an Ethernet/IPv4/UDP packet as a 32 bit pcap record.
+  void putPacket(std::string & out, uint32 group, uint16 port, const std::string & payload, uchar protocol = 17)
+  {
+    putRecord(out, ethernetFrame(ipPacket(group, port, payload, protocol)));
+  }
+
+  /// Append a pcapng block; the body is padded to 32 bits.
+  void putBlock(std::string & out, uint32 type, std::string body)
+  {
+    body.append((4 - body.size() % 4) % 4, '\0');
+    putLittle32(out, type);
+    putLittle32(out, uint32(body.size() + 12));
+    out += body;
+    putLittle32(out, uint32(body.size() + 12));
+  }
+
+  void writeFile(const boost::filesystem::path & path, const std::string & contents)
+  {
+    std::ofstream out(path.string().c_str(), std::ios::out | std::ios::binary);
+    out.write(contents.data(), contents.size());
+  }
+
+  /// A packet holding two messages; the first one in a channel sets seq.
+  std::string channelPayload(size_t nPacket, uint32 data)
+  {
+    std::string payload;
+    if(nPacket == 0)
+    {
+      payload += std::string("\xE0\x82\x81", 3);
+    }
+    else
+    {
+      payload += char(0x80);
+    }
+    payload += char(0x80 | data);
+    payload += char(0x80);
+    payload += char(0x80 | data);
+    return payload;
+  }
+
+  class DiscoveringDecoder : public Codecs::PCapChannelDecoder
+  {
+  public:
+    DiscoveringDecoder(Codecs::TemplateRegistryPtr registry)
+      : registry_(registry)
+      , builder_(consumer_)
+    {
+    }
+
+    virtual void unknownChannel(const std::string & group, unsigned short port)
+    {
+      discovered_.push_back(group + ":" + boost::lexical_cast<std::string>(port));
+      if(port == 30003)
+      {
+        addChannel(group, port, registry_, builder_);
+      }
+    }
+
+    Codecs::TemplateRegistryPtr registry_;
+    ChannelConsumer consumer_;
+    Codecs::GenericMessageBuilder builder_;
+    std::vector<std::string> discovered_;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(TestPCapChannelDecoder)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  const uint32 groupA = 0xE0010101; // 224.1.1.1
+  const uint32 groupB = 0xE0010102; // 224.1.1.2
+  const size_t packetCount = 500;
+  std::string pcap;
+  putLittle32(pcap, 0xa1b2c3d4);
+  pcap += std::string("\x02\x00\x04\x00", 4);
+  putLittle32(pcap, 0);
+  putLittle32(pcap, 0);
+  putLittle32(pcap, 65535);
+  putLittle32(pcap, 1); // Ethernet
+  for(size_t nPacket = 0; nPacket < packetCount; ++nPacket)
+  {
+    putPacket(pcap, groupA, 30001, channelPayload(nPacket, 1));
+    putPacket(pcap, groupB, 30002, channelPayload(nPacket, 2));
+    if(nPacket % 10 == 0)
+    {
+      putPacket(pcap, groupB, 30003, channelPayload(nPacket / 10, 3));
+      // not UDP: must be skipped.
+      putPacket(pcap, groupA, 30001, "garbage", 6);
+    }
+  }
+  boost::filesystem::path path =
+    boost::filesystem::temp_directory_path() / "QuickFASTTestChannels.pcap";
+  writeFile(path, pcap);
+
+  DiscoveringDecoder decoder(templateRegistry);
+  decoder.setWordSize(32);
+  decoder.setThreadCount(3);
+  decoder.setBatchSize(256);
+  ChannelConsumer consumerA;
+  Codecs::GenericMessageBuilder builderA(consumerA);
+  decoder.addChannel("224.1.1.1", 30001, templateRegistry, builderA);
+  ChannelConsumer consumerB;
+  Codecs::GenericMessageBuilder builderB(consumerB);
+  decoder.addChannel("224.1.1.2", 30002, templateRegistry, builderB);
+
+  size_t decoded = decoder.decode(path.string());
+  BOOST_CHECK_EQUAL(decoded, 2 * packetCount + packetCount / 10);
+  BOOST_CHECK_EQUAL(decoder.channelCount(), 3u);
+  BOOST_REQUIRE_EQUAL(decoder.discovered_.size(), 1u);
+  BOOST_CHECK_EQUAL(decoder.discovered_[0], "224.1.1.2:30003");
+
+  ChannelConsumer * consumers[3] = {&consumerA, &consumerB, &decoder.consumer_};
+  size_t expected[3] = {2 * packetCount, 2 * packetCount, 2 * packetCount / 10};
+  for(size_t nChannel = 0; nChannel < 3; ++nChannel)
+  {
+    ChannelConsumer & consumer = *consumers[nChannel];
+    BOOST_CHECK_EQUAL(consumer.errorCount_, 0u);
+    BOOST_REQUIRE_EQUAL(consumer.seqs_.size(), expected[nChannel]);
+    bool inOrder = true;
+    bool rightChannel = true;
+    for(size_t nMessage = 0; nMessage < consumer.seqs_.size(); ++nMessage)
+    {
+      inOrder = inOrder && consumer.seqs_[nMessage] == nMessage + 1;
+      rightChannel = rightChannel && consumer.data_[nMessage] == nChannel + 1;
+    }
+    BOOST_CHECK(inOrder);
+    BOOST_CHECK(rightChannel);
+  }
+
+  // The reader can select one channel by itself.
+  {
+    Communication::PCapReader reader;
+    reader.set32bit(true);
+    BOOST_REQUIRE(reader.open(path.string().c_str()));
+    reader.setFilter(Communication::PCapReader::parseAddress("224.1.1.2"), 30003);
+    const unsigned char * buffer = 0;
+    size_t size = 0;
+    size_t filtered = 0;
+    while(reader.read(buffer, size))
+    {
+      ++filtered;
+      BOOST_CHECK_EQUAL(reader.destinationAddress(), groupB);
+      BOOST_CHECK_EQUAL(reader.destinationPort(), 30003);
+      BOOST_CHECK_EQUAL(reader.sourceAddress(), 0x0A000001u);
+    }
+    BOOST_CHECK_EQUAL(filtered, packetCount / 10);
+  }
+  boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(TestPCapTimestamps)
+{
+  const uint32 group = 0xE0010101; // 224.1.1.1
+  boost::filesystem::path path =
+    boost::filesystem::temp_directory_path() / "QuickFASTTestTimestamps.pcap";
+
+  // nanosecond pcap
+  std::string pcap;
+  putLittle32(pcap, 0xa1b23c4d);
+  pcap += std::string("\x02\x00\x04\x00", 4);
+  putLittle32(pcap, 0);
+  putLittle32(pcap, 0);
+  putLittle32(pcap, 65535);
+  putLittle32(pcap, 1); // Ethernet
+  putRecord(pcap, ethernetFrame(ipPacket(group, 30001, "first")), 1000, 123456789);
+  putRecord(pcap, ethernetFrame(ipPacket(group, 30001, "second")), 1001, 5);
+  writeFile(path, pcap);
+  {
+    Communication::PCapReader reader;
+    BOOST_REQUIRE(reader.open(path.string().c_str()));
+    BOOST_CHECK(!reader.isPcapng());
+    const unsigned char * buffer = 0;
+    size_t size = 0;
+    BOOST_REQUIRE(reader.read(buffer, size));
+    BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char *>(buffer), size), "first");
+    BOOST_CHECK_EQUAL(reader.timestamp(), uint64(1000123456789ULL));
+    BOOST_REQUIRE(reader.read(buffer, size));
+    BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char *>(buffer), size), "second");
+    BOOST_CHECK_EQUAL(reader.timestamp(), uint64(1001000000005ULL));
+    BOOST_CHECK(!reader.read(buffer, size));
+  }
+
+  // pcapng with two interfaces at different resolutions
+  std::string ng;
+  std::string section;
+  putLittle32(section, 0x1A2B3C4D);
+  section += std::string("\x01\x00\x00\x00", 4); // version 1.0
+  section += std::string(8, '\xFF'); // section length unknown
+  putBlock(ng, 0x0A0D0D0A, section);
+
+  std::string ethernetInterface;
+  ethernetInterface += std::string("\x01\x00\x00\x00", 4); // Ethernet
+  putLittle32(ethernetInterface, 65535);
+  // if_tsresol = 9 (nanoseconds)
+  ethernetInterface += std::string("\x09\x00\x01\x00\x09\x00\x00\x00", 8);
+  ethernetInterface += std::string(4, '\0'); // opt_endofopt
+  putBlock(ng, 1, ethernetInterface);
+
+  std::string rawInterface;
+  rawInterface += std::string("\x65\x00\x00\x00", 4); // LINKTYPE_RAW, default microseconds
+  putLittle32(rawInterface, 65535);
+  putBlock(ng, 1, rawInterface);
+
+  std::string frame = ethernetFrame(ipPacket(group, 30001, "ethernet"));
+  std::string enhanced;
+  putLittle32(enhanced, 0); // interface
+  uint64 units = 1500000000123456789ULL;
+  putLittle32(enhanced, uint32(units >> 32));
+  putLittle32(enhanced, uint32(units));
+  putLittle32(enhanced, uint32(frame.size()));
+  putLittle32(enhanced, uint32(frame.size()));
+  enhanced += frame;
+  putBlock(ng, 6, enhanced);
+
+  // an interface statistics block is skipped
+  putBlock(ng, 5, std::string(12, '\0'));
+
+  std::string raw = ipPacket(group, 30002, "raw ip");
+  enhanced.clear();
+  putLittle32(enhanced, 1); // interface
+  units = 1500000001000002ULL; // microseconds
+  putLittle32(enhanced, uint32(units >> 32));
+  putLittle32(enhanced, uint32(units));
+  putLittle32(enhanced, uint32(raw.size()));
+  putLittle32(enhanced, uint32(raw.size()));
+  enhanced += raw;
+  putBlock(ng, 6, enhanced);
+
+  frame = ethernetFrame(ipPacket(group, 30003, "simple"));
+  std::string simple;
+  putLittle32(simple, uint32(frame.size()));
+  simple += frame;
+  putBlock(ng, 3, simple);
+  writeFile(path, ng);
+
+  {
+    Communication::PCapReader reader;
+    BOOST_REQUIRE(reader.open(path.string().c_str()));
+    BOOST_CHECK(reader.isPcapng());
+    const unsigned char * buffer = 0;
+    size_t size = 0;
+    BOOST_REQUIRE(reader.read(buffer, size));
+    BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char *>(buffer), size), "ethernet");
+    BOOST_CHECK_EQUAL(reader.interfaceId(), 0u);
+    BOOST_CHECK_EQUAL(reader.timestamp(), uint64(1500000000123456789ULL));
+    BOOST_REQUIRE(reader.read(buffer, size));
+    BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char *>(buffer), size), "raw ip");
+    BOOST_CHECK_EQUAL(reader.interfaceId(), 1u);
+    BOOST_CHECK_EQUAL(reader.destinationPort(), 30002);
+    BOOST_CHECK_EQUAL(reader.timestamp(), uint64(1500000001000002000ULL));
+    BOOST_REQUIRE(reader.read(buffer, size));
+    BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char *>(buffer), size), "simple");
+    BOOST_CHECK_EQUAL(reader.timestamp(), uint64(0));
+    BOOST_CHECK(!reader.read(buffer, size));
+  }
+  boost::filesystem::remove(path);
+}
@@ -0,0 +1,193 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <Communication/PCapReplayer.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  void put16(std::string & out, uint16 value)
+  {
+    out += char(value >> 8);
+    out += char(value & 0xFF);
+  }
+
+  void putLittle32(std::string & out, uint32 value)
+  {
+    out += char(value & 0xFF);
+    out += char((value >> 8) & 0xFF);
+    out += char((value >> 16) & 0xFF);
+    out += char(value >> 24);
+  }
+
+  /// Start a nanosecond pcap file holding raw IPv4 packets.
+  std::string pcapHeader()
+  {
+    std::string pcap;
+    putLittle32(pcap, 0xa1b23c4d);
+    pcap += std::string("\x02\x00\x04\x00", 4);
+    putLittle32(pcap, 0);
+    putLittle32(pcap, 0);
+    putLittle32(pcap, 65535);
+    putLittle32(pcap, 101); // raw IP
+    return pcap;
+  }
+
+  /// Append an IPv4/UDP packet with a one byte payload captured at a given time.
+  void putPacket(std::string & out, uint32 group, uint16 port, char payload, uint32 seconds, uint32 nanoseconds)
+  {
+    std::string packet;
+    packet += char(0x45);
+    packet += char(0);
+    put16(packet, uint16(20 + 8 + 1));
+    put16(packet, 0);
+    put16(packet, 0);
+    packet += char(1);
+    packet += char(17);
+    put16(packet, 0);
+    packet += std::string("\x0A\x00\x00\x01", 4);
+    put16(packet, uint16(group >> 16));
+    put16(packet, uint16(group & 0xFFFF));
+    put16(packet, 12345);
+    put16(packet, port);
+    put16(packet, uint16(8 + 1));
+    put16(packet, 0);
+    packet += payload;
+
+    putLittle32(out, seconds);
+    putLittle32(out, nanoseconds);
+    putLittle32(out, uint32(packet.size()));
+    putLittle32(out, uint32(packet.size()));
+    out += packet;
+  }
+
+  std::string writeFile(const char * name, const std::string & contents)
+  {
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() / name;
+    std::ofstream out(path.string().c_str(), std::ios::out | std::ios::binary);
+    out.write(contents.data(), contents.size());
+    return path.string();
+  }
+
+  /// Capture the datagrams rather than sending them.
+  class RecordingReplayer : public Communication::PCapReplayer
+  {
+  public:
+    virtual void sendBatch(Communication::DatagramBatch & batch)
+    {
+      uint64 now = Communication::ReplayPacer::now();
+      for(size_t nDatagram = 0; nDatagram < batch.size(); ++nDatagram)
+      {
+        payloads_ += char(batch.data(nDatagram)[0]);
+        addresses_.push_back(batch.address(nDatagram));
+        ports_.push_back(batch.port(nDatagram));
+        times_.push_back(now);
+      }
+      batchSizes_.push_back(batch.size());
+    }
+
+    void reset()
+    {
+      payloads_.clear();
+      addresses_.clear();
+      ports_.clear();
+      times_.clear();
+      batchSizes_.clear();
+    }
+
+  public: // because this is a test class
+    std::string payloads_;
+    std::vector<uint32> addresses_;
+    std::vector<uint16> ports_;
+    std::vector<uint64> times_;
+    std::vector<size_t> batchSizes_;
+  };
+
+  const uint32 groupA = 0xE0010101; // 224.1.1.1
+  const uint32 groupB = 0xE0010102; // 224.1.1.2
+  const uint32 million = 1000000;
+}
+
+BOOST_AUTO_TEST_CASE(TestPCapReplayerMerge)
+{
+  // A and B interleave in time; C was captured an hour later.
+  std::string a = pcapHeader();
+  putPacket(a, groupA, 30001, 'a', 100, 0);
+  putPacket(a, groupA, 30001, 'c', 100, 2 * million);
+  putPacket(a, groupA, 30001, 'e', 100, 4 * million);
+  std::string b = pcapHeader();
+  putPacket(b, groupB, 30002, 'b', 100, 1 * million);
+  putPacket(b, groupB, 30002, 'd', 100, 3 * million);
+  std::string c = pcapHeader();
+  putPacket(c, groupA, 30001, 'X', 3700, 1500000);
+  putPacket(c, groupA, 30001, 'Y', 3700, 3500000);
+
+  RecordingReplayer replayer;
+  replayer.setSpeed(0.0);
+  replayer.addCapture(writeFile("QuickFASTTestReplayA.pcap", a));
+  replayer.addCapture(writeFile("QuickFASTTestReplayB.pcap", b), "224.9.9.9", 40000);
+  BOOST_CHECK_EQUAL(replayer.replay(2), 10u);
+  BOOST_CHECK_EQUAL(replayer.payloads_, "abcdeabcde");
+  // when every packet is due they all go in one batch per pass.
+  BOOST_REQUIRE_EQUAL(replayer.batchSizes_.size(), 2u);
+  BOOST_CHECK_EQUAL(replayer.batchSizes_[0], 5u);
+  BOOST_CHECK_EQUAL(replayer.addresses_[0], groupA);
+  BOOST_CHECK_EQUAL(replayer.ports_[0], 30001);
+  BOOST_CHECK_EQUAL(replayer.addresses_[1], 0xE0090909);
+  BOOST_CHECK_EQUAL(replayer.ports_[1], 40000);
+
+  replayer.reset();
+  replayer.setBatchSize(2);
+  replayer.addCapture(writeFile("QuickFASTTestReplayC.pcap", c));
+  BOOST_CHECK_EQUAL(replayer.replay(), 7u);
+  BOOST_CHECK_EQUAL(replayer.payloads_, "abcdeXY");
+  BOOST_CHECK_EQUAL(replayer.batchCount(), 4u);
+
+  replayer.reset();
+  replayer.setAlign(true);
+  replayer.replay();
+  BOOST_CHECK_EQUAL(replayer.payloads_, "abXcdYe");
+}
+
+BOOST_AUTO_TEST_CASE(TestPCapReplayerPacing)
+{
+  // two packets together, then gaps of 20 and 30 msec.
+  std::string pcap = pcapHeader();
+  putPacket(pcap, groupA, 30001, '1', 200, 0);
+  putPacket(pcap, groupA, 30001, '2', 200, 0);
+  putPacket(pcap, groupA, 30001, '3', 200, 20 * million);
+  putPacket(pcap, groupA, 30001, '4', 200, 50 * million);
+  std::string file = writeFile("QuickFASTTestReplayPacing.pcap", pcap);
+
+  RecordingReplayer replayer;
+  replayer.addCapture(file);
+  BOOST_CHECK_EQUAL(replayer.replay(), 4u);
+  BOOST_CHECK_EQUAL(replayer.payloads_, "1234");
+  BOOST_REQUIRE_EQUAL(replayer.batchSizes_.size(), 3u);
+  BOOST_CHECK_EQUAL(replayer.batchSizes_[0], 2u);
+  BOOST_CHECK(replayer.times_[2] - replayer.times_[0] >= 20 * million);
+  BOOST_CHECK(replayer.times_[3] - replayer.times_[0] >= 50 * million);
+
+  // ten times as fast
+  replayer.reset();
+  replayer.setSpeed(10.0);
+  replayer.replay();
+  BOOST_REQUIRE_EQUAL(replayer.times_.size(), 4u);
+  BOOST_CHECK(replayer.times_[2] - replayer.times_[0] >= 2 * million);
+  BOOST_CHECK(replayer.times_[3] - replayer.times_[0] >= 5 * million);
+  BOOST_CHECK(replayer.times_[3] - replayer.times_[0] < 50 * million);
+
+  // half speed
+  replayer.reset();
+  replayer.setSpeed(0.5);
+  replayer.replay();
+  BOOST_REQUIRE_EQUAL(replayer.times_.size(), 4u);
+  BOOST_CHECK(replayer.times_[3] - replayer.times_[0] >= 100 * million);
+}
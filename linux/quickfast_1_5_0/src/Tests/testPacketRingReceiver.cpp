@@ -0,0 +1,136 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/NoHeaderAnalyzer.h>
+#include <Codecs/MessagePerPacketAssembler.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/MessageConsumer.h>
+#include <Messages/Message.h>
+#include <Communication/PacketRingReceiver.h>
+
+#if defined(__linux__)
+using namespace QuickFAST;
+
+namespace
+{
+  const char template_xml[] =
+    "<templates>"
+    "  <template name=\"ring\" id=\"2\">"
+    "     <uInt32 name=\"seq\" id=\"1\"><copy/></uInt32>"
+    "  </template>"
+    "</templates>"
+    ;
+
+  class RingConsumer : public Codecs::MessageConsumer
+  {
+  public:
+    RingConsumer()
+      : errorCount_(0)
+    {
+    }
+
+    virtual bool consumeMessage(Messages::Message & message)
+    {
+      Messages::FieldCPtr value;
+      if(message.getField("seq", value))
+      {
+        seqs_.push_back(value->toUInt32());
+      }
+      return true;
+    }
+    virtual bool wantLog(unsigned short /*level*/)
+    {
+      return false;
+    }
+    virtual bool logMessage(unsigned short /*level*/, const std::string & logMessage)
+    {
+      log_ = logMessage;
+      return true;
+    }
+    virtual bool reportDecodingError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual bool reportCommunicationError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual void decodingStarted()
+    {
+    }
+    virtual void decodingStopped()
+    {
+    }
+
+  public: // because this is a test class
+    std::vector<uint32> seqs_;
+    size_t errorCount_;
+    std::string log_;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(TestPacketRingReceiver)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  Codecs::NoHeaderAnalyzer packetHeaderAnalyzer;
+  Codecs::NoHeaderAnalyzer messageHeaderAnalyzer;
+  RingConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+  Codecs::MessagePerPacketAssembler assembler(
+      templateRegistry,
+      packetHeaderAnalyzer,
+      messageHeaderAnalyzer,
+      builder);
+
+  const unsigned short port = 30871;
+  boost::asio::io_service ioService;
+  Communication::PacketRingReceiver receiver(ioService, "lo");
+  receiver.addFeed("127.0.0.1", port);
+  receiver.setRing(4096 * 4, 8, 1);
+  if(!receiver.start(assembler, 64, 8))
+  {
+    // needs CAP_NET_RAW
+    BOOST_TEST_MESSAGE("Packet ring receiver not tested: " << consumer.log_);
+    return;
+  }
+
+  boost::asio::ip::udp::socket sender(ioService, boost::asio::ip::udp::v4());
+  boost::asio::ip::udp::endpoint channel(boost::asio::ip::address::from_string("127.0.0.1"), port);
+  boost::asio::ip::udp::endpoint otherChannel(boost::asio::ip::address::from_string("127.0.0.1"), port + 1);
+  for(unsigned char seq = 1; seq <= 3; ++seq)
+  {
+    unsigned char message[] = {0xE0, 0x82, static_cast<unsigned char>(0x80 | seq)};
+    sender.send_to(boost::asio::buffer(message, sizeof(message)), channel);
+    // filtered out
+    sender.send_to(boost::asio::buffer(message, sizeof(message)), otherChannel);
+  }
+
+  for(size_t nWait = 0; nWait < 200 && consumer.seqs_.size() < 3; ++nWait)
+  {
+    ioService.poll();
+    boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+  }
+  receiver.stop();
+  ioService.poll();
+
+  BOOST_CHECK_EQUAL(consumer.errorCount_, 0u);
+  BOOST_REQUIRE_EQUAL(consumer.seqs_.size(), 3u);
+  BOOST_CHECK_EQUAL(consumer.seqs_[0], 1u);
+  BOOST_CHECK_EQUAL(consumer.seqs_[1], 2u);
+  BOOST_CHECK_EQUAL(consumer.seqs_[2], 3u);
+  BOOST_CHECK_EQUAL(receiver.packetsQueued(), 3u);
+  BOOST_CHECK(receiver.blocksReceived() > 0);
+}
+#endif // __linux__
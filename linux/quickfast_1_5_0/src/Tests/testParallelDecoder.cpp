@@ -0,0 +1,238 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/ParallelDecoder.h>
+#include <Codecs/Decoder.h>
+#include <Codecs/DataSourceBuffer.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/MessageConsumer.h>
+#include <Messages/Message.h>
+#include <Common/MappedFile.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const char template_xml[] =
+    "<templates>"
+    "  <template name=\"parallel\" id=\"2\">"
+    "     <uInt32 name=\"seq\" id=\"1\"><increment/></uInt32>"
+    "     <uInt32 name=\"data\" id=\"2\"/>"
+    "  </template>"
+    "</templates>"
+    ;
+
+  class RecordingConsumer : public Codecs::MessageConsumer
+  {
+  public:
+    RecordingConsumer()
+      : errorCount_(0)
+    {
+    }
+
+    virtual bool consumeMessage(Messages::Message & message)
+    {
+      Messages::FieldCPtr seq;
+      Messages::FieldCPtr data;
+      if(message.getField("seq", seq) && message.getField("data", data))
+      {
+        records_.push_back(std::make_pair(seq->toUInt32(), data->toUInt32()));
+      }
+      return true;
+    }
+    virtual bool wantLog(unsigned short /*level*/)
+    {
+      return false;
+    }
+    virtual bool logMessage(unsigned short /*level*/, const std::string & /*logMessage*/)
+    {
+      return true;
+    }
+    virtual bool reportDecodingError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual bool reportCommunicationError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual void decodingStarted()
+    {
+    }
+    virtual void decodingStopped()
+    {
+    }
+
+  public: // because this is a test class
+    std::vector<std::pair<uint32, uint32> > records_;
+    size_t errorCount_;
+  };
+
+  /// Build a stream with a dictionary reset every few messages.
+  /// Some messages contain bytes that look like a reset message.
+  std::string buildStream(size_t messageCount)
+  {
+    std::string fast;
+    for(size_t nMessage = 0; nMessage < messageCount; ++nMessage)
+    {
+      if(nMessage % 7 == 0)
+      {
+        if(nMessage != 0)
+        {
+          // SCP reset: pmap, template id 120
+          fast += char(0xC0);
+          fast += char(0xF8);
+        }
+        // template id and seq are explicit after a reset
+        fast += char(0xE0);
+        fast += char(0x82);
+        fast += char(0x80 | (nMessage & 0x3F));
+      }
+      else if(nMessage % 5 == 0)
+      {
+        // explicit seq 0x40 and data 120 look like a reset message
+        fast += char(0xA0);
+        fast += char(0xC0);
+      }
+      else
+      {
+        fast += char(0x80);
+      }
+      uint32 data = (nMessage % 5 == 0 && nMessage % 7 != 0) ? 120 : (nMessage & 0x7F);
+      fast += char(0x80 | data);
+    }
+    return fast;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestParallelDecoder)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  const size_t messageCount = 2000;
+  std::string fast = buildStream(messageCount);
+  const uchar * data = reinterpret_cast<const uchar *>(fast.data());
+
+  RecordingConsumer sequential;
+  {
+    Codecs::Decoder decoder(templateRegistry);
+    Codecs::DataSourceBuffer source(data, fast.size());
+    Codecs::GenericMessageBuilder builder(sequential);
+    while(source.messageAvailable() > 0)
+    {
+      decoder.decodeMessage(source, builder);
+    }
+  }
+  BOOST_REQUIRE_EQUAL(sequential.records_.size(), messageCount);
+
+  Codecs::ParallelDecoder decoder(templateRegistry);
+  // The first candidate is the look-alike in message 5; the first real reset follows message 6.
+  BOOST_CHECK_EQUAL(decoder.findResetPoint(data, fast.size(), 0), 13u);
+  BOOST_CHECK_EQUAL(decoder.findResetPoint(data, fast.size(), 14), 17u);
+
+  // Small chunks so that some start at the look-alike reset messages.
+  decoder.setChunkSize(16);
+  decoder.setThreadCount(4);
+  RecordingConsumer parallel;
+  Codecs::OrderedMessageHandler handler(parallel);
+  size_t decoded = decoder.decode(data, fast.size(), handler);
+  // the count includes the reset messages
+  BOOST_CHECK_EQUAL(decoded, messageCount + (messageCount - 1) / 7);
+  BOOST_CHECK_EQUAL(parallel.errorCount_, 0u);
+  BOOST_REQUIRE_EQUAL(parallel.records_.size(), messageCount);
+  BOOST_CHECK(parallel.records_ == sequential.records_);
+}
+
+BOOST_AUTO_TEST_CASE(TestParallelDecoderError)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  std::string fast = buildStream(100);
+  // an unknown template after the fourth reset
+  size_t reset = 0;
+  for(size_t nReset = 0; nReset < 4; ++nReset)
+  {
+    reset = fast.find("\xC0\xF8\xE0\x82", reset + 1);
+  }
+  BOOST_REQUIRE(reset != std::string::npos);
+  fast[reset + 3] = char(0x83);
+
+  Codecs::ParallelDecoder decoder(templateRegistry);
+  decoder.setChunkSize(16);
+  decoder.setThreadCount(3);
+  RecordingConsumer parallel;
+  Codecs::OrderedMessageHandler handler(parallel);
+  std::string error;
+  try
+  {
+    decoder.decode(reinterpret_cast<const uchar *>(fast.data()), fast.size(), handler);
+  }
+  catch (const EncodingError & ex)
+  {
+    error = ex.what();
+  }
+  BOOST_CHECK_EQUAL(error, "[ERR D9] Unknown template ID.");
+  // everything before the bad message is delivered
+  BOOST_CHECK_EQUAL(parallel.records_.size(), 28u);
+}
+
+BOOST_AUTO_TEST_CASE(TestParallelDecoderMappedFile)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  const size_t messageCount = 10000;
+  std::string fast = buildStream(messageCount);
+  boost::filesystem::path path =
+    boost::filesystem::temp_directory_path() / "QuickFASTTestParallelDecoder.dat";
+  {
+    std::ofstream out(path.string().c_str(), std::ios::out | std::ios::binary);
+    out.write(fast.data(), fast.size());
+  }
+
+  RecordingConsumer sequential;
+  {
+    Codecs::Decoder decoder(templateRegistry);
+    Codecs::DataSourceBuffer source(reinterpret_cast<const uchar *>(fast.data()), fast.size());
+    Codecs::GenericMessageBuilder builder(sequential);
+    while(source.messageAvailable() > 0)
+    {
+      decoder.decodeMessage(source, builder);
+    }
+  }
+
+  {
+    // the file spans several windows
+    MappedFile file;
+    BOOST_REQUIRE(file.open(path.string(), 4096));
+    BOOST_REQUIRE(file.size() > 4 * file.windowSize());
+
+    Codecs::ParallelDecoder decoder(templateRegistry);
+    decoder.setChunkSize(1000);
+    decoder.setThreadCount(4);
+    RecordingConsumer parallel;
+    Codecs::OrderedMessageHandler handler(parallel);
+    decoder.decode(file, handler);
+    BOOST_CHECK_EQUAL(parallel.errorCount_, 0u);
+    BOOST_REQUIRE_EQUAL(parallel.records_.size(), messageCount);
+    BOOST_CHECK(parallel.records_ == sequential.records_);
+  }
+  boost::filesystem::remove(path);
+}
@@ -0,0 +1,258 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Encoder.h>
+#include <Codecs/PositionalEncoder.h>
+#include <Codecs/DataDestination.h>
+#include <Messages/Message.h>
+#include <Messages/FieldIdentity.h>
+#include <Messages/FieldInt32.h>
+#include <Messages/FieldInt64.h>
+#include <Messages/FieldUInt32.h>
+#include <Messages/FieldUInt64.h>
+#include <Messages/FieldAscii.h>
+#include <Messages/FieldByteVector.h>
+#include <Messages/FieldDecimal.h>
+#include <Messages/FieldGroup.h>
+#include <Messages/FieldSequence.h>
+#include <Messages/Sequence.h>
+#include <Common/Exceptions.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const char template_xml[] =
+    "<templates xmlns=\"http://www.fixprotocol.org/ns/fast/td/1.1\">"
+    "  <template name=\"header\" id=\"10\">"
+    "    <uInt32 name=\"MsgSeqNum\" id=\"34\"><increment/></uInt32>"
+    "  </template>"
+    "  <template name=\"quote\" id=\"11\">"
+    "    <templateRef name=\"header\"/>"
+    "    <string name=\"Symbol\" id=\"55\"><copy/></string>"
+    "    <decimal name=\"Price\" id=\"44\"><delta/></decimal>"
+    "    <int32 name=\"Qty\" id=\"38\" presence=\"optional\"><copy/></int32>"
+    "    <uInt64 name=\"Time\" id=\"52\"><delta/></uInt64>"
+    "    <group name=\"Extra\" presence=\"optional\">"
+    "      <int64 name=\"A\"><copy/></int64>"
+    "      <byteVector name=\"B\"/>"
+    "    </group>"
+    "    <sequence name=\"Levels\">"
+    "      <length name=\"NoLevels\"/>"
+    "      <decimal name=\"Px\"><delta/></decimal>"
+    "      <uInt32 name=\"Sz\" presence=\"optional\"><copy/></uInt32>"
+    "    </sequence>"
+    "    <string name=\"Text\" presence=\"optional\"/>"
+    "  </template>"
+    "</templates>"
+    ;
+
+  // a message holds a reference to each field's identity, so these must outlive it.
+  const Messages::FieldIdentity identity_MsgSeqNum("MsgSeqNum");
+  const Messages::FieldIdentity identity_Symbol("Symbol");
+  const Messages::FieldIdentity identity_Price("Price");
+  const Messages::FieldIdentity identity_Qty("Qty");
+  const Messages::FieldIdentity identity_Time("Time");
+  const Messages::FieldIdentity identity_Extra("Extra");
+  const Messages::FieldIdentity identity_A("A");
+  const Messages::FieldIdentity identity_B("B");
+  const Messages::FieldIdentity identity_NoLevels("NoLevels");
+  const Messages::FieldIdentity identity_Levels("Levels");
+  const Messages::FieldIdentity identity_Px("Px");
+  const Messages::FieldIdentity identity_Sz("Sz");
+  const Messages::FieldIdentity identity_Text("Text");
+
+  struct Level
+  {
+    int64 px_;
+    uint32 sz_;  // zero means absent
+  };
+
+  struct Quote
+  {
+    uint32 seq_;
+    const char * symbol_;
+    int64 price_;
+    int32 qty_; // zero means absent
+    uint64 time_;
+    bool extra_;
+    int64 a_;
+    size_t levelCount_;
+    Level levels_[3];
+    const char * text_; // null means absent
+  };
+
+  const Quote quotes[] =
+  {
+    {1, "IBM", 12345, 100, 1000000, true, -7, 2, {{12340, 5}, {12330, 0}}, 0},
+    {2, "IBM", 12350, 0, 1000100, false, 0, 0, {{0, 0}}, "hello"},
+    {3, "MSFT", 2710, 100, 1000150, true, -7, 3, {{2700, 1}, {2690, 1}, {2680, 9}}, 0},
+  };
+
+  Messages::MessagePtr buildMessage(Codecs::TemplateRegistryPtr & registry, const Quote & quote)
+  {
+    Messages::MessagePtr message(new Messages::Message(registry->maxFieldCount()));
+    message->addField(identity_MsgSeqNum, Messages::FieldUInt32::create(quote.seq_));
+    message->addField(identity_Symbol, Messages::FieldAscii::create(quote.symbol_));
+    message->addField(identity_Price, Messages::FieldDecimal::create(quote.price_, -2));
+    if(quote.qty_ != 0)
+    {
+      message->addField(identity_Qty, Messages::FieldInt32::create(quote.qty_));
+    }
+    message->addField(identity_Time, Messages::FieldUInt64::create(quote.time_));
+    if(quote.extra_)
+    {
+      Messages::FieldSetPtr extra(new Messages::FieldSet(2));
+      extra->addField(identity_A, Messages::FieldInt64::create(quote.a_));
+      extra->addField(identity_B, Messages::FieldByteVector::create(std::string("\x01\x02", 2)));
+      message->addField(identity_Extra, Messages::FieldGroup::create(extra));
+    }
+    Messages::SequencePtr levels(new Messages::Sequence(identity_NoLevels, quote.levelCount_));
+    for(size_t nLevel = 0; nLevel < quote.levelCount_; ++nLevel)
+    {
+      Messages::FieldSetPtr entry(new Messages::FieldSet(2));
+      entry->addField(identity_Px, Messages::FieldDecimal::create(quote.levels_[nLevel].px_, -2));
+      if(quote.levels_[nLevel].sz_ != 0)
+      {
+        entry->addField(identity_Sz, Messages::FieldUInt32::create(quote.levels_[nLevel].sz_));
+      }
+      levels->addEntry(entry);
+    }
+    message->addField(identity_Levels, Messages::FieldSequence::create(levels));
+    if(quote.text_ != 0)
+    {
+      message->addField(identity_Text, Messages::FieldAscii::create(quote.text_));
+    }
+    return message;
+  }
+
+  void encodePositional(Codecs::PositionalEncoder & encoder, const Quote & quote)
+  {
+    encoder.startMessage(11);
+    encoder.addValue(quote.seq_);
+    encoder.addValue(std::string(quote.symbol_));
+    encoder.addValue(Decimal(quote.price_, -2));
+    if(quote.qty_ != 0)
+    {
+      encoder.addValue(quote.qty_);
+    }
+    else
+    {
+      encoder.addAbsent();
+    }
+    encoder.addValue(quote.time_);
+    if(quote.extra_)
+    {
+      encoder.startGroup();
+      encoder.addValue(quote.a_);
+      encoder.addValue(std::string("\x01\x02", 2));
+      encoder.endGroup();
+    }
+    else
+    {
+      encoder.addAbsent();
+    }
+    encoder.startSequence(quote.levelCount_);
+    for(size_t nLevel = 0; nLevel < quote.levelCount_; ++nLevel)
+    {
+      encoder.startSequenceEntry();
+      encoder.addValue(Decimal(quote.levels_[nLevel].px_, -2));
+      if(quote.levels_[nLevel].sz_ != 0)
+      {
+        encoder.addValue(quote.levels_[nLevel].sz_);
+      }
+      // an absent Sz is left for endSequenceEntry to fill in.
+      encoder.endSequenceEntry();
+    }
+    encoder.endSequence();
+    if(quote.text_ != 0)
+    {
+      encoder.addValue(std::string(quote.text_));
+    }
+    encoder.endMessage();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestPositionalEncoder)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr registry = parser.parse(templateStream);
+
+  // the same messages through the accessor-driven encoder and the positional one.
+  Codecs::Encoder accessorEncoder(registry);
+  Codecs::DataDestination accessorDestination;
+  Codecs::Encoder valueEncoder(registry);
+  Codecs::DataDestination valueDestination;
+  Codecs::PositionalEncoder positional(valueEncoder, valueDestination);
+
+  const size_t quoteCount = sizeof(quotes) / sizeof(quotes[0]);
+  for(size_t nQuote = 0; nQuote < quoteCount; ++nQuote)
+  {
+    Messages::MessagePtr message = buildMessage(registry, quotes[nQuote]);
+    accessorEncoder.encodeMessage(accessorDestination, 11, *message);
+    encodePositional(positional, quotes[nQuote]);
+  }
+  std::string expected;
+  accessorDestination.toString(expected);
+  std::string actual;
+  valueDestination.toString(actual);
+  BOOST_CHECK(!expected.empty());
+  BOOST_CHECK(actual == expected);
+
+  // slots count the fields of the static templateRef in line.
+  size_t slot = 0;
+  BOOST_CHECK(positional.findSlot(11, "MsgSeqNum", slot));
+  BOOST_CHECK_EQUAL(slot, 0u);
+  BOOST_CHECK(positional.findSlot(11, "Time", slot));
+  BOOST_CHECK_EQUAL(slot, 4u);
+  BOOST_CHECK(positional.findSlot(11, "Text", slot));
+  BOOST_CHECK_EQUAL(slot, 7u);
+  BOOST_CHECK(!positional.findSlot(11, "Px", slot));
+
+  // skipTo leaves the optional fields in between absent.
+  Messages::MessagePtr sparse(new Messages::Message(registry->maxFieldCount()));
+  sparse->addField(identity_MsgSeqNum, Messages::FieldUInt32::create(4));
+  sparse->addField(identity_Symbol, Messages::FieldAscii::create("MSFT"));
+  sparse->addField(identity_Price, Messages::FieldDecimal::create(2700, -2));
+  sparse->addField(identity_Time, Messages::FieldUInt64::create(1000151));
+  Messages::SequencePtr noLevels(new Messages::Sequence(identity_NoLevels, 0));
+  sparse->addField(identity_Levels, Messages::FieldSequence::create(noLevels));
+  sparse->addField(identity_Text, Messages::FieldAscii::create("sparse"));
+  accessorDestination.clear();
+  accessorEncoder.encodeMessage(accessorDestination, 11, *sparse);
+
+  size_t timeSlot = 0;
+  size_t levelsSlot = 0;
+  BOOST_REQUIRE(positional.findSlot(11, "Time", timeSlot));
+  BOOST_REQUIRE(positional.findSlot(11, "Levels", levelsSlot));
+  valueDestination.clear();
+  positional.startMessage(11);
+  positional.addValue(uint32(4));
+  positional.addValue(std::string("MSFT"));
+  positional.addValue(Decimal(2700, -2));
+  positional.skipTo(timeSlot);
+  positional.addValue(uint64(1000151));
+  positional.skipTo(levelsSlot);
+  positional.startSequence(0);
+  positional.endSequence();
+  positional.addValue(std::string("sparse"));
+  positional.endMessage();
+
+  accessorDestination.toString(expected);
+  valueDestination.toString(actual);
+  BOOST_CHECK(actual == expected);
+
+  // misuse is reported, and the next message starts clean.
+  positional.startMessage(11);
+  BOOST_CHECK_THROW(positional.startGroup(), UsageError);
+  BOOST_CHECK_THROW(positional.endSequence(), UsageError);
+  BOOST_CHECK_THROW(positional.startMessage(99), EncodingError);
+}
@@ -0,0 +1,207 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/XMLTemplateParser.h>
+#include <Codecs/NoHeaderAnalyzer.h>
+#include <Codecs/MessagePerPacketAssembler.h>
+#include <Codecs/GenericMessageBuilder.h>
+#include <Codecs/MessageConsumer.h>
+#include <Messages/Message.h>
+#include <Communication/AsynchReceiver.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  const char template_xml[] =
+    "<templates>"
+    "  <template name=\"segment\" id=\"2\">"
+    "     <uInt32 name=\"seq\" id=\"1\"><copy/></uInt32>"
+    "  </template>"
+    "</templates>"
+    ;
+
+  class SegmentConsumer : public Codecs::MessageConsumer
+  {
+  public:
+    SegmentConsumer()
+      : errorCount_(0)
+    {
+    }
+
+    virtual bool consumeMessage(Messages::Message & message)
+    {
+      Messages::FieldCPtr value;
+      if(message.getField("seq", value))
+      {
+        seqs_.push_back(value->toUInt32());
+      }
+      return true;
+    }
+    virtual bool wantLog(unsigned short /*level*/)
+    {
+      return false;
+    }
+    virtual bool logMessage(unsigned short /*level*/, const std::string & /*logMessage*/)
+    {
+      return true;
+    }
+    virtual bool reportDecodingError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual bool reportCommunicationError(const std::string & /*errorMessage*/)
+    {
+      ++errorCount_;
+      return true;
+    }
+    virtual void decodingStarted()
+    {
+    }
+    virtual void decodingStopped()
+    {
+    }
+
+  public: // because this is a test class
+    std::vector<uint32> seqs_;
+    size_t errorCount_;
+  };
+
+  /// Completes reads on demand as if the kernel had coalesced several datagrams.
+  class SegmentingReceiver : public Communication::AsynchReceiver
+  {
+  public:
+    SegmentingReceiver()
+      : pending_(0)
+    {
+    }
+
+    void deliver(const std::string & data, size_t segmentSize)
+    {
+      Communication::LinkedBuffer * buffer = pending_;
+      BOOST_REQUIRE(buffer != 0);
+      BOOST_REQUIRE(data.size() <= buffer->capacity());
+      pending_ = 0;
+      memcpy(buffer->get(), data.data(), data.size());
+      handleCoalescedReceive(boost::system::error_code(), buffer, data.size(), segmentSize);
+    }
+
+  private:
+    virtual bool initializeReceiver()
+    {
+      return true;
+    }
+
+    virtual bool fillBuffer(Communication::LinkedBuffer * buffer, boost::mutex::scoped_lock &)
+    {
+      pending_ = buffer;
+      return true;
+    }
+
+  private:
+    Communication::LinkedBuffer * pending_;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(TestSegmentedReceive)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  Codecs::NoHeaderAnalyzer packetHeaderAnalyzer;
+  Codecs::NoHeaderAnalyzer messageHeaderAnalyzer;
+  SegmentConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+  Codecs::MessagePerPacketAssembler assembler(
+      templateRegistry,
+      packetHeaderAnalyzer,
+      messageHeaderAnalyzer,
+      builder);
+  SegmentingReceiver receiver;
+  BOOST_REQUIRE(receiver.start(assembler, 64, 2));
+
+  // three 4 byte packets (seq = 128 + n) and a 3 byte packet (seq = 1)
+  std::string coalesced;
+  for(size_t nPacket = 0; nPacket < 3; ++nPacket)
+  {
+    coalesced += "\xE0\x82\x01";
+    coalesced += char(0x80 + nPacket);
+  }
+  coalesced += "\xE0\x82\x81";
+
+  // Three rounds: the first buffer must be reused once all of its segments are released.
+  for(size_t nRound = 0; nRound < 3; ++nRound)
+  {
+    receiver.deliver(coalesced, 4);
+  }
+  // a single packet is passed through as is.
+  receiver.deliver(std::string("\xE0\x82\x82", 3), 4);
+
+  BOOST_CHECK_EQUAL(consumer.errorCount_, 0u);
+  BOOST_REQUIRE_EQUAL(consumer.seqs_.size(), 13u);
+  for(size_t nRound = 0; nRound < 3; ++nRound)
+  {
+    BOOST_CHECK_EQUAL(consumer.seqs_[nRound * 4 + 0], 128u);
+    BOOST_CHECK_EQUAL(consumer.seqs_[nRound * 4 + 1], 129u);
+    BOOST_CHECK_EQUAL(consumer.seqs_[nRound * 4 + 2], 130u);
+    BOOST_CHECK_EQUAL(consumer.seqs_[nRound * 4 + 3], 1u);
+  }
+  BOOST_CHECK_EQUAL(consumer.seqs_[12], 2u);
+  BOOST_CHECK_EQUAL(receiver.coalescedReceives(), 3u);
+  BOOST_CHECK_EQUAL(receiver.packetsQueued(), 13u);
+  BOOST_CHECK_EQUAL(receiver.largestPacket(), 4u);
+  BOOST_CHECK_EQUAL(receiver.buffersAllocated(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(TestInlineService)
+{
+  std::stringstream templateStream(template_xml);
+  Codecs::XMLTemplateParser parser;
+  Codecs::TemplateRegistryPtr templateRegistry =
+    parser.parse(templateStream);
+
+  Codecs::NoHeaderAnalyzer packetHeaderAnalyzer;
+  Codecs::NoHeaderAnalyzer messageHeaderAnalyzer;
+  SegmentConsumer consumer;
+  Codecs::GenericMessageBuilder builder(consumer);
+  Codecs::MessagePerPacketAssembler assembler(
+      templateRegistry,
+      packetHeaderAnalyzer,
+      messageHeaderAnalyzer,
+      builder);
+  SegmentingReceiver receiver;
+  receiver.setInlineService();
+  BOOST_REQUIRE(receiver.start(assembler, 64, 2));
+
+  // single packets bypass the queue
+  for(unsigned char seq = 1; seq <= 5; ++seq)
+  {
+    const char packet[] = {char(0xE0), char(0x82), char(0x80 | seq)};
+    receiver.deliver(std::string(packet, sizeof(packet)), 0);
+  }
+  BOOST_CHECK_EQUAL(receiver.buffersServicedInline(), 5u);
+  BOOST_CHECK_EQUAL(receiver.batchesProcessed(), 0u);
+
+  // segments are queued
+  std::string coalesced("\xE0\x82\x86\xE0\x82\x87", 6);
+  receiver.deliver(coalesced, 3);
+  BOOST_CHECK_EQUAL(receiver.buffersServicedInline(), 5u);
+  BOOST_CHECK(receiver.batchesProcessed() > 0u);
+
+  BOOST_CHECK_EQUAL(consumer.errorCount_, 0u);
+  BOOST_REQUIRE_EQUAL(consumer.seqs_.size(), 7u);
+  for(size_t nMessage = 0; nMessage < 7; ++nMessage)
+  {
+    BOOST_CHECK_EQUAL(consumer.seqs_[nMessage], nMessage + 1);
+  }
+  BOOST_CHECK_EQUAL(receiver.packetsProcessed(), 7u);
+  BOOST_CHECK_EQUAL(receiver.buffersAllocated(), 2u);
+}
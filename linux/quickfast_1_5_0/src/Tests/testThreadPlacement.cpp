@@ -0,0 +1,139 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Communication/ThreadPlacement.h>
+#include <Communication/AsioService.h>
+#include <Common/Exceptions.h>
+
+#if defined(__linux__)
+# include <pthread.h>
+# include <sched.h>
+#endif // __linux__
+
+using namespace QuickFAST;
+
+BOOST_AUTO_TEST_CASE(TestThreadPlacementParse)
+{
+  Communication::ThreadPlacement placement;
+  BOOST_CHECK(placement.empty());
+  BOOST_CHECK(placement.cpus(0).empty());
+  BOOST_CHECK_EQUAL(placement.numaNode(0), -1);
+
+  placement.addThreads("3:1-2,5");
+  BOOST_CHECK(!placement.empty());
+  BOOST_REQUIRE_EQUAL(placement.slotCount(), 2u);
+  BOOST_REQUIRE_EQUAL(placement.cpus(0).size(), 1u);
+  BOOST_CHECK_EQUAL(placement.cpus(0)[0], 3u);
+  BOOST_REQUIRE_EQUAL(placement.cpus(1).size(), 3u);
+  BOOST_CHECK_EQUAL(placement.cpus(1)[0], 1u);
+  BOOST_CHECK_EQUAL(placement.cpus(1)[1], 2u);
+  BOOST_CHECK_EQUAL(placement.cpus(1)[2], 5u);
+  // threads beyond the last slot cycle through the slots
+  BOOST_CHECK_EQUAL(placement.cpus(2)[0], 3u);
+  BOOST_CHECK_EQUAL(placement.cpus(3).size(), 3u);
+
+  BOOST_CHECK_THROW(placement.addThreads(""), UsageError);
+  BOOST_CHECK_THROW(placement.addThreads("1::2"), UsageError);
+  BOOST_CHECK_THROW(placement.addThreads("4-2"), UsageError);
+  BOOST_CHECK_THROW(placement.addThreads("x"), UsageError);
+  // a bad description adds nothing.
+  BOOST_CHECK_EQUAL(placement.slotCount(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(TestNamedIoService)
+{
+  boost::asio::io_service & first = Communication::AsioService::namedIoService("placement-a");
+  BOOST_CHECK(&first == &Communication::AsioService::namedIoService("placement-a"));
+  BOOST_CHECK(&first != &Communication::AsioService::namedIoService("placement-b"));
+}
+
+namespace
+{
+  void recordThreadCount(const Communication::AsioService * service, long * count)
+  {
+    *count = service->runningThreadCount();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestNamedIoServiceThreadCount)
+{
+  // a thread running one connection's event loop runs the other's too.
+  boost::asio::io_service & shared = Communication::AsioService::namedIoService("thread-count");
+  Communication::AsioService running(shared);
+  Communication::AsioService idle(shared);
+  long count = -1;
+  running.post(boost::bind(recordThreadCount, &idle, &count));
+  running.run();
+  BOOST_CHECK_EQUAL(count, 1);
+  BOOST_CHECK_EQUAL(idle.runningThreadCount(), 0);
+}
+
+#if defined(__linux__)
+namespace
+{
+  struct ThreadReport
+  {
+    ThreadReport()
+      : cpuCount_(0)
+      , cpu_(0)
+    {
+      name_[0] = 0;
+    }
+
+    void record()
+    {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      if(::pthread_getaffinity_np(::pthread_self(), sizeof(cpus), &cpus) == 0)
+      {
+        cpuCount_ = CPU_COUNT(&cpus);
+        for(cpu_ = 0; cpu_ < CPU_SETSIZE && !CPU_ISSET(cpu_, &cpus); ++cpu_)
+        {
+        }
+      }
+      ::pthread_getname_np(::pthread_self(), name_, sizeof(name_));
+    }
+
+    int cpuCount_;
+    int cpu_;
+    char name_[16];
+  };
+}
+
+BOOST_AUTO_TEST_CASE(TestThreadPlacementApplied)
+{
+  // pin to the last CPU this process may use.
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  BOOST_REQUIRE(::sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+  unsigned int target = 0;
+  for(unsigned int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+  {
+    if(CPU_ISSET(cpu, &allowed))
+    {
+      target = cpu;
+    }
+  }
+
+  Communication::ThreadPlacement placement;
+  placement.addThread(Communication::ThreadPlacement::CpuSet(1, target));
+  placement.setName("qfplacement");
+
+  boost::asio::io_service ioService;
+  Communication::AsioService service(ioService);
+  service.setThreadPlacement(placement);
+  ThreadReport report;
+  service.post(boost::bind(&ThreadReport::record, &report));
+  service.startThreads(1);
+  service.joinThreads();
+
+  BOOST_CHECK_EQUAL(report.cpuCount_, 1);
+  BOOST_CHECK_EQUAL(report.cpu_, int(target));
+  BOOST_CHECK_EQUAL(std::string(report.name_), "qfplacement-0");
+}
+#endif // __linux__
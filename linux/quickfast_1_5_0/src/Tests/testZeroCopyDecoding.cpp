@@ -0,0 +1,138 @@
+// Copyright (c) 2009, 2010, 2011 Object Computing, Inc.
+// All rights reserved.
+// See the file license.txt for licensing information.
+#include <Common/QuickFASTPch.h>
+
+#define BOOST_TEST_NO_MAIN QuickFASTTest
+#include <boost/test/unit_test.hpp>
+
+#include <Codecs/FieldInstructionByteVector.h>
+#include <Codecs/FieldInstructionAscii.h>
+#include <Codecs/DataSourceBuffer.h>
+#include <Codecs/DictionaryIndexer.h>
+#include <Codecs/PresenceMap.h>
+#include <Codecs/TemplateRegistry.h>
+#include <Codecs/Decoder.h>
+#include <Messages/SingleValueBuilder.h>
+
+using namespace QuickFAST;
+
+namespace
+{
+  /// Remember where the decoder said the value was.
+  class ViewRecorder : public Messages::SingleValueBuilder<std::string>
+  {
+  public:
+    ViewRecorder()
+      : view_(0)
+      , length_(0)
+    {
+    }
+
+    virtual void addValue(const Messages::FieldIdentity & identity, ValueType::Type type, const unsigned char * value, size_t length)
+    {
+      view_ = value;
+      length_ = length;
+      Messages::SingleValueBuilder<std::string>::addValue(identity, type, value, length);
+    }
+
+    const unsigned char * view_;
+    size_t length_;
+  };
+
+  /// Deliver the data a few bytes at a time so values straddle buffers.
+  class ChoppedDataSource : public Codecs::DataSource
+  {
+  public:
+    ChoppedDataSource(const unsigned char * data, size_t size, size_t chunk)
+      : data_(data)
+      , size_(size)
+      , chunk_(chunk)
+      , position_(0)
+    {
+    }
+
+  protected:
+    virtual bool getBuffer(const uchar *& buffer, size_t & size)
+    {
+      if(position_ >= size_)
+      {
+        return false;
+      }
+      buffer = data_ + position_;
+      size = std::min(chunk_, size_ - position_);
+      position_ += size;
+      return true;
+    }
+
+  private:
+    const unsigned char * data_;
+    size_t size_;
+    size_t chunk_;
+    size_t position_;
+  };
+
+  template<typename INSTRUCTION>
+  void decodeOne(Codecs::DataSource & source, ViewRecorder & builder)
+  {
+    Codecs::DictionaryIndexer indexer;
+    Codecs::PresenceMap pmap(1);
+    INSTRUCTION field("Value", "");
+    field.indexDictionaries(indexer, "global", "", "");
+    Codecs::TemplateRegistryPtr registry(new Codecs::TemplateRegistry(3, 3, indexer.size()));
+    field.finalize(*registry);
+    Codecs::Decoder decoder(registry);
+    field.decode(source, pmap, decoder, builder);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestZeroCopyByteVector)
+{
+  const unsigned char data[] = {0x85, 'h', 'e', 'l', 'l', 'o'};
+  Codecs::DataSourceBuffer source(data, sizeof(data));
+  ViewRecorder builder;
+  decodeOne<Codecs::FieldInstructionByteVector>(source, builder);
+  BOOST_REQUIRE(builder.isSet());
+  BOOST_CHECK_EQUAL(builder.value(), "hello");
+  // handed out in place: no copy.
+  BOOST_CHECK(builder.view_ == data + 1);
+  BOOST_CHECK_EQUAL(builder.length_, 5u);
+  uchar byte;
+  BOOST_CHECK(!source.getByte(byte));
+}
+
+BOOST_AUTO_TEST_CASE(TestZeroCopyByteVectorStraddlesBuffers)
+{
+  const unsigned char data[] = {0x85, 'h', 'e', 'l', 'l', 'o'};
+  ChoppedDataSource source(data, sizeof(data), 2);
+  ViewRecorder builder;
+  decodeOne<Codecs::FieldInstructionByteVector>(source, builder);
+  BOOST_REQUIRE(builder.isSet());
+  BOOST_CHECK_EQUAL(builder.value(), "hello");
+  BOOST_CHECK(builder.view_ < data || builder.view_ >= data + sizeof(data));
+  uchar byte;
+  BOOST_CHECK(!source.getByte(byte));
+}
+
+BOOST_AUTO_TEST_CASE(TestAsciiFromContiguousAndStraddledBuffers)
+{
+  const unsigned char data[] = {'h', 'e', 'l', 'l', 'o' | 0x80};
+  {
+    Codecs::DataSourceBuffer source(data, sizeof(data));
+    ViewRecorder builder;
+    decodeOne<Codecs::FieldInstructionAscii>(source, builder);
+    BOOST_REQUIRE(builder.isSet());
+    BOOST_CHECK_EQUAL(builder.value(), "hello");
+    uchar byte;
+    BOOST_CHECK(!source.getByte(byte));
+  }
+  {
+    ChoppedDataSource source(data, sizeof(data), 2);
+    ViewRecorder builder;
+    decodeOne<Codecs::FieldInstructionAscii>(source, builder);
+    BOOST_REQUIRE(builder.isSet());
+    BOOST_CHECK_EQUAL(builder.value(), "hello");
+    uchar byte;
+    BOOST_CHECK(!source.getByte(byte));
+  }
+}